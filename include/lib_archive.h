@@ -0,0 +1,58 @@
+/* lib_archive.h
+ * Arsip riwayat pinjaman per bulan untuk library.c (bukan bagian dari API publik).
+ * - Pinjaman selesai dari bulan yang sudah lewat dipindah saat checkpoint dari
+ *   _loans.csv ke file partisi <db>_loans_YYYY-MM.csv (format sama)
+ * - <db>_loans_manifest.csv mencatat satu baris per file: bulan, jumlah baris
+ *   dan rentang date_returned. Query memilih partisi hanya dari manifest;
+ *   file yang rentangnya tidak beririsan tidak dibuka
+ * - File partisi tidak pernah ditulis ulang oleh save. Pinjaman yang masuk ke
+ *   bulan yang sudah diarsip (mis. tanggal kembali mundur) menjadi segmen baru
+ *   bulan itu: <db>_loans_YYYY-MM_2.csv, dst.
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_ARCHIVE_H
+#define PERPUSTAKAAN_LIB_ARCHIVE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "library.h"
+
+#define LIB_ARCHIVE_FILE_MAX 48
+
+typedef struct {
+    char file[LIB_ARCHIVE_FILE_MAX];  /* sufiks path DB, mis. "_loans_2024-03.csv" */
+    int year;
+    int month;
+    size_t rows;
+    lib_date_t first;                 /* date_returned terkecil / terbesar */
+    lib_date_t last;
+} lib_archive_part_t;
+
+typedef struct lib_archive {
+    lib_archive_part_t *parts;        /* urutan manifest (urutan pengarsipan) */
+    size_t count;
+    size_t capacity;
+    lib_archive_stats_t stats;        /* partitions/archived_rows selalu sinkron */
+} lib_archive_t;
+
+/* Baca manifest; file tidak ada = arsip kosong. NULL hanya jika memori habis. */
+lib_archive_t *lib_archive_load(const char *manifest_path);
+void lib_archive_free(lib_archive_t *a);
+/* Tulis manifest ke path (pemanggil mengurus .tmp + rename). 0 / -1. */
+int lib_archive_write(const lib_archive_t *a, const char *path);
+
+/* Isi part->file/year/month dengan nama segmen baru yang belum dipakai bulan itu */
+void lib_archive_name_part(const lib_archive_t *a, int year, int month, lib_archive_part_t *part);
+bool lib_archive_add(lib_archive_t *a, const lib_archive_part_t *part);
+void lib_archive_remove(lib_archive_t *a, size_t i);
+/* Buang entri sesudah `count` pertama (rollback penambahan yang gagal ditulis) */
+void lib_archive_truncate(lib_archive_t *a, size_t count);
+/* Ada segmen untuk bulan ini? */
+bool lib_archive_has_month(const lib_archive_t *a, int year, int month);
+/* Rentang date_returned partisi beririsan dengan [from, to] */
+bool lib_archive_overlaps(const lib_archive_part_t *p, lib_date_t from, lib_date_t to);
+int lib_archive_date_cmp(lib_date_t a, lib_date_t b);
+
+#endif /* PERPUSTAKAAN_LIB_ARCHIVE_H */
@@ -0,0 +1,89 @@
+/* lib_arena.h
+ * Alokator region untuk library.c (bukan bagian dari API publik).
+ * - lib_arena_t: rantai blok; alokasi = geser pointer, tidak ada free per objek.
+ *   Blok berikutnya dua kali lebih besar, jadi jumlah blok ~ log(total byte)
+ *   dan lib_arena_free hanya membebaskan beberapa blok
+ * - Arena milik DB menyimpan tabel, path DB dan indeks. Alokasi besar
+ *   (>= LIB_ARENA_LARGE) punya blok sendiri yang di-realloc saat tumbuh
+ *   dan dibebaskan lib_mem_release (slot lama saat rehash indeks); array
+ *   kecil yang tumbuh ditinggal di arena. Impor membangun arena baru lalu
+ *   membuang yang lama utuh
+ * - Scratch arena (LIB_SCRATCH): blok pertama = buffer di stack pemanggil,
+ *   heap hanya dipakai jika sementara per query melebihi buffer itu
+ * - lib_heap_*: malloc/calloc/realloc/free yang dihitung. Semua modul library
+ *   memakai ini sehingga lib_get_alloc_stats melihat setiap panggilan heap
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_ARENA_H
+#define PERPUSTAKAAN_LIB_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define LIB_ARENA_ALIGN 16
+#define LIB_ARENA_FIRST_BLOCK (64u * 1024u)
+#define LIB_ARENA_MAX_BLOCK (16u * 1024u * 1024u)   /* di atas ini blok = ukuran permintaan */
+#define LIB_ARENA_LARGE (256u * 1024u)                /* blok sendiri untuk alokasi sebesar ini */
+#define LIB_SCRATCH_INLINE 1024
+
+typedef struct lib_arena_block {
+    struct lib_arena_block *prev;   /* blok lebih lama */
+    size_t size;                    /* byte data sesudah header */
+    size_t used;
+    bool owned;                     /* false = buffer milik pemanggil */
+    bool large;                     /* blok satu alokasi besar (boleh dilepas sendiri) */
+} lib_arena_block_t;
+
+typedef struct lib_arena {
+    lib_arena_block_t *head;        /* blok aktif (terbaru) */
+    size_t next_size;
+    void *last;                     /* alokasi terakhir; bisa diperbesar di tempat */
+    size_t blocks;                  /* blok heap milik arena */
+    size_t reserved;                /* byte blok heap */
+    size_t used;                    /* byte teralokasi, termasuk padding */
+} lib_arena_t;
+
+/* Arena kosong; buf (boleh NULL) dipakai sebagai blok pertama tanpa dibebaskan */
+void lib_arena_init(lib_arena_t *a, void *buf, size_t n);
+/* Arena di heap; struct-nya sendiri tinggal di blok pertama. NULL jika memori habis. */
+lib_arena_t *lib_arena_create(void);
+/* Lepas semua blok milik arena sekaligus (arena dari lib_arena_create ikut hilang) */
+void lib_arena_free(lib_arena_t *a);
+/* Pindahkan semua blok src ke dst; src tidak boleh dipakai lagi */
+void lib_arena_adopt(lib_arena_t *dst, lib_arena_t *src);
+
+/* Rata LIB_ARENA_ALIGN; isi tidak diinisialisasi. NULL jika memori habis. */
+void *lib_arena_alloc(lib_arena_t *a, size_t n);
+void *lib_arena_calloc(lib_arena_t *a, size_t count, size_t size);
+/* Seperti realloc: isi lama disalin, sisanya tidak diinisialisasi. old_n harus
+ * ukuran alokasi p saat ini. Alokasi besar di-realloc bersama bloknya, alokasi
+ * kecil terakhir diperbesar di tempat bila blok cukup; lainnya disalin. */
+void *lib_arena_grow(lib_arena_t *a, void *p, size_t old_n, size_t new_n);
+char *lib_arena_strdup(lib_arena_t *a, const char *s);
+
+/* Scratch arena di stack: LIB_SCRATCH(s); ... lib_arena_free(&s); */
+#define LIB_SCRATCH(name) \
+    unsigned char name##_inline[LIB_SCRATCH_INLINE]; \
+    lib_arena_t name; \
+    lib_arena_init(&name, name##_inline, sizeof(name##_inline))
+
+/* Heap dengan counter (thread-safe) */
+void *lib_heap_malloc(size_t n);
+void *lib_heap_calloc(size_t count, size_t size);
+void *lib_heap_realloc(void *p, size_t n);
+void lib_heap_free(void *p);
+
+/* Alokasi dari arena, atau dari heap jika a == NULL (struktur indeks di luar DB) */
+void *lib_mem_calloc(lib_arena_t *a, size_t count, size_t size);
+void *lib_mem_grow(lib_arena_t *a, void *p, size_t old_n, size_t new_n);
+/* Arena: alokasi besar dibebaskan sekarang, alokasi kecil menunggu lib_arena_free */
+void lib_mem_release(lib_arena_t *a, void *p);
+
+/* Counter global sejak program mulai */
+unsigned long long lib_heap_alloc_count(void);   /* malloc + calloc + realloc */
+unsigned long long lib_heap_free_count(void);
+unsigned long long lib_arena_alloc_count(void);  /* alokasi yang dilayani arena */
+
+#endif /* PERPUSTAKAAN_LIB_ARENA_H */
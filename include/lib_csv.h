@@ -0,0 +1,117 @@
+/* lib_csv.h
+ * CSV RFC 4180 internal untuk library.c (bukan bagian dari API publik).
+ * - Reader streaming: file dibaca per blok besar, field menunjuk langsung ke
+ *   buffer (di-NUL-terminate dan di-unescape di tempat, tanpa alokasi per baris)
+ * - Field boleh diapit tanda kutip; "" di dalamnya berarti satu tanda kutip,
+ *   koma dan baris baru di dalam kutip adalah bagian dari field
+ * - Writer mengutip field yang berisi koma, kutip atau baris baru; angka,
+ *   harga dan tanggal diformat tanpa printf
+ * - lib_csv_writer_t: baris diformat langsung ke satu buffer besar yang
+ *   dikirim ke file dengan fwrite besar (stream tanpa buffer stdio)
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_CSV_H
+#define PERPUSTAKAAN_LIB_CSV_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct {
+    char *ptr;      /* NUL-terminated, milik buffer reader/baris */
+    size_t len;
+} lib_csv_field_t;
+
+typedef struct {
+    FILE *fp;
+    char *buf;
+    size_t cap;
+    size_t len;     /* byte valid di buf */
+    size_t pos;     /* awal record berikutnya */
+    bool eof;
+} lib_csv_reader_t;
+
+/* Buka file untuk dibaca; false jika tidak ada / gagal. */
+bool lib_csv_open(lib_csv_reader_t *r, const char *path);
+void lib_csv_close(lib_csv_reader_t *r);
+
+/* Record berikutnya (baris kosong dilewati). Mengembalikan jumlah field,
+ * 0 di akhir file, -1 jika memori habis. Jika record punya lebih dari
+ * max_fields field, field terakhir berisi sisa record apa adanya (kompatibel
+ * dengan CSV lama yang kolom terakhirnya tidak dikutip). Field valid sampai
+ * panggilan berikutnya. */
+int lib_csv_next(lib_csv_reader_t *r, lib_csv_field_t *fields, size_t max_fields);
+
+/* Pecah satu record yang sudah ada di memori (mis. payload journal). `line`
+ * diubah di tempat. */
+size_t lib_csv_split(char *line, size_t len, lib_csv_field_t *fields, size_t max_fields);
+
+/* Untuk memecah file besar menjadi potongan berisi record utuh: pindai
+ * [p, p+len) sambil melanjutkan status kutip *quoted dari blok sebelumnya.
+ * Mengembalikan offset tepat setelah '\n' akhir record terakhir yang utuh
+ * (0 jika tidak ada). */
+size_t lib_csv_last_record_end(const char *p, size_t len, bool *quoted);
+
+/* Record berikutnya dari potongan di memori yang hanya berisi record utuh.
+ * *cursor maju melewati record; 0 jika potongan habis. Diubah di tempat;
+ * buffer harus punya satu byte cadangan setelah `end` (untuk NUL). */
+size_t lib_csv_next_in(char **cursor, char *end, lib_csv_field_t *fields, size_t max_fields);
+
+/* Konversi field tanpa sscanf/strtol (mengabaikan spasi di depan, berhenti
+ * di karakter pertama yang tidak valid seperti atol/atof). */
+long lib_csv_to_long(const lib_csv_field_t *f);
+double lib_csv_to_double(const lib_csv_field_t *f);
+/* "YYYY-MM-DD" (juga bentuk tanpa nol di depan seperti 2025-1-5) */
+bool lib_csv_to_date(const lib_csv_field_t *f, int *year, int *month, int *day);
+
+/* Penyusun satu baris CSV ke buffer tetap. len menghitung panjang penuh
+ * walaupun buffer terpotong (seperti snprintf). */
+typedef struct {
+    char *out;
+    size_t cap;
+    size_t len;
+    size_t fields;
+} lib_csv_row_t;
+
+void lib_csv_row_init(lib_csv_row_t *row, char *out, size_t cap);
+/* Field teks: dikutip bila berisi koma, kutip atau baris baru */
+void lib_csv_row_str(lib_csv_row_t *row, const char *s);
+/* Field yang sudah pasti aman (angka, tanggal) */
+void lib_csv_row_raw(lib_csv_row_t *row, const char *s);
+/* Bilangan bulat tanpa printf. prefix != 0 ditulis di depan angka (mis. 'L'
+ * untuk ID), min_digits = lebar minimal dengan nol di depan (seperti %0*llu) */
+void lib_csv_row_long(lib_csv_row_t *row, long v);
+void lib_csv_row_uint(lib_csv_row_t *row, char prefix, unsigned long long v, int min_digits);
+/* Dua desimal, hasilnya sama dengan printf("%.2f") */
+void lib_csv_row_fixed2(lib_csv_row_t *row, double v);
+/* "YYYY-MM-DD" seperti printf("%04d-%02d-%02d") */
+void lib_csv_row_date(lib_csv_row_t *row, int year, int month, int day);
+/* Panjang baris (tanpa NUL); >= cap berarti terpotong */
+int lib_csv_row_end(lib_csv_row_t *row);
+
+/* Writer file: setiap flush = satu fwrite sebesar buffer ke stream tanpa
+ * buffer stdio, jadi satu write() per LIB_CSV_WRITE_BUF byte */
+#define LIB_CSV_WRITE_BUF (1u << 20)
+
+typedef struct {
+    FILE *fp;
+    char *buf;
+    size_t len;
+    bool failed;            /* fwrite gagal atau baris melebihi max_len; penulisan berikutnya diabaikan */
+    unsigned long long bytes;
+} lib_csv_writer_t;
+
+/* fopen(path, "w"); false jika file tidak bisa dibuka (errno dari fopen) atau memori habis */
+bool lib_csv_writer_open(lib_csv_writer_t *w, const char *path);
+void lib_csv_writer_put(lib_csv_writer_t *w, const char *s, size_t n);
+/* Mulai baris langsung di buffer writer; baris lebih dari max_len - 1 byte
+ * menandai writer gagal (failed), sehingga lib_csv_writer_close false */
+void lib_csv_writer_row(lib_csv_writer_t *w, lib_csv_row_t *row, size_t max_len);
+/* Akhiri baris dari lib_csv_writer_row dengan '\n' */
+void lib_csv_writer_end_row(lib_csv_writer_t *w, lib_csv_row_t *row);
+/* Kirim sisa buffer, fsync bila sync, tutup file. false jika ada yang gagal. */
+bool lib_csv_writer_close(lib_csv_writer_t *w, bool sync);
+
+#endif /* PERPUSTAKAAN_LIB_CSV_H */
@@ -0,0 +1,41 @@
+/* lib_import.h
+ * Pipeline impor CSV besar untuk library.c (bukan bagian dari API publik).
+ * - Tahap: pembaca blok -> pemotong di batas record -> N parser paralel ->
+ *   satu inserter berurutan (thread pemanggil)
+ * - Antar tahap dihubungkan antrian terbatas: memori tetap, berapa pun
+ *   ukuran file
+ * - Urutan baris hasil impor sama dengan urutan di file
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_IMPORT_H
+#define PERPUSTAKAAN_LIB_IMPORT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "library.h"
+#include "lib_csv.h"
+
+#define LIB_IMPORT_MAX_FIELDS 16
+#define LIB_IMPORT_MAX_PARSERS 8
+
+typedef struct {
+    size_t record_size;      /* ukuran satu record hasil parse */
+    size_t max_fields;       /* <= LIB_IMPORT_MAX_FIELDS */
+    /* Dipanggil di thread parser (harus reentrant); false = record dilewati */
+    bool (*parse)(const lib_csv_field_t *f, size_t n, void *out);
+    /* Dipanggil di thread pemanggil, satu per record, sesuai urutan file */
+    lib_status_t (*insert)(void *ctx, const void *rec);
+    void *ctx;
+} lib_import_table_t;
+
+/* Impor satu file CSV (record pertama = header, dilewati). File tidak ada =
+ * LIB_OK tanpa baris. Statistik ditambahkan ke *stats (boleh NULL).
+ * `parsers` 0 = sesuai jumlah CPU. Jika thread tidak bisa dibuat, tidak ada
+ * record yang dimasukkan dan *pipelined = false; pemanggil membaca file
+ * dengan cara biasa. */
+lib_status_t lib_import_csv(const char *path, const lib_import_table_t *t, unsigned parsers,
+                            lib_import_stats_t *stats, bool *pipelined);
+
+#endif /* PERPUSTAKAAN_LIB_IMPORT_H */
@@ -0,0 +1,145 @@
+/* lib_index.h
+ * Indeks internal untuk library.c (bukan bagian dari API publik).
+ * - lib_hindex_t: hash index open addressing (linear probing) yang memetakan
+ *   hash kunci -> nomor baris di tabel (books / borrowers / loans).
+ * - Indeks tidak menyimpan kunci; perbandingan kunci dilakukan lewat callback
+ *   sehingga satu implementasi dipakai untuk ISBN, loan_id, id dan NIM.
+ * - lib_trigram_index_t: posting list trigram untuk pencarian substring.
+ * - lib_calendar_index_t: bucket per hari untuk query rentang tanggal.
+ * - Memori indeks diambil dari arena yang diberikan saat init (NULL = heap);
+ *   dengan arena, free hanya melupakan array dan memorinya ikut arena.
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_INDEX_H
+#define PERPUSTAKAAN_LIB_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+struct lib_arena;
+
+/* Nilai "tidak ditemukan" untuk nomor baris */
+#define LIB_ROW_NONE UINT32_MAX
+
+/* Satu slot = (tag hash 32-bit << 32) | (row + 1). Slot 0 berarti kosong. */
+typedef struct {
+    uint64_t *slots;
+    size_t capacity;   /* selalu pangkat dua (atau 0 jika belum dialokasi) */
+    size_t count;
+    struct lib_arena *arena;
+} lib_hindex_t;
+
+/* Callback pembanding: true jika baris `row` memiliki kunci `key`. */
+typedef bool (*lib_hindex_eq_fn)(const void *ctx, uint32_t row, const void *key);
+
+/* FNV-1a 64-bit + final mix (sama dengan hash password, ditambah avalanche) */
+uint64_t lib_hash_str(const char *s);
+/* Kunci integer (ID 64-bit): hanya final mix, tanpa loop per byte */
+uint64_t lib_hash_u64(uint64_t v);
+
+void lib_hindex_init(lib_hindex_t *ix, struct lib_arena *arena);
+void lib_hindex_free(lib_hindex_t *ix);
+void lib_hindex_clear(lib_hindex_t *ix);
+/* Siapkan kapasitas untuk `n` entri sekaligus (mis. saat rebuild). */
+bool lib_hindex_reserve(lib_hindex_t *ix, size_t n);
+
+/* Tambah entri; kunci duplikat tidak dicek (pemanggil yang memastikan). */
+bool lib_hindex_insert(lib_hindex_t *ix, uint64_t hash, uint32_t row);
+/* Cari baris untuk `key`; LIB_ROW_NONE jika tidak ada. */
+uint32_t lib_hindex_find(const lib_hindex_t *ix, uint64_t hash,
+                         lib_hindex_eq_fn eq, const void *ctx, const void *key);
+/* Untuk indeks dengan kunci duplikat (multimap): baris berikutnya yang cocok
+ * dengan `key`. *pos = 0 untuk mulai; LIB_ROW_NONE jika habis. Indeks tidak
+ * boleh diubah selama iterasi. */
+uint32_t lib_hindex_find_next(const lib_hindex_t *ix, uint64_t hash,
+                              lib_hindex_eq_fn eq, const void *ctx, const void *key, size_t *pos);
+/* Hapus entri (hash, row) jika ada. */
+bool lib_hindex_remove(lib_hindex_t *ix, uint64_t hash, uint32_t row);
+
+/* -------------------------
+   Trigram inverted index
+   -------------------------
+ * Memetakan setiap trigram (3 byte, huruf kecil ASCII) ke posting list berisi
+ * nomor baris yang terurut naik. Query mengambil irisan posting list dari
+ * trigram needle sebagai kandidat; pemanggil tetap memverifikasi substring.
+ */
+
+typedef struct {
+    uint32_t trigram;   /* 3 byte huruf kecil, dikemas ke 24 bit */
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *rows;     /* terurut naik, tanpa duplikat */
+} lib_posting_t;
+
+typedef struct {
+    lib_hindex_t lookup;    /* hash(trigram) -> nomor posting list */
+    lib_posting_t *lists;
+    size_t list_count;
+    size_t list_capacity;
+    struct lib_arena *arena;
+} lib_trigram_index_t;
+
+/* Callback kandidat; kembalikan false untuk berhenti. */
+typedef bool (*lib_trigram_visit_fn)(void *ctx, uint32_t row);
+
+void lib_trigram_init(lib_trigram_index_t *tx, struct lib_arena *arena);
+void lib_trigram_free(lib_trigram_index_t *tx);
+void lib_trigram_clear(lib_trigram_index_t *tx);
+/* Tambah / hapus posting untuk teks baris `row`. */
+bool lib_trigram_add(lib_trigram_index_t *tx, uint32_t row, const char *text);
+void lib_trigram_remove(lib_trigram_index_t *tx, uint32_t row, const char *text);
+/* Setelah tabel dipadatkan: baris r menjadi map[r] (urutan tetap naik),
+ * LIB_ROW_NONE = baris dibuang. Satu sweep atas semua posting list. */
+void lib_trigram_remap(lib_trigram_index_t *tx, const uint32_t *map, size_t rows);
+/* Kunjungi kandidat (urut naik) untuk needle. Mengembalikan false jika needle
+ * terlalu pendek (< 3 byte) sehingga indeks tidak bisa dipakai. */
+bool lib_trigram_query(const lib_trigram_index_t *tx, const char *needle,
+                       lib_trigram_visit_fn visit, void *ctx);
+
+/* -------------------------
+   Indeks kalender (bucket per hari)
+   -------------------------
+ * Memetakan nomor hari (mis. jatuh tempo) -> baris. Hanya hari yang berisi
+ * baris yang disimpan, terurut naik; setiap hari punya doubly-linked list
+ * baris (array next/prev per baris). Query rentang = binary search hari awal
+ * lalu telusuri bucket sampai hari akhir: O(log D + hari + hasil).
+ */
+
+typedef struct {
+    int32_t day;
+    uint32_t head;      /* baris pertama; LIB_ROW_NONE tidak pernah (bucket kosong dibuang) */
+    uint32_t count;
+} lib_day_bucket_t;
+
+typedef struct {
+    lib_day_bucket_t *buckets;   /* terurut naik menurut day */
+    size_t bucket_count;
+    size_t bucket_capacity;
+    uint32_t *next;              /* per baris; LIB_ROW_NONE = akhir list */
+    uint32_t *prev;
+    int32_t *day_of;             /* hari milik baris (untuk hapus) */
+    size_t row_capacity;
+    size_t count;                /* baris di indeks */
+    struct lib_arena *arena;
+} lib_calendar_index_t;
+
+/* Callback baris; kembalikan false untuk berhenti. */
+typedef bool (*lib_calendar_visit_fn)(void *ctx, uint32_t row, int32_t day);
+
+void lib_calendar_init(lib_calendar_index_t *cx, struct lib_arena *arena);
+void lib_calendar_free(lib_calendar_index_t *cx);
+void lib_calendar_clear(lib_calendar_index_t *cx);
+/* Siapkan array per baris untuk baris 0..n-1. */
+bool lib_calendar_reserve(lib_calendar_index_t *cx, size_t n);
+/* Tambah baris pada hari `day` (baris belum boleh ada di indeks). */
+bool lib_calendar_add(lib_calendar_index_t *cx, uint32_t row, int32_t day);
+/* Hapus baris jika ada. */
+void lib_calendar_remove(lib_calendar_index_t *cx, uint32_t row);
+/* Kunjungi baris dengan hari di [lo, hi], urut hari naik. */
+void lib_calendar_query(const lib_calendar_index_t *cx, int32_t lo, int32_t hi,
+                        lib_calendar_visit_fn visit, void *ctx);
+
+#endif /* PERPUSTAKAAN_LIB_INDEX_H */
@@ -0,0 +1,59 @@
+/* lib_journal.h
+ * Write-ahead journal internal untuk library.c (bukan bagian dari API publik).
+ * - Setiap mutasi dicatat sebagai satu record teks (after-image baris CSV)
+ *   ke buffer pending; lib_journal_commit menulis semua record pending dengan
+ *   satu append + fsync. lib_journal_write + lib_journal_sync memisahkan
+ *   keduanya untuk group commit (beberapa write berbagi satu fsync).
+ * - Format per baris: "<crc32 8 hex> <op> <payload>\n". CRC mencakup "<op> <payload>".
+ *   Record terakhir yang terpotong (crash saat menulis) dibuang saat replay.
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_JOURNAL_H
+#define PERPUSTAKAAN_LIB_JOURNAL_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct lib_journal {
+    char *path;
+    FILE *fp;                /* dibuka "ab" saat commit pertama */
+    char *pending;           /* record yang belum di-commit */
+    size_t pending_len;
+    size_t pending_cap;
+    size_t pending_records;
+    size_t entries;          /* record di file sejak checkpoint terakhir */
+    size_t unsynced_records; /* sudah ditulis ke OS tapi belum di-fsync */
+    double unsynced_since_ms; /* waktu monotonic write pertama yang belum di-fsync */
+    bool need_checkpoint;    /* journal tidak bisa dipercaya: simpan snapshot penuh */
+} lib_journal_t;
+
+/* Callback replay; payload boleh diubah (milik buffer baris). */
+typedef void (*lib_journal_apply_fn)(void *ctx, char op, char *payload);
+
+lib_journal_t *lib_journal_open(const char *path);
+void lib_journal_close(lib_journal_t *j);
+
+/* Tambah record ke buffer pending (belum ditulis ke disk). Payload yang
+ * berisi baris baru ditolak dan menandai need_checkpoint. */
+bool lib_journal_append(lib_journal_t *j, char op, const char *payload);
+/* Tulis record pending: satu write + fsync. 0 jika berhasil, -1 jika I/O gagal. */
+int lib_journal_commit(lib_journal_t *j);
+/* Tulis record pending ke OS (fflush) tanpa fsync. 0 / -1. */
+int lib_journal_write(lib_journal_t *j);
+/* fsync record yang sudah ditulis. 0 / -1 (no-op jika tidak ada). */
+int lib_journal_sync(lib_journal_t *j);
+/* Umur (ms) record tertua yang belum di-fsync; 0 jika tidak ada. */
+double lib_journal_unsynced_age_ms(const lib_journal_t *j);
+/* Buang record pending (tidak ditulis). */
+void lib_journal_discard(lib_journal_t *j);
+/* Setelah checkpoint: hapus file journal dan buang pending. */
+int lib_journal_reset(lib_journal_t *j);
+
+/* Terapkan semua record valid di file secara berurutan. Ekor yang rusak
+ * dipotong dari file. Mengembalikan jumlah record yang diterapkan. */
+size_t lib_journal_replay(lib_journal_t *j, lib_journal_apply_fn apply, void *ctx);
+
+#endif /* PERPUSTAKAAN_LIB_JOURNAL_H */
@@ -0,0 +1,124 @@
+/* lib_proto.h
+ * Protokol biner daemon sirkulasi (perpusd) lewat Unix domain socket, plus
+ * klien blocking untuk kiosk/admin.
+ * - Frame: u32 panjang isi (little-endian, tanpa 4 byte panjang itu sendiri)
+ * - Request: u8 op, u32 tag, payload per op
+ * - Response: u32 tag (disalin dari request), i8 status (lib_status_t),
+ *   payload per op hanya jika status LIB_OK atau LIB_ERR_NOT_DURABLE
+ * - Integer little-endian; teks = u16 panjang + byte (tanpa NUL); tanggal =
+ *   lib_day_t (i32)
+ * - Klien boleh mengirim beberapa request sebelum membaca response
+ *   (pipelining); response per koneksi datang sesuai urutan request
+ * - Response request yang mengubah data baru dikirim setelah commit journal
+ *   yang memuatnya
+ *
+ * Payload (request -> response):
+ *   CHECKOUT  u64 isbn, str nim, i32 tgl_pinjam, i32 tgl_jatuh_tempo -> u64 loan_id
+ *   RETURN    u64 loan_id, i32 tgl_kembali                          -> u64 denda
+ *   SEARCH    u8 kolom (0 judul, 1 pengarang), u16 maks, str kata   -> u16 n, n x buku
+ *             buku = u64 isbn, i32 tersedia, i32 total, str judul, str pengarang
+ *   BORROWER  str nim, u8 buat_jika_belum_ada, str nama             -> u64 id, str nama, u16 pinjaman aktif
+ *   REPORT    (kosong)                                              -> u64 judul, i64 eksemplar,
+ *             i64 tersedia, i64 dipinjam, u64 stok_habis, u64 pinjaman_aktif, i64 nilai_stok
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_PROTO_H
+#define PERPUSTAKAAN_LIB_PROTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "library.h"
+
+#define LIB_PROTO_MAX_FRAME   (64u * 1024u)   /* isi frame maksimal */
+#define LIB_PROTO_MAX_RESULTS 64              /* hasil SEARCH per request */
+
+typedef enum {
+    LIB_OP_CHECKOUT = 1,
+    LIB_OP_RETURN = 2,
+    LIB_OP_SEARCH = 3,
+    LIB_OP_BORROWER = 4,
+    LIB_OP_REPORT = 5
+} lib_proto_op_t;
+
+/* ---------- encoder / decoder ---------- */
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+    bool oom;                /* alokasi gagal; isi buffer tidak lengkap */
+} lib_wbuf_t;
+
+void lib_wbuf_init(lib_wbuf_t *w);
+void lib_wbuf_free(lib_wbuf_t *w);
+void lib_wbuf_put_u8(lib_wbuf_t *w, uint8_t v);
+void lib_wbuf_put_u16(lib_wbuf_t *w, uint16_t v);
+void lib_wbuf_put_u32(lib_wbuf_t *w, uint32_t v);
+void lib_wbuf_put_u64(lib_wbuf_t *w, uint64_t v);
+/* Teks dipotong ke 65535 byte */
+void lib_wbuf_put_str(lib_wbuf_t *w, const char *s);
+/* Sisipkan placeholder panjang frame; kembalikan posisinya untuk lib_wbuf_end_frame */
+size_t lib_wbuf_begin_frame(lib_wbuf_t *w);
+void lib_wbuf_end_frame(lib_wbuf_t *w, size_t at);
+
+typedef struct {
+    const unsigned char *data;
+    size_t len;
+    size_t pos;
+    bool bad;                /* membaca melewati akhir / teks terlalu panjang */
+} lib_rbuf_t;
+
+void lib_rbuf_init(lib_rbuf_t *r, const void *data, size_t len);
+uint8_t lib_rbuf_get_u8(lib_rbuf_t *r);
+uint16_t lib_rbuf_get_u16(lib_rbuf_t *r);
+uint32_t lib_rbuf_get_u32(lib_rbuf_t *r);
+uint64_t lib_rbuf_get_u64(lib_rbuf_t *r);
+/* Salin teks ke out (selalu diakhiri NUL, dipotong jika out kecil) */
+void lib_rbuf_get_str(lib_rbuf_t *r, char *out, size_t out_sz);
+
+/* ---------- klien ---------- */
+
+typedef struct {
+    lib_isbn_t isbn;
+    int available;
+    int total_stock;
+    char title[LIB_MAX_TITLE];
+    char author[LIB_MAX_AUTHOR];
+} lib_proto_book_t;
+
+typedef struct {
+    lib_id_t id;
+    char name[LIB_MAX_NAME];
+    unsigned active_loans;
+} lib_proto_borrower_t;
+
+typedef struct {
+    lib_stock_report_t stock;
+    unsigned long long active_loans;
+} lib_proto_report_t;
+
+typedef struct lib_client lib_client_t;
+
+/* NULL jika socket tidak bisa dihubungi (*err = LIB_ERR_IO) */
+lib_client_t *lib_client_connect(const char *socket_path, lib_status_t *err);
+void lib_client_close(lib_client_t *c);
+
+/* Semua panggilan blocking. LIB_ERR_IO = koneksi putus / response rusak;
+ * status lain berasal dari server (sama dengan API lib_* padanannya).
+ * LIB_ERR_NOT_DURABLE: perubahan sudah diterapkan (out_* terisi) tetapi
+ * commit-nya gagal; jangan diulang. */
+lib_status_t lib_client_checkout(lib_client_t *c, lib_isbn_t isbn, const char *nim,
+                                 lib_date_t date_borrow, lib_date_t date_due, lib_id_t *out_loan_id);
+lib_status_t lib_client_return(lib_client_t *c, lib_id_t loan_id, lib_date_t date_return,
+                               unsigned long *out_fine);
+lib_status_t lib_client_search(lib_client_t *c, bool by_author, const char *query,
+                               lib_proto_book_t *out, size_t out_capacity, size_t *out_count);
+/* name dipakai hanya saat peminjam baru dibuat (create = true) */
+lib_status_t lib_client_borrower(lib_client_t *c, const char *nim, bool create, const char *name,
+                                 lib_proto_borrower_t *out);
+lib_status_t lib_client_report(lib_client_t *c, lib_proto_report_t *out);
+
+#endif /* PERPUSTAKAAN_LIB_PROTO_H */
@@ -0,0 +1,58 @@
+/* lib_rows.h
+ * Penyimpanan baris tabel per chunk untuk library.c (bukan bagian dari API publik).
+ * - lib_rows_t: direktori pointer chunk; setiap chunk berisi 2^shift baris
+ *   dengan ukuran tetap (<= LIB_ROWS_CHUNK_BYTES). Baris ke-i ada di
+ *   chunks[i >> shift] pada posisi i & mask: dua load, tanpa pencarian
+ * - Tumbuh = tambah chunk baru; chunk lama tidak pernah dipindah, jadi alamat
+ *   baris tetap sampai barisnya sendiri digeser/dihapus. Hanya direktori
+ *   (satu pointer per chunk) yang disalin saat penuh
+ * - Memori diambil dari arena yang diberikan pemanggil (NULL = heap). Arena
+ *   tidak disimpan di struct karena tabel bisa dipindah antar db (loader)
+ * - Jumlah baris terisi disimpan pemanggil (books_count dst.)
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_ROWS_H
+#define PERPUSTAKAAN_LIB_ROWS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+struct lib_arena;
+
+/* Target ukuran chunk; di bawah LIB_ARENA_LARGE sehingga chunk diambil dari blok arena */
+#define LIB_ROWS_CHUNK_BYTES (128u * 1024u)
+
+typedef struct {
+    unsigned char **chunks;   /* direktori */
+    size_t chunk_count;
+    size_t dir_capacity;
+    size_t elem_size;
+    unsigned shift;           /* baris per chunk = 1 << shift */
+    size_t capacity;          /* chunk_count << shift */
+} lib_rows_t;
+
+/* Tabel kosong untuk elemen sebesar elem_size; belum ada alokasi */
+void lib_rows_init(lib_rows_t *r, size_t elem_size);
+/* Lepas chunk dan direktori (hanya perlu untuk arena == NULL) */
+void lib_rows_free(lib_rows_t *r, struct lib_arena *arena);
+/* Pastikan kapasitas >= n baris; isi chunk baru nol. false jika memori habis
+ * (chunk yang sudah ada tetap utuh). */
+bool lib_rows_reserve(lib_rows_t *r, struct lib_arena *arena, size_t n);
+
+/* Baris ke-i (i < capacity) */
+static inline void *lib_rows_at(const lib_rows_t *r, size_t i) {
+    return r->chunks[i >> r->shift] + (i & (((size_t)1 << r->shift) - 1)) * r->elem_size;
+}
+
+/* Versi bertipe: ukuran elemen konstanta sehingga offset tidak perlu perkalian
+ * runtime. r dan i dievaluasi dua kali. */
+#define LIB_ROWS_AT(type, r, i) \
+    ((type *)(void *)(r)->chunks[(i) >> (r)->shift] + ((i) & (((size_t)1 << (r)->shift) - 1)))
+
+/* Potongan kontigu mulai dari baris i sampai akhir chunk atau `end` (i < end):
+ * *n = jumlah baris dalam potongan. Untuk loop sekuensial per chunk. */
+void *lib_rows_span(const lib_rows_t *r, size_t i, size_t end, size_t *n);
+
+#endif /* PERPUSTAKAAN_LIB_ROWS_H */
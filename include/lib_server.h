@@ -0,0 +1,58 @@
+/* lib_server.h
+ * Server sirkulasi: satu proses memegang satu library_db_t dan melayani
+ * banyak klien kiosk/admin lewat Unix domain socket (protokol lib_proto.h).
+ * - Event loop epoll satu thread, socket non-blocking; tidak ada kunci DB
+ *   yang diperlukan selama hanya server yang memakai db
+ * - Group commit: semua request yang siap dalam satu putaran dijalankan di
+ *   memori, lalu satu lib_db_save (satu append + fsync journal) untuk semua
+ *   request pengubah data, baru kemudian response dikirim. Makin banyak meja
+ *   yang mengirim bersamaan, makin banyak request per fsync
+ * - Response sukses berarti durable hanya pada durability sync (default).
+ *   Pada group, fsync menyusul paling lambat group_commit_ms (lib_db_tick);
+ *   pada buffered, crash bisa menghilangkan perubahan yang sudah di-ack
+ * - Commit gagal tidak di-rollback: response sukses diganti
+ *   LIB_ERR_NOT_DURABLE (payload tetap) dan record ikut save berikutnya
+ * - Hanya Linux (epoll); di platform lain lib_server_open gagal (LIB_ERR_IO)
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_SERVER_H
+#define PERPUSTAKAAN_LIB_SERVER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "library.h"
+
+#define LIB_SERVER_DEFAULT_SOCKET "data/perpusd.sock"
+
+typedef struct {
+    unsigned long long connections;     /* klien yang pernah diterima */
+    size_t clients;                     /* klien yang masih terhubung */
+    unsigned long long requests;
+    unsigned long long writes;          /* request pengubah data yang berhasil */
+    unsigned long long commits;         /* lib_db_save yang dipanggil */
+    unsigned long long commit_failures;
+    size_t max_batch;                   /* request pengubah data terbanyak per commit */
+    unsigned long long protocol_errors; /* frame rusak / op tidak dikenal (koneksi ditutup) */
+    double commit_ms;                   /* total waktu di lib_db_save */
+} lib_server_stats_t;
+
+typedef struct lib_server lib_server_t;
+
+/* Bind + listen di socket_path (file socket lama dihapus). db tetap milik
+ * pemanggil dan tidak boleh dipakai thread lain selama lib_server_run. */
+lib_server_t *lib_server_open(library_db_t *db, const char *socket_path, lib_status_t *err);
+/* Request pengubah data per commit: 0 = semua yang siap dalam satu putaran
+ * (default), 1 = commit setiap request (tanpa batching) */
+void lib_server_set_commit_batch(lib_server_t *s, size_t max_writes);
+/* Layani klien sampai lib_server_stop; LIB_ERR_IO jika epoll gagal */
+lib_status_t lib_server_run(lib_server_t *s);
+/* Minta lib_server_run berhenti; aman dari signal handler atau thread lain */
+void lib_server_stop(lib_server_t *s);
+/* Baca setelah lib_server_run selesai (atau dari thread server) */
+lib_status_t lib_server_get_stats(const lib_server_t *s, lib_server_stats_t *out);
+/* Tutup semua koneksi dan hapus file socket; db tidak ditutup */
+void lib_server_close(lib_server_t *s);
+
+#endif /* PERPUSTAKAAN_LIB_SERVER_H */
@@ -0,0 +1,45 @@
+/* lib_snapshot.h
+ * Snapshot biner internal untuk library.c (bukan bagian dari API publik).
+ * - Header berversi + tabel section: buku, peminjam, pinjaman (record
+ *   lebar tetap; ISBN, ID dan tanggal integer mentah) dan string heap (hanya
+ *   teks bebas, NUL-terminated, dirujuk lewat offset)
+ * - Dibaca lewat mmap: header dan batas section divalidasi sekali, lalu
+ *   record disalin langsung ke tabel tanpa parsing teks
+ * - Format tidak bergantung pada layout struct in-memory
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_SNAPSHOT_H
+#define PERPUSTAKAAN_LIB_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "library.h"
+
+#define LIB_SNAPSHOT_VERSION 2u   /* 2: ISBN, ID dan tanggal sebagai integer mentah */
+
+typedef struct lib_snapshot {
+    const unsigned char *base;   /* hasil mmap (read-only) */
+    size_t size;
+    const unsigned char *books;      size_t books_count;
+    const unsigned char *borrowers;  size_t borrowers_count;
+    const unsigned char *loans;      size_t loans_count;
+    const char *heap;                size_t heap_size;
+    void *handle;                /* handle mapping (Windows) */
+} lib_snapshot_t;
+
+/* Map dan validasi file snapshot. NULL jika tidak ada, versi berbeda atau rusak. */
+lib_snapshot_t *lib_snapshot_map(const char *path);
+void lib_snapshot_unmap(lib_snapshot_t *s);
+
+/* Salin record ke-i (i < *_count) ke struct in-memory. */
+void lib_snapshot_book(const lib_snapshot_t *s, size_t i, book_t *out);
+void lib_snapshot_borrower(const lib_snapshot_t *s, size_t i, borrower_t *out);
+void lib_snapshot_loan(const lib_snapshot_t *s, size_t i, loan_t *out);
+
+/* Tulis ketiga tabel ke `outfile` (fsync sebelum kembali). Tabel harus sudah
+ * dipadatkan (tanpa tombstone), seperti saat checkpoint. */
+lib_status_t lib_snapshot_write(const library_db_t *db, const char *outfile);
+
+#endif /* PERPUSTAKAAN_LIB_SNAPSHOT_H */
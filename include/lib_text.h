@@ -0,0 +1,25 @@
+/* lib_text.h
+ * Kernel teks internal untuk library.c (bukan bagian dari API publik).
+ * - lib_contains_ci: pencarian substring case-insensitive (ASCII) tanpa alokasi.
+ *   Memakai AVX2/SSE2 di x86-64 (dipilih saat runtime) dengan fallback scalar.
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_TEXT_H
+#define PERPUSTAKAAN_LIB_TEXT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* true jika `needle` muncul di `haystack` tanpa membedakan huruf besar/kecil.
+ * Needle kosong selalu cocok; NULL tidak pernah cocok. */
+bool lib_contains_ci(const char *haystack, const char *needle);
+
+/* Varian dengan panjang eksplisit (tidak memanggil strlen). */
+bool lib_contains_ci_n(const char *haystack, size_t hlen, const char *needle, size_t nlen);
+
+/* Nama kernel yang aktif: "avx2", "sse2" atau "scalar" (untuk benchmark/log). */
+const char *lib_text_kernel_name(void);
+
+#endif /* PERPUSTAKAAN_LIB_TEXT_H */
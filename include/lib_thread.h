@@ -0,0 +1,124 @@
+/* lib_thread.h
+ * Thread pekerja minimal untuk library.c (bukan bagian dari API publik).
+ * - Windows: _beginthreadex, POSIX: pthread
+ * - Jika thread gagal dibuat, pemanggil menjalankan pekerjaan di thread sendiri
+ * - Mutex + condition variable (Windows: SRWLOCK / CONDITION_VARIABLE)
+ * - Reader-writer lock (Windows: SRWLOCK, POSIX: pthread_rwlock)
+ * - lib_once: inisialisasi global sekali jalan yang aman lintas thread
+ * - LIB_THREAD_LOCAL: penyimpanan per thread (kunci DB yang sedang dipegang)
+ * - lib_clock_ms: jam monotonic untuk statistik waktu
+ * - lib_wall_clock_ms: jam dinding (epoch Unix) untuk alokator ID
+ * - lib_atomic_add: penambahan atomik untuk counter statistik lintas thread
+ *
+ * Standard: ISO C99
+ */
+
+#ifndef PERPUSTAKAAN_LIB_THREAD_H
+#define PERPUSTAKAAN_LIB_THREAD_H
+
+#include <stdbool.h>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  #include <pthread.h>
+#endif
+
+typedef void (*lib_thread_fn)(void *arg);
+
+typedef struct {
+    lib_thread_fn fn;
+    void *arg;
+    bool started;
+#if defined(_WIN32) || defined(_WIN64)
+    void *handle;
+#else
+    pthread_t id;
+#endif
+} lib_thread_t;
+
+/* Jalankan fn(arg) di thread baru. false jika gagal (fn tidak dipanggil). */
+bool lib_thread_start(lib_thread_t *t, lib_thread_fn fn, void *arg);
+/* Tunggu thread selesai; no-op jika tidak pernah dimulai. */
+void lib_thread_join(lib_thread_t *t);
+
+typedef struct {
+#if defined(_WIN32) || defined(_WIN64)
+    void *srw;               /* SRWLOCK, inisialisasi = 0 */
+#else
+    pthread_mutex_t m;
+#endif
+} lib_mutex_t;
+
+typedef struct {
+#if defined(_WIN32) || defined(_WIN64)
+    void *cv;                /* CONDITION_VARIABLE, inisialisasi = 0 */
+#else
+    pthread_cond_t c;
+#endif
+} lib_cond_t;
+
+bool lib_mutex_init(lib_mutex_t *m);
+void lib_mutex_destroy(lib_mutex_t *m);
+void lib_mutex_lock(lib_mutex_t *m);
+void lib_mutex_unlock(lib_mutex_t *m);
+
+typedef struct {
+#if defined(_WIN32) || defined(_WIN64)
+    void *srw;               /* SRWLOCK, inisialisasi = 0 */
+#else
+    pthread_rwlock_t rw;
+#endif
+} lib_rwlock_t;
+
+/* Kunci baca/tulis. Tidak rekursif: thread yang sudah memegang kunci tidak
+ * boleh mengambilnya lagi (pemanggil melacak sendiri, lihat library.c). */
+bool lib_rwlock_init(lib_rwlock_t *l);
+void lib_rwlock_destroy(lib_rwlock_t *l);
+void lib_rwlock_read_lock(lib_rwlock_t *l);
+void lib_rwlock_read_unlock(lib_rwlock_t *l);
+void lib_rwlock_write_lock(lib_rwlock_t *l);
+void lib_rwlock_write_unlock(lib_rwlock_t *l);
+
+typedef struct {
+#if defined(_WIN32) || defined(_WIN64)
+    void *once;              /* INIT_ONCE */
+#else
+    pthread_once_t once;
+#endif
+} lib_once_t;
+
+#if defined(_WIN32) || defined(_WIN64)
+  #define LIB_ONCE_INIT { NULL }
+#else
+  #define LIB_ONCE_INIT { PTHREAD_ONCE_INIT }
+#endif
+
+/* Jalankan fn tepat sekali per o; thread lain menunggu sampai fn selesai */
+void lib_once(lib_once_t *o, void (*fn)(void));
+
+#if defined(_MSC_VER)
+  #define LIB_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+  #define LIB_THREAD_LOCAL __thread
+#else
+  #define LIB_THREAD_LOCAL _Thread_local
+#endif
+
+bool lib_cond_init(lib_cond_t *c);
+void lib_cond_destroy(lib_cond_t *c);
+/* m harus dipegang; dilepas selama menunggu */
+void lib_cond_wait(lib_cond_t *c, lib_mutex_t *m);
+void lib_cond_signal(lib_cond_t *c);
+void lib_cond_broadcast(lib_cond_t *c);
+
+/* Jumlah CPU online (minimal 1) */
+unsigned lib_cpu_count(void);
+
+/* Waktu monotonic dalam milidetik (titik nol tidak ditentukan) */
+double lib_clock_ms(void);
+/* Milidetik sejak 1970-01-01 UTC (jam dinding; bisa mundur bila jam diubah) */
+unsigned long long lib_wall_clock_ms(void);
+
+/* *p += v secara atomik (relaxed); kembalikan nilai baru */
+unsigned long long lib_atomic_add(volatile unsigned long long *p, unsigned long long v);
+
+#endif /* PERPUSTAKAAN_LIB_THREAD_H */
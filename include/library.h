@@ -17,6 +17,7 @@
 #include <stdbool.h>
 #include <time.h>       /* time_t */
 #include <string.h>
+#include "lib_rows.h"
 
 /* -------------------------
    Konfigurasi / Constants
@@ -37,9 +38,29 @@
 /* Batas jumlah entri default (dapat diresize dinamis) */
 #define LIB_DEFAULT_CAPACITY 256
 
-/* Maksimal jenis buku (default dan hard limit) */
+/* Maksimal jenis buku (default dan hard limit). Hard limit = nomor baris
+ * terbesar yang muat di indeks (uint32, UINT32_MAX dipakai sebagai "tidak ada") */
 #define LIB_MAX_BOOK_TYPES 1024U
-#define LIB_MAX_BOOK_TYPES_HARD_LIMIT 65536U
+#define LIB_MAX_BOOK_TYPES_HARD_LIMIT (UINT32_MAX - 1U)
+
+/* Journal: checkpoint (tulis ulang CSV penuh) setelah sekian record */
+#define LIB_DEFAULT_JOURNAL_CHECKPOINT 256
+
+/* Hapus buku/pinjaman hanya menandai tombstone; tabel dipadatkan dalam satu
+ * sweep saat tombstone melebihi 1/LIB_TOMBSTONE_COMPACT_DIV baris atau saat checkpoint */
+#define LIB_TOMBSTONE_COMPACT_DIV 4
+
+/* Group commit: default jendela fsync */
+#define LIB_DEFAULT_GROUP_COMMIT_MS  50
+#define LIB_DEFAULT_GROUP_COMMIT_OPS 64
+
+/* Tabel yang berubah sejak snapshot CSV terakhir (library_db_t.dirty) */
+#define LIB_DIRTY_BOOKS     0x1u
+#define LIB_DIRTY_BORROWERS 0x2u
+#define LIB_DIRTY_LOANS     0x4u
+#define LIB_DIRTY_META      0x8u
+#define LIB_DIRTY_TABLES    (LIB_DIRTY_BOOKS | LIB_DIRTY_BORROWERS | LIB_DIRTY_LOANS)
+#define LIB_DIRTY_ALL       (LIB_DIRTY_TABLES | LIB_DIRTY_META)
 
 /* Kebijakan denda: nilai default (bisa diubah) */
 #define LIB_DEFAULT_FINE_PER_DAY 1000 /* contoh: Rupiah per hari */
@@ -57,7 +78,10 @@ typedef enum {
     LIB_ERR_INVALID_ARG = -5,
     LIB_ERR_MEMORY = -6,
     LIB_ERR_AUTH = -7,
-    LIB_ERR_MAX_TYPES = -8
+    LIB_ERR_MAX_TYPES = -8,
+    /* Perubahan sudah diterapkan di memori tetapi commit ke disk gagal; record
+     * journal-nya ikut save berikutnya. Jangan ulangi request (perpusd). */
+    LIB_ERR_NOT_DURABLE = -9
 } lib_status_t;
 
 /* -------------------------
@@ -69,15 +93,75 @@ typedef struct {
     int day;   /* 1-31 */
 } lib_date_t;
 
+/* Nomor hari sejak 1970-01-01 (kalender Gregorian proleptik, tanpa zona
+ * waktu). Tanggal pinjaman disimpan dalam bentuk ini sehingga selisih dan
+ * perbandingan cukup operasi integer; lib_date_t untuk input dan tampilan. */
+typedef int32_t lib_day_t;
+
+/* ID pinjaman/peminjam: integer 64-bit, 0 = kosong (juga tombstone loan).
+ * Di CSV, journal, dan tampilan ditulis sebagai huruf awalan + desimal
+ * ("L190234...", "B1001"); di memori hanya angkanya. */
+typedef uint64_t lib_id_t;
+#define LIB_ID_NONE ((lib_id_t)0)
+#define LIB_ID_TEXT_MAX 24   /* awalan + 20 digit + NUL */
+
+/* ISBN dikemas dalam 64-bit: ISBN-13 kanonik disimpan sebagai angka 13
+ * digitnya (ISBN-10 dikonversi ke 978-...), 0 = kosong. Urutan integer sama
+ * dengan urutan teks 13 digit. Kode lama yang tidak lolos checksum tetap bisa
+ * dimuat sebagai kunci "mentah" (bit 63 menyala, teks asli bisa dibentuk ulang):
+ * angka <= 17 digit atau teks ASCII <= 8 karakter. */
+typedef uint64_t lib_isbn_t;
+#define LIB_ISBN_NONE ((lib_isbn_t)0)
+#define LIB_ISBN_TEXT_MAX 20
+
 /* Utility: convert time_t <-> lib_date_t */
 lib_date_t lib_date_from_time_t(time_t t);
 time_t lib_time_t_from_date(lib_date_t d);
 int lib_date_days_between(lib_date_t a, lib_date_t b); /* b - a in days */
 
+/* Konversi lib_date_t <-> nomor hari, aritmetika kalender murni (tanpa
+ * mktime/timegm). Hari di luar 1..panjang bulan ikut dinormalisasi. */
+lib_day_t lib_date_to_days(lib_date_t d);
+lib_date_t lib_date_from_days(lib_day_t days);
+/* d + n hari (n boleh negatif), benar melewati akhir bulan/tahun */
+lib_date_t lib_date_add_days(lib_date_t d, int n);
+/* Tanggal hari ini (UTC, sama dengan lib_date_from_time_t(time(NULL)))
+ * sebagai nomor hari */
+lib_day_t lib_day_today(void);
+/* "YYYY-MM-DD" ke out (cukup 11 byte) */
+void lib_day_format(lib_day_t day, char *out, size_t out_sz);
+
+/* lib_id_t <-> teks. Format: awalan (mis. 'L' / 'B') + desimal; prefix 0
+ * berarti tanpa awalan. Parse menerima satu huruf awalan apa pun (ID lama
+ * "B1001", "P1", "L1762...") lalu angkanya; teks lain yang tidak kosong
+ * dipetakan ke hash 64-bit dengan bit teratas menyala (tidak pernah dihasilkan
+ * alokator). Parse mengembalikan false hanya untuk teks kosong. */
+void lib_id_format(lib_id_t id, char prefix, char *out, size_t out_sz);
+bool lib_id_parse(const char *text, lib_id_t *out);
+
+/* Teks ISBN-10/13 (boleh dengan '-' atau spasi) -> ISBN-13 kanonik.
+ * false jika panjang, digit, awalan 978/979 atau checksum tidak valid. */
+bool lib_isbn_parse(const char *text, lib_isbn_t *out);
+/* Seperti lib_isbn_parse, tetapi kode yang tidak valid dikemas sebagai kunci
+ * mentah (untuk data tersimpan dan pencarian). LIB_ISBN_NONE jika teks kosong
+ * atau tidak muat. */
+lib_isbn_t lib_isbn_key(const char *text);
+/* Tulis ulang teks: 13 digit tanpa tanda hubung, atau teks mentah aslinya */
+void lib_isbn_format(lib_isbn_t isbn, char *out, size_t out_sz);
+/* true untuk ISBN-13 kanonik (bukan kunci mentah atau kosong) */
+bool lib_isbn_is_valid(lib_isbn_t isbn);
+
 /* -------------------------
    Entitas data
    ------------------------- */
 
+/* Kapan lib_db_save melakukan fsync journal (disimpan di _meta.cfg) */
+typedef enum {
+    LIB_DURABILITY_SYNC = 0,   /* setiap save: write + fsync (default) */
+    LIB_DURABILITY_GROUP,      /* fsync tiap group_commit_ms atau group_commit_ops record */
+    LIB_DURABILITY_BUFFERED    /* serahkan ke OS; fsync hanya di lib_db_flush/checkpoint/close */
+} lib_durability_t;
+
 typedef enum {
     BOOK_AVAILABLE = 0,
     BOOK_BORROWED,
@@ -86,7 +170,7 @@ typedef enum {
 } book_status_t;
 
 typedef struct {
-    char isbn[LIB_MAX_ISBN];
+    lib_isbn_t isbn;    /* kunci buku, lihat lib_isbn_parse */
     char title[LIB_MAX_TITLE];
     char author[LIB_MAX_AUTHOR];
     int year;           /* tahun terbit */
@@ -97,9 +181,24 @@ typedef struct {
    char notes[LIB_MAX_NOTES];
 } book_t;
 
+/* Kolom "panas" buku (hot/cold split), sejajar dengan books[i].
+ * book_t berukuran ~520 byte karena teks (judul/pengarang/catatan); lookup
+ * ISBN dan scan yang hanya butuh stok/harga (laporan stok, filter
+ * ketersediaan) membaca array ringkas ini (32 byte per buku) sehingga teks
+ * dingin tidak ikut terbawa ke cache. Dikelola library.c: setiap perubahan
+ * buku lewat API lib_* menulis baris dan kolom panasnya bersamaan; tidak ada
+ * pointer book_t yang bisa diubah dari luar. */
+typedef struct {
+    lib_isbn_t isbn;
+    double price;
+    int32_t year;
+    int32_t total_stock;
+    int32_t available;
+} lib_book_hot_t;
+
 /* Borrower: tambahan field 'nim' untuk mahasiswa */
 typedef struct {
-    char id[32];          /* unik internal (autogen) */
+    lib_id_t id;          /* unik internal (autogen), teks "B<angka>" */
     char nim[32];         /* NIM mahasiswa (kosong jika bukan) */
     char name[LIB_MAX_NAME];
     char phone[32];
@@ -107,12 +206,12 @@ typedef struct {
 } borrower_t;
 
 typedef struct {
-    char loan_id[32];     /* unik */
-    char isbn[LIB_MAX_ISBN];
-    char borrower_id[32];
-    lib_date_t date_borrow;
-    lib_date_t date_due;
-    lib_date_t date_returned;
+    lib_id_t loan_id;     /* unik; LIB_ID_NONE = baris sudah dihapus (tombstone) */
+    lib_isbn_t isbn;
+    lib_id_t borrower_id;
+    lib_day_t date_borrow;  /* nomor hari, lihat lib_date_to_days */
+    lib_day_t date_due;
+    lib_day_t date_returned;  /* hanya berarti jika is_returned */
     bool is_returned;
     bool is_lost;
     long fine_paid;
@@ -122,18 +221,125 @@ typedef struct {
    Database container
    ------------------------- */
 
+/* Statistik lib_db_save. File snapshot = 3 CSV + meta (atau snapshot biner
+ * + meta); pada setiap save files_written + files_skipped selalu sama dengan
+ * jumlah file tersebut (save yang hanya commit journal melewati semuanya),
+ * ditambah partisi arsip + manifest yang ditulis checkpoint itu. */
 typedef struct {
-    book_t *books;
+    /* save terakhir */
+    bool checkpoint;                 /* snapshot CSV/meta ditulis */
+    bool synced;                     /* journal di-fsync pada save ini */
+    unsigned files_written;
+    unsigned files_skipped;          /* tabel bersih: file lama dipertahankan */
+    unsigned long journal_records;   /* record yang di-commit ke journal */
+    unsigned long long bytes_written; /* CSV + meta + journal */
+    /* kumulatif sejak DB dibuka */
+    unsigned long saves;
+    unsigned long checkpoints;
+    unsigned long syncs;
+    unsigned long long total_bytes_written;
+} lib_save_stats_t;
+
+/* Rincian waktu lib_db_open terakhir (ms, jam monotonic). Ketiga CSV dibaca
+ * dan diindeks bersamaan (meta di thread pemanggil), jadi load_ms mendekati
+ * tabel terlama, bukan jumlahnya. */
+typedef struct {
+    bool from_snapshot;
+    unsigned threads;        /* worker thread yang berhasil dibuat (0 = berurutan) */
+    double books_ms;         /* baca + indeks per tabel (di worker) */
+    double borrowers_ms;
+    double loans_ms;
+    double meta_ms;
+    double index_ms;         /* penggabungan indeks (atau build penuh dari snapshot) */
+    double load_ms;          /* wall time sampai data + indeks siap */
+    double replay_ms;
+    double total_ms;
+} lib_open_stats_t;
+
+/* Statistik lib_db_import_csv terakhir (ketiga file). Waktu per tahap adalah
+ * waktu sibuk tanpa menunggu antrian; parse_ms dijumlahkan atas semua parser. */
+typedef struct {
+    unsigned parsers;                /* thread parser (0 = impor berurutan) */
+    unsigned long rows;              /* baris yang dimasukkan */
+    unsigned long rows_skipped;      /* record tidak valid */
+    unsigned long chunks;
+    unsigned long long bytes;
+    double read_ms;
+    double split_ms;
+    double parse_ms;
+    double insert_ms;
+    double total_ms;                 /* wall time, termasuk rebuild indeks */
+    double rows_per_sec;
+} lib_import_stats_t;
+
+/* Alokasi memori. Counter heap bersifat global (semua DB dan thread) dan
+ * menghitung setiap malloc/calloc/realloc library, termasuk blok arena;
+ * selisih dua pembacaan = panggilan heap sebuah operasi. Field arena_* milik
+ * DB: tabel, path dan indeks tinggal di arena itu dan dilepas sekaligus. */
+typedef struct {
+    unsigned long long heap_allocs;  /* malloc + calloc + realloc */
+    unsigned long long heap_frees;
+    unsigned long long arena_allocs; /* alokasi dilayani arena tanpa heap */
+    size_t arena_blocks;             /* blok arena DB */
+    size_t arena_reserved;           /* byte blok arena DB */
+    size_t arena_used;               /* byte terpakai (termasuk array lama yang sudah tumbuh) */
+} lib_alloc_stats_t;
+
+/* Arsip riwayat pinjaman per bulan (lihat lib_loan_history_between) */
+typedef struct {
+    size_t partitions;               /* file partisi di manifest */
+    unsigned long long archived_rows;
+    unsigned long last_archived;     /* baris yang dipindah checkpoint terakhir */
+} lib_archive_stats_t;
+
+/* Statistik satu query lib_loan_history_between (milik pemanggil) */
+typedef struct {
+    size_t parts_scanned;            /* partisi yang dibuka */
+    size_t parts_pruned;             /* dilewati berdasarkan manifest */
+    unsigned long long rows_read;    /* baris dibaca dari partisi */
+    double query_ms;
+} lib_history_stats_t;
+
+/* Indeks internal (hash primary-key); didefinisikan di library.c */
+struct lib_db_index;
+/* Write-ahead journal; didefinisikan di lib_journal.h */
+struct lib_journal;
+/* Manifest arsip pinjaman; didefinisikan di lib_archive.h */
+struct lib_archive;
+/* Arena memori DB; didefinisikan di lib_arena.h */
+struct lib_arena;
+/* Kunci baca-tulis DB (lib_set_thread_safe); didefinisikan di library.c */
+struct lib_db_sync;
+
+typedef struct {
+    /* Tabel disimpan per chunk (lib_rows_t): menambah baris tidak pernah
+     * memindahkan baris lain, jadi pointer buku/peminjam tetap valid sampai
+     * tabel dipadatkan (tombstone hapus melewati ambang, checkpoint,
+     * lib_db_compact()) atau diganti (impor). Baca lewat lib_book_at(),
+     * lib_borrower_at(), lib_loan_at(), lib_active_loan_at(). */
+    lib_rows_t books;         /* book_t */
+    lib_rows_t books_hot;     /* lib_book_hot_t, nomor baris sama dengan books */
     size_t books_count;
-    size_t books_capacity;
+    size_t books_tombstones;  /* buku terhapus (isbn kosong) yang belum dipadatkan */
 
-    borrower_t *borrowers;
+    lib_rows_t borrowers;     /* borrower_t; tidak pernah dihapus, alamat stabil */
     size_t borrowers_count;
-    size_t borrowers_capacity;
 
-    loan_t *loans;
+    /* Pinjaman dipisah dua partisi; satu loan hanya ada di salah satunya.
+     * - active_loans: belum kembali dan belum hilang. Padat dan kecil; urutan
+     *   tidak dijaga (hapus/selesai = baris terakhir dipindah ke lubangnya)
+     * - loans: riwayat (sudah kembali / hilang), append-only; bisa berisi
+     *   tombstone, lihat lib_loan_is_deleted()
+     * lib_return_book / lib_mark_book_lost memindahkan loan dari aktif ke riwayat.
+     * Riwayat yang sudah kembali dari bulan yang lewat dipindah checkpoint ke
+     * file arsip per bulan dan tidak dimuat lagi saat open (archive). */
+    lib_rows_t active_loans;  /* loan_t */
+    size_t active_loans_count;
+
+    lib_rows_t loans;         /* loan_t */
     size_t loans_count;
-    size_t loans_capacity;
+    size_t loans_tombstones;  /* baris terhapus yang belum dipadatkan */
+    struct lib_archive *archive; /* NULL = tanpa arsip (lib_db_init) */
 
     long fine_per_day; /* policy */
 
@@ -147,7 +353,46 @@ typedef struct {
    /* Max overdue days before auto-marking as lost. Default is 30 days. */
    unsigned long max_overdue_days_before_lost;
 
+    /* ID terbesar yang pernah dibagikan (loan maupun borrower). Disimpan di
+     * _meta.cfg sebagai id_high_water; ID baru selalu lebih besar walaupun
+     * jam sistem mundur. Lihat lib_next_id(). */
+    lib_id_t id_high_water;
+
     char *db_file_path;
+
+    /* Pemilik memori tabel, db_file_path dan indeks (internal). lib_db_close
+     * melepas semuanya sekaligus; jangan free() pointer di atas satu per satu. */
+    struct lib_arena *arena;
+
+    /* Hash index ISBN / borrower id / NIM / loan_id (internal, jangan diubah langsung).
+     * NULL berarti indeks tidak aktif dan pencarian jatuh ke linear scan. */
+    struct lib_db_index *index;
+
+    /* Journal mutasi (<db>_journal.log). lib_db_save menambahkan record pending
+     * dengan satu append+fsync; CSV ditulis ulang (checkpoint) setelah
+     * journal_checkpoint_entries record. NULL berarti selalu tulis CSV penuh. */
+    struct lib_journal *journal;
+    size_t journal_checkpoint_entries;
+
+    /* LIB_DIRTY_*: diset oleh setiap API yang mengubah data, dibersihkan
+     * per tabel saat CSV-nya ditulis ulang. Checkpoint melewati tabel bersih. */
+    unsigned dirty;
+    lib_save_stats_t save_stats;
+
+    /* Kebijakan fsync journal; lihat lib_set_durability() */
+    lib_durability_t durability;
+    unsigned long group_commit_ms;
+    unsigned long group_commit_ops;
+
+    /* Checkpoint menulis <db>_snapshot.bin (biner, dibaca lewat mmap) sebagai
+     * pengganti ketiga CSV; lihat lib_set_binary_snapshot() */
+    bool binary_snapshot;
+
+    lib_open_stats_t open_stats;
+    lib_import_stats_t import_stats;
+
+    /* NULL = mode satu thread (default); lihat lib_set_thread_safe() */
+    struct lib_db_sync *sync;
 } library_db_t;
 
 /* -------------------------
@@ -155,9 +400,91 @@ typedef struct {
    ------------------------- */
 
 library_db_t *lib_db_open(const char *path, lib_status_t *err);
+/* Commit perubahan sejak save terakhir ke journal (checkpoint otomatis bila perlu) */
 lib_status_t lib_db_save(library_db_t *db);
+/* Tulis ulang CSV/meta yang dirty sekarang dan kosongkan journal */
+lib_status_t lib_db_checkpoint(library_db_t *db);
+/* Barrier: save + fsync, apa pun kebijakan durability-nya */
+lib_status_t lib_db_flush(library_db_t *db);
+/* Tenggat group commit tanpa menunggu save berikutnya: fsync journal jika
+ * record tertua yang belum di-fsync sudah >= group_commit_ms (atau segera
+ * jika idle = pemanggil akan memblokir tanpa batas, mis. menunggu input).
+ * *next_ms (boleh NULL) = sisa ms sampai tenggat berikutnya, -1 jika tidak
+ * ada; loop event memakainya sebagai timeout. No-op di luar mode GROUP. */
+lib_status_t lib_db_tick(library_db_t *db, bool idle, long *next_ms);
 lib_status_t lib_db_close(library_db_t *db);
 
+/* -------------------------
+   Thread safety
+   -------------------------
+   Default satu thread: tidak ada penguncian sama sekali. Setelah
+   lib_set_thread_safe(db, true) setiap API lib_* yang menerima db mengambil
+   kunci baca-tulis milik db: pencarian/laporan berjalan paralel (kunci baca),
+   mutasi, save dan impor eksklusif (kunci tulis). Aktifkan/matikan sebelum
+   db dibagi ke thread lain; lib_db_open/lib_db_close tidak dikunci.
+
+   Umur pointer (book_t*, borrower_t*, loan_t*) dalam mode ini:
+   - hanya aman selama tidak ada mutasi dari thread lain. Pegang
+     lib_db_read_lock() selama memakai pointer hasil pencarian, atau salin
+     lewat lib_get_book()/lib_get_borrower_by_nim()/lib_get_loan()
+   - pointer mutable (lib_find_loan_by_id_mutable, lib_get_or_create_borrower_by_nim)
+     hanya boleh diubah sambil memegang lib_db_write_lock()
+   - alamat borrower stabil sampai impor; lib_checkout_book boleh menerima
+     pointer borrower yang didapat sebelumnya
+   Kunci bisa ditumpuk per thread (API lib_* di dalam kunci yang sama tidak
+   mengunci ulang), tetapi kunci baca tidak bisa dinaikkan menjadi kunci tulis:
+   API yang mengubah data di dalam lib_db_read_lock() gagal dengan
+   LIB_ERR_INVALID_ARG. Lepas kunci di thread yang mengambilnya. */
+lib_status_t lib_set_thread_safe(library_db_t *db, bool enabled);
+bool lib_get_thread_safe(const library_db_t *db);
+
+/* Satu frame kunci; simpan di stack pemanggil sampai lib_db_unlock */
+typedef struct lib_db_lock {
+    const library_db_t *db;
+    struct lib_db_lock *outer;   /* kunci lain yang dipegang thread ini */
+    bool write;
+    bool held;                   /* false = no-op (mode satu thread / sudah dipegang) */
+} lib_db_lock_t;
+
+void lib_db_read_lock(const library_db_t *db, lib_db_lock_t *lk);
+/* false jika db NULL atau thread ini hanya memegang kunci baca db */
+bool lib_db_write_lock(library_db_t *db, lib_db_lock_t *lk);
+void lib_db_unlock(lib_db_lock_t *lk);
+
+/* Jumlah record journal sebelum checkpoint otomatis (0 = default) */
+lib_status_t lib_set_journal_checkpoint_entries(library_db_t *db, size_t entries);
+size_t lib_get_journal_checkpoint_entries(const library_db_t *db);
+
+/* Kebijakan durability. Untuk LIB_DURABILITY_GROUP, interval_ms/max_ops 0 = default;
+ * fsync dilakukan saat save pertama yang melewati salah satu batas, atau oleh
+ * lib_db_tick() saat interval_ms lewat tanpa save baru. */
+lib_status_t lib_set_durability(library_db_t *db, lib_durability_t mode,
+                                unsigned long interval_ms, unsigned long max_ops);
+lib_durability_t lib_get_durability(const library_db_t *db);
+/* "sync" / "group" / "buffered" <-> enum; parse mengembalikan false jika tidak dikenal */
+const char *lib_durability_name(lib_durability_t mode);
+bool lib_durability_parse(const char *name, lib_durability_t *out);
+
+/* Format snapshot checkpoint (disimpan di _meta.cfg). true = snapshot biner;
+ * lib_db_open memakainya bila lebih baru dari CSV. CSV tetap bisa dibuat
+ * lewat lib_db_export_csv(). */
+lib_status_t lib_set_binary_snapshot(library_db_t *db, bool enabled);
+bool lib_get_binary_snapshot(const library_db_t *db);
+
+/* Statistik save terakhir + kumulatif */
+lib_status_t lib_get_save_stats(const library_db_t *db, lib_save_stats_t *out);
+/* Padatkan tabel (buang tombstone) sekarang; otomatis saat checkpoint */
+lib_status_t lib_db_compact(library_db_t *db);
+/* Rincian waktu lib_db_open */
+lib_status_t lib_get_open_stats(const library_db_t *db, lib_open_stats_t *out);
+/* Throughput dan waktu per tahap lib_db_import_csv terakhir */
+lib_status_t lib_get_import_stats(const library_db_t *db, lib_import_stats_t *out);
+/* Counter alokasi; db boleh NULL (hanya counter global) */
+lib_status_t lib_get_alloc_stats(const library_db_t *db, lib_alloc_stats_t *out);
+/* Tandai tabel berubah (mis. setelah menulis lewat pointer *_mutable) agar
+ * checkpoint berikutnya menulis ulang CSV-nya */
+lib_status_t lib_db_mark_dirty(library_db_t *db, unsigned tables);
+
 /* Replacement-cost policy getters/setters */
 lib_status_t lib_set_replacement_cost_days(library_db_t *db, unsigned long days);
 unsigned long lib_get_replacement_cost_days(const library_db_t *db);
@@ -179,14 +506,57 @@ size_t lib_get_max_book_types(const library_db_t *db);
    ------------------------- */
 
 lib_status_t lib_add_book(library_db_t *db, const book_t *book);
-lib_status_t lib_remove_book(library_db_t *db, const char *isbn);
-const book_t *lib_find_book_by_isbn(const library_db_t *db, const char *isbn);
+lib_status_t lib_remove_book(library_db_t *db, lib_isbn_t isbn);
+const book_t *lib_find_book_by_isbn(const library_db_t *db, lib_isbn_t isbn);
 size_t lib_search_books_by_title(const library_db_t *db,
                                  const char *title_substr,
                                  const book_t **out,
                                  size_t out_capacity);
-lib_status_t lib_update_book_stock(library_db_t *db, const char *isbn, int delta);
-lib_status_t lib_update_book(library_db_t *db, const char *isbn, const book_t *updated_book);
+size_t lib_search_books_by_author(const library_db_t *db,
+                                  const char *author_substr,
+                                  const book_t **out,
+                                  size_t out_capacity);
+lib_status_t lib_update_book_stock(library_db_t *db, lib_isbn_t isbn, int delta);
+lib_status_t lib_update_book(library_db_t *db, lib_isbn_t isbn, const book_t *updated_book);
+
+/* Akses baris buku ke-i (0 <= i < lib_book_count); NULL jika di luar batas.
+ * Jumlah baris termasuk buku terhapus yang belum dipadatkan: lewati baris
+ * yang lib_book_is_deleted() */
+size_t lib_book_count(const library_db_t *db);
+const book_t *lib_book_at(const library_db_t *db, size_t i);
+bool lib_book_is_deleted(const book_t *b);
+/* Salin buku ke *out (aman dipakai setelah kunci dilepas) */
+lib_status_t lib_get_book(const library_db_t *db, lib_isbn_t isbn, book_t *out);
+
+/* Handle buku: ISBN + nomor baris terakhir yang diketahui. Tetap berlaku
+ * setelah tabel dipadatkan (compact) atau diganti (impor):
+ * lib_book_get() memakai baris langsung jika ISBN-nya masih cocok (O(1)),
+ * selain itu mencari lewat indeks ISBN. */
+typedef struct {
+    lib_isbn_t isbn;
+    size_t row;
+} lib_book_ref_t;
+
+lib_book_ref_t lib_book_ref(const library_db_t *db, const book_t *book);
+const book_t *lib_book_get(const library_db_t *db, lib_book_ref_t *ref); /* NULL jika buku sudah dihapus */
+
+/* Ringkasan stok seluruh koleksi (hanya membaca kolom panas) */
+typedef struct {
+    size_t titles;          /* jumlah judul */
+    long total_stock;       /* jumlah eksemplar */
+    long available;         /* eksemplar tersedia */
+    long borrowed;          /* total_stock - available */
+    size_t out_of_stock;    /* judul dengan stok tersedia 0 */
+    double stock_value;     /* sum(price * total_stock) */
+} lib_stock_report_t;
+
+lib_status_t lib_stock_report(const library_db_t *db, lib_stock_report_t *out);
+/* Buku dengan available >= min_available (urut tabel); mengembalikan jumlah hasil */
+size_t lib_find_available_books(const library_db_t *db, int min_available,
+                                const book_t **out, size_t out_capacity);
+/* Hapus pinjaman yang sudah kembali >= days_old hari. Partisi arsip yang
+ * seluruhnya lebih tua dihapus filenya; hanya partisi di batas cutoff yang
+ * ditulis ulang, sisanya tidak dibuka. */
 lib_status_t lib_remove_old_loans(library_db_t *db, unsigned long days_old);
 
 /* -------------------------
@@ -194,43 +564,154 @@ lib_status_t lib_remove_old_loans(library_db_t *db, unsigned long days_old);
    ------------------------- */
 
 lib_status_t lib_add_borrower(library_db_t *db, const borrower_t *b);
-const borrower_t *lib_find_borrower_by_id(const library_db_t *db, const char *id);
+const borrower_t *lib_find_borrower_by_id(const library_db_t *db, lib_id_t id);
 const borrower_t *lib_find_borrower_by_nim(const library_db_t *db, const char *nim);
-/* get or create: returns pointer to internal borrower (modifiable if not const) */
+/* get or create: returns pointer to internal borrower. Ubah profil lewat
+ * lib_update_borrower() agar perubahan tercatat di journal. */
 borrower_t *lib_get_or_create_borrower_by_nim(library_db_t *db, const char *nim, bool create_if_missing);
+/* Update nama/telepon/email (id dan NIM adalah kunci, tidak diubah) */
+lib_status_t lib_update_borrower(library_db_t *db, lib_id_t id, const borrower_t *updated);
+/* Salin peminjam ke *out */
+lib_status_t lib_get_borrower_by_nim(const library_db_t *db, const char *nim, borrower_t *out);
+/* Akses peminjam ke-i (0 <= i < lib_borrower_count); NULL jika di luar batas */
+size_t lib_borrower_count(const library_db_t *db);
+const borrower_t *lib_borrower_at(const library_db_t *db, size_t i);
+
+/* Handle peminjam (lihat lib_book_ref_t); bertahan melewati impor */
+typedef struct {
+    lib_id_t id;
+    size_t row;
+} lib_borrower_ref_t;
+
+lib_borrower_ref_t lib_borrower_ref(const library_db_t *db, const borrower_t *borrower);
+const borrower_t *lib_borrower_get(const library_db_t *db, lib_borrower_ref_t *ref);
 bool lib_validate_nim_format(const char *nim);
+/* ID baru bergaya snowflake: (milidetik sejak 2020-01-01 << 22) | urutan.
+ * Monoton naik per DB (maks(high-water + 1, jam)), tanpa rand(); dipakai untuk
+ * loan dan borrower. LIB_ID_NONE hanya jika db NULL. */
+lib_id_t lib_next_id(library_db_t *db);
 
 /* -------------------------
    Loan API
    ------------------------- */
 
 lib_status_t lib_checkout_book(library_db_t *db,
-                               const char *isbn,
+                               lib_isbn_t isbn,
                                const borrower_t *borrower,
                                lib_date_t date_borrow,
                                lib_date_t date_due,
-                               char out_loan_id[32]);
+                               lib_id_t *out_loan_id);
 lib_status_t lib_return_book(library_db_t *db,
-                             const char *loan_id,
+                             lib_id_t loan_id,
                              lib_date_t date_return,
                              unsigned long *out_fine);
+
+/* Sirkulasi batch (satu meja memindai setumpuk buku). Semua item divalidasi
+ * dan kapasitasnya dipesan dulu; jika ada yang gagal tidak ada yang
+ * diterapkan, fungsi mengembalikan status item gagal pertama dan status tiap
+ * item menunjukkan item mana yang menolak (item lain LIB_OK, loan_id
+ * LIB_ID_NONE). Jika lolos, item diterapkan berurutan lalu disimpan dengan
+ * satu lib_db_save (status save menjadi nilai kembali; perubahan tetap di
+ * memori seperti lib_db_save biasa). Gagal saat menerapkan (LIB_ERR_MEMORY)
+ * menghentikan batch di item itu: item sebelumnya tetap berlaku dengan
+ * loan_id terisi. Berbeda dengan lib_checkout_book, peminjam harus sudah
+ * terdaftar (LIB_ERR_NOT_FOUND). */
+typedef struct {
+    lib_isbn_t isbn;
+    const borrower_t *borrower;
+    lib_id_t loan_id;           /* keluaran */
+    lib_status_t status;        /* keluaran */
+} lib_checkout_item_t;
+
+typedef struct {
+    lib_id_t loan_id;
+    unsigned long fine;         /* keluaran: denda keterlambatan */
+    lib_status_t status;        /* keluaran */
+} lib_return_item_t;
+
+lib_status_t lib_checkout_batch(library_db_t *db, lib_checkout_item_t *items, size_t count,
+                                lib_date_t date_borrow, lib_date_t date_due);
+lib_status_t lib_return_batch(library_db_t *db, lib_return_item_t *items, size_t count,
+                              lib_date_t date_return);
 lib_status_t lib_mark_book_lost(library_db_t *db,
-                                const char *loan_id,
+                                lib_id_t loan_id,
                                 unsigned long *out_cost);
 /* Allow caller to set payment amount recorded on a loan (e.g., payment for fine/replacement).
  * This updates the loan's fine_paid field.
  */
-lib_status_t lib_set_loan_payment(library_db_t *db, const char *loan_id, long amount);
+lib_status_t lib_set_loan_payment(library_db_t *db, lib_id_t loan_id, long amount);
+/* Pinjaman hilang yang biaya penggantiannya sudah dibayar: status menjadi kembali */
+lib_status_t lib_settle_lost_loan(library_db_t *db, lib_id_t loan_id);
+/* Lookup loan by id (O(1) via index). Mutable variant for legacy callers;
+ * perubahan lewat pointer mutable tidak tercatat di journal (lihat lib_db_mark_dirty).
+ * Pointer loan berlaku sampai mutasi pinjaman berikutnya (kembali/hilang
+ * memindahkan baris ke partisi riwayat). */
+const loan_t *lib_find_loan_by_id(const library_db_t *db, lib_id_t loan_id);
+loan_t *lib_find_loan_by_id_mutable(library_db_t *db, lib_id_t loan_id);
+/* Salin pinjaman (aktif atau riwayat di memori) ke *out */
+lib_status_t lib_get_loan(const library_db_t *db, lib_id_t loan_id, loan_t *out);
+/* Delete a single loan record from the history (keeps indexes consistent).
+ * Loan yang sudah diarsip dihapus dengan menulis ulang partisinya sekarang. */
+lib_status_t lib_remove_loan(library_db_t *db, lib_id_t loan_id);
+/* Baris loan yang sudah dihapus tetapi belum dipadatkan; lewati saat
+ * mengiterasi riwayat lewat lib_loan_at() */
+bool lib_loan_is_deleted(const loan_t *l);
+/* Baris ke-i partisi riwayat (i < loans_count) / aktif (i < active_loans_count);
+ * NULL jika di luar batas */
+const loan_t *lib_loan_at(const library_db_t *db, size_t i);
+const loan_t *lib_active_loan_at(const library_db_t *db, size_t i);
+/* Jumlah pinjaman (aktif + riwayat + arsip) tanpa tombstone */
+size_t lib_loan_count(const library_db_t *db);
+/* Pinjaman selesai (kembali/hilang) dengan date_returned di [from, to]:
+ * partisi arsip yang rentangnya beririsan (urut manifest), lalu riwayat di
+ * memori. visit mengembalikan false untuk berhenti. Mengembalikan jumlah
+ * pinjaman yang dikunjungi; pointer hanya berlaku selama callback. Hanya
+ * kunci baca; statistik query ditulis ke *stats (boleh NULL). */
+typedef bool (*lib_loan_visit_fn)(void *ctx, const loan_t *loan);
+size_t lib_loan_history_between(const library_db_t *db, lib_date_t from, lib_date_t to,
+                                lib_loan_visit_fn visit, void *ctx, lib_history_stats_t *stats);
+/* Jumlah partisi/baris arsip */
+lib_status_t lib_get_archive_stats(const library_db_t *db, lib_archive_stats_t *out);
+/* Semua pinjaman di memori (riwayat lalu aktif) milik peminjam, cocok
+ * id (teks, lihat lib_id_parse)/nama/NIM; arsip tidak ikut (pakai
+ * lib_loan_history_between) */
 size_t lib_find_loans_by_borrower(const library_db_t *db,
                                   const char *borrower_id_or_name,
                                   loan_t **out, size_t out_capacity);
+/* Hanya pinjaman aktif milik borrower_id (persis); tidak menyentuh riwayat */
+size_t lib_find_active_loans_by_borrower(const library_db_t *db,
+                                         lib_id_t borrower_id,
+                                         loan_t **out, size_t out_capacity);
+/* Pinjaman hilang yang belum dilunasi milik borrower_id (ada di riwayat
+ * memori sampai lib_settle_lost_loan); O(riwayat peminjam itu) */
+size_t lib_find_lost_loans_by_borrower(const library_db_t *db,
+                                       lib_id_t borrower_id,
+                                       loan_t **out, size_t out_capacity);
+
+/* Pinjaman aktif dengan date_due di [from, to], urut jatuh tempo (indeks
+ * kalender; biaya sebanding jumlah hari + hasil). Pointer berlaku sampai
+ * mutasi pinjaman berikutnya. */
+size_t lib_find_loans_due_between(const library_db_t *db,
+                                  lib_date_t from, lib_date_t to,
+                                  loan_t **out, size_t out_capacity);
+/* Pinjaman aktif yang terlambat lebih dari min_days_late hari pada `today`
+ * (0 = semua yang lewat jatuh tempo), urut jatuh tempo paling lama dulu */
+size_t lib_find_overdue_loans(const library_db_t *db, lib_date_t today,
+                              unsigned long min_days_late,
+                              loan_t **out, size_t out_capacity);
+/* Tulis CSV pengingat untuk pinjaman yang jatuh tempo dalam days_ahead hari
+ * sejak `today` (inklusif): loan_id,isbn,title,borrower_id,nim,name,phone,
+ * email,date_due,days_left. *out_count = jumlah baris data. */
+lib_status_t lib_export_due_reminders(const library_db_t *db, const char *path,
+                                      lib_date_t today, unsigned days_ahead,
+                                      size_t *out_count);
 
 /* -------------------------
    Fine helper
    ------------------------- */
 unsigned long lib_calculate_fine(const library_db_t *db,
-                                 lib_date_t due_date,
-                                 lib_date_t return_date);
+                                 lib_day_t due_date,
+                                 lib_day_t return_date);
 
 /* -------------------------
    Admin / Auth helpers
@@ -249,14 +730,16 @@ lib_status_t lib_verify_admin(const char *username, const char *password_plain,
    Persistence helpers
    ------------------------- */
 lib_status_t lib_db_export_csv(const library_db_t *db, const char *path);
+/* Ganti seluruh isi tabel dengan <path>_{books,borrowers,loans}.csv lewat
+ * pipeline paralel (lihat lib_get_import_stats) */
 lib_status_t lib_db_import_csv(library_db_t *db, const char *path);
 
 /* Compatibility / convenience initialiser used by older main.c */
 lib_status_t lib_db_init(library_db_t *db);
 
-/* Mutable find and delete aliases (backwards compatibility) */
-book_t *lib_find_book_by_isbn_mutable(library_db_t *db, const char *isbn);
-lib_status_t lib_delete_book(library_db_t *db, const char *isbn);
+/* Delete alias (backwards compatibility). Buku hanya diubah lewat
+ * lib_update_book() / lib_update_book_stock(). */
+lib_status_t lib_delete_book(library_db_t *db, lib_isbn_t isbn);
 
 /* -------------------------
    Utility / debug
@@ -6,6 +6,12 @@
 /* Helper untuk membaca input dengan aman - internal use only */
 char *ui_read_line(char *buf, size_t size);
 
+/* DB yang dipakai menu. Sebelum memblokir menunggu input, helper input
+ * memanggil ui_idle_sync() agar record group commit tidak menunggu fsync
+ * selama pengguna mengetik (lib_db_tick idle). */
+void ui_set_db(library_db_t *db);
+void ui_idle_sync(void);
+
 /* Fungsi untuk menu dan UI */
 void header_tampilan(const char *title);
 void press_enter(void);
@@ -12,6 +12,7 @@ const char *passwordkey = "pass123";
 /* Helper untuk membaca input */
 static char *read_line_local(char *buf, size_t size) {
     if (!buf || size == 0) return NULL;
+    ui_idle_sync();
     if (fgets(buf, (int)size, stdin) == NULL) return NULL;
     size_t len = strlen(buf);
     while (len > 0 && (buf[len-1] == '\n' || buf[len-1] == '\r')) buf[--len] = '\0';
@@ -38,6 +39,39 @@ static int read_int_choice_local(void) {
     return atoi(p);
 }
 
+/* Satu baris tabel history peminjaman (menu 6) */
+static void print_history_row(const library_db_t *db, const loan_t *l) {
+    const borrower_t *br = lib_find_borrower_by_id(db, l->borrower_id);
+
+    char date_borrow[16], date_due[16], date_return[16], id[LIB_ID_TEXT_MAX], isbn[LIB_ISBN_TEXT_MAX];
+    lib_id_format(l->loan_id, 'L', id, sizeof(id));
+    lib_isbn_format(l->isbn, isbn, sizeof(isbn));
+    lib_day_format(l->date_borrow, date_borrow, sizeof(date_borrow));
+    lib_day_format(l->date_due, date_due, sizeof(date_due));
+    if (l->is_returned) {
+        lib_day_format(l->date_returned, date_return, sizeof(date_return));
+    } else {
+        strcpy(date_return, "-");
+    }
+
+    printf("%-10s %-15s %-20s %-12s %-12s %-12s ",
+           id,
+           isbn,
+           br ? br->name : "???",
+           date_borrow,
+           date_due,
+           date_return);
+
+    if (l->is_lost) printf("HILANG\n");
+    else if (l->is_returned) printf("Kembali\n");
+    else printf("Dipinjam\n");
+}
+
+static bool print_history_visit(void *ctx, const loan_t *l) {
+    print_history_row(ctx, l);
+    return true;
+}
+
 /* Login admin */
 int login_admin(void) {
     char username[32], password[32];
@@ -96,7 +130,7 @@ void menu_admin(library_db_t *db) {
                 animation_delay(300);
                 printf("\n=== DAFTAR BUKU ===\n");
                 /* small shelf scan animation before listing */
-                animation_bookshelf_scan((int)(db->books_count > 12 ? 12 : db->books_count));
+                animation_bookshelf_scan((int)(lib_book_count(db) > 12 ? 12 : lib_book_count(db)));
                 printf("\n%-15s | %-28s | %-18s | %-10s | %-6s | %s\n",
                     printf("Username\t: ");
                 printf("%-15s-+-%-28s-+-%-18s-+-%-10s-+-%-6s-+-%s\n",
@@ -106,14 +140,23 @@ void menu_admin(library_db_t *db) {
                        "==========",
                        "======",
                                 printf("\nMasukkan ISBN buku baru\t: ");
-                for (size_t i = 0; i < db->books_count; i++) {
-                    const book_t *b = &db->books[i];
+                for (size_t i = 0; i < lib_book_count(db); i++) {
+                    const book_t *b = lib_book_at(db, i);
+                    if (lib_book_is_deleted(b)) continue;
                     printf("%-15s | %-28s | %-18s | Rp%8.2f | %-6d | %d\n",
                                 printf("Judul buku\t: ");
                            (strlen(b->title) > 28) ? "..." : b->title, 
                            (strlen(b->author) > 18) ? "..." : b->author,
                            b->price, b->total_stock, b->available);
                                 printf("Pengarang\t: ");
+                {
+                    lib_stock_report_t rep;
+                    if (lib_stock_report(db, &rep) == LIB_OK) {
+                        printf("\nTotal: %lu judul | %ld eksemplar | %ld tersedia | %ld dipinjam | %lu judul habis\n",
+                               (unsigned long)rep.titles, rep.total_stock, rep.available, rep.borrowed,
+                               (unsigned long)rep.out_of_stock);
+                    }
+                }
                 printf("\n");
                 break;
             }
@@ -126,12 +169,17 @@ void menu_admin(library_db_t *db) {
                 printf("ISBN                  : ");
                 if (!read_line_local(buf, sizeof(buf))) break;
                 trim_spaces(buf);
-                strncpy(new_book.isbn, buf, LIB_MAX_ISBN-1);
+                if (!lib_isbn_parse(buf, &new_book.isbn)) {
+                    printf("[!] ISBN tidak valid (periksa ISBN-10/13 dan digit terakhirnya).\n");
+                    break;
+                }
                                 printf("\nMasukkan ISBN buku yang akan dihapus\t: ");
                 {
                     const book_t *existing = lib_find_book_by_isbn(db, new_book.isbn);
                     if (existing) {
-                        printf("\n[!] Buku dengan ISBN %s sudah ada: %s (penulis: %s)\n", existing->isbn, existing->title, existing->author);
+                        char isbn[LIB_ISBN_TEXT_MAX];
+                        lib_isbn_format(existing->isbn, isbn, sizeof(isbn));
+                        printf("\n[!] Buku dengan ISBN %s sudah ada: %s (penulis: %s)\n", isbn, existing->title, existing->author);
                                 printf("\nMasukkan ISBN buku yang akan diupdate\t: ");
                         if (!read_line_local(buf, sizeof(buf))) break;
                         if (buf[0] == 'y' || buf[0] == 'Y') {
@@ -146,7 +194,8 @@ void menu_admin(library_db_t *db) {
                             if (buf[0] == 'y' || buf[0] == 'Y') {
                                 printf("Masukkan harga baru      : "); if (!read_line_local(buf, sizeof(buf))) break;
                                 printf("Stok baru (0 jika tidak diubah)\t: ");
-                                if (bm) { bm->price = atof(buf); lib_db_save(db); printf("Harga diubah.\n"); }
+                                book_t upd = *existing; upd.price = atof(buf);
+                                if (lib_update_book(db, existing->isbn, &upd) == LIB_OK) { lib_db_save(db); printf("Harga diubah.\n"); }
                             }
                         }
                                 printf("\nMasukkan NIM peminjam yang akan dihapus\t: ");
@@ -195,7 +244,7 @@ void menu_admin(library_db_t *db) {
                 if (!read_line_local(buf, sizeof(buf))) break;
                 trim_spaces(buf);
 
-                const book_t *b = lib_find_book_by_isbn(db, buf);
+                const book_t *b = lib_find_book_by_isbn(db, lib_isbn_key(buf));
                 if (!b) {
                     printf("[!] Buku tidak ditemukan.\n");
                     break;
@@ -227,7 +276,7 @@ void menu_admin(library_db_t *db) {
                 if (!read_line_local(buf, sizeof(buf))) break;
                 trim_spaces(buf);
 
-                const book_t *b = lib_find_book_by_isbn(db, buf);
+                const book_t *b = lib_find_book_by_isbn(db, lib_isbn_key(buf));
                 if (!b) {
                     printf("[!] Buku tidak ditemukan.\n");
                     break;
@@ -280,9 +329,9 @@ void menu_admin(library_db_t *db) {
                     if (buf[0] == 'y' || buf[0] == 'Y') {
                         printf("Masukkan harga baru (mis. 15000.00): ");
                         if (!read_line_local(buf, sizeof(buf))) break;
-                        book_t *bm = lib_find_book_by_isbn_mutable(db, b->isbn);
-                        if (bm) {
-                            bm->price = atof(buf);
+                        book_t upd = *b;
+                        upd.price = atof(buf);
+                        if (lib_update_book(db, b->isbn, &upd) == LIB_OK) {
                             printf("Harga berhasil diubah.\n");
                             lib_db_save(db);
                         } else {
@@ -326,33 +375,31 @@ void menu_admin(library_db_t *db) {
                 printf("%-10s-+-%-13s-+-%-18s-+-%-12s-+-%-12s-+-%-12s-+-%s\n",
                        "==========", "=============", "==================", "============", "============", "============", "=========");
 
+                /* riwayat (selesai/hilang) lalu pinjaman yang masih aktif */
                 for (size_t i = 0; i < db->loans_count; i++) {
-                    const loan_t *l = &db->loans[i];
-                    const borrower_t *br = lib_find_borrower_by_id(db, l->borrower_id);
+                    const loan_t *ln = lib_loan_at(db, i);
+                    if (!lib_loan_is_deleted(ln)) print_history_row(db, ln);
+                }
+                for (size_t i = 0; i < db->active_loans_count; i++) print_history_row(db, lib_active_loan_at(db, i));
 
-                    char date_borrow[16], date_due[16], date_return[16];
-                    snprintf(date_borrow, sizeof(date_borrow), "%04d-%02d-%02d",
-                            l->date_borrow.year, l->date_borrow.month, l->date_borrow.day);
-                    snprintf(date_due, sizeof(date_due), "%04d-%02d-%02d",
-                            l->date_due.year, l->date_due.month, l->date_due.day);
-                    if (l->is_returned) {
-                        snprintf(date_return, sizeof(date_return), "%04d-%02d-%02d",
-                                l->date_returned.year, l->date_returned.month, l->date_returned.day);
-                    } else {
-                        strcpy(date_return, "-");
+                /* riwayat bulan-bulan lalu ada di arsip: dibaca per rentang tanggal */
+                lib_archive_stats_t as;
+                lib_get_archive_stats(db, &as);
+                if (as.archived_rows > 0) {
+                    printf("\n%llu pinjaman lama tersimpan di arsip bulanan (%lu file).\n",
+                           as.archived_rows, (unsigned long)as.partitions);
+                    printf("Tampilkan riwayat rentang tanggal (YYYY-MM-DD YYYY-MM-DD, kosong = lewati): ");
+                    if (!read_line_local(buf, sizeof(buf))) break;
+                    lib_date_t from, to;
+                    if (sscanf(buf, "%d-%d-%d %d-%d-%d", &from.year, &from.month, &from.day,
+                               &to.year, &to.month, &to.day) == 6) {
+                        printf("\n");
+                        lib_history_stats_t hs;
+                        size_t shown = lib_loan_history_between(db, from, to, print_history_visit, db, &hs);
+                        printf("\n%lu pinjaman (%lu dari %lu file arsip dibuka).\n", (unsigned long)shown,
+                               (unsigned long)hs.parts_scanned,
+                               (unsigned long)(hs.parts_scanned + hs.parts_pruned));
                     }
-
-                    printf("%-10s %-15s %-20s %-12s %-12s %-12s ",
-                           l->loan_id,
-                           l->isbn,
-                           br ? br->name : "???",
-                           date_borrow,
-                           date_due,
-                           date_return);
-
-                    if (l->is_lost) printf("HILANG\n");
-                    else if (l->is_returned) printf("Kembali\n");
-                    else printf("Dipinjam\n");
                 }
 
                 /* Tambahkan opsi untuk hapus history pinjaman tertentu */
@@ -362,21 +409,11 @@ void menu_admin(library_db_t *db) {
                     printf("Masukkan Loan ID yang ingin dihapus: ");
                     if (!read_line_local(buf, sizeof(buf))) break;
                     trim_spaces(buf);
-                    size_t index = 0;
-                    for (index = 0; index < db->loans_count; index++) {
-                        if (strcmp(db->loans[index].loan_id, buf) == 0) {
-                            break;
-                        }
-                    }
-                    if (index == db->loans_count) {
+                    lib_id_t loan_id = LIB_ID_NONE;
+                    if (!lib_id_parse(buf, &loan_id) || lib_remove_loan(db, loan_id) != LIB_OK) {
                         printf("[!] Loan ID tidak ditemukan.\n");
                         break;
                     }
-                    // Remove by shifting
-                    for (size_t i = index; i < db->loans_count - 1; i++) {
-                        db->loans[i] = db->loans[i+1];
-                    }
-                    db->loans_count--;
                     printf("History pinjaman %s berhasil dihapus.\n", buf);
                     lib_db_save(db);
                     animation_loading_bar(300);
@@ -388,44 +425,68 @@ void menu_admin(library_db_t *db) {
                 animation_typewriter("[Admin] Cek pinjaman terlambat...", 25);
                 animation_delay(300);
                 /* Automatically mark loans overdue > max_overdue_days_before_lost as lost */
-                printf("\n=== PINJAMAN TERLAMBAT ===");
+                printf("\n=== PINJAMAN TERLAMBAT ===\n");
                 lib_date_t today = lib_date_from_time_t(time(NULL));
                 unsigned long max_overdue = lib_get_max_overdue_days_before_lost(db);
-                int found = 0;
+                /* indeks jatuh tempo: hanya pinjaman yang sudah lewat, urut paling lama dulu */
+                size_t cap = db->active_loans_count ? db->active_loans_count : 1;
+                loan_t **late = malloc(cap * sizeof(*late));
+                lib_id_t *lost_ids = malloc(cap * sizeof(*lost_ids));
+                if (!late || !lost_ids) {
+                    printf("[!] Memori tidak cukup.\n");
+                    free(late); free(lost_ids);
+                    break;
+                }
+                size_t found = lib_find_overdue_loans(db, today, 0, late, cap);
+                size_t n_lost = 0;
+                for (size_t i = 0; i < found; ++i) {
+                    const loan_t *l = late[i];
+                    int days = (int)(lib_date_to_days(today) - l->date_due);
+                    const borrower_t *br = lib_find_borrower_by_id(db, l->borrower_id);
+                    char due[16], id[LIB_ID_TEXT_MAX], isbn[LIB_ISBN_TEXT_MAX];
+                    lib_day_format(l->date_due, due, sizeof(due));
+                    lib_id_format(l->loan_id, 'L', id, sizeof(id));
+                    lib_isbn_format(l->isbn, isbn, sizeof(isbn));
+                    printf("Loan ID: %s | ISBN: %s | Borrower: %s | Due: %s | Days late: %d\n",
+                           id, isbn, br ? br->name : "(unknown)", due, days);
+                    /* menandai hilang memindahkan baris, jadi ID dikumpulkan dulu */
+                    if ((unsigned long)days > max_overdue) lost_ids[n_lost++] = l->loan_id;
+                }
                 int auto_marked = 0;
-                for (size_t i = 0; i < db->loans_count; ++i) {
-                    loan_t *l = &db->loans[i];
-                    if (!l->is_returned && !l->is_lost) {
-                        int days = lib_date_days_between(l->date_due, today);
-                        if (days > 0) {
-                            const borrower_t *br = lib_find_borrower_by_id(db, l->borrower_id);
-                            printf("Loan ID: %s | ISBN: %s | Borrower: %s | Due: %04d-%02d-%02d | Days late: %d\n",
-                                   l->loan_id, l->isbn, br ? br->name : "(unknown)",
-                                   l->date_due.year, l->date_due.month, l->date_due.day, days);
-                            found++;
-                            if ((unsigned long)days > max_overdue) {
-                                unsigned long cost = 0;
-                                lib_status_t st = lib_mark_book_lost(db, l->loan_id, &cost);
-                                if (st == LIB_OK) {
-                                    printf("  -> OTOMATIS DITANDAI HILANG (terlambat > %lu hari). Biaya penggantian: %lu\n", max_overdue, cost);
-                                    auto_marked++;
-                                } else {
-                                    printf("  -> Gagal menandai hilang otomatis (kode: %d).\n", (int)st);
-                                }
-                            }
-                        }
+                for (size_t i = 0; i < n_lost; ++i) {
+                    unsigned long cost = 0;
+                    char id[LIB_ID_TEXT_MAX];
+                    lib_id_format(lost_ids[i], 'L', id, sizeof(id));
+                    lib_status_t st = lib_mark_book_lost(db, lost_ids[i], &cost);
+                    if (st == LIB_OK) {
+                        printf("  -> %s OTOMATIS DITANDAI HILANG (terlambat > %lu hari). Biaya penggantian: %lu\n", id, max_overdue, cost);
+                        auto_marked++;
+                    } else {
+                        printf("  -> %s gagal ditandai hilang otomatis (kode: %d).\n", id, (int)st);
                     }
                 }
+                free(late);
+                free(lost_ids);
                 if (found == 0) {
                     printf("Tidak ada pinjaman terlambat saat ini.\n");
                 } else {
-                    printf("\nTotal pinjaman terlambat: %d\n", found);
+                    printf("\nTotal pinjaman terlambat: %zu\n", found);
                     printf("Otomatis ditandai hilang: %d\n", auto_marked);
                     if (auto_marked > 0) {
                         lib_db_save(db);
                         printf("Perubahan telah disimpan.\n");
                     }
                 }
+                printf("\nEkspor pengingat jatuh tempo untuk berapa hari ke depan? (kosong = lewati): ");
+                if (!read_line_local(buf, sizeof(buf))) break;
+                trim_spaces(buf);
+                if (buf[0] == '\0') break;
+                unsigned days_ahead = (unsigned)strtoul(buf, NULL, 10);
+                size_t n_reminders = 0;
+                if (lib_export_due_reminders(db, "data/reminders.csv", today, days_ahead, &n_reminders) == LIB_OK)
+                    printf("%zu pengingat ditulis ke data/reminders.csv\n", n_reminders);
+                else
+                    printf("[!] Gagal menulis data/reminders.csv\n");
                 break;
             }
             case 8: {
@@ -441,7 +502,9 @@ void menu_admin(library_db_t *db) {
                     break;
                 }
                 unsigned long cost = 0;
-                lib_status_t st = lib_mark_book_lost(db, buf, &cost);
+                lib_id_t loan_id = LIB_ID_NONE;
+                (void)lib_id_parse(buf, &loan_id);
+                lib_status_t st = lib_mark_book_lost(db, loan_id, &cost);
                 if (st == LIB_OK) {
                     printf("Buku berhasil ditandai hilang.\n");
                     printf("Biaya penggantian: %lu\n", cost);
@@ -484,6 +547,18 @@ void menu_admin(library_db_t *db) {
                         printf("Nilai tidak valid, tidak diubah.\n");
                     }
                 }
+                printf("Mode durability saat ini: %s\n", lib_durability_name(lib_get_durability(db)));
+                printf("Masukkan mode baru (sync/group/buffered, kosong untuk tidak mengubah): ");
+                if (!read_line_local(buf, sizeof(buf))) break;
+                if (buf[0] != '\0') {
+                    lib_durability_t mode;
+                    if (lib_durability_parse(buf, &mode)) {
+                        lib_set_durability(db, mode, 0, 0);
+                        printf("Mode durability diubah menjadi: %s\n", lib_durability_name(mode));
+                    } else {
+                        printf("Mode tidak dikenal, tidak diubah.\n");
+                    }
+                }
                 /* Persist settings */
                 lib_db_save(db);
                 break;
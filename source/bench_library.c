@@ -0,0 +1,1728 @@
+/* bench_library.c
+ *
+ * Microbenchmark untuk core library (bukan bagian dari program utama).
+ * Jalankan dari root project:
+ *
+ *   gcc -Iinclude -O2 -o bin/bench_library.exe source/bench_library.c source/library.c \
+ *       source/lib_index.c source/lib_text.c source/lib_journal.c source/lib_snapshot.c source/lib_csv.c \
+ *       source/lib_thread.c source/lib_import.c source/lib_archive.c source/lib_arena.c source/lib_rows.c \
+ *       source/lib_proto.c source/lib_server.c -pthread -lm
+ *   ./bin/bench_library.exe            (semua benchmark)
+ *   ./bin/bench_library.exe text       (hanya benchmark tertentu)
+ *
+ * Data uji dibuat secara sintetis (judul/nama mirip data perpustakaan nyata).
+ * Benchmark "save" dan "open" menulis file sementara bench_tmp_db_* di direktori kerja
+ * lalu menghapusnya; "daemon" juga membuat socket bench_tmp_perpusd.sock.
+ * "csv" mengisi 1 juta pinjaman (beberapa detik + ~100 MB file sementara).
+ *
+ * Standard: ISO C99
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#endif
+
+#include "../include/library.h"
+#include "../include/lib_text.h"
+#include "../include/lib_index.h"
+#include "../include/lib_rows.h"
+#include "../include/lib_csv.h"
+#include "../include/lib_thread.h"
+#include "../include/lib_proto.h"
+#include "../include/lib_server.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+/* ---------- timing helper ---------- */
+
+static double now_ms(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart * 1000.0 / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+#endif
+}
+
+/* ---------- synthetic data ---------- */
+
+static const char *title_words[] = {
+    "Pengantar", "Algoritma", "Struktur", "Data", "Sistem", "Informasi", "Basis",
+    "Pemrograman", "Bahasa", "Jaringan", "Komputer", "Keamanan", "Introduction",
+    "to", "the", "of", "and", "Clean", "Architecture", "Harry", "Potter", "Lessons",
+    "Century", "Misteri", "Bukit", "Kebijakan", "Ekonomi", "Sejarah", "Indonesia",
+    "Modern", "Teori", "Praktik", "Statistika", "Matematika", "Diskrit", "Kalkulus"
+};
+#define TITLE_WORD_COUNT (sizeof(title_words) / sizeof(title_words[0]))
+
+static void make_title(char *out, size_t out_sz, unsigned seed) {
+    size_t len = 0;
+    out[0] = '\0';
+    int words = 2 + (int)(seed % 5);
+    for (int w = 0; w < words; ++w) {
+        seed = seed * 1103515245u + 12345u;
+        const char *word = title_words[(seed >> 16) % TITLE_WORD_COUNT];
+        int n = snprintf(out + len, out_sz - len, "%s%s", w ? " " : "", word);
+        if (n < 0 || (size_t)n >= out_sz - len) break;
+        len += (size_t)n;
+    }
+}
+
+/* ISBN-13 valid ke-i: 978 + 9 digit + digit pemeriksa */
+static lib_isbn_t bench_isbn(unsigned long i) {
+    uint64_t p = 978000000000ULL + i % 1000000000UL, v = p;
+    int sum = 0;
+    for (int k = 0; k < 12; ++k, v /= 10) sum += (int)(v % 10) * (k % 2 ? 1 : 3);
+    return p * 10 + (uint64_t)((10 - sum % 10) % 10);
+}
+
+/* ---------- text: case-insensitive substring ---------- */
+
+/* Implementasi lama dari library.c (dua malloc + lower-casing per baris) sebagai baseline */
+static int legacy_contains_case_insensitive(const char *haystack, const char *needle) {
+    if (!haystack || !needle) return 0;
+    size_t hlen = strlen(haystack), nlen = strlen(needle);
+    if (nlen == 0) return 1;
+    char *hl = malloc(hlen + 1);
+    char *nl = malloc(nlen + 1);
+    if (!hl || !nl) { free(hl); free(nl); return 0; }
+    strcpy(hl, haystack); strcpy(nl, needle);
+    for (char *p = hl; *p; ++p) *p = (char)tolower((unsigned char)*p);
+    for (char *p = nl; *p; ++p) *p = (char)tolower((unsigned char)*p);
+    int res = (strstr(hl, nl) != NULL);
+    free(hl); free(nl);
+    return res;
+}
+
+static void bench_text(void) {
+    /* working set kecil (muat di cache) supaya yang terukur biaya kernel, bukan memori */
+    enum { ROWS = 20000, ROUNDS = 50 };
+    static const char *queries[] = { "algoritma", "HARRY potter", "data", "sejarah indonesia modern", "xyz", "of the" };
+    const size_t nq = sizeof(queries) / sizeof(queries[0]);
+    char (*titles)[LIB_MAX_TITLE] = malloc((size_t)ROWS * LIB_MAX_TITLE);
+    if (!titles) return;
+    for (unsigned i = 0; i < ROWS; ++i) make_title(titles[i], LIB_MAX_TITLE, i * 2654435761u);
+
+    printf("[text] %d judul x %lu query x %d putaran, kernel: %s\n",
+           ROWS, (unsigned long)nq, ROUNDS, lib_text_kernel_name());
+    size_t hits_old = 0, hits_new = 0;
+    double t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (size_t q = 0; q < nq; ++q)
+            for (unsigned i = 0; i < ROWS; ++i) hits_old += (size_t)legacy_contains_case_insensitive(titles[i], queries[q]);
+    double t_old = now_ms() - t0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (size_t q = 0; q < nq; ++q)
+            for (unsigned i = 0; i < ROWS; ++i) hits_new += lib_contains_ci(titles[i], queries[q]) ? 1u : 0u;
+    double t_new = now_ms() - t0;
+    double cmps = (double)ROWS * (double)nq * ROUNDS;
+    printf("  legacy (malloc+tolower+strstr): %8.1f ms  %6.1f ns/baris  hits=%lu\n", t_old, t_old * 1e6 / cmps, (unsigned long)hits_old);
+    printf("  lib_contains_ci               : %8.1f ms  %6.1f ns/baris  hits=%lu\n", t_new, t_new * 1e6 / cmps, (unsigned long)hits_new);
+    printf("  speedup: %.1fx\n", t_new > 0 ? t_old / t_new : 0.0);
+    free(titles);
+}
+
+/* ---------- stock: hot/cold split ---------- */
+
+static void make_book(book_t *b, size_t i) {
+    memset(b, 0, sizeof(*b));
+    b->isbn = bench_isbn((unsigned long)i);
+    make_title(b->title, sizeof(b->title), (unsigned)i * 2654435761u);
+    snprintf(b->author, sizeof(b->author), "Penulis %lu", (unsigned long)(i % 997));
+    b->year = 1990 + (int)(i % 35);
+    b->total_stock = 1 + (int)(i % 7);
+    b->available = (int)((i * 7919u) % (unsigned)(b->total_stock + 1));
+    b->price = 15000.0 + (double)(i % 50) * 1000.0;
+}
+
+/* DB sintetis dengan `n` buku (max_book_types dinaikkan ke hard limit) */
+static library_db_t *make_book_db(size_t n) {
+    library_db_t *db = calloc(1, sizeof(library_db_t));
+    if (!db || lib_db_init(db) != LIB_OK) { free(db); return NULL; }
+    lib_set_max_book_types(db, LIB_MAX_BOOK_TYPES_HARD_LIMIT);
+    for (size_t i = 0; i < n; ++i) {
+        book_t b;
+        make_book(&b, i);
+        if (lib_add_book(db, &b) != LIB_OK) break;
+    }
+    return db;
+}
+
+static void bench_stock(void) {
+    enum { ROUNDS = 200, BOOKS = 65536 };
+    library_db_t *db = make_book_db(BOOKS);
+    if (!db) return;
+    size_t n = lib_book_count(db);
+    const book_t **out = malloc(n * sizeof(*out));
+    /* baseline: array book_t kontigu (layout lama) */
+    book_t *rows = malloc(n * sizeof(*rows));
+    if (!out || !rows) { free(out); free(rows); lib_db_close(db); return; }
+    for (size_t i = 0; i < n; ++i) rows[i] = *lib_book_at(db, i);
+    printf("[stock] %lu buku x %d putaran (book_t %lu byte, kolom panas %lu byte)\n",
+           (unsigned long)n, ROUNDS, (unsigned long)sizeof(book_t), (unsigned long)sizeof(lib_book_hot_t));
+
+    /* baseline: scan langsung array book_t */
+    volatile double sink = 0.0;
+    double t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) {
+        long total = 0, avail = 0; double value = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            total += rows[i].total_stock;
+            avail += rows[i].available;
+            value += rows[i].price * (double)rows[i].total_stock;
+        }
+        sink += (double)(total - avail) + value;
+    }
+    double t_rows = now_ms() - t0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) {
+        lib_stock_report_t rep;
+        lib_stock_report(db, &rep);
+        sink += (double)rep.borrowed + rep.stock_value;
+    }
+    double t_hot = now_ms() - t0;
+    printf("  laporan stok   book_t: %7.1f ms | kolom panas: %7.1f ms | speedup %.1fx\n",
+           t_rows, t_hot, t_hot > 0 ? t_rows / t_hot : 0.0);
+
+    size_t found_rows = 0, found_hot = 0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) {
+        size_t found = 0;
+        for (size_t i = 0; i < n; ++i) if (rows[i].available >= 3) out[found++] = &rows[i];
+        found_rows += found;
+    }
+    t_rows = now_ms() - t0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) found_hot += lib_find_available_books(db, 3, out, n);
+    t_hot = now_ms() - t0;
+    printf("  filter tersedia book_t: %7.1f ms | kolom panas: %7.1f ms | speedup %.1fx (hasil %lu/%lu)\n",
+           t_rows, t_hot, t_hot > 0 ? t_rows / t_hot : 0.0, (unsigned long)found_rows, (unsigned long)found_hot);
+    (void)sink;
+    free(out);
+    free(rows);
+    lib_db_close(db);
+}
+
+/* ---------- save: journal vs tulis ulang CSV ---------- */
+
+static void remove_db_files(const char *base) {
+    static const char *suffixes[] = { "_books.csv", "_borrowers.csv", "_loans.csv", "_meta.cfg", "_journal.log",
+                                      "_snapshot.bin", "_loans_manifest.csv" };
+    char path[256];
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i) {
+        snprintf(path, sizeof(path), "%s%s", base, suffixes[i]);
+        remove(path);
+    }
+    /* partisi arsip (data benchmark bertanggal 2024/2025) */
+    for (int y = 2024; y <= 2025; ++y)
+        for (int m = 1; m <= 12; ++m) {
+            snprintf(path, sizeof(path), "%s_loans_%04d-%02d.csv", base, y, m);
+            remove(path);
+        }
+}
+
+/* Isi DB dengan buku, peminjam dan pinjaman sintetis (lewat API publik) */
+static bool fill_library(library_db_t *db, size_t books, size_t borrowers, size_t loans) {
+    lib_set_max_book_types(db, LIB_MAX_BOOK_TYPES_HARD_LIMIT);
+    for (size_t i = 0; i < books; ++i) {
+        book_t b; memset(&b, 0, sizeof(b));
+        b.isbn = bench_isbn((unsigned long)i);
+        make_title(b.title, sizeof(b.title), (unsigned)i * 2654435761u);
+        snprintf(b.author, sizeof(b.author), "Penulis %lu", (unsigned long)(i % 997));
+        b.total_stock = b.available = 10;
+        b.price = 50000.0;
+        lib_add_book(db, &b);
+    }
+    borrower_t *brs = calloc(borrowers, sizeof(borrower_t));
+    if (!brs) return false;
+    for (size_t i = 0; i < borrowers; ++i) {
+        brs[i].id = (lib_id_t)i + 1;
+        snprintf(brs[i].nim, sizeof(brs[i].nim), "NIM%06lu", (unsigned long)i);
+        snprintf(brs[i].name, sizeof(brs[i].name), "Mahasiswa %lu", (unsigned long)i);
+        lib_add_borrower(db, &brs[i]);
+    }
+    lib_date_t d = { 2025, 1, 1 };
+    for (size_t i = 0; i < loans; ++i) {
+        lib_checkout_book(db, bench_isbn((unsigned long)(i % books)), &brs[i % borrowers], d, d, NULL);
+    }
+    free(brs);
+    return true;
+}
+
+static void bench_save(void) {
+    enum { BOOKS = 20000, BORROWERS = 5000, LOANS = 50000, OPS = 512 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) return;
+    if (!fill_library(db, BOOKS, BORROWERS, LOANS)) { lib_db_close(db); return; }
+    lib_db_checkpoint(db);
+    printf("[save] %d buku, %d peminjam, %lu pinjaman; %d operasi stok + save\n",
+           BOOKS, BORROWERS, (unsigned long)db->loans_count, OPS);
+
+    double worst = 0.0, t0 = now_ms();
+    for (int i = 0; i < OPS; ++i) {
+        double s0 = now_ms();
+        lib_update_book_stock(db, bench_isbn(7), (i & 1) ? -1 : 1);
+        lib_db_save(db);
+        double dt = now_ms() - s0;
+        if (dt > worst) worst = dt;
+    }
+    double t_journal = now_ms() - t0;
+    printf("  lib_db_save (journal, checkpoint tiap %lu): %8.3f ms/op  (maks %.1f ms)\n",
+           (unsigned long)lib_get_journal_checkpoint_entries(db), t_journal / OPS, worst);
+
+    /* durability: save beruntun berbagi fsync */
+    static const lib_durability_t modes[] = { LIB_DURABILITY_GROUP, LIB_DURABILITY_BUFFERED };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        lib_save_stats_t before, after;
+        lib_set_durability(db, modes[m], 0, 0);
+        lib_get_save_stats(db, &before);
+        t0 = now_ms();
+        for (int i = 0; i < OPS; ++i) {
+            lib_update_book_stock(db, bench_isbn(7), (i & 1) ? -1 : 1);
+            lib_db_save(db);
+        }
+        lib_db_flush(db);
+        double t_mode = now_ms() - t0;
+        lib_get_save_stats(db, &after);
+        printf("  lib_db_save durability=%-8s          : %8.3f ms/op  (%lu fsync, %lu checkpoint)\n",
+               lib_durability_name(modes[m]), t_mode / OPS,
+               after.syncs - before.syncs, after.checkpoints - before.checkpoints);
+    }
+    lib_set_durability(db, LIB_DURABILITY_SYNC, 0, 0);
+    lib_db_flush(db);
+
+    /* checkpoint: hanya tabel dirty (buku) vs semua tabel (perilaku lama) */
+    lib_save_stats_t st;
+    unsigned long long bytes_dirty = 0, bytes_full = 0;
+    unsigned long skipped = 0;
+    t0 = now_ms();
+    for (int i = 0; i < OPS / 32; ++i) {
+        lib_update_book_stock(db, bench_isbn(7), (i & 1) ? -1 : 1);
+        lib_db_checkpoint(db);
+        lib_get_save_stats(db, &st);
+        bytes_dirty += st.bytes_written;
+        skipped += st.files_skipped;
+    }
+    double t_dirty = now_ms() - t0;
+    t0 = now_ms();
+    for (int i = 0; i < OPS / 32; ++i) {
+        lib_update_book_stock(db, bench_isbn(7), (i & 1) ? -1 : 1);
+        lib_db_mark_dirty(db, LIB_DIRTY_ALL);
+        lib_db_checkpoint(db);
+        lib_get_save_stats(db, &st);
+        bytes_full += st.bytes_written;
+    }
+    double t_full = now_ms() - t0;
+    printf("  checkpoint tabel dirty saja             : %8.3f ms/op  (%llu KB/op, %lu file dilewati)\n",
+           t_dirty / (OPS / 32), bytes_dirty / (OPS / 32) / 1024, skipped / (OPS / 32));
+    printf("  tulis ulang semua CSV (perilaku lama)    : %8.3f ms/op  (%llu KB/op)\n",
+           t_full / (OPS / 32), bytes_full / (OPS / 32) / 1024);
+    printf("  speedup rata-rata journal: %.1fx, dirty checkpoint: %.1fx\n",
+           t_journal > 0 ? (t_full / (OPS / 32)) / (t_journal / OPS) : 0.0,
+           t_dirty > 0 ? t_full / t_dirty : 0.0);
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- open: parsing CSV vs snapshot biner ---------- */
+
+/* acc (boleh NULL) menjumlahkan rincian lib_get_open_stats */
+/* rows: buku, peminjam, pinjaman (riwayat + aktif) */
+static double time_open(const char *base, size_t rows[3], lib_open_stats_t *acc) {
+    lib_status_t err;
+    double t0 = now_ms();
+    library_db_t *db = lib_db_open(base, &err);
+    double dt = now_ms() - t0;
+    rows[0] = db ? lib_book_count(db) : 0;
+    rows[1] = db ? lib_borrower_count(db) : 0;
+    rows[2] = db ? lib_loan_count(db) : 0;
+    lib_open_stats_t os;
+    if (acc && lib_get_open_stats(db, &os) == LIB_OK) {
+        acc->threads = os.threads;
+        acc->books_ms += os.books_ms;
+        acc->borrowers_ms += os.borrowers_ms;
+        acc->loans_ms += os.loans_ms;
+        acc->meta_ms += os.meta_ms;
+        acc->load_ms += os.load_ms;
+        acc->index_ms += os.index_ms;
+        acc->replay_ms += os.replay_ms;
+    }
+    lib_db_close(db);
+    return dt;
+}
+
+static void bench_open(void) {
+    enum { BOOKS = 20000, BORROWERS = 5000, LOANS = 200000, ROUNDS = 5 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) return;
+    if (!fill_library(db, BOOKS, BORROWERS, LOANS)) { lib_db_close(db); return; }
+    lib_db_checkpoint(db);
+    lib_db_close(db);
+    printf("[open] %d buku, %d peminjam, %d pinjaman; %d kali buka\n", BOOKS, BORROWERS, LOANS, ROUNDS);
+
+    size_t n_csv[3] = { 0 }, n_snap[3] = { 0 };
+    double t_csv = 0.0, t_snap = 0.0;
+    lib_open_stats_t os;
+    memset(&os, 0, sizeof(os));
+    for (int r = 0; r < ROUNDS; ++r) t_csv += time_open(base, n_csv, &os);
+
+    db = lib_db_open(base, &err);
+    if (!db) return;
+    lib_set_binary_snapshot(db, true);
+    lib_db_checkpoint(db);
+    lib_db_close(db);
+    for (int r = 0; r < ROUNDS; ++r) t_snap += time_open(base, n_snap, NULL);
+    /* kedua jalur harus memuat data yang sama */
+    assert(n_csv[2] == LOANS);
+    assert(memcmp(n_csv, n_snap, sizeof(n_csv)) == 0);
+
+    printf("  lib_db_open CSV: %8.1f ms | snapshot biner: %8.1f ms | speedup %.1fx (pinjaman %lu/%lu)\n",
+           t_csv / ROUNDS, t_snap / ROUNDS, t_snap > 0 ? t_csv / t_snap : 0.0,
+           (unsigned long)n_csv[2], (unsigned long)n_snap[2]);
+    /* baca paralel: load (wall) ~ tabel terlama, bukan jumlah ketiganya */
+    printf("  rincian CSV (%u thread): buku %.1f | peminjam %.1f | pinjaman %.1f | meta %.2f ms\n",
+           os.threads, os.books_ms / ROUNDS, os.borrowers_ms / ROUNDS, os.loans_ms / ROUNDS, os.meta_ms / ROUNDS);
+    printf("  fase baca+indeks %.1f ms (jumlah per tabel %.1f ms, gabung indeks %.2f ms) | replay %.2f ms\n",
+           os.load_ms / ROUNDS, (os.books_ms + os.borrowers_ms + os.loans_ms + os.meta_ms) / ROUNDS,
+           os.index_ms / ROUNDS, os.replay_ms / ROUNDS);
+    remove_db_files(base);
+}
+
+/* ---------- import: pipeline paralel untuk file besar ---------- */
+
+/* Tulis CSV sintetis langsung (lebih cepat daripada lewat API untuk jutaan baris) */
+static bool write_import_files(const char *base, unsigned books, unsigned borrowers, unsigned loans) {
+    char path[256], title[LIB_MAX_TITLE], isbn[LIB_ISBN_TEXT_MAX];
+    snprintf(path, sizeof(path), "%s_books.csv", base);
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    fputs("isbn,title,author,year,total_stock,available,price,notes\n", f);
+    for (unsigned i = 0; i < books; ++i) {
+        make_title(title, sizeof(title), i * 2654435761u);
+        lib_isbn_format(bench_isbn(i), isbn, sizeof(isbn));
+        fprintf(f, "%s,%s,Penulis %u,%u,%u,%u,%u.50,%s\n", isbn, title, i % 500, 1980 + i % 45,
+                1 + i % 9, i % 9, 20000 + i % 90000, i % 13 ? "" : "\"Edisi 2, revisi\"");
+    }
+    fclose(f);
+    snprintf(path, sizeof(path), "%s_borrowers.csv", base);
+    if (!(f = fopen(path, "wb"))) return false;
+    fputs("id,nim,name,phone,email\n", f);
+    for (unsigned i = 0; i < borrowers; ++i)
+        fprintf(f, "P%u,672%05u,Mahasiswa %u,0812%07u,m%u@kampus.ac.id\n", i, i, i, i, i);
+    fclose(f);
+    snprintf(path, sizeof(path), "%s_loans.csv", base);
+    if (!(f = fopen(path, "wb"))) return false;
+    fputs("loan_id,isbn,borrower_id,date_borrow,date_due,date_returned,is_returned,is_lost,fine_paid\n", f);
+    for (unsigned i = 0; i < loans; ++i) {
+        unsigned m = 1 + i % 12, d = 1 + i % 28;
+        lib_isbn_format(bench_isbn(i % books), isbn, sizeof(isbn));
+        if (i % 3)
+            fprintf(f, "L%u,%s,P%u,2024-%02u-%02u,2024-%02u-%02u,2024-%02u-%02u,1,0,%u\n",
+                    i, isbn, i % borrowers, m, d, m, d, m, d, (i % 5) * 500);
+        else
+            fprintf(f, "L%u,%s,P%u,2024-%02u-%02u,2024-%02u-%02u,,0,0,0\n", i, isbn, i % borrowers, m, d, m, d);
+    }
+    fclose(f);
+    return true;
+}
+
+static void bench_import(void) {
+    enum { BOOKS = 60000, BORROWERS = 20000, LOANS = 1000000 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    if (!write_import_files(base, BOOKS, BORROWERS, LOANS)) return;
+    printf("[import] %d buku, %d peminjam, %d pinjaman\n", BOOKS, BORROWERS, LOANS);
+
+    /* baseline: satu parser per tabel (loader lib_db_open) */
+    lib_status_t err;
+    double t0 = now_ms();
+    library_db_t *db = lib_db_open(base, &err);
+    double t_open = now_ms() - t0;
+    if (!db) { remove_db_files(base); return; }
+    unsigned long rows = (unsigned long)(db->books_count + db->borrowers_count + db->loans_count);
+
+    lib_status_t st = lib_db_import_csv(db, base);
+    lib_import_stats_t is;
+    lib_get_import_stats(db, &is);
+    printf("  lib_db_open (1 parser/tabel) : %8.1f ms  %9.0f baris/s\n", t_open, t_open > 0 ? rows * 1000.0 / t_open : 0.0);
+    printf("  lib_db_import_csv (%u parser) : %8.1f ms  %9.0f baris/s  (%lu baris, %.1f MB, %lu potongan, status %d)\n",
+           is.parsers, is.total_ms, is.rows_per_sec, is.rows, is.bytes / 1048576.0, is.chunks, (int)st);
+    printf("  tahap (waktu sibuk): baca %.1f | potong %.1f | parse %.1f | insert %.1f ms\n",
+           is.read_ms, is.split_ms, is.parse_ms, is.insert_ms);
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- purge: tombstone + satu sweep vs geser per baris ---------- */
+
+/* Algoritma lama lib_remove_old_loans: memmove sisa tabel untuk setiap baris */
+static size_t legacy_purge(loan_t *loans, size_t count) {
+    size_t removed = 0;
+    for (size_t i = 0; i < count; ) {
+        if (loans[i].is_returned && !loans[i].is_lost) {
+            memmove(&loans[i], &loans[i + 1], (count - i - 1) * sizeof(loan_t));
+            count--;
+            removed++;
+            continue;
+        }
+        i++;
+    }
+    return removed;
+}
+
+static void bench_purge(void) {
+    enum { LOANS = 1500000, LEGACY_ROWS = 60000 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    if (!write_import_files(base, 20000, 5000, LOANS)) return;
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) { remove_db_files(base); return; }
+    size_t before = lib_loan_count(db);
+    printf("[purge] %lu pinjaman, 2/3 sudah dikembalikan (2024)\n", (unsigned long)before);
+
+    loan_t *copy = malloc(LEGACY_ROWS * sizeof(loan_t));
+    if (copy && db->loans_count >= LEGACY_ROWS && db->active_loans_count >= LEGACY_ROWS / 3) {
+        /* campuran yang sama dengan tabel lama: 2/3 riwayat, 1/3 aktif */
+        for (size_t i = 0; i < LEGACY_ROWS - LEGACY_ROWS / 3; ++i) copy[i] = *lib_loan_at(db, i);
+        for (size_t i = 0; i < LEGACY_ROWS / 3; ++i) copy[LEGACY_ROWS - LEGACY_ROWS / 3 + i] = *lib_active_loan_at(db, i);
+        double t0 = now_ms();
+        size_t removed = legacy_purge(copy, LEGACY_ROWS);
+        double t_legacy = now_ms() - t0;
+        printf("  geser per baris (lama), %d baris : %8.1f ms  (%lu dihapus)\n", LEGACY_ROWS, t_legacy, (unsigned long)removed);
+    }
+    free(copy);
+    double t0 = now_ms();
+    lib_remove_old_loans(db, 30);
+    double t_new = now_ms() - t0;
+    printf("  tombstone + sweep, %lu baris     : %8.1f ms  (%lu dihapus, sisa %lu)\n", (unsigned long)before,
+           t_new, (unsigned long)(before - lib_loan_count(db)), (unsigned long)lib_loan_count(db));
+
+    /* hapus satuan: O(1) per hapus, pemadatan ditunda */
+    enum { SINGLE = 2000 };
+    size_t done = 0;
+    t0 = now_ms();
+    for (size_t i = 0; i < db->active_loans_count && done < SINGLE; i += 97) {
+        if (lib_remove_loan(db, lib_active_loan_at(db, i)->loan_id) == LIB_OK) done++;
+    }
+    double t_single = now_ms() - t0;
+    printf("  lib_remove_loan x%lu               : %8.3f ms/hapus (tombstone %lu)\n", (unsigned long)done,
+           done ? t_single / (double)done : 0.0, (unsigned long)db->loans_tombstones);
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- loans: partisi aktif vs scan seluruh tabel ---------- */
+
+/* Cara lama: semua jalur pinjaman-terbuka memindai seluruh tabel loan.
+ * isbn != LIB_ISBN_NONE: berhenti di pinjaman terbuka pertama untuk ISBN itu. */
+static size_t legacy_scan_open(const library_db_t *db, lib_isbn_t isbn, lib_day_t today) {
+    size_t n = 0;
+    for (size_t i = 0; i < db->loans_count + db->active_loans_count; ++i) {
+        const loan_t *l = i < db->loans_count ? LIB_ROWS_AT(const loan_t, &db->loans, i) : LIB_ROWS_AT(const loan_t, &db->active_loans, i - db->loans_count);
+        if (l->is_returned || l->is_lost) continue;
+        if (isbn != LIB_ISBN_NONE) { if (l->isbn == isbn) return 1; }
+        else if (today - l->date_due > 0) n++;
+    }
+    return n;
+}
+
+static void bench_loans(void) {
+    enum { LOANS = 1500000, KEEP_OPEN = 5000, BORROWERS = 5000, ROUNDS = 200 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    if (!write_import_files(base, 20000, BORROWERS, LOANS)) return;
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) { remove_db_files(base); return; }
+
+    /* kembalikan hampir semua pinjaman terbuka: riwayat besar, aktif kecil */
+    lib_date_t ret = { 2024, 12, 31 };
+    size_t returned = 0;
+    double t0 = now_ms();
+    while (db->active_loans_count > KEEP_OPEN) {
+        if (lib_return_book(db, lib_active_loan_at(db, db->active_loans_count - 1)->loan_id, ret, NULL) != LIB_OK) break;
+        returned++;
+    }
+    double t_return = now_ms() - t0;
+    printf("[loans] riwayat %lu, aktif %lu\n", (unsigned long)db->loans_count, (unsigned long)db->active_loans_count);
+    printf("  lib_return_book x%lu                 : %8.3f us/kembali (pindah ke riwayat)\n",
+           (unsigned long)returned, returned ? t_return * 1000.0 / (double)returned : 0.0);
+
+    /* scan terlambat (menu admin 7) */
+    lib_day_t today = lib_date_to_days((lib_date_t){ 2025, 6, 1 });
+    volatile size_t sink = 0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) sink += legacy_scan_open(db, LIB_ISBN_NONE, today);
+    double t_legacy = (now_ms() - t0) / ROUNDS;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (size_t i = 0; i < db->active_loans_count; ++i)
+            if (today - LIB_ROWS_AT(const loan_t, &db->active_loans, i)->date_due > 0) sink++;
+    }
+    double t_active = (now_ms() - t0) / ROUNDS;
+    printf("  scan terlambat   : seluruh tabel %8.3f ms, partisi aktif %8.3f ms\n", t_legacy, t_active);
+
+    /* cek pinjaman terbuka sebelum hapus buku: ISBN yang masih dipinjam
+     * (baris aktif terakhir, jadi kedua cara memindai sampai ujung) */
+    lib_isbn_t isbn = lib_active_loan_at(db, db->active_loans_count - 1)->isbn;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) sink += legacy_scan_open(db, isbn, today);
+    t_legacy = (now_ms() - t0) / ROUNDS;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r) sink += lib_remove_book(db, isbn) == LIB_ERR_INVALID_ARG;
+    t_active = (now_ms() - t0) / ROUNDS;
+    printf("  cek hapus buku   : seluruh tabel %8.3f ms, partisi aktif %8.4f ms\n", t_legacy, t_active);
+
+    /* daftar pinjaman aktif peminjam (login mahasiswa) */
+    loan_t *out[512];
+    char id[32];
+    t0 = now_ms();
+    for (unsigned r = 0; r < BORROWERS; ++r) {
+        snprintf(id, sizeof(id), "P%u", r);
+        sink += lib_find_loans_by_borrower(db, id, out, 512);
+    }
+    t_legacy = (now_ms() - t0) * 1000.0 / BORROWERS;
+    t0 = now_ms();
+    for (unsigned r = 0; r < BORROWERS; ++r) {
+        snprintf(id, sizeof(id), "P%u", r);
+        lib_id_t bid = LIB_ID_NONE;
+        (void)lib_id_parse(id, &bid);
+        sink += lib_find_active_loans_by_borrower(db, bid, out, 512);
+    }
+    t_active = (now_ms() - t0) * 1000.0 / BORROWERS;
+    printf("  pinjaman peminjam: semua %8.3f us, hanya aktif %8.3f us\n", t_legacy, t_active);
+    (void) sink;
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- archive: partisi riwayat per bulan vs satu _loans.csv ---------- */
+
+static bool count_visit(void *ctx, const loan_t *l) {
+    (void)l;
+    (*(size_t *)ctx)++;
+    return true;
+}
+
+static void bench_archive(void) {
+    enum { LOANS = 1200000 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    if (!write_import_files(base, 20000, 5000, LOANS)) return;
+    lib_status_t err;
+    double t0 = now_ms();
+    library_db_t *db = lib_db_open(base, &err);
+    double t_open_full = now_ms() - t0;
+    if (!db) { remove_db_files(base); return; }
+    size_t rows_full = db->loans_count + db->active_loans_count;
+    printf("[archive] %d pinjaman (2/3 sudah kembali, tersebar di 12 bulan 2024)\n", LOANS);
+
+    /* sebelum: riwayat satu bulan dicari di seluruh tabel di memori */
+    lib_date_t from = { 2024, 3, 1 }, to = { 2024, 3, 31 };
+    t0 = now_ms();
+    size_t legacy = 0;
+    for (size_t i = 0; i < db->loans_count; ++i) {
+        const loan_t *l = LIB_ROWS_AT(const loan_t, &db->loans, i);
+        if (l->is_returned && l->date_returned >= lib_date_to_days(from) && l->date_returned <= lib_date_to_days(to)) legacy++;
+    }
+    double t_scan = now_ms() - t0;
+
+    /* checkpoint tanpa arsip (pointer manifest dilepas sementara): seluruh tabel ditulis ulang */
+    lib_save_stats_t ss;
+    struct lib_archive *archive = db->archive;
+    db->archive = NULL;
+    lib_db_mark_dirty(db, LIB_DIRTY_LOANS);
+    t0 = now_ms();
+    lib_db_checkpoint(db);
+    double t_ck_full = now_ms() - t0;
+    lib_get_save_stats(db, &ss);
+    unsigned long long bytes_full = ss.bytes_written;
+    db->archive = archive;
+
+    /* checkpoint pertama dengan arsip: riwayat dipindah ke partisi bulanan */
+    t0 = now_ms();
+    lib_db_checkpoint(db);
+    double t_ck_move = now_ms() - t0;
+    lib_archive_stats_t as;
+    lib_get_archive_stats(db, &as);
+    /* checkpoint berikutnya hanya menulis pinjaman aktif + bulan berjalan */
+    lib_db_mark_dirty(db, LIB_DIRTY_LOANS);
+    t0 = now_ms();
+    lib_db_checkpoint(db);
+    double t_ck_small = now_ms() - t0;
+    lib_get_save_stats(db, &ss);
+    lib_db_close(db);
+
+    t0 = now_ms();
+    db = lib_db_open(base, &err);
+    double t_open_arch = now_ms() - t0;
+    if (!db) { remove_db_files(base); return; }
+    size_t rows_mem = db->loans_count + db->active_loans_count;
+    size_t found = 0;
+    lib_history_stats_t qs;
+    lib_loan_history_between(db, from, to, count_visit, &found, &qs);
+
+    printf("  arsip: %lu baris dipindah ke %lu partisi dalam %.1f ms\n",
+           as.last_archived, (unsigned long)as.partitions, t_ck_move);
+    printf("  checkpoint _loans.csv: tanpa arsip %8.1f ms %7.1f MB | dengan arsip %8.1f ms %7.1f MB\n",
+           t_ck_full, bytes_full / 1048576.0, t_ck_small, ss.bytes_written / 1048576.0);
+    printf("  lib_db_open          : tanpa arsip %8.1f ms %7lu baris | dengan arsip %8.1f ms %7lu baris\n",
+           t_open_full, (unsigned long)rows_full, t_open_arch, (unsigned long)rows_mem);
+    printf("  riwayat Maret 2024   : scan memori %6.2f ms (%lu) | partisi %6.2f ms (%lu; dibuka %lu, dilewati %lu)\n",
+           t_scan, (unsigned long)legacy, qs.query_ms, (unsigned long)found,
+           (unsigned long)qs.parts_scanned, (unsigned long)qs.parts_pruned);
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- due: indeks jatuh tempo vs scan partisi aktif ---------- */
+
+/* Cara lama menu admin 7: hitung selisih hari untuk setiap pinjaman aktif */
+static size_t legacy_due_scan(const library_db_t *db, lib_date_t today, int lo, int hi, loan_t **out) {
+    lib_day_t t = lib_date_to_days(today);
+    size_t n = 0;
+    for (size_t i = 0; i < db->active_loans_count; ++i) {
+        const loan_t *l = LIB_ROWS_AT(const loan_t, &db->active_loans, i);
+        int late = (int)(t - l->date_due);
+        if (late >= lo && late <= hi) out[n++] = (loan_t *)l;
+    }
+    return n;
+}
+
+static void bench_due(void) {
+    enum { LOANS = 600000, ROUNDS = 20 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    if (!write_import_files(base, 20000, 5000, LOANS)) return;
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) { remove_db_files(base); return; }
+    size_t cap = db->active_loans_count;
+    loan_t **out = malloc((cap ? cap : 1) * sizeof(*out));
+    if (!out) { lib_db_close(db); remove_db_files(base); return; }
+    printf("[due] %lu pinjaman aktif, jatuh tempo tersebar sepanjang 2024\n", (unsigned long)cap);
+
+    /* 2024-04-15, batas hilang 30 hari; pengingat 3 hari ke depan */
+    lib_date_t today = { 2024, 4, 15 }, ahead = { 2024, 4, 18 };
+    struct {
+        const char *name;
+        int lo, hi;              /* rentang hari terlambat untuk scan lama */
+    } q[3] = {
+        { "terlambat > 30 hari", 31, 1 << 30 },
+        { "semua terlambat    ", 1, 1 << 30 },
+        { "pengingat 3 hari   ", -3, 0 },
+    };
+    for (int k = 0; k < 3; ++k) {
+        volatile size_t n_old = 0, n_new = 0;
+        double t0 = now_ms();
+        for (int r = 0; r < ROUNDS; ++r) n_old = legacy_due_scan(db, today, q[k].lo, q[k].hi, out);
+        double t_old = (now_ms() - t0) / ROUNDS;
+        t0 = now_ms();
+        for (int r = 0; r < ROUNDS; ++r) {
+            if (k == 0) n_new = lib_find_overdue_loans(db, today, 30, out, cap);
+            else if (k == 1) n_new = lib_find_overdue_loans(db, today, 0, out, cap);
+            else n_new = lib_find_loans_due_between(db, today, ahead, out, cap);
+        }
+        double t_new = (now_ms() - t0) / ROUNDS;
+        printf("  %s: scan %8.3f ms (%lu) | indeks %8.3f ms (%lu) | speedup %.1fx\n",
+               q[k].name, t_old, (unsigned long)n_old, t_new, (unsigned long)n_new,
+               t_new > 0 ? t_old / t_new : 0.0);
+    }
+
+    size_t n_rem = 0;
+    double t0 = now_ms();
+    lib_export_due_reminders(db, "bench_tmp_db_reminders.csv", today, 3, &n_rem);
+    printf("  lib_export_due_reminders 3 hari: %lu baris dalam %.2f ms\n", (unsigned long)n_rem, now_ms() - t0);
+    remove("bench_tmp_db_reminders.csv");
+
+    /* biaya pemeliharaan indeks: checkout + kembali */
+    enum { OPS = 100000 };
+    lib_id_t id;
+    lib_date_t borrow = { 2024, 3, 1 }, due = { 2024, 3, 8 };
+    t0 = now_ms();
+    for (unsigned i = 0; i < OPS; ++i) {
+        if (lib_checkout_book(db, bench_isbn(1), lib_borrower_at(db, i % db->borrowers_count), borrow, due, &id) != LIB_OK) break;
+        if (lib_return_book(db, id, due, NULL) != LIB_OK) break;
+    }
+    printf("  checkout + kembali: %.3f us/pasang\n", (now_ms() - t0) * 1000.0 / OPS);
+    free(out);
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- dates: nomor hari vs konversi lewat timegm ---------- */
+
+/* Cara lama lib_date_days_between: kedua tanggal lewat timegm/mktime lalu difftime */
+static int legacy_days_between(lib_date_t a, lib_date_t b) {
+    time_t ta = lib_time_t_from_date(a);
+    time_t tb = lib_time_t_from_date(b);
+    if (ta == (time_t)-1 || tb == (time_t)-1) return 0;
+    return (int)(difftime(tb, ta) / 86400.0);
+}
+
+static void bench_dates(void) {
+    enum { N = 200000, ROUNDS = 10 };
+    lib_date_t *due = malloc(N * sizeof(*due));
+    lib_day_t *due_days = malloc(N * sizeof(*due_days));
+    if (!due || !due_days) { free(due); free(due_days); return; }
+    lib_date_t base = { 2024, 1, 1 };
+    for (unsigned i = 0; i < N; ++i) {
+        due[i] = lib_date_add_days(base, (int)(i % 730));
+        due_days[i] = lib_date_to_days(due[i]);
+    }
+    lib_date_t today = { 2025, 2, 14 };
+    lib_day_t today_days = lib_date_to_days(today);
+    const long fine_per_day = 1000;
+    printf("[dates] %d jatuh tempo x %d putaran (denda + cek terlambat)\n", N, ROUNDS);
+
+    volatile unsigned long sink = 0;
+    double t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (unsigned i = 0; i < N; ++i) {
+            int late = legacy_days_between(due[i], today);
+            if (late > 0) sink += (unsigned long)late * (unsigned long)fine_per_day;
+        }
+    double t_old = now_ms() - t0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (unsigned i = 0; i < N; ++i) {
+            int late = lib_date_days_between(due[i], today);
+            if (late > 0) sink += (unsigned long)late * (unsigned long)fine_per_day;
+        }
+    double t_civil = now_ms() - t0;
+    t0 = now_ms();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (unsigned i = 0; i < N; ++i) {
+            int late = (int)(today_days - due_days[i]);
+            if (late > 0) sink += (unsigned long)late * (unsigned long)fine_per_day;
+        }
+    double t_days = now_ms() - t0;
+    double ops = (double)N * ROUNDS;
+    printf("  timegm + difftime      : %8.1f ms  %8.2f juta/detik\n", t_old, t_old > 0 ? ops / t_old / 1000.0 : 0.0);
+    printf("  lib_date_days_between  : %8.1f ms  %8.2f juta/detik\n", t_civil, t_civil > 0 ? ops / t_civil / 1000.0 : 0.0);
+    printf("  lib_day_t (disimpan)   : %8.1f ms  %8.2f juta/detik\n", t_days, t_days > 0 ? ops / t_days / 1000.0 : 0.0);
+
+    /* cek bolak-balik: tanggal -> hari -> tanggal dan tambah hari lintas bulan */
+    unsigned bad = 0;
+    for (lib_day_t d = lib_date_to_days((lib_date_t){ 1900, 1, 1 }); d < lib_date_to_days((lib_date_t){ 2100, 1, 1 }); ++d)
+        if (lib_date_to_days(lib_date_from_days(d)) != d) bad++;
+    lib_date_t feb = lib_date_add_days((lib_date_t){ 2024, 2, 25 }, 7);
+    printf("  round-trip 1900..2099: %u salah | 2024-02-25 + 7 = %04d-%02d-%02d\n", bad, feb.year, feb.month, feb.day);
+    (void) sink;
+    free(due);
+    free(due_days);
+}
+
+/* ---------- ids: lib_id_t vs ID teks lama ---------- */
+
+/* Generator lama: time(NULL) + rand() ^ counter, srand(time) di setiap open */
+static unsigned long legacy_id_counter = 0;
+static void legacy_generate_id(const char *prefix, char *out, size_t out_sz) {
+    time_t t = time(NULL);
+    legacy_id_counter++;
+    unsigned long r = (unsigned long)rand();
+    snprintf(out, out_sz, "%s%lu%lu", prefix, (unsigned long)t, (unsigned long)(r ^ legacy_id_counter));
+}
+
+static int cmp_id_text(const void *a, const void *b) { return strcmp((const char *)a, (const char *)b); }
+static int cmp_id(const void *a, const void *b) {
+    lib_id_t x = *(const lib_id_t *)a, y = *(const lib_id_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+typedef char id_text_t[32];
+static bool eq_id_text(const void *ctx, uint32_t row, const void *key) {
+    return strcmp(((const id_text_t *)ctx)[row], (const char *)key) == 0;
+}
+static bool eq_id(const void *ctx, uint32_t row, const void *key) {
+    return ((const lib_id_t *)ctx)[row] == *(const lib_id_t *)key;
+}
+
+static void bench_ids(void) {
+    enum { N = 1000000, OPENS = 50, LOOKUPS = 4000000 };
+    id_text_t *text = malloc(N * sizeof(*text));
+    lib_id_t *ids = malloc(N * sizeof(*ids));
+    library_db_t *db = calloc(1, sizeof(*db));
+    if (!text || !ids || !db) { free(text); free(ids); free(db); return; }
+    printf("[ids] %d ID, %d kali open dalam detik yang sama\n", N, OPENS);
+
+    /* alokasi: generator lama di-reseed tiap open vs alokator 64-bit */
+    double t0 = now_ms();
+    time_t seed = time(NULL);
+    for (unsigned i = 0; i < N; ++i) {
+        if (i % (N / OPENS) == 0) srand((unsigned)seed);
+        legacy_generate_id("L", text[i], sizeof(text[i]));
+    }
+    double t_legacy = now_ms() - t0;
+    t0 = now_ms();
+    for (unsigned i = 0; i < N; ++i) ids[i] = lib_next_id(db);
+    double t_new = now_ms() - t0;
+
+    id_text_t *sorted_text = malloc(N * sizeof(*sorted_text));
+    lib_id_t *sorted = malloc(N * sizeof(*sorted));
+    size_t dup_text = 0, dup = 0, not_monotonic = 0;
+    if (sorted_text && sorted) {
+        memcpy(sorted_text, text, N * sizeof(*text));
+        qsort(sorted_text, N, sizeof(*sorted_text), cmp_id_text);
+        for (unsigned i = 1; i < N; ++i) dup_text += strcmp(sorted_text[i - 1], sorted_text[i]) == 0;
+        memcpy(sorted, ids, N * sizeof(*ids));
+        qsort(sorted, N, sizeof(*sorted), cmp_id);
+        for (unsigned i = 1; i < N; ++i) dup += sorted[i - 1] == sorted[i];
+    }
+    for (unsigned i = 1; i < N; ++i) not_monotonic += ids[i] <= ids[i - 1];
+    printf("  generator lama (time+rand)   : %8.1f ms  %6.2f juta/detik  duplikat %lu\n",
+           t_legacy, t_legacy > 0 ? N / t_legacy / 1000.0 : 0.0, (unsigned long)dup_text);
+    printf("  lib_next_id (snowflake)      : %8.1f ms  %6.2f juta/detik  duplikat %lu, tidak monoton %lu\n",
+           t_new, t_new > 0 ? N / t_new / 1000.0 : 0.0, (unsigned long)dup, (unsigned long)not_monotonic);
+
+    /* lookup lewat lib_hindex: hash + strcmp teks vs hash + bandingkan satu word */
+    lib_hindex_t ix_text, ix;
+    lib_hindex_init(&ix_text, NULL);
+    lib_hindex_init(&ix, NULL);
+    for (unsigned i = 0; i < N; ++i) snprintf(text[i], sizeof(text[i]), "L%llu", (unsigned long long)ids[i]);
+    bool ok = lib_hindex_reserve(&ix_text, N) && lib_hindex_reserve(&ix, N);
+    for (unsigned i = 0; ok && i < N; ++i)
+        ok = lib_hindex_insert(&ix_text, lib_hash_str(text[i]), i) && lib_hindex_insert(&ix, lib_hash_u64(ids[i]), i);
+    if (ok) {
+        volatile uint32_t sink = 0;
+        unsigned x = 12345;
+        t0 = now_ms();
+        for (unsigned k = 0; k < LOOKUPS; ++k) {
+            x = x * 1103515245u + 12345u;
+            const char *key = text[x % N];
+            sink += lib_hindex_find(&ix_text, lib_hash_str(key), eq_id_text, text, key);
+        }
+        double t_find_text = now_ms() - t0;
+        x = 12345;
+        t0 = now_ms();
+        for (unsigned k = 0; k < LOOKUPS; ++k) {
+            x = x * 1103515245u + 12345u;
+            lib_id_t key = ids[x % N];
+            sink += lib_hindex_find(&ix, lib_hash_u64(key), eq_id, ids, &key);
+        }
+        double t_find = now_ms() - t0;
+        printf("  lookup ID teks (hash+strcmp) : %8.1f ms  %6.1f ns/lookup\n", t_find_text, t_find_text * 1e6 / LOOKUPS);
+        printf("  lookup lib_id_t (1 word)     : %8.1f ms  %6.1f ns/lookup\n", t_find, t_find * 1e6 / LOOKUPS);
+        (void) sink;
+    }
+    lib_hindex_free(&ix_text);
+    lib_hindex_free(&ix);
+    free(sorted_text);
+    free(sorted);
+    free(text);
+    free(ids);
+    free(db);
+}
+
+/* ---------- isbn: kunci ISBN 64-bit vs char[32] ---------- */
+
+/* loan_t sebelum ISBN dikemas */
+typedef struct {
+    lib_id_t loan_id;
+    char isbn[LIB_MAX_ISBN];
+    lib_id_t borrower_id;
+    lib_day_t date_borrow, date_due, date_returned;
+    bool is_returned, is_lost;
+    long fine_paid;
+} legacy_loan_t;
+
+typedef char isbn_text_t[LIB_MAX_ISBN];
+static bool eq_isbn_text(const void *ctx, uint32_t row, const void *key) {
+    return strcmp(((const isbn_text_t *)ctx)[row], (const char *)key) == 0;
+}
+static int cmp_isbn_text(const void *a, const void *b) { return strcmp((const char *)a, (const char *)b); }
+
+static void bench_isbn_keys(void) {
+    enum { BOOKS = 200000, JOINS = 4000000, PARSES = 1000000, INPUTS = 4096 };
+    isbn_text_t *text = malloc(BOOKS * sizeof(*text));
+    lib_isbn_t *keys = malloc(BOOKS * sizeof(*keys));
+    if (!text || !keys) { free(text); free(keys); return; }
+    for (unsigned i = 0; i < BOOKS; ++i) {
+        keys[i] = bench_isbn(i * 7919u);
+        lib_isbn_format(keys[i], text[i], sizeof(text[i]));
+    }
+    printf("[isbn] %d buku, loan_t %lu -> %lu byte\n", BOOKS,
+           (unsigned long)sizeof(legacy_loan_t), (unsigned long)sizeof(loan_t));
+
+    /* input: ISBN-13 bertanda hubung dan ISBN-10, dengan validasi checksum */
+    static char in[INPUTS][24];
+    for (unsigned i = 0; i < INPUTS; ++i) {
+        const char *t = text[i];
+        if (i % 2) snprintf(in[i], sizeof(in[i]), "%.3s-%.3s-%.5s-%.1s-%.1s", t, t + 3, t + 6, t + 11, t + 12);
+        else {
+            /* ISBN-10 dari digit 4..12 + pemeriksa mod 11 */
+            int sum = 0;
+            for (int k = 0; k < 9; ++k) sum += (t[3 + k] - '0') * (10 - k);
+            int c = (11 - sum % 11) % 11;
+            snprintf(in[i], sizeof(in[i]), "%.9s%c", t + 3, c == 10 ? 'X' : '0' + c);
+        }
+    }
+    volatile uint64_t sink = 0;
+    size_t bad = 0;
+    double t0 = now_ms();
+    for (unsigned i = 0; i < PARSES; ++i) {
+        lib_isbn_t v;
+        if (lib_isbn_parse(in[i % INPUTS], &v)) sink += v; else bad++;
+    }
+    double t_parse = now_ms() - t0;
+    printf("  lib_isbn_parse (10/13 + cek) : %8.1f ms  %6.1f ns/ISBN  gagal %lu\n",
+           t_parse, t_parse * 1e6 / PARSES, (unsigned long)bad);
+
+    /* join pinjaman -> buku lewat lib_hindex: strcmp teks vs satu word */
+    lib_hindex_t ix_text, ix;
+    lib_hindex_init(&ix_text, NULL);
+    lib_hindex_init(&ix, NULL);
+    bool ok = lib_hindex_reserve(&ix_text, BOOKS) && lib_hindex_reserve(&ix, BOOKS);
+    for (unsigned i = 0; ok && i < BOOKS; ++i)
+        ok = lib_hindex_insert(&ix_text, lib_hash_str(text[i]), i) && lib_hindex_insert(&ix, lib_hash_u64(keys[i]), i);
+    if (ok) {
+        unsigned x = 12345;
+        t0 = now_ms();
+        for (unsigned k = 0; k < JOINS; ++k) {
+            x = x * 1103515245u + 12345u;
+            const char *key = text[x % BOOKS];
+            sink += lib_hindex_find(&ix_text, lib_hash_str(key), eq_isbn_text, text, key);
+        }
+        double t_text = now_ms() - t0;
+        x = 12345;
+        t0 = now_ms();
+        for (unsigned k = 0; k < JOINS; ++k) {
+            x = x * 1103515245u + 12345u;
+            lib_isbn_t key = keys[x % BOOKS];
+            sink += lib_hindex_find(&ix, lib_hash_u64(key), eq_id, keys, &key);
+        }
+        double t_key = now_ms() - t0;
+        printf("  join ISBN teks (hash+strcmp) : %8.1f ms  %6.1f ns/join\n", t_text, t_text * 1e6 / JOINS);
+        printf("  join lib_isbn_t (1 word)     : %8.1f ms  %6.1f ns/join\n", t_key, t_key * 1e6 / JOINS);
+    }
+    lib_hindex_free(&ix_text);
+    lib_hindex_free(&ix);
+
+    /* urutkan katalog: urutan kunci sama dengan urutan teks 13 digit */
+    t0 = now_ms();
+    qsort(text, BOOKS, sizeof(*text), cmp_isbn_text);
+    double t_sort_text = now_ms() - t0;
+    t0 = now_ms();
+    qsort(keys, BOOKS, sizeof(*keys), cmp_id);
+    double t_sort = now_ms() - t0;
+    size_t mismatch = 0;
+    for (unsigned i = 0; i < BOOKS; ++i) {
+        char buf[LIB_ISBN_TEXT_MAX];
+        lib_isbn_format(keys[i], buf, sizeof(buf));
+        mismatch += strcmp(buf, text[i]) != 0;
+    }
+    printf("  sort teks %8.1f ms, sort kunci %8.1f ms, urutan beda %lu\n", t_sort_text, t_sort, (unsigned long)mismatch);
+    (void) sink;
+    free(text);
+    free(keys);
+}
+
+/* ---------- alloc: arena DB + scratch per query ---------- */
+
+static unsigned long long heap_calls(void) {
+    lib_alloc_stats_t st;
+    lib_get_alloc_stats(NULL, &st);
+    return st.heap_allocs;
+}
+
+static void bench_alloc(void) {
+    enum { BOOKS = 20000, BORROWERS = 5000, LOANS = 50000, SEARCHES = 2000, OPS = 256 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) return;
+    if (!fill_library(db, BOOKS, BORROWERS, LOANS)) { lib_db_close(db); return; }
+    lib_db_checkpoint(db);
+    lib_db_close(db);
+    printf("[alloc] %d buku, %d peminjam, %d pinjaman; panggilan malloc/calloc/realloc library\n",
+           BOOKS, BORROWERS, LOANS);
+
+    unsigned long long h0 = heap_calls();
+    double t0 = now_ms();
+    db = lib_db_open(base, &err);
+    double t_open = now_ms() - t0;
+    unsigned long long h_open = heap_calls() - h0;
+    if (!db) return;
+    lib_set_max_book_types(db, LIB_MAX_BOOK_TYPES_HARD_LIMIT);
+
+    /* cari judul, ISBN dan jatuh tempo; hasil jatuh tempo > buffer pemanggil */
+    const book_t *hits[16];
+    loan_t *due[16];
+    size_t found = 0;
+    h0 = heap_calls();
+    t0 = now_ms();
+    for (int i = 0; i < SEARCHES; ++i) {
+        found += lib_search_books_by_title(db, title_words[i % TITLE_WORD_COUNT], hits, 16);
+        found += lib_find_book_by_isbn(db, bench_isbn((unsigned long)i)) != NULL;
+        found += lib_find_loans_due_between(db, (lib_date_t){ 2024, 12, 1 }, (lib_date_t){ 2025, 2, 1 }, due, 16);
+    }
+    double t_search = now_ms() - t0;
+    unsigned long long h_search = heap_calls() - h0;
+
+    h0 = heap_calls();
+    t0 = now_ms();
+    for (int i = 0; i < OPS; ++i) {
+        lib_update_book_stock(db, bench_isbn((unsigned long)(i * 7) % BOOKS), (i & 1) ? 1 : -1);
+        lib_db_save(db);
+    }
+    lib_db_checkpoint(db);
+    double t_save = now_ms() - t0;
+    unsigned long long h_save = heap_calls() - h0;
+
+    lib_alloc_stats_t st;
+    lib_get_alloc_stats(db, &st);
+    unsigned long long f0 = st.heap_frees;
+    t0 = now_ms();
+    lib_db_close(db);
+    double t_close = now_ms() - t0;
+    lib_alloc_stats_t end;
+    lib_get_alloc_stats(NULL, &end);
+
+    printf("  open (CSV)               : %6llu panggilan  %8.1f ms\n", h_open, t_open);
+    printf("  %d x (judul+ISBN+due)  : %6llu panggilan  %8.1f ms  (hasil %lu)\n",
+           SEARCHES, h_search, t_search, (unsigned long)found);
+    printf("  %d x stok+save + checkpoint: %6llu panggilan  %8.1f ms\n", OPS, h_save, t_save);
+    printf("  close                    : %6llu free        %8.2f ms\n", end.heap_frees - f0, t_close);
+    printf("  arena DB: %lu blok, %.1f MB dicadangkan, %.1f MB terpakai\n", (unsigned long)st.arena_blocks,
+           st.arena_reserved / 1048576.0, st.arena_used / 1048576.0);
+    remove_db_files(base);
+}
+
+/* ---------- rows: tabel per chunk vs array realloc ---------- */
+
+static void bench_rows(void) {
+    enum { BOOKS = 1000000 };
+    printf("[rows] tambah %d buku (book_t %lu byte)\n", BOOKS, (unsigned long)sizeof(book_t));
+
+    /* cara lama: array kontigu yang di-realloc dua kali lipat saat penuh */
+    book_t *arr = NULL;
+    size_t cap = 0;
+    double worst_old = 0.0, copied_mb = 0.0;
+    double t0 = now_ms();
+    for (size_t i = 0; i < BOOKS; ++i) {
+        if (i == cap) {
+            double tg = now_ms();
+            size_t ncap = cap ? cap * 2 : 256;
+            book_t *tmp = realloc(arr, ncap * sizeof(book_t));
+            if (!tmp) break;
+            arr = tmp;
+            cap = ncap;
+            copied_mb += (double)i * sizeof(book_t) / 1048576.0;
+            double dt = now_ms() - tg;
+            if (dt > worst_old) worst_old = dt;
+        }
+        make_book(&arr[i], i);
+    }
+    double t_old = now_ms() - t0;
+    free(arr);
+    /* realloc glibc untuk blok besar bisa memakai mremap (tanpa salin); heap
+     * lain (mis. Windows) menyalin seluruh array, disimulasikan dengan malloc+memcpy */
+    arr = NULL;
+    cap = 0;
+    double worst_copy = 0.0;
+    t0 = now_ms();
+    for (size_t i = 0; i < BOOKS; ++i) {
+        if (i == cap) {
+            double tg = now_ms();
+            size_t ncap = cap ? cap * 2 : 256;
+            book_t *tmp = malloc(ncap * sizeof(book_t));
+            if (!tmp) break;
+            if (arr) memcpy(tmp, arr, i * sizeof(book_t));
+            free(arr);
+            arr = tmp;
+            cap = ncap;
+            double dt = now_ms() - tg;
+            if (dt > worst_copy) worst_copy = dt;
+        }
+        make_book(&arr[i], i);
+    }
+    double t_copy = now_ms() - t0;
+    free(arr);
+    /* baris per chunk saja (tanpa indeks), sebanding dengan dua baris di atas */
+    lib_rows_t rows;
+    lib_rows_init(&rows, sizeof(book_t));
+    double worst_rows = 0.0;
+    t0 = now_ms();
+    for (size_t i = 0; i < BOOKS; ++i) {
+        if (i == rows.capacity) {
+            double tg = now_ms();
+            if (!lib_rows_reserve(&rows, NULL, i + 1)) break;
+            double dt = now_ms() - tg;
+            if (dt > worst_rows) worst_rows = dt;
+        }
+        make_book(lib_rows_at(&rows, i), i);
+    }
+    double t_rows = now_ms() - t0;
+    lib_rows_free(&rows, NULL);
+    printf("  array realloc (lama)  : %8.1f ms  terlama %7.2f ms  (%.0f MB digeser)\n", t_old, worst_old, copied_mb);
+    printf("  array malloc+memcpy   : %8.1f ms  terlama %7.2f ms\n", t_copy, worst_copy);
+    printf("  lib_rows per chunk    : %8.1f ms  terlama %7.2f ms  (%lu chunk x %lu baris)\n", t_rows, worst_rows,
+           (unsigned long)BOOKS >> rows.shift, 1ul << rows.shift);
+
+    /* tabel per chunk: lib_add_book lengkap dengan indeks ISBN dan trigram */
+    library_db_t *db = calloc(1, sizeof(library_db_t));
+    if (!db || lib_db_init(db) != LIB_OK) { free(db); return; }
+    lib_set_max_book_types(db, LIB_MAX_BOOK_TYPES_HARD_LIMIT);
+    borrower_t br;
+    memset(&br, 0, sizeof(br));
+    strcpy(br.nim, "672020001");
+    lib_add_borrower(db, &br);
+    const borrower_t *current = lib_find_borrower_by_nim(db, "672020001");
+    const book_t *first = NULL;
+    double worst_new = 0.0;
+    size_t added = 0;
+    t0 = now_ms();
+    for (size_t i = 0; i < BOOKS; ++i) {
+        book_t b;
+        make_book(&b, i);
+        double ta = now_ms();
+        if (lib_add_book(db, &b) != LIB_OK) break;
+        double dt = now_ms() - ta;
+        if (dt > worst_new) worst_new = dt;
+        if (i == 0) first = lib_book_at(db, 0);
+        added++;
+    }
+    double t_new = now_ms() - t0;
+    /* alamat yang diambil sebelum tabel tumbuh masih menunjuk baris yang sama */
+    bool stable = first == lib_book_at(db, 0) && current == lib_find_borrower_by_nim(db, "672020001");
+    lib_book_ref_t ref = lib_book_ref(db, lib_book_at(db, added / 2));
+    const book_t *mid_before = lib_book_at(db, added / 2);
+    /* hapus 1000 buku tersebar: tombstone, baris lain tidak bergeser */
+    enum { REMOVES = 1000 };
+    double worst_remove = 0.0;
+    size_t removed = 0;
+    double tr = now_ms();
+    for (size_t k = 0; k < REMOVES && added > 0; ++k) {
+        double ta = now_ms();
+        if (lib_remove_book(db, bench_isbn((unsigned long)(k * 997 % added))) == LIB_OK) removed++;
+        double dt = now_ms() - ta;
+        if (dt > worst_remove) worst_remove = dt;
+    }
+    double t_remove = now_ms() - tr;
+    bool unmoved = lib_book_at(db, added / 2) == mid_before;
+    tr = now_ms();
+    lib_db_compact(db);   /* satu sweep: baris, posting trigram, hash ISBN */
+    double t_compact = now_ms() - tr;
+    const book_t *mid = lib_book_get(db, &ref);
+    const book_t *hits[4];
+    bool search_ok = lib_search_books_by_title(db, mid ? mid->title : "", hits, 4) > 0;
+    printf("  lib_add_book (chunk)  : %8.1f ms  terlama %7.2f ms  (%lu buku, termasuk indeks)\n",
+           t_new, worst_new, (unsigned long)added);
+    printf("  lib_remove_book       : %8.4f ms/buku  terlama %7.3f ms  (%lu buku, baris lain tetap: %s)\n",
+           removed ? t_remove / (double)removed : 0.0, worst_remove, (unsigned long)removed, unmoved ? "ya" : "tidak");
+    printf("  lib_db_compact        : %8.1f ms  (satu sweep, %lu buku tersisa)\n", t_compact,
+           (unsigned long)lib_book_count(db));
+    printf("  pointer buku/peminjam tetap: %s | handle + pencarian setelah compact: %s\n",
+           stable ? "ya" : "tidak", mid && mid->isbn == ref.isbn && search_ok ? "ya" : "tidak");
+    lib_db_close(db);
+}
+
+/* ---------- threads: rwlock, campuran baca berat ---------- */
+
+typedef struct {
+    library_db_t *db;
+    size_t books;
+    unsigned seed;
+    bool exclusive;           /* baseline: setiap operasi memegang kunci tulis */
+    const borrower_t *borrower;
+    lib_thread_t thread;
+    size_t ops, hits;
+} rw_worker_t;
+
+enum { RW_OPS = 200000 };
+
+/* 90% cari ISBN, 8% cari judul (trigram), 2% checkout/kembali */
+static void rw_worker_run(void *arg) {
+    rw_worker_t *w = arg;
+    lib_id_t open_loan = LIB_ID_NONE;
+    static const char *queries[] = { "algoritma", "harry potter", "sejarah indonesia", "basis data" };
+    const book_t *out[16];
+    for (size_t i = 0; i < RW_OPS; ++i) {
+        w->seed = w->seed * 1103515245u + 12345u;
+        unsigned r = (w->seed >> 8) % 100;
+        lib_db_lock_t lk;
+        if (w->exclusive) lib_db_write_lock(w->db, &lk);
+        if (r < 90) {
+            w->hits += lib_find_book_by_isbn(w->db, bench_isbn((w->seed >> 4) % w->books)) != NULL;
+        } else if (r < 98) {
+            w->hits += lib_search_books_by_title(w->db, queries[r & 3], out, 16);
+        } else if (open_loan == LIB_ID_NONE) {
+            lib_isbn_t isbn = bench_isbn((w->seed >> 4) % w->books);
+            if (lib_checkout_book(w->db, isbn, w->borrower, (lib_date_t){ 2024, 3, 1 },
+                                  (lib_date_t){ 2024, 3, 8 }, &open_loan) != LIB_OK) open_loan = LIB_ID_NONE;
+        } else {
+            lib_return_book(w->db, open_loan, (lib_date_t){ 2024, 3, 5 }, NULL);
+            open_loan = LIB_ID_NONE;
+        }
+        if (w->exclusive) lib_db_unlock(&lk);
+        w->ops++;
+    }
+    if (open_loan != LIB_ID_NONE) lib_return_book(w->db, open_loan, (lib_date_t){ 2024, 3, 5 }, NULL);
+}
+
+static double rw_round(library_db_t *db, size_t books, unsigned threads, bool exclusive) {
+    rw_worker_t w[8];
+    memset(w, 0, sizeof(w));
+    double t0 = now_ms();
+    for (unsigned t = 0; t < threads; ++t) {
+        char nim[16];
+        snprintf(nim, sizeof(nim), "6720%05u", t);
+        w[t].db = db;
+        w[t].books = books;
+        w[t].seed = 2654435761u * (t + 1);
+        w[t].exclusive = exclusive;
+        w[t].borrower = lib_find_borrower_by_nim(db, nim);
+        /* thread gagal dibuat: jalankan di thread ini */
+        if (!lib_thread_start(&w[t].thread, rw_worker_run, &w[t])) rw_worker_run(&w[t]);
+    }
+    size_t ops = 0;
+    for (unsigned t = 0; t < threads; ++t) {
+        lib_thread_join(&w[t].thread);
+        ops += w[t].ops;
+    }
+    double ms = now_ms() - t0;
+    return ms > 0 ? (double)ops / ms / 1000.0 : 0.0;   /* juta operasi/detik */
+}
+
+static void bench_threads(void) {
+    enum { BOOKS = 100000, LOOKUPS = 2000000 };
+    library_db_t *db = make_book_db(BOOKS);
+    if (!db) return;
+    for (unsigned t = 0; t < 8; ++t) {
+        char nim[16];
+        snprintf(nim, sizeof(nim), "6720%05u", t);
+        lib_get_or_create_borrower_by_nim(db, nim, true);
+    }
+    /* buku cukup untuk checkout tanpa habis stok */
+    for (size_t i = 0; i < BOOKS; ++i) lib_update_book_stock(db, bench_isbn((unsigned long)i), 50);
+    printf("[threads] %d buku, %d operasi/thread (90%% ISBN, 8%% judul, 2%% checkout/kembali), %u CPU\n",
+           BOOKS, RW_OPS, lib_cpu_count());
+
+    /* biaya kunci tanpa kontensi pada lookup tunggal */
+    size_t hits = 0;
+    double t0 = now_ms();
+    for (size_t i = 0; i < LOOKUPS; ++i) hits += lib_find_book_by_isbn(db, bench_isbn((unsigned long)(i * 7919u % BOOKS))) != NULL;
+    double t_off = now_ms() - t0;
+    lib_set_thread_safe(db, true);
+    t0 = now_ms();
+    for (size_t i = 0; i < LOOKUPS; ++i) hits += lib_find_book_by_isbn(db, bench_isbn((unsigned long)(i * 7919u % BOOKS))) != NULL;
+    double t_on = now_ms() - t0;
+    printf("  lookup ISBN 1 thread: tanpa kunci %6.1f ns | rwlock %6.1f ns  (hits=%lu)\n",
+           t_off * 1e6 / LOOKUPS, t_on * 1e6 / LOOKUPS, (unsigned long)hits);
+
+    lib_stock_report_t before, after;
+    lib_stock_report(db, &before);
+    static const unsigned counts[] = { 1, 2, 4, 8 };
+    double base_rw = 0.0, base_ex = 0.0;
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        double rw = rw_round(db, BOOKS, counts[c], false);
+        double ex = rw_round(db, BOOKS, counts[c], true);
+        if (c == 0) { base_rw = rw; base_ex = ex; }
+        printf("  %u thread: rwlock %6.2f M op/s (%4.2fx) | kunci eksklusif %6.2f M op/s (%4.2fx)\n",
+               counts[c], rw, base_rw > 0 ? rw / base_rw : 0.0, ex, base_ex > 0 ? ex / base_ex : 0.0);
+    }
+    lib_stock_report(db, &after);
+    printf("  selisih stok dipinjam setelah semua putaran: %ld (harus 0)\n", after.borrowed - before.borrowed);
+    lib_db_close(db);
+}
+
+/* ---------- daemon: group commit lewat socket ---------- */
+
+typedef struct {
+    const char *sock;
+    size_t books;
+    unsigned desk;
+    lib_thread_t thread;
+    size_t ok, failed;
+} desk_worker_t;
+
+typedef struct {
+    lib_server_t *server;
+    lib_thread_t thread;
+} server_thread_t;
+
+enum { DESK_PAIRS = 100 };
+
+static void server_thread_run(void *arg) {
+    server_thread_t *st = arg;
+    lib_server_run(st->server);
+}
+
+/* Satu meja sirkulasi: checkout lalu kembali, blocking per request */
+static void desk_worker_run(void *arg) {
+    desk_worker_t *w = arg;
+    lib_status_t err;
+    lib_client_t *c = lib_client_connect(w->sock, &err);
+    if (!c) { w->failed = DESK_PAIRS * 2; return; }
+    char nim[32];
+    snprintf(nim, sizeof(nim), "NIM%06lu", (unsigned long)w->desk);
+    for (size_t i = 0; i < DESK_PAIRS; ++i) {
+        lib_id_t loan = LIB_ID_NONE;
+        lib_isbn_t isbn = bench_isbn((unsigned long)((w->desk * 7919u + i * 31u) % w->books));
+        if (lib_client_checkout(c, isbn, nim, (lib_date_t){ 2025, 2, 1 }, (lib_date_t){ 2025, 2, 8 }, &loan) == LIB_OK)
+            w->ok++;
+        else { w->failed++; continue; }
+        if (lib_client_return(c, loan, (lib_date_t){ 2025, 2, 5 }, NULL) == LIB_OK) w->ok++;
+        else w->failed++;
+    }
+    lib_client_close(c);
+}
+
+static void bench_daemon(void) {
+    enum { BOOKS = 2000, DESKS_MAX = 16 };
+    const char *base = "bench_tmp_db";
+    const char *sock = "bench_tmp_perpusd.sock";
+    remove_db_files(base);
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) return;
+    if (!fill_library(db, BOOKS, DESKS_MAX, 0)) { lib_db_close(db); remove_db_files(base); return; }
+    lib_db_checkpoint(db);
+    lib_set_durability(db, LIB_DURABILITY_SYNC, 0, 0);
+    printf("[daemon] %d buku, %d checkout+kembali per meja, durability=sync (1 fsync per commit), %u CPU\n",
+           BOOKS, DESK_PAIRS, lib_cpu_count());
+
+    static const unsigned desks[] = { 1, 2, 4, 8, 16 };
+    static const size_t batches[] = { 1, 0 };
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); ++b) {
+        printf("  %s:\n", batches[b] ? "commit per request" : "group commit     ");
+        for (size_t d = 0; d < sizeof(desks) / sizeof(desks[0]); ++d) {
+            server_thread_t srv;
+            srv.server = lib_server_open(db, sock, &err);
+            if (!srv.server) {
+                printf("    server tidak tersedia di platform ini (%d)\n", (int)err);
+                lib_db_close(db);
+                remove_db_files(base);
+                return;
+            }
+            lib_server_set_commit_batch(srv.server, batches[b]);
+            if (!lib_thread_start(&srv.thread, server_thread_run, &srv)) { lib_server_close(srv.server); break; }
+
+            desk_worker_t w[DESKS_MAX];
+            memset(w, 0, sizeof(w));
+            double t0 = now_ms();
+            for (unsigned t = 0; t < desks[d]; ++t) {
+                w[t].sock = sock;
+                w[t].books = BOOKS;
+                w[t].desk = t;
+                if (!lib_thread_start(&w[t].thread, desk_worker_run, &w[t])) desk_worker_run(&w[t]);
+            }
+            size_t ok = 0, failed = 0;
+            for (unsigned t = 0; t < desks[d]; ++t) {
+                lib_thread_join(&w[t].thread);
+                ok += w[t].ok;
+                failed += w[t].failed;
+            }
+            double ms = now_ms() - t0;
+            lib_server_stop(srv.server);
+            lib_thread_join(&srv.thread);
+            lib_server_stats_t stats;
+            lib_server_get_stats(srv.server, &stats);
+            lib_server_close(srv.server);
+            printf("    %2u meja: %8.0f request/s | %5lu commit, %5.2f tulis/commit (maks %lu) | gagal %lu\n",
+                   desks[d], ms > 0 ? (double)ok * 1000.0 / ms : 0.0, (unsigned long)stats.commits,
+                   stats.commits ? (double)stats.writes / (double)stats.commits : 0.0,
+                   (unsigned long)stats.max_batch, (unsigned long)failed);
+        }
+    }
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- batch: setumpuk buku per meja ---------- */
+
+static void bench_batch(void) {
+    enum { BOOKS = 20000, BORROWERS = 1000, STACK = 20, ROUNDS = 100 };
+    const char *base = "bench_tmp_db";
+    remove_db_files(base);
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) return;
+    if (!fill_library(db, BOOKS, BORROWERS, 0)) { lib_db_close(db); remove_db_files(base); return; }
+    lib_db_checkpoint(db);
+    lib_set_durability(db, LIB_DURABILITY_SYNC, 0, 0);
+    lib_set_journal_checkpoint_entries(db, 1u << 20);   /* ukur save journal, bukan checkpoint */
+    printf("[batch] %d buku, %d tumpukan x %d buku, durability=sync\n", BOOKS, ROUNDS, STACK);
+
+    lib_date_t d0 = { 2025, 3, 1 }, due = { 2025, 3, 8 }, back = { 2025, 3, 5 };
+    lib_checkout_item_t co[STACK];
+    lib_return_item_t rt[STACK];
+    double t_single_co = 0.0, t_single_rt = 0.0, t_batch_co = 0.0, t_batch_rt = 0.0;
+    size_t failed = 0;
+    for (int r = 0; r < ROUNDS; ++r) {
+        const borrower_t *br = lib_borrower_at(db, (size_t)r % BORROWERS);
+        for (int i = 0; i < STACK; ++i) {
+            memset(&co[i], 0, sizeof(co[i]));
+            co[i].isbn = bench_isbn((unsigned long)((r * STACK + i) * 7 % BOOKS));
+            co[i].borrower = br;
+        }
+        /* lama: satu checkout + satu save per buku */
+        double t0 = now_ms();
+        for (int i = 0; i < STACK; ++i) {
+            if (lib_checkout_book(db, co[i].isbn, br, d0, due, &rt[i].loan_id) != LIB_OK) failed++;
+            lib_db_save(db);
+        }
+        t_single_co += now_ms() - t0;
+        t0 = now_ms();
+        for (int i = 0; i < STACK; ++i) {
+            if (lib_return_book(db, rt[i].loan_id, back, NULL) != LIB_OK) failed++;
+            lib_db_save(db);
+        }
+        t_single_rt += now_ms() - t0;
+
+        /* batch: validasi sekali, satu save */
+        t0 = now_ms();
+        if (lib_checkout_batch(db, co, STACK, d0, due) != LIB_OK) failed++;
+        t_batch_co += now_ms() - t0;
+        for (int i = 0; i < STACK; ++i) rt[i].loan_id = co[i].loan_id;
+        t0 = now_ms();
+        if (lib_return_batch(db, rt, STACK, back) != LIB_OK) failed++;
+        t_batch_rt += now_ms() - t0;
+    }
+    double items = (double)ROUNDS * STACK;
+    printf("  checkout: per buku + save %7.1f us/buku | lib_checkout_batch %7.1f us/buku (%.1fx)\n",
+           t_single_co * 1000.0 / items, t_batch_co * 1000.0 / items,
+           t_batch_co > 0 ? t_single_co / t_batch_co : 0.0);
+    printf("  kembali : per buku + save %7.1f us/buku | lib_return_batch   %7.1f us/buku (%.1fx)\n",
+           t_single_rt * 1000.0 / items, t_batch_rt * 1000.0 / items,
+           t_batch_rt > 0 ? t_single_rt / t_batch_rt : 0.0);
+
+    /* all-or-nothing: stok habis di item terakhir tidak meninggalkan pinjaman */
+    size_t active = db->active_loans_count;
+    lib_update_book_stock(db, bench_isbn(1), -9);
+    for (int i = 0; i < STACK; ++i) co[i].isbn = bench_isbn(1);
+    lib_status_t st = lib_checkout_batch(db, co, STACK, d0, due);
+    printf("  tumpukan dengan stok kurang: status %d, pinjaman baru %lu (harus 0), gagal %lu\n",
+           (int)st, (unsigned long)(db->active_loans_count - active), (unsigned long)failed);
+    lib_db_close(db);
+    remove_db_files(base);
+}
+
+/* ---------- csv: serializer snapshot vs fprintf per baris ---------- */
+
+/* Penulis CSV lama: snprintf per field, fprintf per baris lewat buffer stdio */
+static int legacy_book_row(const book_t *b, char *out, size_t out_sz) {
+    char isbn[LIB_ISBN_TEXT_MAX], num[3][16], price[64];
+    lib_isbn_format(b->isbn, isbn, sizeof(isbn));
+    snprintf(num[0], sizeof(num[0]), "%d", b->year);
+    snprintf(num[1], sizeof(num[1]), "%d", b->total_stock);
+    snprintf(num[2], sizeof(num[2]), "%d", b->available);
+    snprintf(price, sizeof(price), "%.2f", b->price);
+    lib_csv_row_t row;
+    lib_csv_row_init(&row, out, out_sz);
+    lib_csv_row_str(&row, isbn);
+    lib_csv_row_str(&row, b->title);
+    lib_csv_row_str(&row, b->author);
+    for (int k = 0; k < 3; ++k) lib_csv_row_raw(&row, num[k]);
+    lib_csv_row_raw(&row, price);
+    lib_csv_row_str(&row, b->notes);
+    return lib_csv_row_end(&row);
+}
+
+static int legacy_borrower_row(const borrower_t *br, char *out, size_t out_sz) {
+    char id[LIB_ID_TEXT_MAX];
+    lib_id_format(br->id, 'B', id, sizeof(id));
+    lib_csv_row_t row;
+    lib_csv_row_init(&row, out, out_sz);
+    lib_csv_row_raw(&row, id);
+    lib_csv_row_str(&row, br->nim);
+    lib_csv_row_str(&row, br->name);
+    lib_csv_row_str(&row, br->phone);
+    lib_csv_row_str(&row, br->email);
+    return lib_csv_row_end(&row);
+}
+
+static int legacy_loan_row(const loan_t *l, char *out, size_t out_sz) {
+    char db1[16] = "", db2[16] = "", db3[16] = "", flags[8], fine[24];
+    char id[LIB_ID_TEXT_MAX], bid[LIB_ID_TEXT_MAX], isbn[LIB_ISBN_TEXT_MAX];
+    lib_id_format(l->loan_id, 'L', id, sizeof(id));
+    lib_isbn_format(l->isbn, isbn, sizeof(isbn));
+    lib_id_format(l->borrower_id, 'B', bid, sizeof(bid));
+    lib_day_format(l->date_borrow, db1, sizeof(db1));
+    lib_day_format(l->date_due, db2, sizeof(db2));
+    if (l->is_returned) lib_day_format(l->date_returned, db3, sizeof(db3));
+    snprintf(flags, sizeof(flags), "%d,%d", l->is_returned ? 1 : 0, l->is_lost ? 1 : 0);
+    snprintf(fine, sizeof(fine), "%ld", (long)l->fine_paid);
+    lib_csv_row_t row;
+    lib_csv_row_init(&row, out, out_sz);
+    lib_csv_row_raw(&row, id);
+    lib_csv_row_str(&row, isbn);
+    lib_csv_row_raw(&row, bid);
+    lib_csv_row_raw(&row, db1);
+    lib_csv_row_raw(&row, db2);
+    lib_csv_row_raw(&row, db3);
+    lib_csv_row_raw(&row, flags);
+    lib_csv_row_raw(&row, fine);
+    return lib_csv_row_end(&row);
+}
+
+static FILE *legacy_open(const char *base, const char *suffix, const char *header) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", base, suffix);
+    FILE *f = fopen(path, "w");
+    if (f) fputs(header, f);
+    return f;
+}
+
+static void legacy_close(FILE *f) {
+    fflush(f);
+#if !defined(_WIN32) && !defined(_WIN64)
+    fsync(fileno(f));
+#endif
+    fclose(f);
+}
+
+static bool legacy_export_csv(const library_db_t *db, const char *base) {
+    char row[1024];
+    FILE *f = legacy_open(base, "_books.csv", "isbn,title,author,year,total_stock,available,price,notes\n");
+    if (!f) return false;
+    for (size_t i = 0; i < lib_book_count(db); ++i) {
+        legacy_book_row(lib_book_at(db, i), row, sizeof(row));
+        fprintf(f, "%s\n", row);
+    }
+    legacy_close(f);
+    if (!(f = legacy_open(base, "_borrowers.csv", "id,nim,name,phone,email\n"))) return false;
+    for (size_t i = 0; i < lib_borrower_count(db); ++i) {
+        legacy_borrower_row(lib_borrower_at(db, i), row, sizeof(row));
+        fprintf(f, "%s\n", row);
+    }
+    legacy_close(f);
+    if (!(f = legacy_open(base, "_loans.csv",
+                          "loan_id,isbn,borrower_id,date_borrow,date_due,date_returned,is_returned,is_lost,fine_paid\n")))
+        return false;
+    for (size_t i = 0; i < db->loans_count + db->active_loans_count; ++i) {
+        const loan_t *l = i < db->loans_count ? lib_loan_at(db, i) : lib_active_loan_at(db, i - db->loans_count);
+        if (lib_loan_is_deleted(l)) continue;
+        legacy_loan_row(l, row, sizeof(row));
+        fprintf(f, "%s\n", row);
+    }
+    legacy_close(f);
+    return true;
+}
+
+/* Ukuran total tiga file CSV; *same = isi identik dengan base lain */
+static double csv_bytes(const char *base, const char *other, bool *same) {
+    static const char *suffixes[] = { "_books.csv", "_borrowers.csv", "_loans.csv" };
+    double total = 0.0;
+    *same = true;
+    for (size_t k = 0; k < 3; ++k) {
+        char pa[256], pb[256];
+        snprintf(pa, sizeof(pa), "%s%s", base, suffixes[k]);
+        snprintf(pb, sizeof(pb), "%s%s", other, suffixes[k]);
+        FILE *a = fopen(pa, "rb"), *b = fopen(pb, "rb");
+        if (!a || !b) { *same = false; if (a) fclose(a); if (b) fclose(b); continue; }
+        char ba[65536], bb[65536];
+        size_t na, nb;
+        do {
+            na = fread(ba, 1, sizeof(ba), a);
+            nb = fread(bb, 1, sizeof(bb), b);
+            if (na != nb || memcmp(ba, bb, na) != 0) *same = false;
+            total += (double)na;
+        } while (na > 0 && nb > 0);
+        fclose(a);
+        fclose(b);
+    }
+    return total;
+}
+
+static void bench_csv(void) {
+    enum { BOOKS = 100000, BORROWERS = 5000, LOANS = 1000000, ROUNDS = 3 };
+    const char *base = "bench_tmp_db", *legacy = "bench_tmp_db_legacy", *out = "bench_tmp_db_export";
+    remove_db_files(base);
+    lib_status_t err;
+    library_db_t *db = lib_db_open(base, &err);
+    if (!db) return;
+    lib_set_journal_checkpoint_entries(db, 1u << 22);
+    if (!fill_library(db, BOOKS, BORROWERS, LOANS)) { lib_db_close(db); remove_db_files(base); return; }
+    printf("[csv] %d buku, %d peminjam, %lu pinjaman\n", BOOKS, BORROWERS, (unsigned long)lib_loan_count(db));
+
+    double t_legacy = 1e30, t_new = 1e30;
+    for (int r = 0; r < ROUNDS; ++r) {
+        double t0 = now_ms();
+        if (!legacy_export_csv(db, legacy)) break;
+        double t = now_ms() - t0;
+        if (t < t_legacy) t_legacy = t;
+        t0 = now_ms();
+        if (lib_db_export_csv(db, out) != LIB_OK) break;
+        t = now_ms() - t0;
+        if (t < t_new) t_new = t;
+    }
+    bool same = false;
+    double mb = csv_bytes(out, legacy, &same) / (1024.0 * 1024.0);
+    printf("  ekspor %.1f MB: fprintf per baris %7.1f ms (%6.1f MB/s) | serializer %7.1f ms (%6.1f MB/s) | %.1fx, identik: %s\n",
+           mb, t_legacy, t_legacy > 0 ? mb * 1000.0 / t_legacy : 0.0,
+           t_new, t_new > 0 ? mb * 1000.0 / t_new : 0.0,
+           t_new > 0 ? t_legacy / t_new : 0.0, same ? "ya" : "TIDAK");
+
+    /* checkpoint penuh (CSV + meta, journal dikosongkan) dengan serializer baru */
+    double t0 = now_ms();
+    lib_db_checkpoint(db);
+    double t_ck = now_ms() - t0;
+    printf("  lib_db_checkpoint                   : %7.1f ms (%6.1f MB/s)\n", t_ck,
+           t_ck > 0 ? mb * 1000.0 / t_ck : 0.0);
+    lib_db_close(db);
+    remove_db_files(base);
+    remove_db_files(legacy);
+    remove_db_files(out);
+}
+
+/* ---------- runner ---------- */
+
+typedef struct {
+    const char *name;
+    void (*fn)(void);
+} bench_entry_t;
+
+static const bench_entry_t benches[] = {
+    { "text", bench_text },
+    { "stock", bench_stock },
+    { "save", bench_save },
+    { "open", bench_open },
+    { "import", bench_import },
+    { "purge", bench_purge },
+    { "loans", bench_loans },
+    { "archive", bench_archive },
+    { "due", bench_due },
+    { "dates", bench_dates },
+    { "ids", bench_ids },
+    { "isbn", bench_isbn_keys },
+    { "alloc", bench_alloc },
+    { "rows", bench_rows },
+    { "threads", bench_threads },
+    { "daemon", bench_daemon },
+    { "batch", bench_batch },
+    { "csv", bench_csv },
+};
+
+int main(int argc, char **argv) {
+    size_t n = sizeof(benches) / sizeof(benches[0]);
+    for (size_t i = 0; i < n; ++i) {
+        bool selected = (argc < 2);
+        for (int a = 1; a < argc; ++a) if (strcmp(argv[a], benches[i].name) == 0) selected = true;
+        if (selected) benches[i].fn();
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* lib_archive.c
+ *
+ * Manifest arsip pinjaman per bulan (lihat lib_archive.h).
+ * Format manifest (CSV, record pertama header):
+ *   file,month,rows,first_returned,last_returned
+ *   _loans_2024-03.csv,2024-03,1520,2024-03-01,2024-03-31
+ *
+ * Standard: ISO C99
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/lib_archive.h"
+#include "../include/lib_csv.h"
+#include "../include/lib_arena.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  #include <unistd.h>     /* fsync */
+#endif
+
+#define MANIFEST_FIELDS 5
+
+int lib_archive_date_cmp(lib_date_t a, lib_date_t b) {
+    if (a.year != b.year) return a.year < b.year ? -1 : 1;
+    if (a.month != b.month) return a.month < b.month ? -1 : 1;
+    if (a.day != b.day) return a.day < b.day ? -1 : 1;
+    return 0;
+}
+
+bool lib_archive_overlaps(const lib_archive_part_t *p, lib_date_t from, lib_date_t to) {
+    return lib_archive_date_cmp(p->first, to) <= 0 && lib_archive_date_cmp(p->last, from) >= 0;
+}
+
+bool lib_archive_add(lib_archive_t *a, const lib_archive_part_t *part) {
+    if (a->count == a->capacity) {
+        size_t cap = a->capacity ? a->capacity * 2 : 16;
+        lib_archive_part_t *p = lib_heap_realloc(a->parts, cap * sizeof(*p));
+        if (!p) return false;
+        a->parts = p;
+        a->capacity = cap;
+    }
+    a->parts[a->count++] = *part;
+    a->stats.partitions = a->count;
+    a->stats.archived_rows += part->rows;
+    return true;
+}
+
+void lib_archive_remove(lib_archive_t *a, size_t i) {
+    if (i >= a->count) return;
+    a->stats.archived_rows -= a->parts[i].rows;
+    memmove(&a->parts[i], &a->parts[i + 1], (a->count - i - 1) * sizeof(a->parts[0]));
+    a->count--;
+    a->stats.partitions = a->count;
+}
+
+void lib_archive_truncate(lib_archive_t *a, size_t count) {
+    while (a->count > count) lib_archive_remove(a, a->count - 1);
+}
+
+bool lib_archive_has_month(const lib_archive_t *a, int year, int month) {
+    for (size_t i = 0; i < a->count; ++i)
+        if (a->parts[i].year == year && a->parts[i].month == month) return true;
+    return false;
+}
+
+static bool file_listed(const lib_archive_t *a, const char *file) {
+    for (size_t i = 0; i < a->count; ++i)
+        if (strcmp(a->parts[i].file, file) == 0) return true;
+    return false;
+}
+
+void lib_archive_name_part(const lib_archive_t *a, int year, int month, lib_archive_part_t *part) {
+    memset(part, 0, sizeof(*part));
+    part->year = year;
+    part->month = month;
+    snprintf(part->file, sizeof(part->file), "_loans_%04d-%02d.csv", year, month);
+    /* segmen pertama tanpa nomor; berikutnya _2, _3, ... (nama lama tidak dipakai ulang) */
+    for (unsigned n = 2; file_listed(a, part->file); ++n)
+        snprintf(part->file, sizeof(part->file), "_loans_%04d-%02d_%u.csv", year, month, n);
+}
+
+static bool parse_part(const lib_csv_field_t *f, int n, lib_archive_part_t *p) {
+    int y, m, d;
+    if (n < MANIFEST_FIELDS || f[0].len == 0 || f[0].len >= sizeof(p->file)) return false;
+    memset(p, 0, sizeof(*p));
+    memcpy(p->file, f[0].ptr, f[0].len + 1);
+    /* "YYYY-MM": tambahkan hari agar bisa dibaca lib_csv_to_date */
+    char month[16];
+    snprintf(month, sizeof(month), "%.10s-01", f[1].ptr);
+    lib_csv_field_t mf = { month, strlen(month) };
+    if (!lib_csv_to_date(&mf, &p->year, &p->month, &d)) return false;
+    p->rows = (size_t)lib_csv_to_long(&f[2]);
+    if (!lib_csv_to_date(&f[3], &y, &m, &d)) return false;
+    p->first.year = y; p->first.month = m; p->first.day = d;
+    if (!lib_csv_to_date(&f[4], &y, &m, &d)) return false;
+    p->last.year = y; p->last.month = m; p->last.day = d;
+    return true;
+}
+
+lib_archive_t *lib_archive_load(const char *manifest_path) {
+    lib_archive_t *a = lib_heap_calloc(1, sizeof(*a));
+    if (!a) return NULL;
+    lib_csv_reader_t rd;
+    if (!lib_csv_open(&rd, manifest_path)) return a;
+    lib_csv_field_t f[MANIFEST_FIELDS];
+    int n = lib_csv_next(&rd, f, MANIFEST_FIELDS);
+    while (n > 0 && (n = lib_csv_next(&rd, f, MANIFEST_FIELDS)) > 0) {
+        lib_archive_part_t p;
+        if (!parse_part(f, n, &p)) continue;   /* baris rusak dilewati */
+        if (!lib_archive_add(a, &p)) { n = -1; break; }
+    }
+    lib_csv_close(&rd);
+    if (n < 0) { lib_archive_free(a); return NULL; }
+    return a;
+}
+
+void lib_archive_free(lib_archive_t *a) {
+    if (!a) return;
+    lib_heap_free(a->parts);
+    lib_heap_free(a);
+}
+
+int lib_archive_write(const lib_archive_t *a, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    int rc = fprintf(f, "file,month,rows,first_returned,last_returned\n") < 0 ? -1 : 0;
+    for (size_t i = 0; rc == 0 && i < a->count; ++i) {
+        const lib_archive_part_t *p = &a->parts[i];
+        if (fprintf(f, "%s,%04d-%02d,%lu,%04d-%02d-%02d,%04d-%02d-%02d\n",
+                    p->file, p->year, p->month, (unsigned long)p->rows,
+                    p->first.year, p->first.month, p->first.day,
+                    p->last.year, p->last.month, p->last.day) < 0) rc = -1;
+    }
+    if (fflush(f) != 0) rc = -1;
+#if !defined(_WIN32) && !defined(_WIN64)
+    fsync(fileno(f));
+#endif
+    if (fclose(f) != 0) rc = -1;
+    return rc;
+}
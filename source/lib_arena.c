@@ -0,0 +1,273 @@
+/* lib_arena.c
+ *
+ * Implementasi lib_arena.h: arena bump-pointer dengan blok geometris dan
+ * pembungkus heap yang menghitung panggilan malloc/free.
+ * Header blok dibulatkan ke LIB_ARENA_ALIGN sehingga data blok (dan setiap
+ * alokasi) rata 16 byte relatif ke awal blok.
+ * Alokasi >= LIB_ARENA_LARGE (array tabel/indeks besar) mendapat blok sendiri
+ * yang di-realloc saat tumbuh dan dibebaskan oleh lib_mem_release, jadi
+ * salinan lama tidak tertinggal di arena; alokasi kecil tidak pernah
+ * diperbesar di tempat sampai batas itu.
+ *
+ * Standard: ISO C99
+ */
+
+#define _POSIX_C_SOURCE 200809L   /* pthread_rwlock_t di lib_thread.h */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/lib_arena.h"
+#include "../include/lib_thread.h"
+
+#define BLOCK_HEADER ((sizeof(lib_arena_block_t) + LIB_ARENA_ALIGN - 1) & ~(size_t)(LIB_ARENA_ALIGN - 1))
+
+static volatile unsigned long long heap_allocs;
+static volatile unsigned long long heap_frees;
+static volatile unsigned long long arena_allocs;
+
+/* ---------- Heap dengan counter ---------- */
+
+void *lib_heap_malloc(size_t n) {
+    void *p = malloc(n);
+    if (p) lib_atomic_add(&heap_allocs, 1);
+    return p;
+}
+
+void *lib_heap_calloc(size_t count, size_t size) {
+    void *p = calloc(count, size);
+    if (p) lib_atomic_add(&heap_allocs, 1);
+    return p;
+}
+
+void *lib_heap_realloc(void *p, size_t n) {
+    void *q = realloc(p, n);
+    if (q) lib_atomic_add(&heap_allocs, 1);
+    return q;
+}
+
+void lib_heap_free(void *p) {
+    if (!p) return;
+    lib_atomic_add(&heap_frees, 1);
+    free(p);
+}
+
+unsigned long long lib_heap_alloc_count(void) { return lib_atomic_add(&heap_allocs, 0); }
+unsigned long long lib_heap_free_count(void) { return lib_atomic_add(&heap_frees, 0); }
+unsigned long long lib_arena_alloc_count(void) { return lib_atomic_add(&arena_allocs, 0); }
+
+/* ---------- Arena ---------- */
+
+static unsigned char *block_data(lib_arena_block_t *b) {
+    return (unsigned char *)b + BLOCK_HEADER;
+}
+
+static size_t round_up(size_t n) {
+    return (n + LIB_ARENA_ALIGN - 1) & ~(size_t)(LIB_ARENA_ALIGN - 1);
+}
+
+void lib_arena_init(lib_arena_t *a, void *buf, size_t n) {
+    memset(a, 0, sizeof(*a));
+    a->next_size = LIB_ARENA_FIRST_BLOCK;
+    if (!buf) return;
+    uintptr_t start = ((uintptr_t)buf + LIB_ARENA_ALIGN - 1) & ~(uintptr_t)(LIB_ARENA_ALIGN - 1);
+    size_t skip = (size_t)(start - (uintptr_t)buf);
+    if (n < skip + BLOCK_HEADER + LIB_ARENA_ALIGN) return;
+    lib_arena_block_t *b = (lib_arena_block_t *)start;
+    b->prev = NULL;
+    b->size = (n - skip - BLOCK_HEADER) & ~(size_t)(LIB_ARENA_ALIGN - 1);
+    b->used = 0;
+    b->owned = false;
+    b->large = false;
+    a->head = b;
+}
+
+static lib_arena_block_t *new_block(lib_arena_t *a, size_t need) {
+    size_t size = a->next_size ? a->next_size : LIB_ARENA_FIRST_BLOCK;
+    while (size < need && size < LIB_ARENA_MAX_BLOCK) size *= 2;
+    if (size < need) size = need;
+    if (size > SIZE_MAX - BLOCK_HEADER) return NULL;
+    lib_arena_block_t *b = lib_heap_malloc(BLOCK_HEADER + size);
+    if (!b) return NULL;
+    b->prev = a->head;
+    b->size = size;
+    b->used = 0;
+    b->owned = true;
+    b->large = false;
+    a->head = b;
+    a->blocks++;
+    a->reserved += size;
+    if (size * 2 <= LIB_ARENA_MAX_BLOCK) a->next_size = size * 2;
+    else a->next_size = LIB_ARENA_MAX_BLOCK;
+    return b;
+}
+
+/* Blok khusus satu alokasi besar; disisipkan di bawah head agar blok aktif tetap.
+ * zero: calloc (halaman baru dari OS sudah nol, tidak perlu memset). */
+static void *large_alloc(lib_arena_t *a, size_t need, bool zero) {
+    if (need > SIZE_MAX - BLOCK_HEADER) return NULL;
+    lib_arena_block_t *b = zero ? lib_heap_calloc(1, BLOCK_HEADER + need) : lib_heap_malloc(BLOCK_HEADER + need);
+    if (!b) return NULL;
+    b->size = b->used = need;
+    b->owned = true;
+    b->large = true;
+    if (a->head) {
+        b->prev = a->head->prev;
+        a->head->prev = b;
+    } else {
+        b->prev = NULL;
+        a->head = b;
+    }
+    a->blocks++;
+    a->reserved += need;
+    a->used += need;
+    lib_atomic_add(&arena_allocs, 1);
+    return block_data(b);
+}
+
+/* Tautan yang menunjuk blok besar milik p, atau NULL jika p bukan awal blok
+ * besar arena ini (alokasi kecil, atau milik arena lain) */
+static lib_arena_block_t **large_link(lib_arena_t *a, void *p) {
+    lib_arena_block_t *b = (lib_arena_block_t *)((unsigned char *)p - BLOCK_HEADER);
+    lib_arena_block_t **link = &a->head;
+    while (*link && *link != b) link = &(*link)->prev;
+    return *link && b->large ? link : NULL;
+}
+
+static void *large_grow(lib_arena_t *a, void *p, size_t new_n) {
+    size_t need = round_up(new_n);
+    if (need < new_n || need > SIZE_MAX - BLOCK_HEADER) return NULL;
+    lib_arena_block_t **link = large_link(a, p);
+    if (!link) return NULL;
+    lib_arena_block_t *b = *link;
+    size_t old = b->size;
+    lib_arena_block_t *nb = lib_heap_realloc(b, BLOCK_HEADER + need);
+    if (!nb) return NULL;
+    *link = nb;
+    nb->size = nb->used = need;
+    a->reserved += need - old;
+    a->used += need - old;
+    return block_data(nb);
+}
+
+lib_arena_t *lib_arena_create(void) {
+    lib_arena_t tmp;
+    lib_arena_init(&tmp, NULL, 0);
+    lib_arena_t *a = lib_arena_alloc(&tmp, sizeof(*a));
+    if (!a) return NULL;
+    *a = tmp;
+    a->last = NULL;
+    return a;
+}
+
+void lib_arena_free(lib_arena_t *a) {
+    if (!a) return;
+    lib_arena_block_t *b = a->head;
+    /* `a` bisa berada di salah satu blok: jangan disentuh sesudah loop */
+    while (b) {
+        lib_arena_block_t *prev = b->prev;
+        if (b->owned) lib_heap_free(b);
+        b = prev;
+    }
+}
+
+void lib_arena_adopt(lib_arena_t *dst, lib_arena_t *src) {
+    if (!dst || !src || dst == src) return;
+    lib_arena_block_t *b = src->head;
+    size_t blocks = src->blocks, reserved = src->reserved, used = src->used;
+    /* blok src disisipkan di bawah head dst supaya head dst tetap blok aktif */
+    while (b) {
+        lib_arena_block_t *prev = b->prev;
+        if (b->owned) {
+            if (dst->head) {
+                b->prev = dst->head->prev;
+                dst->head->prev = b;
+            } else {
+                b->prev = NULL;
+                dst->head = b;
+            }
+        }
+        b = prev;
+    }
+    dst->blocks += blocks;
+    dst->reserved += reserved;
+    dst->used += used;
+}
+
+void *lib_arena_alloc(lib_arena_t *a, size_t n) {
+    if (!a) return NULL;
+    size_t need = round_up(n ? n : 1);
+    if (need < n) return NULL;
+    if (need >= LIB_ARENA_LARGE) return large_alloc(a, need, false);
+    lib_arena_block_t *b = a->head;
+    if (!b || b->size - b->used < need) {
+        b = new_block(a, need);
+        if (!b) return NULL;
+    }
+    void *p = block_data(b) + b->used;
+    b->used += need;
+    a->used += need;
+    a->last = p;
+    lib_atomic_add(&arena_allocs, 1);
+    return p;
+}
+
+void *lib_arena_calloc(lib_arena_t *a, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    if (a && round_up(count * size) >= LIB_ARENA_LARGE) return large_alloc(a, round_up(count * size), true);
+    void *p = lib_arena_alloc(a, count * size);
+    if (p) memset(p, 0, count * size);
+    return p;
+}
+
+void *lib_arena_grow(lib_arena_t *a, void *p, size_t old_n, size_t new_n) {
+    if (!p) return lib_arena_alloc(a, new_n);
+    if (new_n <= old_n) return p;
+    if (round_up(old_n) >= LIB_ARENA_LARGE) return large_grow(a, p, new_n);
+    lib_arena_block_t *b = a->head;
+    if (p == a->last && b) {
+        size_t off = (size_t)((unsigned char *)p - block_data(b));
+        size_t need = round_up(new_n);
+        if (need >= new_n && need < LIB_ARENA_LARGE && off + need <= b->size) {
+            a->used += off + need - b->used;
+            b->used = off + need;
+            return p;
+        }
+    }
+    void *q = lib_arena_alloc(a, new_n);
+    if (q) memcpy(q, p, old_n);
+    return q;
+}
+
+char *lib_arena_strdup(lib_arena_t *a, const char *s) {
+    if (!s) return NULL;
+    size_t len = strlen(s) + 1;
+    char *d = lib_arena_alloc(a, len);
+    if (d) memcpy(d, s, len);
+    return d;
+}
+
+/* ---------- Arena atau heap ---------- */
+
+void *lib_mem_calloc(lib_arena_t *a, size_t count, size_t size) {
+    return a ? lib_arena_calloc(a, count, size) : lib_heap_calloc(count, size);
+}
+
+void *lib_mem_grow(lib_arena_t *a, void *p, size_t old_n, size_t new_n) {
+    return a ? lib_arena_grow(a, p, old_n, new_n) : lib_heap_realloc(p, new_n);
+}
+
+void lib_mem_release(lib_arena_t *a, void *p) {
+    if (!a) { lib_heap_free(p); return; }
+    if (!p) return;
+    /* Blok besar (slot hash yang di-rehash, tabel indeks) langsung dilepas;
+     * alokasi kecil tetap di arena sampai lib_arena_free */
+    lib_arena_block_t **link = large_link(a, p);
+    if (!link) return;
+    lib_arena_block_t *b = *link;
+    *link = b->prev;
+    a->blocks--;
+    a->reserved -= b->size;
+    a->used -= b->size;
+    lib_heap_free(b);
+}
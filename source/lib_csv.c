@@ -0,0 +1,506 @@
+/* lib_csv.c
+ *
+ * Reader/writer CSV RFC 4180 (lihat lib_csv.h).
+ * - Batas record dicari dengan scan '"' / '\n' (SSE2 16 byte per iterasi bila
+ *   tersedia) sambil melacak status kutip; baru setelah record utuh ada di
+ *   buffer, field dipecah dan di-unescape di tempat
+ * - Angka dan tanggal diurai dengan rutin khusus (tanpa sscanf/strtod kecuali
+ *   untuk bentuk yang jarang seperti eksponen)
+ * - Arah sebaliknya juga tanpa printf: bilangan bulat lewat tabel dua digit,
+ *   harga sebagai sen (fixed-point) dengan fallback snprintf hanya untuk
+ *   nilai yang pembulatannya ambigu atau sangat besar
+ *
+ * Standard: ISO C99
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "../include/lib_csv.h"
+#include "../include/lib_arena.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define LIB_CSV_HAVE_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+#define CSV_BLOCK (256u * 1024u)
+
+/* ---------- structural scan ---------- */
+
+#if defined(LIB_CSV_HAVE_SSE2)
+static unsigned lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (unsigned)idx;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+/* Posisi pertama '"' atau '\n' di [p, end), atau end */
+static const char *scan_quote_or_newline(const char *p, const char *end) {
+#if defined(LIB_CSV_HAVE_SSE2)
+    const __m128i vq = _mm_set1_epi8('"');
+    const __m128i vn = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vq), _mm_cmpeq_epi8(v, vn)));
+        if (mask) return p + lowest_bit(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\n') ++p;
+    return p;
+}
+
+/* Akhir record: posisi '\n' pertama di luar kutip dalam [p, end), atau NULL
+ * jika belum ada. *quoted membawa status kutip antar panggilan sehingga
+ * pemindaian bisa dilanjutkan setelah buffer diisi ulang. */
+static const char *find_record_end(const char *p, const char *end, bool *quoted) {
+    for (;;) {
+        p = scan_quote_or_newline(p, end);
+        if (p == end) return NULL;
+        if (*p == '"') *quoted = !*quoted;
+        else if (!*quoted) return p;
+        ++p;
+    }
+}
+
+/* ---------- field split ---------- */
+
+static size_t split_record(char *p, char *rec_end, lib_csv_field_t *fields, size_t max_fields) {
+    size_t n = 0;
+    if (max_fields == 0) return 0;
+    for (;;) {
+        lib_csv_field_t *f = &fields[n++];
+        char *stop;
+        if (p < rec_end && *p == '"') {
+            /* field dikutip: salin segmen di antara kutip ke kiri ("" -> ") */
+            char *w = p, *q = p + 1;
+            for (;;) {
+                char *c = memchr(q, '"', (size_t)(rec_end - q));
+                if (!c) { memmove(w, q, (size_t)(rec_end - q)); w += rec_end - q; q = rec_end; break; }
+                memmove(w, q, (size_t)(c - q));
+                w += c - q;
+                if (c + 1 < rec_end && c[1] == '"') { *w++ = '"'; q = c + 2; continue; }
+                q = c + 1;
+                break;
+            }
+            f->ptr = p;
+            f->len = (size_t)(w - p);
+            /* karakter setelah kutip penutup sampai koma diabaikan */
+            stop = (n == max_fields || q >= rec_end) ? NULL : memchr(q, ',', (size_t)(rec_end - q));
+            if (!stop) stop = rec_end;
+            *w = '\0';
+        } else {
+            /* slot terakhir mengambil sisa record */
+            stop = (n == max_fields || p >= rec_end) ? NULL : memchr(p, ',', (size_t)(rec_end - p));
+            if (!stop) stop = rec_end;
+            char *e = stop;
+            if (stop == rec_end && e > p && e[-1] == '\r') --e;
+            f->ptr = p;
+            f->len = (size_t)(e - p);
+            *e = '\0';
+        }
+        if (stop == rec_end) return n;
+        p = stop + 1;
+        if (p == rec_end || (p + 1 == rec_end && *p == '\r')) {
+            /* koma di akhir: field kosong terakhir */
+            if (n < max_fields) { fields[n].ptr = stop; fields[n].len = 0; n++; }
+            return n;
+        }
+    }
+}
+
+size_t lib_csv_split(char *line, size_t len, lib_csv_field_t *fields, size_t max_fields) {
+    if (!line) return 0;
+    return split_record(line, line + len, fields, max_fields);
+}
+
+size_t lib_csv_last_record_end(const char *p, size_t len, bool *quoted) {
+    const char *end = p + len, *q = p, *last = NULL;
+    while ((q = find_record_end(q, end, quoted)) != NULL) last = ++q;
+    return last ? (size_t)(last - p) : 0;
+}
+
+size_t lib_csv_next_in(char **cursor, char *end, lib_csv_field_t *fields, size_t max_fields) {
+    char *p = *cursor;
+    while (p < end && (*p == '\n' || *p == '\r')) ++p;
+    if (p >= end) { *cursor = end; return 0; }
+    bool quoted = false;
+    char *rec_end = (char *)find_record_end(p, end, &quoted);
+    if (!rec_end) rec_end = end;
+    size_t n = split_record(p, rec_end, fields, max_fields);
+    *cursor = rec_end < end ? rec_end + 1 : end;
+    return n;
+}
+
+/* ---------- reader ---------- */
+
+bool lib_csv_open(lib_csv_reader_t *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    if (!path) return false;
+    r->fp = fopen(path, "rb");
+    if (!r->fp) return false;
+    r->buf = lib_heap_malloc(CSV_BLOCK + 1);
+    if (!r->buf) { fclose(r->fp); r->fp = NULL; return false; }
+    r->cap = CSV_BLOCK;
+    return true;
+}
+
+void lib_csv_close(lib_csv_reader_t *r) {
+    if (!r) return;
+    if (r->fp) fclose(r->fp);
+    lib_heap_free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+/* Geser sisa data ke awal buffer lalu baca blok berikutnya (buffer diperbesar
+ * jika satu record lebih besar dari buffer). false jika memori habis. */
+static bool refill(lib_csv_reader_t *r) {
+    size_t rest = r->len - r->pos;
+    if (r->pos > 0) memmove(r->buf, r->buf + r->pos, rest);
+    r->pos = 0;
+    r->len = rest;
+    if (r->len == r->cap) {
+        char *tmp = lib_heap_realloc(r->buf, r->cap * 2 + 1);
+        if (!tmp) return false;
+        r->buf = tmp;
+        r->cap *= 2;
+    }
+    size_t n = fread(r->buf + r->len, 1, r->cap - r->len, r->fp);
+    r->len += n;
+    if (n == 0) r->eof = true;
+    return true;
+}
+
+int lib_csv_next(lib_csv_reader_t *r, lib_csv_field_t *fields, size_t max_fields) {
+    if (!r || !r->buf) return 0;
+    size_t scanned = 0;     /* byte record ini yang sudah dipindai (relatif ke pos) */
+    bool quoted = false;
+    for (;;) {
+        if (scanned == 0) {
+            while (r->pos < r->len && (r->buf[r->pos] == '\n' || r->buf[r->pos] == '\r')) r->pos++;
+        }
+        if (r->pos < r->len) {
+            char *start = r->buf + r->pos;
+            char *end = r->buf + r->len;
+            const char *rec_end = find_record_end(start + scanned, end, &quoted);
+            if (!rec_end && r->eof) rec_end = end;   /* record terakhir tanpa '\n' */
+            if (rec_end) {
+                size_t n = split_record(start, (char *)rec_end, fields, max_fields);
+                r->pos = (size_t)(rec_end - r->buf) + (rec_end < end ? 1 : 0);
+                return (int)n;
+            }
+            scanned = r->len - r->pos;
+        } else if (r->eof) {
+            return 0;
+        }
+        if (!refill(r)) return -1;
+    }
+}
+
+/* ---------- number / date parsing ---------- */
+
+static const char *skip_ws(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+long lib_csv_to_long(const lib_csv_field_t *f) {
+    const char *p = skip_ws(f->ptr, f->ptr + f->len), *end = f->ptr + f->len;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) neg = *p++ == '-';
+    unsigned long v = 0;
+    while (p < end && (unsigned)(*p - '0') < 10u) v = v * 10u + (unsigned long)(*p++ - '0');
+    return neg ? -(long)v : (long)v;
+}
+
+double lib_csv_to_double(const lib_csv_field_t *f) {
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+                                    1e21, 1e22 };
+    const char *p = skip_ws(f->ptr, f->ptr + f->len), *end = f->ptr + f->len;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) neg = *p++ == '-';
+    uint64_t mant = 0;
+    int digits = 0, frac = 0;
+    while (p < end && (unsigned)(*p - '0') < 10u) { mant = mant * 10u + (uint64_t)(*p++ - '0'); digits++; }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && (unsigned)(*p - '0') < 10u) { mant = mant * 10u + (uint64_t)(*p++ - '0'); digits++; frac++; }
+    }
+    /* jalur cepat: mantisa <= 2^53 dan pembagi 10^k eksak -> hasil dibulatkan benar */
+    bool simple = (p == end || *p == ' ' || *p == '\t') && digits <= 15 && frac <= 22;
+    if (!simple) return strtod(f->ptr, NULL);
+    double v = (double)mant / pow10[frac];
+    return neg ? -v : v;
+}
+
+static bool read_uint(const char **pp, const char *end, int max_digits, int *out) {
+    const char *p = *pp;
+    int v = 0, n = 0;
+    while (p < end && n < max_digits && (unsigned)(*p - '0') < 10u) { v = v * 10 + (*p++ - '0'); n++; }
+    if (n == 0) return false;
+    *pp = p;
+    *out = v;
+    return true;
+}
+
+bool lib_csv_to_date(const lib_csv_field_t *f, int *year, int *month, int *day) {
+    const char *p = skip_ws(f->ptr, f->ptr + f->len), *end = f->ptr + f->len;
+    if (end - p < 5) return false;
+    /* jalur cepat "YYYY-MM-DD" */
+    if (end - p >= 10 && p[4] == '-' && p[7] == '-') {
+        int d[8], k = 0;
+        static const int pos[8] = { 0, 1, 2, 3, 5, 6, 8, 9 };
+        for (; k < 8; ++k) {
+            unsigned c = (unsigned)(p[pos[k]] - '0');
+            if (c >= 10u) break;
+            d[k] = (int)c;
+        }
+        if (k == 8) {
+            *year = d[0] * 1000 + d[1] * 100 + d[2] * 10 + d[3];
+            *month = d[4] * 10 + d[5];
+            *day = d[6] * 10 + d[7];
+            return true;
+        }
+    }
+    int y, m, dd;
+    if (!read_uint(&p, end, 4, &y) || p >= end || *p++ != '-') return false;
+    if (!read_uint(&p, end, 2, &m) || p >= end || *p++ != '-') return false;
+    if (!read_uint(&p, end, 2, &dd)) return false;
+    *year = y; *month = m; *day = dd;
+    return true;
+}
+
+/* ---------- writer ---------- */
+
+void lib_csv_row_init(lib_csv_row_t *row, char *out, size_t cap) {
+    row->out = out;
+    row->cap = cap;
+    row->len = 0;
+    row->fields = 0;
+    if (cap) out[0] = '\0';
+}
+
+static void row_putc(lib_csv_row_t *row, char c) {
+    if (row->len + 1 < row->cap) row->out[row->len] = c;
+    row->len++;
+}
+
+static void row_put(lib_csv_row_t *row, const char *s, size_t n) {
+    if (row->len + 1 < row->cap) {
+        size_t room = row->cap - 1 - row->len;
+        memcpy(row->out + row->len, s, n < room ? n : room);
+    }
+    row->len += n;
+}
+
+static void row_sep(lib_csv_row_t *row) {
+    if (row->fields++) row_putc(row, ',');
+}
+
+void lib_csv_row_raw(lib_csv_row_t *row, const char *s) {
+    row_sep(row);
+    row_put(row, s, strlen(s));
+}
+
+void lib_csv_row_str(lib_csv_row_t *row, const char *s) {
+    row_sep(row);
+    size_t n = strlen(s);
+    if (strcspn(s, ",\"\r\n") == n) { row_put(row, s, n); return; }
+    row_putc(row, '"');
+    for (;;) {
+        const char *q = strchr(s, '"');
+        if (!q) { row_put(row, s, strlen(s)); break; }
+        row_put(row, s, (size_t)(q - s) + 1);
+        row_putc(row, '"');
+        s = q + 1;
+    }
+    row_putc(row, '"');
+}
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Tulis v rata kanan berakhir di end; kembalikan pointer digit pertama */
+static char *u64_to_text(char *end, unsigned long long v, int min_digits) {
+    char *p = end;
+    while (v >= 100) {
+        unsigned d = (unsigned)(v % 100) * 2;
+        v /= 100;
+        *--p = digit_pairs[d + 1];
+        *--p = digit_pairs[d];
+    }
+    if (v >= 10) {
+        *--p = digit_pairs[v * 2 + 1];
+        *--p = digit_pairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    while (end - p < min_digits) *--p = '0';
+    return p;
+}
+
+void lib_csv_row_uint(lib_csv_row_t *row, char prefix, unsigned long long v, int min_digits) {
+    char tmp[48];
+    char *end = tmp + sizeof(tmp);
+    if (min_digits > 40) min_digits = 40;
+    char *p = u64_to_text(end, v, min_digits);
+    if (prefix) *--p = prefix;
+    row_sep(row);
+    row_put(row, p, (size_t)(end - p));
+}
+
+void lib_csv_row_long(lib_csv_row_t *row, long v) {
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    unsigned long long mag = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    char *p = u64_to_text(end, mag, 0);
+    if (v < 0) *--p = '-';
+    row_sep(row);
+    row_put(row, p, (size_t)(end - p));
+}
+
+void lib_csv_row_fixed2(lib_csv_row_t *row, double v) {
+    /* Jalur cepat hanya jika hasil pembulatan v*100 pasti sama dengan printf:
+     * |v| < 1e9 (galat v*100 jauh di bawah 1e-4) dan pecahan tidak dekat .5 */
+    double x = v < 0 ? -v * 100.0 : v * 100.0;
+    unsigned long long cents = 0;
+    bool fast = x < 1e11;
+    if (fast) {
+        cents = (unsigned long long)x;
+        double frac = x - (double)cents;
+        if (frac > 0.4999 && frac < 0.5001) fast = false;
+        else if (frac > 0.5) cents++;
+    }
+    if (!fast) {
+        char tmp[352];
+        snprintf(tmp, sizeof(tmp), "%.2f", v);
+        row_sep(row);
+        row_put(row, tmp, strlen(tmp));
+        return;
+    }
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+    unsigned d = (unsigned)(cents % 100) * 2;
+    *--end = digit_pairs[d + 1];
+    *--end = digit_pairs[d];
+    *--end = '.';
+    char *p = u64_to_text(end, cents / 100, 0);
+    if (signbit(v)) *--p = '-';   /* termasuk -0.00 seperti printf */
+    end = tmp + sizeof(tmp);
+    row_sep(row);
+    row_put(row, p, (size_t)(end - p));
+}
+
+void lib_csv_row_date(lib_csv_row_t *row, int year, int month, int day) {
+    if (year < 0 || year > 9999 || month < 0 || month > 99 || day < 0 || day > 99) {
+        char tmp[40];
+        snprintf(tmp, sizeof(tmp), "%04d-%02d-%02d", year, month, day);
+        row_sep(row);
+        row_put(row, tmp, strlen(tmp));
+        return;
+    }
+    char t[10];
+    t[0] = digit_pairs[(year / 100) * 2];
+    t[1] = digit_pairs[(year / 100) * 2 + 1];
+    t[2] = digit_pairs[(year % 100) * 2];
+    t[3] = digit_pairs[(year % 100) * 2 + 1];
+    t[4] = '-';
+    t[5] = digit_pairs[month * 2];
+    t[6] = digit_pairs[month * 2 + 1];
+    t[7] = '-';
+    t[8] = digit_pairs[day * 2];
+    t[9] = digit_pairs[day * 2 + 1];
+    row_sep(row);
+    row_put(row, t, sizeof(t));
+}
+
+int lib_csv_row_end(lib_csv_row_t *row) {
+    if (row->cap) row->out[row->len < row->cap ? row->len : row->cap - 1] = '\0';
+    return (int)row->len;
+}
+
+/* ---------- file writer ---------- */
+
+bool lib_csv_writer_open(lib_csv_writer_t *w, const char *path) {
+    memset(w, 0, sizeof(*w));
+    if (!path) return false;
+    w->buf = lib_heap_malloc(LIB_CSV_WRITE_BUF);
+    if (!w->buf) return false;
+    w->fp = fopen(path, "w");
+    if (!w->fp) { lib_heap_free(w->buf); w->buf = NULL; return false; }
+    /* buffer sendiri sudah besar: fwrite langsung menjadi write() */
+    setvbuf(w->fp, NULL, _IONBF, 0);
+    return true;
+}
+
+static void writer_flush(lib_csv_writer_t *w) {
+    if (w->len && !w->failed && fwrite(w->buf, 1, w->len, w->fp) != w->len) w->failed = true;
+    w->bytes += w->len;
+    w->len = 0;
+}
+
+void lib_csv_writer_put(lib_csv_writer_t *w, const char *s, size_t n) {
+    while (n > 0) {
+        if (w->len == LIB_CSV_WRITE_BUF) writer_flush(w);
+        size_t room = LIB_CSV_WRITE_BUF - w->len;
+        size_t k = n < room ? n : room;
+        memcpy(w->buf + w->len, s, k);
+        w->len += k;
+        s += k;
+        n -= k;
+    }
+}
+
+void lib_csv_writer_row(lib_csv_writer_t *w, lib_csv_row_t *row, size_t max_len) {
+    if (max_len + 1 > LIB_CSV_WRITE_BUF) max_len = LIB_CSV_WRITE_BUF - 1;
+    if (LIB_CSV_WRITE_BUF - w->len < max_len + 1) writer_flush(w);   /* + '\n' */
+    lib_csv_row_init(row, w->buf + w->len, max_len);
+}
+
+void lib_csv_writer_end_row(lib_csv_writer_t *w, lib_csv_row_t *row) {
+    /* baris terpotong bisa meninggalkan kutip terbuka yang menelan baris
+     * sesudahnya saat dibaca ulang: gagalkan file, jangan tulis setengah */
+    if (row->len >= row->cap) w->failed = true;
+    size_t n = row->len < row->cap ? row->len : row->cap - 1;
+    w->buf[w->len + n] = '\n';
+    w->len += n + 1;
+}
+
+bool lib_csv_writer_close(lib_csv_writer_t *w, bool sync) {
+    if (!w->fp) return false;
+    writer_flush(w);
+    bool ok = !w->failed && fflush(w->fp) == 0;
+#if defined(_WIN32) || defined(_WIN64)
+    if (ok && sync) ok = _commit(_fileno(w->fp)) == 0;
+#else
+    if (ok && sync) ok = fsync(fileno(w->fp)) == 0;
+#endif
+    if (fclose(w->fp) != 0) ok = false;
+    lib_heap_free(w->buf);
+    w->fp = NULL;
+    w->buf = NULL;
+    return ok;
+}
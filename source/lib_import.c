@@ -0,0 +1,372 @@
+/* lib_import.c
+ *
+ * Pipeline impor CSV (lihat lib_import.h):
+ *
+ *   reader --raw--> splitter --chunks--> parser x N --window--> inserter
+ *
+ * - reader: fread blok IMPORT_BLOCK byte
+ * - splitter: memotong blok di akhir record utuh terakhir (status kutip
+ *   dibawa antar blok); sisa blok disambung ke potongan berikutnya. Setiap
+ *   potongan diberi nomor urut.
+ * - parser: memecah record potongan dan mengurainya ke array record
+ * - inserter: mengambil batch dari jendela urut (window) sesuai nomor urut
+ * Satu mutex melindungi semua antrian; operasi antrian hanya terjadi sekali
+ * per potongan sehingga kontensinya kecil.
+ *
+ * Standard: ISO C99
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/lib_import.h"
+#include "../include/lib_thread.h"
+#include "../include/lib_arena.h"
+
+#define IMPORT_BLOCK (256u * 1024u)
+#define RAW_QUEUE_CAP 4
+
+typedef struct {
+    char *data;              /* len + 1 byte (cadangan untuk NUL) */
+    size_t len;
+    unsigned long seq;
+} import_chunk_t;
+
+typedef struct {
+    unsigned char *recs;
+    size_t count;
+    size_t skipped;
+} import_batch_t;
+
+/* Antrian FIFO terbatas berisi pointer; NULL dipakai sebagai penanda akhir */
+typedef struct {
+    void **items;
+    size_t cap, head, count;
+    lib_cond_t not_empty, not_full;
+} import_queue_t;
+
+typedef struct {
+    const lib_import_table_t *t;
+    FILE *fp;
+    unsigned parsers;
+    lib_mutex_t m;
+    import_queue_t raw, chunks;
+    /* jendela urut: batch seq s menempati slot s % window_cap */
+    import_batch_t **window;
+    size_t window_cap;
+    unsigned long next_seq;
+    unsigned long total_chunks;
+    bool split_done;
+    lib_cond_t window_free, window_ready;
+    bool abort;
+    lib_status_t err;
+    /* statistik; read/split hanya ditulis satu thread, parse di bawah m */
+    double read_ms, split_ms, parse_ms;
+    unsigned long long bytes;
+} import_pipeline_t;
+
+static void chunk_free(import_chunk_t *c) {
+    if (!c) return;
+    lib_heap_free(c->data);
+    lib_heap_free(c);
+}
+
+static void batch_free(import_batch_t *b) {
+    if (!b) return;
+    lib_heap_free(b->recs);
+    lib_heap_free(b);
+}
+
+static bool queue_init(import_queue_t *q, size_t cap) {
+    memset(q, 0, sizeof(*q));
+    q->items = lib_heap_calloc(cap, sizeof(void *));
+    if (!q->items) return false;
+    q->cap = cap;
+    lib_cond_init(&q->not_empty);
+    lib_cond_init(&q->not_full);
+    return true;
+}
+
+static void queue_destroy(import_queue_t *q, void (*free_item)(void *)) {
+    for (size_t i = 0; i < q->count; ++i) free_item(q->items[(q->head + i) % q->cap]);
+    lib_heap_free(q->items);
+    lib_cond_destroy(&q->not_empty);
+    lib_cond_destroy(&q->not_full);
+}
+
+/* Hentikan semua tahap (error pertama yang dicatat) */
+static void pipeline_fail(import_pipeline_t *p, lib_status_t err) {
+    lib_mutex_lock(&p->m);
+    if (!p->abort) { p->abort = true; p->err = err; }
+    lib_cond_broadcast(&p->raw.not_empty);  lib_cond_broadcast(&p->raw.not_full);
+    lib_cond_broadcast(&p->chunks.not_empty); lib_cond_broadcast(&p->chunks.not_full);
+    lib_cond_broadcast(&p->window_free);    lib_cond_broadcast(&p->window_ready);
+    lib_mutex_unlock(&p->m);
+}
+
+/* false jika pipeline dibatalkan (item tidak masuk antrian) */
+static bool queue_push(import_pipeline_t *p, import_queue_t *q, void *item) {
+    lib_mutex_lock(&p->m);
+    while (q->count == q->cap && !p->abort) lib_cond_wait(&q->not_full, &p->m);
+    bool ok = !p->abort;
+    if (ok) {
+        q->items[(q->head + q->count) % q->cap] = item;
+        q->count++;
+        lib_cond_signal(&q->not_empty);
+    }
+    lib_mutex_unlock(&p->m);
+    return ok;
+}
+
+static bool queue_pop(import_pipeline_t *p, import_queue_t *q, void **item) {
+    lib_mutex_lock(&p->m);
+    while (q->count == 0 && !p->abort) lib_cond_wait(&q->not_empty, &p->m);
+    bool ok = !p->abort;
+    if (ok) {
+        *item = q->items[q->head];
+        q->head = (q->head + 1) % q->cap;
+        q->count--;
+        lib_cond_signal(&q->not_full);
+    }
+    lib_mutex_unlock(&p->m);
+    return ok;
+}
+
+/* ---------- stages ---------- */
+
+static void reader_run(void *arg) {
+    import_pipeline_t *p = arg;
+    for (;;) {
+        double t = lib_clock_ms();
+        import_chunk_t *c = lib_heap_calloc(1, sizeof(*c));
+        if (c) c->data = lib_heap_malloc(IMPORT_BLOCK + 1);
+        if (!c || !c->data) { chunk_free(c); pipeline_fail(p, LIB_ERR_MEMORY); return; }
+        c->len = fread(c->data, 1, IMPORT_BLOCK, p->fp);
+        p->read_ms += lib_clock_ms() - t;
+        p->bytes += c->len;
+        if (c->len == 0) {
+            chunk_free(c);
+            if (ferror(p->fp)) { pipeline_fail(p, LIB_ERR_IO); return; }
+            queue_push(p, &p->raw, NULL);
+            return;
+        }
+        if (!queue_push(p, &p->raw, c)) { chunk_free(c); return; }
+    }
+}
+
+/* Sambung carry + data[0..n) menjadi potongan baru bernomor seq */
+static import_chunk_t *make_chunk(const char *carry, size_t carry_len, const char *data, size_t n,
+                                  unsigned long seq) {
+    import_chunk_t *c = lib_heap_calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    c->data = lib_heap_malloc(carry_len + n + 1);
+    if (!c->data) { lib_heap_free(c); return NULL; }
+    if (carry_len) memcpy(c->data, carry, carry_len);
+    memcpy(c->data + carry_len, data, n);
+    c->len = carry_len + n;
+    c->seq = seq;
+    return c;
+}
+
+static void splitter_run(void *arg) {
+    import_pipeline_t *p = arg;
+    char *carry = NULL;
+    size_t carry_len = 0, carry_cap = 0;
+    bool quoted = false;
+    unsigned long seq = 0;
+    for (;;) {
+        void *item;
+        if (!queue_pop(p, &p->raw, &item)) break;
+        import_chunk_t *b = item;
+        double t = lib_clock_ms();
+        size_t cut = b ? lib_csv_last_record_end(b->data, b->len, &quoted) : 0;
+        import_chunk_t *c = NULL;
+        bool emit = false;
+        if (!b) {
+            /* akhir file: sisa (record terakhir tanpa '\n') jadi potongan terakhir */
+            emit = carry_len > 0;
+            if (emit) c = make_chunk(carry, carry_len, "", 0, seq);
+            carry_len = 0;
+        } else if (cut) {
+            emit = true;
+            c = make_chunk(carry, carry_len, b->data, cut, seq);
+            carry_len = 0;
+        }
+        if (emit && !c) { chunk_free(b); pipeline_fail(p, LIB_ERR_MEMORY); break; }
+        if (c) seq++;
+        if (b && cut < b->len) {
+            size_t rest = b->len - cut;
+            if (carry_len + rest > carry_cap) {
+                size_t cap = carry_cap ? carry_cap : IMPORT_BLOCK;
+                while (cap < carry_len + rest) cap *= 2;
+                char *tmp = lib_heap_realloc(carry, cap);
+                if (!tmp) { chunk_free(b); chunk_free(c); pipeline_fail(p, LIB_ERR_MEMORY); break; }
+                carry = tmp;
+                carry_cap = cap;
+            }
+            memcpy(carry + carry_len, b->data + cut, rest);
+            carry_len += rest;
+        }
+        chunk_free(b);
+        p->split_ms += lib_clock_ms() - t;
+        if (c && !queue_push(p, &p->chunks, c)) { chunk_free(c); break; }
+        if (!b) {
+            lib_mutex_lock(&p->m);
+            p->total_chunks = seq;
+            p->split_done = true;
+            lib_cond_broadcast(&p->window_ready);
+            lib_mutex_unlock(&p->m);
+            for (unsigned i = 0; i < p->parsers; ++i) if (!queue_push(p, &p->chunks, NULL)) break;
+            break;
+        }
+    }
+    lib_heap_free(carry);
+}
+
+static import_batch_t *parse_chunk(const lib_import_table_t *t, import_chunk_t *c) {
+    import_batch_t *b = lib_heap_calloc(1, sizeof(*b));
+    if (!b) return NULL;
+    size_t cap = c->len / 64 + 16;
+    b->recs = lib_heap_malloc(cap * t->record_size);
+    if (!b->recs) { lib_heap_free(b); return NULL; }
+    lib_csv_field_t f[LIB_IMPORT_MAX_FIELDS];
+    char *cur = c->data, *end = c->data + c->len;
+    size_t n;
+    if (c->seq == 0) (void) lib_csv_next_in(&cur, end, f, t->max_fields);   /* header */
+    while ((n = lib_csv_next_in(&cur, end, f, t->max_fields)) > 0) {
+        if (b->count == cap) {
+            unsigned char *tmp = lib_heap_realloc(b->recs, cap * 2 * t->record_size);
+            if (!tmp) { batch_free(b); return NULL; }
+            b->recs = tmp;
+            cap *= 2;
+        }
+        if (t->parse(f, n, b->recs + b->count * t->record_size)) b->count++;
+        else b->skipped++;
+    }
+    return b;
+}
+
+static void parser_run(void *arg) {
+    import_pipeline_t *p = arg;
+    for (;;) {
+        void *item;
+        if (!queue_pop(p, &p->chunks, &item) || !item) return;
+        import_chunk_t *c = item;
+        double t = lib_clock_ms();
+        unsigned long seq = c->seq;
+        import_batch_t *b = parse_chunk(p->t, c);
+        chunk_free(c);
+        double dt = lib_clock_ms() - t;
+        if (!b) { pipeline_fail(p, LIB_ERR_MEMORY); return; }
+        lib_mutex_lock(&p->m);
+        p->parse_ms += dt;
+        while (seq >= p->next_seq + p->window_cap && !p->abort) lib_cond_wait(&p->window_free, &p->m);
+        if (p->abort) { lib_mutex_unlock(&p->m); batch_free(b); return; }
+        p->window[seq % p->window_cap] = b;
+        lib_cond_signal(&p->window_ready);
+        lib_mutex_unlock(&p->m);
+    }
+}
+
+/* Inserter (thread pemanggil): batch diambil tepat sesuai urutan potongan */
+static void inserter_run(import_pipeline_t *p, lib_import_stats_t *st) {
+    const lib_import_table_t *t = p->t;
+    for (;;) {
+        lib_mutex_lock(&p->m);
+        size_t slot = p->next_seq % p->window_cap;
+        while (!p->abort && !p->window[slot] && !(p->split_done && p->next_seq == p->total_chunks))
+            lib_cond_wait(&p->window_ready, &p->m);
+        import_batch_t *b = p->abort ? NULL : p->window[slot];
+        if (b) {
+            p->window[slot] = NULL;
+            p->next_seq++;
+            lib_cond_broadcast(&p->window_free);
+        }
+        lib_mutex_unlock(&p->m);
+        if (!b) return;
+        double t0 = lib_clock_ms();
+        lib_status_t err = LIB_OK;
+        for (size_t i = 0; i < b->count && err == LIB_OK; ++i) err = t->insert(t->ctx, b->recs + i * t->record_size);
+        st->rows += (unsigned long)b->count;
+        st->rows_skipped += (unsigned long)b->skipped;
+        batch_free(b);
+        st->insert_ms += lib_clock_ms() - t0;
+        if (err != LIB_OK) { pipeline_fail(p, err); return; }
+    }
+}
+
+static void free_chunk_item(void *item) { chunk_free(item); }
+
+lib_status_t lib_import_csv(const char *path, const lib_import_table_t *t, unsigned parsers,
+                            lib_import_stats_t *stats, bool *pipelined) {
+    if (pipelined) *pipelined = true;
+    if (!path || !t || !t->parse || !t->insert || t->max_fields == 0 ||
+        t->max_fields > LIB_IMPORT_MAX_FIELDS) return LIB_ERR_INVALID_ARG;
+    lib_import_stats_t local;
+    memset(&local, 0, sizeof(local));
+    if (parsers == 0) parsers = lib_cpu_count();
+    if (parsers > LIB_IMPORT_MAX_PARSERS) parsers = LIB_IMPORT_MAX_PARSERS;
+    double t_start = lib_clock_ms();
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return LIB_OK;
+    import_pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    p.t = t;
+    p.fp = fp;
+    p.parsers = parsers;
+    p.err = LIB_OK;
+    p.window_cap = 2 * (size_t)parsers;
+    p.window = lib_heap_calloc(p.window_cap, sizeof(*p.window));
+    bool ok = p.window && lib_mutex_init(&p.m);
+    if (ok && !queue_init(&p.raw, RAW_QUEUE_CAP)) ok = false;
+    if (ok && !queue_init(&p.chunks, 2 * (size_t)parsers)) { queue_destroy(&p.raw, free_chunk_item); ok = false; }
+    if (!ok) { lib_heap_free(p.window); fclose(fp); return LIB_ERR_MEMORY; }
+    lib_cond_init(&p.window_free);
+    lib_cond_init(&p.window_ready);
+
+    lib_thread_t reader, splitter, workers[LIB_IMPORT_MAX_PARSERS];
+    memset(workers, 0, sizeof(workers));
+    bool started = lib_thread_start(&reader, reader_run, &p);
+    started = lib_thread_start(&splitter, splitter_run, &p) && started;
+    for (unsigned i = 0; i < parsers; ++i) started = lib_thread_start(&workers[i], parser_run, &p) && started;
+
+    if (started) {
+        inserter_run(&p, &local);
+    } else {
+        if (pipelined) *pipelined = false;
+        pipeline_fail(&p, LIB_OK);
+    }
+    /* bangunkan tahap yang masih menunggu (mis. setelah error) lalu join */
+    pipeline_fail(&p, LIB_OK);
+    lib_thread_join(&reader);
+    lib_thread_join(&splitter);
+    for (unsigned i = 0; i < parsers; ++i) lib_thread_join(&workers[i]);
+
+    lib_status_t err = p.err;
+    for (size_t i = 0; i < p.window_cap; ++i) batch_free(p.window[i]);
+    lib_heap_free(p.window);
+    queue_destroy(&p.raw, free_chunk_item);
+    queue_destroy(&p.chunks, free_chunk_item);
+    lib_cond_destroy(&p.window_free);
+    lib_cond_destroy(&p.window_ready);
+    lib_mutex_destroy(&p.m);
+    fclose(fp);
+
+    if (stats && started) {
+        stats->parsers = parsers;
+        stats->rows += local.rows;
+        stats->rows_skipped += local.rows_skipped;
+        stats->chunks += p.total_chunks;
+        stats->bytes += p.bytes;
+        stats->read_ms += p.read_ms;
+        stats->split_ms += p.split_ms;
+        stats->parse_ms += p.parse_ms;
+        stats->insert_ms += local.insert_ms;
+        stats->total_ms += lib_clock_ms() - t_start;
+    }
+    return err;
+}
@@ -0,0 +1,442 @@
+/* lib_index.c
+ *
+ * Implementasi hash index open addressing untuk library.c
+ * - Linear probing, load factor maksimum 0.7, kapasitas pangkat dua
+ * - Penghapusan memakai backward-shift (tanpa tombstone) sehingga probe tetap pendek
+ * Ditambah trigram inverted index dan indeks kalender (lihat lib_index.h)
+ * Semua array dialokasikan lewat lib_mem_* (arena DB atau heap jika arena NULL)
+ *
+ * Standard: ISO C99
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../include/lib_index.h"
+#include "../include/lib_arena.h"
+
+#define HINDEX_MIN_CAPACITY 64
+
+static uint32_t slot_tag(uint64_t slot) { return (uint32_t)(slot >> 32); }
+static uint32_t slot_row(uint64_t slot) { return (uint32_t)(slot & 0xffffffffULL) - 1U; }
+static uint32_t hash_tag(uint64_t hash) { return (uint32_t)(hash >> 32); }
+
+uint64_t lib_hash_str(const char *s) {
+    uint64_t h = 1469598103934665603ULL;
+    if (s) {
+        for (const unsigned char *p = (const unsigned char *)s; *p; ++p) h = (h ^ *p) * 1099511628211ULL;
+    }
+    /* avalanche (splitmix64 finaliser) agar bit atas juga teracak */
+    return lib_hash_u64(h);
+}
+
+uint64_t lib_hash_u64(uint64_t v) {
+    v ^= v >> 33; v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33; v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return v;
+}
+
+void lib_hindex_init(lib_hindex_t *ix, struct lib_arena *arena) {
+    if (!ix) return;
+    ix->slots = NULL;
+    ix->capacity = 0;
+    ix->count = 0;
+    ix->arena = arena;
+}
+
+void lib_hindex_free(lib_hindex_t *ix) {
+    if (!ix) return;
+    lib_mem_release(ix->arena, ix->slots);
+    lib_hindex_init(ix, ix->arena);
+}
+
+void lib_hindex_clear(lib_hindex_t *ix) {
+    if (!ix) return;
+    if (ix->slots) memset(ix->slots, 0, ix->capacity * sizeof(uint64_t));
+    ix->count = 0;
+}
+
+static void place_slot(uint64_t *slots, size_t mask, uint64_t slot) {
+    size_t i = slot_tag(slot) & mask;
+    while (slots[i] != 0) i = (i + 1) & mask;
+    slots[i] = slot;
+}
+
+static bool rehash_to(lib_hindex_t *ix, size_t newcap) {
+    uint64_t *ns = lib_mem_calloc(ix->arena, newcap, sizeof(uint64_t));
+    if (!ns) return false;
+    for (size_t i = 0; i < ix->capacity; ++i) {
+        if (ix->slots[i] != 0) place_slot(ns, newcap - 1, ix->slots[i]);
+    }
+    lib_mem_release(ix->arena, ix->slots);
+    ix->slots = ns;
+    ix->capacity = newcap;
+    return true;
+}
+
+bool lib_hindex_reserve(lib_hindex_t *ix, size_t n) {
+    if (!ix) return false;
+    size_t need = HINDEX_MIN_CAPACITY;
+    while (need * 7 / 10 < n) need *= 2;
+    if (need <= ix->capacity) return true;
+    return rehash_to(ix, need);
+}
+
+bool lib_hindex_insert(lib_hindex_t *ix, uint64_t hash, uint32_t row) {
+    if (!ix || row == LIB_ROW_NONE) return false;
+    if (!lib_hindex_reserve(ix, ix->count + 1)) return false;
+    uint64_t slot = ((uint64_t)hash_tag(hash) << 32) | (uint64_t)(row + 1U);
+    place_slot(ix->slots, ix->capacity - 1, slot);
+    ix->count++;
+    return true;
+}
+
+uint32_t lib_hindex_find(const lib_hindex_t *ix, uint64_t hash,
+                         lib_hindex_eq_fn eq, const void *ctx, const void *key) {
+    if (!ix || ix->capacity == 0) return LIB_ROW_NONE;
+    size_t mask = ix->capacity - 1;
+    uint32_t tag = hash_tag(hash);
+    for (size_t i = tag & mask; ix->slots[i] != 0; i = (i + 1) & mask) {
+        uint64_t s = ix->slots[i];
+        if (slot_tag(s) == tag && eq(ctx, slot_row(s), key)) return slot_row(s);
+    }
+    return LIB_ROW_NONE;
+}
+
+uint32_t lib_hindex_find_next(const lib_hindex_t *ix, uint64_t hash,
+                              lib_hindex_eq_fn eq, const void *ctx, const void *key, size_t *pos) {
+    if (!ix || !pos || ix->capacity == 0) return LIB_ROW_NONE;
+    size_t mask = ix->capacity - 1;
+    uint32_t tag = hash_tag(hash);
+    /* *pos = jumlah slot probe yang sudah dilewati dari posisi awal */
+    for (size_t i = (tag + *pos) & mask; ix->slots[i] != 0; i = (i + 1) & mask) {
+        uint64_t s = ix->slots[i];
+        (*pos)++;
+        if (slot_tag(s) == tag && eq(ctx, slot_row(s), key)) return slot_row(s);
+    }
+    return LIB_ROW_NONE;
+}
+
+bool lib_hindex_remove(lib_hindex_t *ix, uint64_t hash, uint32_t row) {
+    if (!ix || ix->capacity == 0) return false;
+    size_t mask = ix->capacity - 1;
+    uint64_t want = ((uint64_t)hash_tag(hash) << 32) | (uint64_t)(row + 1U);
+    size_t i = hash_tag(hash) & mask;
+    while (ix->slots[i] != 0 && ix->slots[i] != want) i = (i + 1) & mask;
+    if (ix->slots[i] == 0) return false;
+    /* backward-shift: geser entri berikutnya yang "melewati" slot kosong */
+    size_t j = i;
+    for (;;) {
+        ix->slots[i] = 0;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (ix->slots[j] == 0) { ix->count--; return true; }
+            size_t home = slot_tag(ix->slots[j]) & mask;
+            /* entri j boleh dipindah ke i jika home tidak berada di (i, j] secara siklik */
+            bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+            if (movable) break;
+        }
+        ix->slots[i] = ix->slots[j];
+        i = j;
+    }
+}
+
+/* ---------- Trigram inverted index ---------- */
+
+#define TRIGRAM_MAX_QUERY 32
+
+static unsigned char fold_byte(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+static uint32_t trigram_at(const unsigned char *p) {
+    return ((uint32_t)fold_byte(p[0]) << 16) | ((uint32_t)fold_byte(p[1]) << 8) | (uint32_t)fold_byte(p[2]);
+}
+
+static uint64_t trigram_hash(uint32_t tri) {
+    return ((uint64_t)tri + 1ULL) * 0x9E3779B97F4A7C15ULL;
+}
+
+static bool eq_trigram(const void *ctx, uint32_t list, const void *key) {
+    const lib_trigram_index_t *tx = ctx;
+    return tx->lists[list].trigram == *(const uint32_t *)key;
+}
+
+static lib_posting_t *trigram_list(const lib_trigram_index_t *tx, uint32_t tri) {
+    uint32_t id = lib_hindex_find(&tx->lookup, trigram_hash(tri), eq_trigram, tx, &tri);
+    return id == LIB_ROW_NONE ? NULL : &tx->lists[id];
+}
+
+/* Posisi pertama dengan rows[pos] >= row */
+static uint32_t posting_lower_bound(const lib_posting_t *pl, uint32_t from, uint32_t row) {
+    uint32_t lo = from, hi = pl->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (pl->rows[mid] < row) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+void lib_trigram_init(lib_trigram_index_t *tx, struct lib_arena *arena) {
+    if (!tx) return;
+    lib_hindex_init(&tx->lookup, arena);
+    tx->lists = NULL;
+    tx->list_count = 0;
+    tx->list_capacity = 0;
+    tx->arena = arena;
+}
+
+void lib_trigram_free(lib_trigram_index_t *tx) {
+    if (!tx) return;
+    if (!tx->arena) {
+        for (size_t i = 0; i < tx->list_count; ++i) lib_heap_free(tx->lists[i].rows);
+        lib_heap_free(tx->lists);
+    }
+    lib_hindex_free(&tx->lookup);
+    lib_trigram_init(tx, tx->arena);
+}
+
+void lib_trigram_clear(lib_trigram_index_t *tx) {
+    if (!tx) return;
+    for (size_t i = 0; i < tx->list_count; ++i) tx->lists[i].count = 0;
+}
+
+static lib_posting_t *trigram_list_create(lib_trigram_index_t *tx, uint32_t tri) {
+    if (tx->list_count >= tx->list_capacity) {
+        size_t newcap = tx->list_capacity ? tx->list_capacity * 2 : 1024;
+        lib_posting_t *t = lib_mem_grow(tx->arena, tx->lists, tx->list_capacity * sizeof(lib_posting_t),
+                                        newcap * sizeof(lib_posting_t));
+        if (!t) return NULL;
+        tx->lists = t;
+        tx->list_capacity = newcap;
+    }
+    uint32_t id = (uint32_t)tx->list_count;
+    if (!lib_hindex_insert(&tx->lookup, trigram_hash(tri), id)) return NULL;
+    lib_posting_t *pl = &tx->lists[tx->list_count++];
+    pl->trigram = tri;
+    pl->count = 0;
+    pl->capacity = 0;
+    pl->rows = NULL;
+    return pl;
+}
+
+static bool posting_insert(lib_trigram_index_t *tx, lib_posting_t *pl, uint32_t row) {
+    /* jalur cepat: baris baru selalu paling besar saat tabel di-append */
+    uint32_t pos = (pl->count == 0 || pl->rows[pl->count - 1] < row) ? pl->count : posting_lower_bound(pl, 0, row);
+    if (pos < pl->count && pl->rows[pos] == row) return true;
+    if (pl->count >= pl->capacity) {
+        uint32_t newcap = pl->capacity ? pl->capacity * 2 : 4;
+        uint32_t *t = lib_mem_grow(tx->arena, pl->rows, (size_t)pl->capacity * sizeof(uint32_t),
+                                   (size_t)newcap * sizeof(uint32_t));
+        if (!t) return false;
+        pl->rows = t;
+        pl->capacity = newcap;
+    }
+    if (pos < pl->count) memmove(&pl->rows[pos + 1], &pl->rows[pos], (size_t)(pl->count - pos) * sizeof(uint32_t));
+    pl->rows[pos] = row;
+    pl->count++;
+    return true;
+}
+
+bool lib_trigram_add(lib_trigram_index_t *tx, uint32_t row, const char *text) {
+    if (!tx || !text) return false;
+    const unsigned char *p = (const unsigned char *)text;
+    size_t len = strlen(text);
+    for (size_t i = 0; i + 3 <= len; ++i) {
+        uint32_t tri = trigram_at(p + i);
+        lib_posting_t *pl = trigram_list(tx, tri);
+        if (!pl) pl = trigram_list_create(tx, tri);
+        if (!pl || !posting_insert(tx, pl, row)) return false;
+    }
+    return true;
+}
+
+void lib_trigram_remove(lib_trigram_index_t *tx, uint32_t row, const char *text) {
+    if (!tx || !text) return;
+    const unsigned char *p = (const unsigned char *)text;
+    size_t len = strlen(text);
+    for (size_t i = 0; i + 3 <= len; ++i) {
+        lib_posting_t *pl = trigram_list(tx, trigram_at(p + i));
+        if (!pl) continue;
+        uint32_t pos = posting_lower_bound(pl, 0, row);
+        if (pos >= pl->count || pl->rows[pos] != row) continue;
+        memmove(&pl->rows[pos], &pl->rows[pos + 1], (size_t)(pl->count - pos - 1) * sizeof(uint32_t));
+        pl->count--;
+    }
+}
+
+void lib_trigram_remap(lib_trigram_index_t *tx, const uint32_t *map, size_t rows) {
+    if (!tx || !map) return;
+    for (size_t i = 0; i < tx->list_count; ++i) {
+        lib_posting_t *pl = &tx->lists[i];
+        uint32_t w = 0;
+        for (uint32_t j = 0; j < pl->count; ++j) {
+            uint32_t r = pl->rows[j];
+            if (r < rows && map[r] != LIB_ROW_NONE) pl->rows[w++] = map[r];
+        }
+        pl->count = w;
+    }
+}
+
+/* Maju ke posisi pertama >= row memakai galloping (exponential) search. */
+static uint32_t posting_seek(const lib_posting_t *pl, uint32_t from, uint32_t row) {
+    uint32_t step = 1, hi = from;
+    while (hi < pl->count && pl->rows[hi] < row) {
+        from = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    if (hi > pl->count) hi = pl->count;
+    uint32_t lo = from;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (pl->rows[mid] < row) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+bool lib_trigram_query(const lib_trigram_index_t *tx, const char *needle,
+                       lib_trigram_visit_fn visit, void *ctx) {
+    if (!tx || !needle || !visit) return false;
+    size_t len = strlen(needle);
+    if (len < 3) return false;
+    const lib_posting_t *lists[TRIGRAM_MAX_QUERY];
+    size_t n = 0;
+    const unsigned char *p = (const unsigned char *)needle;
+    /* needle yang sangat panjang cukup memakai TRIGRAM_MAX_QUERY trigram pertama;
+       hasil tetap superset karena pemanggil memverifikasi substring */
+    for (size_t i = 0; i + 3 <= len && n < TRIGRAM_MAX_QUERY; ++i) {
+        const lib_posting_t *pl = trigram_list(tx, trigram_at(p + i));
+        if (!pl || pl->count == 0) return true; /* ada trigram tanpa posting: tidak ada hasil */
+        bool dup = false;
+        for (size_t k = 0; k < n; ++k) if (lists[k] == pl) { dup = true; break; }
+        if (!dup) lists[n++] = pl;
+    }
+    /* urutkan dari posting list terpendek (insertion sort, n kecil) */
+    for (size_t i = 1; i < n; ++i) {
+        const lib_posting_t *t = lists[i];
+        size_t j = i;
+        while (j > 0 && lists[j - 1]->count > t->count) { lists[j] = lists[j - 1]; j--; }
+        lists[j] = t;
+    }
+    uint32_t cursor[TRIGRAM_MAX_QUERY] = {0};
+    const lib_posting_t *base = lists[0];
+    for (uint32_t bi = 0; bi < base->count; ++bi) {
+        uint32_t row = base->rows[bi];
+        bool all = true;
+        for (size_t k = 1; k < n; ++k) {
+            cursor[k] = posting_seek(lists[k], cursor[k], row);
+            if (cursor[k] >= lists[k]->count) return true; /* list habis: tidak ada irisan lagi */
+            if (lists[k]->rows[cursor[k]] != row) { all = false; break; }
+        }
+        if (all && !visit(ctx, row)) return true;
+    }
+    return true;
+}
+
+/* ---------- Calendar bucket index ---------- */
+
+/* Penanda baris yang tidak ada di indeks (next[row]) */
+#define CALENDAR_ABSENT (LIB_ROW_NONE - 1U)
+
+void lib_calendar_init(lib_calendar_index_t *cx, struct lib_arena *arena) {
+    memset(cx, 0, sizeof(*cx));
+    cx->arena = arena;
+}
+
+void lib_calendar_free(lib_calendar_index_t *cx) {
+    lib_mem_release(cx->arena, cx->buckets);
+    lib_mem_release(cx->arena, cx->next);
+    lib_mem_release(cx->arena, cx->prev);
+    lib_mem_release(cx->arena, cx->day_of);
+    lib_calendar_init(cx, cx->arena);
+}
+
+void lib_calendar_clear(lib_calendar_index_t *cx) {
+    cx->bucket_count = 0;
+    cx->count = 0;
+    for (size_t i = 0; i < cx->row_capacity; ++i) cx->next[i] = CALENDAR_ABSENT;
+}
+
+bool lib_calendar_reserve(lib_calendar_index_t *cx, size_t n) {
+    if (n <= cx->row_capacity) return true;
+    size_t cap = cx->row_capacity ? cx->row_capacity : 64;
+    while (cap < n) cap *= 2;
+    uint32_t *nx = lib_mem_grow(cx->arena, cx->next, cx->row_capacity * sizeof(uint32_t), cap * sizeof(uint32_t));
+    if (!nx) return false;
+    cx->next = nx;
+    uint32_t *pv = lib_mem_grow(cx->arena, cx->prev, cx->row_capacity * sizeof(uint32_t), cap * sizeof(uint32_t));
+    if (!pv) return false;
+    cx->prev = pv;
+    int32_t *d = lib_mem_grow(cx->arena, cx->day_of, cx->row_capacity * sizeof(int32_t), cap * sizeof(int32_t));
+    if (!d) return false;
+    cx->day_of = d;
+    for (size_t i = cx->row_capacity; i < cap; ++i) cx->next[i] = CALENDAR_ABSENT;
+    cx->row_capacity = cap;
+    return true;
+}
+
+/* Posisi bucket pertama dengan day >= `day` */
+static size_t bucket_lower_bound(const lib_calendar_index_t *cx, int32_t day) {
+    size_t lo = 0, hi = cx->bucket_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cx->buckets[mid].day < day) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+bool lib_calendar_add(lib_calendar_index_t *cx, uint32_t row, int32_t day) {
+    if (!lib_calendar_reserve(cx, (size_t)row + 1)) return false;
+    size_t b = bucket_lower_bound(cx, day);
+    if (b == cx->bucket_count || cx->buckets[b].day != day) {
+        /* hari baru: sisipkan bucket (jumlah hari berbeda kecil, memmove murah) */
+        if (cx->bucket_count == cx->bucket_capacity) {
+            size_t cap = cx->bucket_capacity ? cx->bucket_capacity * 2 : 64;
+            lib_day_bucket_t *nb = lib_mem_grow(cx->arena, cx->buckets, cx->bucket_capacity * sizeof(*nb), cap * sizeof(*nb));
+            if (!nb) return false;
+            cx->buckets = nb;
+            cx->bucket_capacity = cap;
+        }
+        memmove(&cx->buckets[b + 1], &cx->buckets[b], (cx->bucket_count - b) * sizeof(cx->buckets[0]));
+        cx->buckets[b].day = day;
+        cx->buckets[b].head = LIB_ROW_NONE;
+        cx->buckets[b].count = 0;
+        cx->bucket_count++;
+    }
+    lib_day_bucket_t *bk = &cx->buckets[b];
+    cx->next[row] = bk->head;
+    cx->prev[row] = LIB_ROW_NONE;
+    if (bk->head != LIB_ROW_NONE) cx->prev[bk->head] = row;
+    bk->head = row;
+    bk->count++;
+    cx->day_of[row] = day;
+    cx->count++;
+    return true;
+}
+
+void lib_calendar_remove(lib_calendar_index_t *cx, uint32_t row) {
+    if (row >= cx->row_capacity || cx->next[row] == CALENDAR_ABSENT) return;
+    size_t b = bucket_lower_bound(cx, cx->day_of[row]);
+    if (b == cx->bucket_count || cx->buckets[b].day != cx->day_of[row]) return;
+    lib_day_bucket_t *bk = &cx->buckets[b];
+    uint32_t nx = cx->next[row], pv = cx->prev[row];
+    if (pv != LIB_ROW_NONE) cx->next[pv] = nx;
+    else bk->head = nx;
+    if (nx != LIB_ROW_NONE) cx->prev[nx] = pv;
+    cx->next[row] = CALENDAR_ABSENT;
+    cx->count--;
+    if (--bk->count == 0) {
+        memmove(&cx->buckets[b], &cx->buckets[b + 1], (cx->bucket_count - b - 1) * sizeof(cx->buckets[0]));
+        cx->bucket_count--;
+    }
+}
+
+void lib_calendar_query(const lib_calendar_index_t *cx, int32_t lo, int32_t hi,
+                        lib_calendar_visit_fn visit, void *ctx) {
+    for (size_t b = bucket_lower_bound(cx, lo); b < cx->bucket_count && cx->buckets[b].day <= hi; ++b) {
+        for (uint32_t row = cx->buckets[b].head; row != LIB_ROW_NONE; row = cx->next[row])
+            if (!visit(ctx, row, cx->buckets[b].day)) return;
+    }
+}
@@ -0,0 +1,248 @@
+/* lib_journal.c
+ *
+ * Write-ahead journal append-only (lihat lib_journal.h).
+ * - Commit = satu fwrite untuk semua record pending + fflush + fsync
+ * - Group commit: write (fflush ke OS) dan fsync bisa dipisah; fsync menyusul
+ *   untuk semua write sejak fsync terakhir
+ * - Replay membaca seluruh file sekaligus lalu memverifikasi CRC per baris;
+ *   baris pertama yang rusak/terpotong menandai akhir journal yang sah
+ *
+ * Standard: ISO C99
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include "../include/lib_journal.h"
+#include "../include/lib_arena.h"
+#include "../include/lib_thread.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <io.h>
+  #include <fcntl.h>
+  #include <windows.h>
+#else
+  #include <unistd.h>
+  #include <time.h>
+#endif
+
+/* ---------- CRC32 (IEEE, reflected) ---------- */
+
+static uint32_t crc_table[256];
+static lib_once_t crc_once = LIB_ONCE_INIT;
+
+static void crc_init(void) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32_of(const char *data, size_t len) {
+    lib_once(&crc_once, crc_init);
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) c = crc_table[(c ^ (unsigned char)data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+/* ---------- file helpers ---------- */
+
+static double monotonic_ms(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    return (double)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+#endif
+}
+
+static int sync_file(FILE *fp) {
+    if (fflush(fp) != 0) return -1;
+#if defined(_WIN32) || defined(_WIN64)
+    return _commit(_fileno(fp)) == 0 ? 0 : -1;
+#else
+    return fsync(fileno(fp)) == 0 ? 0 : -1;
+#endif
+}
+
+static int truncate_file(const char *path, long size) {
+#if defined(_WIN32) || defined(_WIN64)
+    int fd = _open(path, _O_RDWR | _O_BINARY);
+    if (fd < 0) return -1;
+    int rc = _chsize(fd, size);
+    _close(fd);
+    return rc == 0 ? 0 : -1;
+#else
+    return truncate(path, (off_t)size) == 0 ? 0 : -1;
+#endif
+}
+
+/* ---------- public ---------- */
+
+lib_journal_t *lib_journal_open(const char *path) {
+    if (!path) return NULL;
+    lib_journal_t *j = lib_heap_calloc(1, sizeof(*j));
+    if (!j) return NULL;
+    size_t len = strlen(path) + 1;
+    j->path = lib_heap_malloc(len);
+    if (!j->path) { lib_heap_free(j); return NULL; }
+    memcpy(j->path, path, len);
+    return j;
+}
+
+void lib_journal_close(lib_journal_t *j) {
+    if (!j) return;
+    if (j->fp) fclose(j->fp);
+    lib_heap_free(j->pending);
+    lib_heap_free(j->path);
+    lib_heap_free(j);
+}
+
+bool lib_journal_append(lib_journal_t *j, char op, const char *payload) {
+    if (!j || !payload) return false;
+    size_t plen = strlen(payload);
+    /* Journal berbasis baris: field CSV berisi baris baru hanya aman lewat snapshot */
+    if (memchr(payload, '\n', plen)) { j->need_checkpoint = true; return false; }
+    size_t need = j->pending_len + 8 + 1 + 1 + 1 + plen + 1 + 1;
+    if (need > j->pending_cap) {
+        size_t cap = j->pending_cap ? j->pending_cap : 1024;
+        while (cap < need) cap *= 2;
+        char *tmp = lib_heap_realloc(j->pending, cap);
+        if (!tmp) { j->need_checkpoint = true; return false; }
+        j->pending = tmp;
+        j->pending_cap = cap;
+    }
+    char *rec = j->pending + j->pending_len + 9;   /* "<op> <payload>" setelah "xxxxxxxx " */
+    rec[0] = op;
+    rec[1] = ' ';
+    memcpy(rec + 2, payload, plen);
+    uint32_t crc = crc32_of(rec, plen + 2);
+    char hex[10];
+    snprintf(hex, sizeof(hex), "%08lx ", (unsigned long)crc);
+    memcpy(j->pending + j->pending_len, hex, 9);
+    rec[plen + 2] = '\n';
+    j->pending_len += 9 + plen + 3;
+    j->pending_records++;
+    return true;
+}
+
+int lib_journal_write(lib_journal_t *j) {
+    if (!j) return -1;
+    if (j->pending_len == 0) return 0;
+    if (!j->fp) {
+        j->fp = fopen(j->path, "ab");
+        if (!j->fp) return -1;
+    }
+    if (fwrite(j->pending, 1, j->pending_len, j->fp) != j->pending_len || fflush(j->fp) != 0) {
+        /* sebagian record mungkin sudah tertulis; replay akan membuang ekor yang
+         * terpotong, tapi isi journal tidak lagi bisa dipercaya -> checkpoint */
+        fclose(j->fp);
+        j->fp = NULL;
+        j->need_checkpoint = true;
+        return -1;
+    }
+    if (j->unsynced_records == 0) j->unsynced_since_ms = monotonic_ms();
+    j->unsynced_records += j->pending_records;
+    j->entries += j->pending_records;
+    j->pending_len = 0;
+    j->pending_records = 0;
+    return 0;
+}
+
+int lib_journal_sync(lib_journal_t *j) {
+    if (!j) return -1;
+    if (j->unsynced_records == 0 || !j->fp) return 0;
+    if (sync_file(j->fp) != 0) {
+        j->need_checkpoint = true;
+        return -1;
+    }
+    j->unsynced_records = 0;
+    return 0;
+}
+
+int lib_journal_commit(lib_journal_t *j) {
+    if (lib_journal_write(j) != 0) return -1;
+    return lib_journal_sync(j);
+}
+
+double lib_journal_unsynced_age_ms(const lib_journal_t *j) {
+    if (!j || j->unsynced_records == 0) return 0.0;
+    return monotonic_ms() - j->unsynced_since_ms;
+}
+
+void lib_journal_discard(lib_journal_t *j) {
+    if (!j) return;
+    j->pending_len = 0;
+    j->pending_records = 0;
+}
+
+int lib_journal_reset(lib_journal_t *j) {
+    if (!j) return -1;
+    if (j->fp) { fclose(j->fp); j->fp = NULL; }
+    lib_journal_discard(j);
+    j->entries = 0;
+    j->unsynced_records = 0;
+    if (remove(j->path) != 0 && errno != ENOENT) {
+        /* tidak bisa dihapus: kosongkan isinya */
+        FILE *f = fopen(j->path, "wb");
+        if (!f) return -1;
+        fclose(f);
+    }
+    j->need_checkpoint = false;
+    return 0;
+}
+
+size_t lib_journal_replay(lib_journal_t *j, lib_journal_apply_fn apply, void *ctx) {
+    if (!j || !apply) return 0;
+    FILE *f = fopen(j->path, "rb");
+    if (!f) return 0;
+    char *buf = NULL;
+    size_t len = 0, cap = 0, n;
+    char chunk[65536];
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        if (len + n + 1 > cap) {
+            size_t newcap = cap ? cap * 2 : sizeof(chunk) * 2;
+            while (newcap < len + n + 1) newcap *= 2;
+            char *tmp = lib_heap_realloc(buf, newcap);
+            if (!tmp) { lib_heap_free(buf); fclose(f); j->need_checkpoint = true; return 0; }
+            buf = tmp;
+            cap = newcap;
+        }
+        memcpy(buf + len, chunk, n);
+        len += n;
+    }
+    fclose(f);
+    if (!buf) return 0;
+
+    size_t applied = 0, pos = 0;
+    while (pos < len) {
+        char *line = buf + pos;
+        char *nl = memchr(line, '\n', len - pos);
+        if (!nl) break;                          /* record terakhir terpotong */
+        size_t line_len = (size_t)(nl - line);
+        if (line_len < 11 || line[8] != ' ' || line[10] != ' ') break;
+        char hex[9];
+        memcpy(hex, line, 8);
+        hex[8] = '\0';
+        char *end = NULL;
+        unsigned long want = strtoul(hex, &end, 16);
+        if (end != hex + 8 || (uint32_t)want != crc32_of(line + 9, line_len - 9)) break;
+        *nl = '\0';
+        apply(ctx, line[9], line + 11);
+        applied++;
+        pos += line_len + 1;
+    }
+    lib_heap_free(buf);
+    if (pos < len) {
+        /* buang ekor yang rusak agar append berikutnya tidak tertahan di belakangnya */
+        if (truncate_file(j->path, (long)pos) != 0) j->need_checkpoint = true;
+    }
+    j->entries = applied;
+    return applied;
+}
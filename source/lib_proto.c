@@ -0,0 +1,359 @@
+/* lib_proto.c
+ *
+ * Implementasi lib_proto.h: encoder/decoder frame dan klien blocking.
+ * Buffer tulis tumbuh dua kali lipat lewat lib_heap_*; gagal alokasi hanya
+ * menandai oom sehingga pemanggil cukup memeriksa sekali di akhir frame.
+ * Klien tersedia di POSIX (AF_UNIX); di platform lain connect selalu gagal.
+ *
+ * Standard: ISO C99
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include "../include/lib_proto.h"
+#include "../include/lib_arena.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  #include <errno.h>
+  #include <unistd.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #define LIB_PROTO_HAVE_UNIX 1
+  #ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0   /* macOS: tanpa flag ini, SIGPIPE diabaikan pemanggil */
+  #endif
+#endif
+
+/* ---------- lib_wbuf_t ---------- */
+
+void lib_wbuf_init(lib_wbuf_t *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+void lib_wbuf_free(lib_wbuf_t *w) {
+    lib_heap_free(w->data);
+    lib_wbuf_init(w);
+}
+
+static unsigned char *wbuf_reserve(lib_wbuf_t *w, size_t n) {
+    if (w->oom) return NULL;
+    if (w->len + n > w->cap) {
+        size_t cap = w->cap ? w->cap : 256;
+        while (cap < w->len + n) cap *= 2;
+        unsigned char *p = lib_heap_realloc(w->data, cap);
+        if (!p) { w->oom = true; return NULL; }
+        w->data = p;
+        w->cap = cap;
+    }
+    unsigned char *p = w->data + w->len;
+    w->len += n;
+    return p;
+}
+
+static void put_le(unsigned char *p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint64_t get_le(const unsigned char *p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+void lib_wbuf_put_u8(lib_wbuf_t *w, uint8_t v) {
+    unsigned char *p = wbuf_reserve(w, 1);
+    if (p) *p = v;
+}
+
+void lib_wbuf_put_u16(lib_wbuf_t *w, uint16_t v) {
+    unsigned char *p = wbuf_reserve(w, 2);
+    if (p) put_le(p, v, 2);
+}
+
+void lib_wbuf_put_u32(lib_wbuf_t *w, uint32_t v) {
+    unsigned char *p = wbuf_reserve(w, 4);
+    if (p) put_le(p, v, 4);
+}
+
+void lib_wbuf_put_u64(lib_wbuf_t *w, uint64_t v) {
+    unsigned char *p = wbuf_reserve(w, 8);
+    if (p) put_le(p, v, 8);
+}
+
+void lib_wbuf_put_str(lib_wbuf_t *w, const char *s) {
+    size_t n = s ? strlen(s) : 0;
+    if (n > UINT16_MAX) n = UINT16_MAX;
+    lib_wbuf_put_u16(w, (uint16_t)n);
+    unsigned char *p = wbuf_reserve(w, n);
+    if (p && n) memcpy(p, s, n);
+}
+
+size_t lib_wbuf_begin_frame(lib_wbuf_t *w) {
+    size_t at = w->len;
+    lib_wbuf_put_u32(w, 0);
+    return at;
+}
+
+void lib_wbuf_end_frame(lib_wbuf_t *w, size_t at) {
+    if (w->oom) return;
+    put_le(w->data + at, (uint64_t)(w->len - at - 4), 4);
+}
+
+/* ---------- lib_rbuf_t ---------- */
+
+void lib_rbuf_init(lib_rbuf_t *r, const void *data, size_t len) {
+    r->data = data;
+    r->len = len;
+    r->pos = 0;
+    r->bad = false;
+}
+
+static const unsigned char *rbuf_take(lib_rbuf_t *r, size_t n) {
+    if (r->bad || r->len - r->pos < n) { r->bad = true; return NULL; }
+    const unsigned char *p = r->data + r->pos;
+    r->pos += n;
+    return p;
+}
+
+uint8_t lib_rbuf_get_u8(lib_rbuf_t *r) {
+    const unsigned char *p = rbuf_take(r, 1);
+    return p ? *p : 0;
+}
+
+uint16_t lib_rbuf_get_u16(lib_rbuf_t *r) {
+    const unsigned char *p = rbuf_take(r, 2);
+    return p ? (uint16_t)get_le(p, 2) : 0;
+}
+
+uint32_t lib_rbuf_get_u32(lib_rbuf_t *r) {
+    const unsigned char *p = rbuf_take(r, 4);
+    return p ? (uint32_t)get_le(p, 4) : 0;
+}
+
+uint64_t lib_rbuf_get_u64(lib_rbuf_t *r) {
+    const unsigned char *p = rbuf_take(r, 8);
+    return p ? get_le(p, 8) : 0;
+}
+
+void lib_rbuf_get_str(lib_rbuf_t *r, char *out, size_t out_sz) {
+    size_t n = lib_rbuf_get_u16(r);
+    const unsigned char *p = rbuf_take(r, n);
+    if (!out || out_sz == 0) return;
+    size_t k = p ? (n < out_sz - 1 ? n : out_sz - 1) : 0;
+    if (k) memcpy(out, p, k);
+    out[k] = '\0';
+}
+
+/* ---------- klien ---------- */
+
+struct lib_client {
+    int fd;
+    uint32_t next_tag;
+    lib_wbuf_t req;
+    unsigned char *resp;     /* isi frame response terakhir */
+    size_t resp_cap;
+};
+
+#if defined(LIB_PROTO_HAVE_UNIX)
+
+lib_client_t *lib_client_connect(const char *socket_path, lib_status_t *err) {
+    if (err) *err = LIB_ERR_INVALID_ARG;
+    struct sockaddr_un addr;
+    if (!socket_path || strlen(socket_path) >= sizeof(addr.sun_path)) return NULL;
+    if (err) *err = LIB_ERR_IO;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) { close(fd); return NULL; }
+    lib_client_t *c = lib_heap_calloc(1, sizeof(*c));
+    if (!c) { close(fd); if (err) *err = LIB_ERR_MEMORY; return NULL; }
+    c->fd = fd;
+    lib_wbuf_init(&c->req);
+    if (err) *err = LIB_OK;
+    return c;
+}
+
+void lib_client_close(lib_client_t *c) {
+    if (!c) return;
+    close(c->fd);
+    lib_wbuf_free(&c->req);
+    lib_heap_free(c->resp);
+    lib_heap_free(c);
+}
+
+static bool write_all(int fd, const unsigned char *p, size_t n) {
+    while (n > 0) {
+        ssize_t k = send(fd, p, n, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        n -= (size_t)k;
+    }
+    return true;
+}
+
+static bool read_all(int fd, unsigned char *p, size_t n) {
+    while (n > 0) {
+        ssize_t k = recv(fd, p, n, 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        n -= (size_t)k;
+    }
+    return true;
+}
+
+#else
+
+lib_client_t *lib_client_connect(const char *socket_path, lib_status_t *err) {
+    (void)socket_path;
+    if (err) *err = LIB_ERR_IO;
+    return NULL;
+}
+
+void lib_client_close(lib_client_t *c) {
+    (void)c;
+}
+
+static bool write_all(int fd, const unsigned char *p, size_t n) {
+    (void)fd; (void)p; (void)n;
+    return false;
+}
+
+static bool read_all(int fd, unsigned char *p, size_t n) {
+    (void)fd; (void)p; (void)n;
+    return false;
+}
+
+#endif
+
+/* Mulai request baru di c->req; kembalikan posisi frame */
+static size_t request_begin(lib_client_t *c, lib_proto_op_t op) {
+    c->req.len = 0;
+    c->req.oom = false;
+    size_t at = lib_wbuf_begin_frame(&c->req);
+    lib_wbuf_put_u8(&c->req, (uint8_t)op);
+    lib_wbuf_put_u32(&c->req, ++c->next_tag);
+    return at;
+}
+
+/* Kirim request, tunggu response-nya. *r menunjuk payload setelah status. */
+static lib_status_t request_call(lib_client_t *c, size_t at, lib_rbuf_t *r) {
+    lib_wbuf_end_frame(&c->req, at);
+    if (c->req.oom) return LIB_ERR_MEMORY;
+    if (!write_all(c->fd, c->req.data, c->req.len)) return LIB_ERR_IO;
+    unsigned char hdr[4];
+    if (!read_all(c->fd, hdr, sizeof(hdr))) return LIB_ERR_IO;
+    size_t n = (size_t)get_le(hdr, 4);
+    if (n < 5 || n > LIB_PROTO_MAX_FRAME) return LIB_ERR_IO;
+    if (n > c->resp_cap) {
+        unsigned char *p = lib_heap_realloc(c->resp, n);
+        if (!p) return LIB_ERR_MEMORY;
+        c->resp = p;
+        c->resp_cap = n;
+    }
+    if (!read_all(c->fd, c->resp, n)) return LIB_ERR_IO;
+    lib_rbuf_init(r, c->resp, n);
+    uint32_t tag = lib_rbuf_get_u32(r);
+    int8_t status = (int8_t)lib_rbuf_get_u8(r);
+    if (tag != c->next_tag) return LIB_ERR_IO;
+    return (lib_status_t)status;
+}
+
+lib_status_t lib_client_checkout(lib_client_t *c, lib_isbn_t isbn, const char *nim,
+                                 lib_date_t date_borrow, lib_date_t date_due, lib_id_t *out_loan_id) {
+    if (!c || !nim) return LIB_ERR_INVALID_ARG;
+    size_t at = request_begin(c, LIB_OP_CHECKOUT);
+    lib_wbuf_put_u64(&c->req, isbn);
+    lib_wbuf_put_str(&c->req, nim);
+    lib_wbuf_put_u32(&c->req, (uint32_t)lib_date_to_days(date_borrow));
+    lib_wbuf_put_u32(&c->req, (uint32_t)lib_date_to_days(date_due));
+    lib_rbuf_t r;
+    lib_status_t st = request_call(c, at, &r);
+    if (st != LIB_OK && st != LIB_ERR_NOT_DURABLE) return st;
+    lib_id_t id = lib_rbuf_get_u64(&r);
+    if (r.bad) return LIB_ERR_IO;
+    if (out_loan_id) *out_loan_id = id;
+    return st;
+}
+
+lib_status_t lib_client_return(lib_client_t *c, lib_id_t loan_id, lib_date_t date_return,
+                               unsigned long *out_fine) {
+    if (!c) return LIB_ERR_INVALID_ARG;
+    size_t at = request_begin(c, LIB_OP_RETURN);
+    lib_wbuf_put_u64(&c->req, loan_id);
+    lib_wbuf_put_u32(&c->req, (uint32_t)lib_date_to_days(date_return));
+    lib_rbuf_t r;
+    lib_status_t st = request_call(c, at, &r);
+    if (st != LIB_OK && st != LIB_ERR_NOT_DURABLE) return st;
+    uint64_t fine = lib_rbuf_get_u64(&r);
+    if (r.bad) return LIB_ERR_IO;
+    if (out_fine) *out_fine = (unsigned long)fine;
+    return st;
+}
+
+lib_status_t lib_client_search(lib_client_t *c, bool by_author, const char *query,
+                               lib_proto_book_t *out, size_t out_capacity, size_t *out_count) {
+    if (out_count) *out_count = 0;
+    if (!c || !query || (!out && out_capacity)) return LIB_ERR_INVALID_ARG;
+    size_t want = out_capacity < LIB_PROTO_MAX_RESULTS ? out_capacity : LIB_PROTO_MAX_RESULTS;
+    size_t at = request_begin(c, LIB_OP_SEARCH);
+    lib_wbuf_put_u8(&c->req, by_author ? 1 : 0);
+    lib_wbuf_put_u16(&c->req, (uint16_t)want);
+    lib_wbuf_put_str(&c->req, query);
+    lib_rbuf_t r;
+    lib_status_t st = request_call(c, at, &r);
+    if (st != LIB_OK) return st;
+    size_t n = lib_rbuf_get_u16(&r);
+    if (n > want) return LIB_ERR_IO;
+    for (size_t i = 0; i < n; ++i) {
+        lib_proto_book_t *b = &out[i];
+        b->isbn = lib_rbuf_get_u64(&r);
+        b->available = (int32_t)lib_rbuf_get_u32(&r);
+        b->total_stock = (int32_t)lib_rbuf_get_u32(&r);
+        lib_rbuf_get_str(&r, b->title, sizeof(b->title));
+        lib_rbuf_get_str(&r, b->author, sizeof(b->author));
+    }
+    if (r.bad) return LIB_ERR_IO;
+    if (out_count) *out_count = n;
+    return LIB_OK;
+}
+
+lib_status_t lib_client_borrower(lib_client_t *c, const char *nim, bool create, const char *name,
+                                 lib_proto_borrower_t *out) {
+    if (!c || !nim) return LIB_ERR_INVALID_ARG;
+    size_t at = request_begin(c, LIB_OP_BORROWER);
+    lib_wbuf_put_str(&c->req, nim);
+    lib_wbuf_put_u8(&c->req, create ? 1 : 0);
+    lib_wbuf_put_str(&c->req, name ? name : "");
+    lib_rbuf_t r;
+    lib_status_t st = request_call(c, at, &r);
+    if (st != LIB_OK && st != LIB_ERR_NOT_DURABLE) return st;
+    lib_proto_borrower_t b;
+    b.id = lib_rbuf_get_u64(&r);
+    lib_rbuf_get_str(&r, b.name, sizeof(b.name));
+    b.active_loans = lib_rbuf_get_u16(&r);
+    if (r.bad) return LIB_ERR_IO;
+    if (out) *out = b;
+    return st;
+}
+
+lib_status_t lib_client_report(lib_client_t *c, lib_proto_report_t *out) {
+    if (!c || !out) return LIB_ERR_INVALID_ARG;
+    size_t at = request_begin(c, LIB_OP_REPORT);
+    lib_rbuf_t r;
+    lib_status_t st = request_call(c, at, &r);
+    if (st != LIB_OK) return st;
+    memset(out, 0, sizeof(*out));
+    out->stock.titles = (size_t)lib_rbuf_get_u64(&r);
+    out->stock.total_stock = (long)(int64_t)lib_rbuf_get_u64(&r);
+    out->stock.available = (long)(int64_t)lib_rbuf_get_u64(&r);
+    out->stock.borrowed = (long)(int64_t)lib_rbuf_get_u64(&r);
+    out->stock.out_of_stock = (size_t)lib_rbuf_get_u64(&r);
+    out->active_loans = lib_rbuf_get_u64(&r);
+    out->stock.stock_value = (double)(int64_t)lib_rbuf_get_u64(&r);
+    return r.bad ? LIB_ERR_IO : LIB_OK;
+}
@@ -0,0 +1,590 @@
+/* lib_server.c
+ *
+ * Implementasi lib_server.h: event loop epoll satu thread untuk daemon
+ * sirkulasi. Setiap putaran:
+ *   1. terima klien baru, baca semua socket yang siap, jalankan setiap frame
+ *      lengkap langsung ke library_db_t dan tulis response ke buffer keluar
+ *   2. satu lib_db_save untuk semua request pengubah data putaran itu (atau
+ *      setiap commit_batch request); jika gagal, byte status response sukses
+ *      yang belum terkirim diganti LIB_ERR_NOT_DURABLE
+ *   3. kirim buffer keluar, lalu tutup koneksi yang mati
+ * Timeout epoll_wait = tenggat lib_db_tick berikutnya, sehingga fsync group
+ * commit tetap terjadi dalam group_commit_ms walau tidak ada request baru.
+ * Tidak ada response pengubah data yang keluar sebelum commit-nya selesai.
+ * "Selesai" mengikuti durability db: sync = sudah di-fsync, group = fsync
+ * menyusul paling lambat group_commit_ms, buffered = belum tentu di disk.
+ * Buffer per koneksi dibatasi: frame > LIB_PROTO_MAX_FRAME menutup koneksi,
+ * dan klien yang tidak membaca response berhenti dibaca sampai buffer
+ * keluarnya kosong.
+ *
+ * Standard: ISO C99
+ */
+
+#if defined(__linux__)
+  #define _GNU_SOURCE            /* accept4 */
+#endif
+
+#include <string.h>
+#include "../include/lib_server.h"
+#include "../include/lib_proto.h"
+#include "../include/lib_arena.h"
+#include "../include/lib_thread.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define SERVER_MAX_EVENTS   64
+#define SERVER_READ_CHUNK   (16u * 1024u)
+#define SERVER_MAX_BACKLOG  (1024u * 1024u)   /* byte response belum terkirim */
+
+typedef struct {
+    int fd;
+    unsigned char *in;
+    size_t in_len;
+    size_t in_cap;
+    lib_wbuf_t out;
+    size_t out_sent;
+    uint32_t events;         /* interest epoll yang terdaftar */
+    bool dead;
+    bool touched;            /* sudah ada di daftar flush putaran ini */
+} conn_t;
+
+/* Response pengubah data yang menunggu commit: posisi byte status-nya */
+typedef struct {
+    conn_t *conn;
+    size_t status_at;
+} pending_write_t;
+
+struct lib_server {
+    library_db_t *db;
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;             /* eventfd: lib_server_stop menulis ke sini */
+    char *path;
+    size_t commit_batch;
+    conn_t **conns;
+    size_t conn_count, conn_cap;
+    conn_t **touched;
+    size_t touched_count, touched_cap;
+    pending_write_t *pending;
+    size_t pending_count, pending_cap;
+    bool reap;               /* ada koneksi dead yang perlu ditutup */
+    lib_server_stats_t stats;
+};
+
+static bool grow(void **p, size_t *cap, size_t need, size_t elem) {
+    if (need <= *cap) return true;
+    size_t n = *cap ? *cap * 2 : 16;
+    while (n < need) n *= 2;
+    void *q = lib_heap_realloc(*p, n * elem);
+    if (!q) return false;
+    *p = q;
+    *cap = n;
+    return true;
+}
+
+static uint32_t le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* ---------- koneksi ---------- */
+
+static void touch(lib_server_t *s, conn_t *c) {
+    if (c->touched) return;
+    if (!grow((void **)&s->touched, &s->touched_cap, s->touched_count + 1, sizeof(*s->touched))) {
+        c->dead = true;
+        s->reap = true;
+        return;
+    }
+    c->touched = true;
+    s->touched[s->touched_count++] = c;
+}
+
+static void kill_conn(lib_server_t *s, conn_t *c) {
+    c->dead = true;
+    s->reap = true;
+}
+
+static void set_interest(lib_server_t *s, conn_t *c, uint32_t events) {
+    if (c->events == events) return;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = c;
+    if (epoll_ctl(s->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev) != 0) { kill_conn(s, c); return; }
+    c->events = events;
+}
+
+static size_t backlog_of(const conn_t *c) {
+    return c->out.len - c->out_sent;
+}
+
+/* Ada frame lengkap (atau header rusak) di buffer masuk */
+static bool has_frame(const conn_t *c) {
+    return c->in_len >= 4 && c->in_len - 4 >= le32(c->in);
+}
+
+static void accept_all(lib_server_t *s) {
+    for (;;) {
+        int fd = accept4(s->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;   /* EAGAIN, atau kehabisan fd: coba lagi putaran berikutnya */
+        conn_t *c = lib_heap_calloc(1, sizeof(*c));
+        if (!c || !grow((void **)&s->conns, &s->conn_cap, s->conn_count + 1, sizeof(*s->conns))) {
+            lib_heap_free(c);
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+        lib_wbuf_init(&c->out);
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        if (epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            lib_heap_free(c);
+            close(fd);
+            continue;
+        }
+        s->conns[s->conn_count++] = c;
+        s->stats.connections++;
+        s->stats.clients = s->conn_count;
+    }
+}
+
+/* ---------- commit ---------- */
+
+static void commit_pending(lib_server_t *s) {
+    if (s->pending_count == 0) return;
+    double t0 = lib_clock_ms();
+    lib_status_t st = lib_db_save(s->db);
+    s->stats.commit_ms += lib_clock_ms() - t0;
+    s->stats.commits++;
+    if (s->pending_count > s->stats.max_batch) s->stats.max_batch = s->pending_count;
+    if (st != LIB_OK) {
+        /* Tidak di-rollback: perubahan sudah ada di memori dan record journal
+         * tetap pending untuk save berikutnya. Response yang sukses menjadi
+         * LIB_ERR_NOT_DURABLE (payload tetap, mis. loan_id) agar kiosk tidak
+         * mengulang request dan membuat pinjaman ganda. */
+        s->stats.commit_failures++;
+        for (size_t i = 0; i < s->pending_count; ++i) {
+            pending_write_t *p = &s->pending[i];
+            unsigned char *status = &p->conn->out.data[p->status_at];
+            if ((int8_t)*status == LIB_OK) *status = (unsigned char)(int8_t)LIB_ERR_NOT_DURABLE;
+        }
+    }
+    s->pending_count = 0;
+}
+
+/* ---------- handler per op ----------
+ * Semua argumen dibaca dulu; jika r->bad, handler kembali tanpa menyentuh db
+ * (pemanggil menutup koneksi). Payload hanya ditulis jika LIB_OK. */
+
+static lib_status_t op_checkout(lib_server_t *s, lib_rbuf_t *r, lib_wbuf_t *o, bool *wrote) {
+    lib_isbn_t isbn = lib_rbuf_get_u64(r);
+    char nim[sizeof(((borrower_t *)0)->nim)];
+    lib_rbuf_get_str(r, nim, sizeof(nim));
+    lib_day_t borrow = (lib_day_t)(int32_t)lib_rbuf_get_u32(r);
+    lib_day_t due = (lib_day_t)(int32_t)lib_rbuf_get_u32(r);
+    if (r->bad) return LIB_ERR_INVALID_ARG;
+
+    const borrower_t *b = lib_find_borrower_by_nim(s->db, nim);
+    if (!b) return LIB_ERR_NOT_FOUND;
+    lib_id_t id = LIB_ID_NONE;
+    lib_status_t st = lib_checkout_book(s->db, isbn, b, lib_date_from_days(borrow),
+                                        lib_date_from_days(due), &id);
+    if (st != LIB_OK) return st;
+    lib_wbuf_put_u64(o, id);
+    *wrote = true;
+    return LIB_OK;
+}
+
+static lib_status_t op_return(lib_server_t *s, lib_rbuf_t *r, lib_wbuf_t *o, bool *wrote) {
+    lib_id_t id = lib_rbuf_get_u64(r);
+    lib_day_t day = (lib_day_t)(int32_t)lib_rbuf_get_u32(r);
+    if (r->bad) return LIB_ERR_INVALID_ARG;
+
+    unsigned long fine = 0;
+    lib_status_t st = lib_return_book(s->db, id, lib_date_from_days(day), &fine);
+    if (st != LIB_OK) return st;
+    lib_wbuf_put_u64(o, fine);
+    *wrote = true;
+    return LIB_OK;
+}
+
+static lib_status_t op_search(lib_server_t *s, lib_rbuf_t *r, lib_wbuf_t *o) {
+    uint8_t by_author = lib_rbuf_get_u8(r);
+    size_t max = lib_rbuf_get_u16(r);
+    char query[LIB_MAX_TITLE];
+    lib_rbuf_get_str(r, query, sizeof(query));
+    if (r->bad) return LIB_ERR_INVALID_ARG;
+
+    const book_t *hits[LIB_PROTO_MAX_RESULTS];
+    if (max > LIB_PROTO_MAX_RESULTS) max = LIB_PROTO_MAX_RESULTS;
+    size_t n = by_author ? lib_search_books_by_author(s->db, query, hits, max)
+                         : lib_search_books_by_title(s->db, query, hits, max);
+    lib_wbuf_put_u16(o, (uint16_t)n);
+    for (size_t i = 0; i < n; ++i) {
+        lib_wbuf_put_u64(o, hits[i]->isbn);
+        lib_wbuf_put_u32(o, (uint32_t)hits[i]->available);
+        lib_wbuf_put_u32(o, (uint32_t)hits[i]->total_stock);
+        lib_wbuf_put_str(o, hits[i]->title);
+        lib_wbuf_put_str(o, hits[i]->author);
+    }
+    return LIB_OK;
+}
+
+static lib_status_t op_borrower(lib_server_t *s, lib_rbuf_t *r, lib_wbuf_t *o, bool *wrote) {
+    char nim[sizeof(((borrower_t *)0)->nim)];
+    char name[LIB_MAX_NAME];
+    lib_rbuf_get_str(r, nim, sizeof(nim));
+    uint8_t create = lib_rbuf_get_u8(r);
+    lib_rbuf_get_str(r, name, sizeof(name));
+    if (r->bad) return LIB_ERR_INVALID_ARG;
+
+    const borrower_t *b = lib_find_borrower_by_nim(s->db, nim);
+    if (!b) {
+        if (!create) return LIB_ERR_NOT_FOUND;
+        if (!lib_validate_nim_format(nim)) return LIB_ERR_INVALID_ARG;
+        borrower_t *nb = lib_get_or_create_borrower_by_nim(s->db, nim, true);
+        if (!nb) return LIB_ERR_MEMORY;
+        *wrote = true;
+        if (name[0]) {
+            borrower_t upd = *nb;
+            strncpy(upd.name, name, sizeof(upd.name) - 1);
+            upd.name[sizeof(upd.name) - 1] = '\0';
+            lib_status_t st = lib_update_borrower(s->db, nb->id, &upd);
+            if (st != LIB_OK) return st;
+        }
+        b = nb;
+    }
+    loan_t *active[256];
+    size_t n = lib_find_active_loans_by_borrower(s->db, b->id, active, 256);
+    lib_wbuf_put_u64(o, b->id);
+    lib_wbuf_put_str(o, b->name);
+    lib_wbuf_put_u16(o, (uint16_t)n);
+    return LIB_OK;
+}
+
+static lib_status_t op_report(lib_server_t *s, lib_rbuf_t *r, lib_wbuf_t *o) {
+    (void)r;
+    lib_stock_report_t rep;
+    lib_status_t st = lib_stock_report(s->db, &rep);
+    if (st != LIB_OK) return st;
+    double v = rep.stock_value;
+    lib_wbuf_put_u64(o, rep.titles);
+    lib_wbuf_put_u64(o, (uint64_t)(int64_t)rep.total_stock);
+    lib_wbuf_put_u64(o, (uint64_t)(int64_t)rep.available);
+    lib_wbuf_put_u64(o, (uint64_t)(int64_t)rep.borrowed);
+    lib_wbuf_put_u64(o, rep.out_of_stock);
+    lib_wbuf_put_u64(o, s->db->active_loans_count);
+    lib_wbuf_put_u64(o, (uint64_t)(int64_t)(v < 0 ? v - 0.5 : v + 0.5));
+    return LIB_OK;
+}
+
+/* Jalankan satu request; false = frame rusak / op tidak dikenal */
+static bool handle_frame(lib_server_t *s, conn_t *c, const unsigned char *p, size_t n) {
+    lib_rbuf_t r;
+    lib_rbuf_init(&r, p, n);
+    uint8_t op = lib_rbuf_get_u8(&r);
+    uint32_t tag = lib_rbuf_get_u32(&r);
+    if (r.bad) return false;
+
+    /* Slot pending disiapkan sebelum db disentuh */
+    if (!grow((void **)&s->pending, &s->pending_cap, s->pending_count + 1, sizeof(*s->pending))) {
+        kill_conn(s, c);
+        return true;
+    }
+
+    lib_wbuf_t *o = &c->out;
+    size_t frame = lib_wbuf_begin_frame(o);
+    lib_wbuf_put_u32(o, tag);
+    size_t status_at = o->len;
+    lib_wbuf_put_u8(o, 0);
+
+    bool wrote = false;
+    lib_status_t st;
+    switch (op) {
+    case LIB_OP_CHECKOUT: st = op_checkout(s, &r, o, &wrote); break;
+    case LIB_OP_RETURN:   st = op_return(s, &r, o, &wrote); break;
+    case LIB_OP_SEARCH:   st = op_search(s, &r, o); break;
+    case LIB_OP_BORROWER: st = op_borrower(s, &r, o, &wrote); break;
+    case LIB_OP_REPORT:   st = op_report(s, &r, o); break;
+    default:              st = LIB_ERR_INVALID_ARG; r.bad = true; break;
+    }
+    /* Frame rusak: buang header yang sudah ditulis agar respons setengah jadi
+     * tidak ikut terkirim sebelum koneksi ditutup */
+    if (r.bad) { o->len = frame; return false; }
+    if (o->oom) { kill_conn(s, c); return true; }
+
+    if (st != LIB_OK) o->len = status_at + 1;
+    o->data[status_at] = (unsigned char)(int8_t)st;
+    lib_wbuf_end_frame(o, frame);
+    s->stats.requests++;
+
+    if (wrote) {
+        /* Perubahan yang sudah terjadi ikut commit walau langkah berikutnya
+         * gagal (mis. nama peminjam baru) */
+        s->pending[s->pending_count].conn = c;
+        s->pending[s->pending_count].status_at = status_at;
+        s->pending_count++;
+        if (st == LIB_OK) s->stats.writes++;
+        if (s->commit_batch && s->pending_count >= s->commit_batch) commit_pending(s);
+    }
+    touch(s, c);
+    return true;
+}
+
+/* Jalankan semua frame lengkap di buffer masuk lalu buang yang sudah dipakai */
+static void process_input(lib_server_t *s, conn_t *c) {
+    size_t pos = 0;
+    while (!c->dead && c->in_len - pos >= 4 && backlog_of(c) < SERVER_MAX_BACKLOG) {
+        uint32_t n = le32(c->in + pos);
+        if (n < 5 || n > LIB_PROTO_MAX_FRAME) {
+            s->stats.protocol_errors++;
+            kill_conn(s, c);
+            break;
+        }
+        if (c->in_len - pos - 4 < n) break;
+        if (!handle_frame(s, c, c->in + pos + 4, n)) {
+            s->stats.protocol_errors++;
+            kill_conn(s, c);
+            break;
+        }
+        pos += 4 + (size_t)n;
+    }
+    if (pos) {
+        memmove(c->in, c->in + pos, c->in_len - pos);
+        c->in_len -= pos;
+    }
+}
+
+static void read_conn(lib_server_t *s, conn_t *c) {
+    while (!c->dead) {
+        /* Klien yang tidak membaca response: berhenti membaca (EPOLLOUT saja)
+         * sampai buffer keluarnya terkirim */
+        if (backlog_of(c) >= SERVER_MAX_BACKLOG) { touch(s, c); return; }
+        if (c->in_cap - c->in_len < SERVER_READ_CHUNK) {
+            size_t cap = c->in_cap ? c->in_cap * 2 : SERVER_READ_CHUNK;
+            while (cap - c->in_len < SERVER_READ_CHUNK) cap *= 2;
+            unsigned char *p = lib_heap_realloc(c->in, cap);
+            if (!p) { kill_conn(s, c); return; }
+            c->in = p;
+            c->in_cap = cap;
+        }
+        ssize_t k = recv(c->fd, c->in + c->in_len, c->in_cap - c->in_len, 0);
+        if (k > 0) {
+            c->in_len += (size_t)k;
+            process_input(s, c);
+            continue;
+        }
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        /* EOF / error: response yang sudah ada tetap dicoba dikirim */
+        kill_conn(s, c);
+        touch(s, c);
+        return;
+    }
+}
+
+static void flush_conn(lib_server_t *s, conn_t *c) {
+    while (backlog_of(c) > 0) {
+        ssize_t k = send(c->fd, c->out.data + c->out_sent, backlog_of(c), MSG_NOSIGNAL);
+        if (k > 0) { c->out_sent += (size_t)k; continue; }
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        kill_conn(s, c);
+        return;
+    }
+    if (backlog_of(c) == 0) {
+        c->out.len = 0;
+        c->out_sent = 0;
+    }
+    if (c->dead) return;
+    /* Frame yang tertahan karena backlog: minta EPOLLOUT agar putaran
+     * berikutnya langsung memprosesnya (data sudah di buffer, tidak akan ada
+     * EPOLLIN baru untuknya) */
+    size_t backlog = backlog_of(c);
+    bool stalled = has_frame(c);
+    set_interest(s, c, backlog >= SERVER_MAX_BACKLOG ? EPOLLOUT
+                     : (EPOLLIN | ((backlog || stalled) ? EPOLLOUT : 0)));
+}
+
+static void free_conn(lib_server_t *s, conn_t *c) {
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    lib_heap_free(c->in);
+    lib_wbuf_free(&c->out);
+    lib_heap_free(c);
+}
+
+static void reap_dead(lib_server_t *s) {
+    if (!s->reap) return;
+    size_t j = 0;
+    for (size_t i = 0; i < s->conn_count; ++i) {
+        if (s->conns[i]->dead) free_conn(s, s->conns[i]);
+        else s->conns[j++] = s->conns[i];
+    }
+    s->conn_count = j;
+    s->stats.clients = j;
+    s->reap = false;
+}
+
+/* ---------- API ---------- */
+
+lib_server_t *lib_server_open(library_db_t *db, const char *socket_path, lib_status_t *err) {
+    lib_status_t dummy;
+    if (!err) err = &dummy;
+    *err = LIB_ERR_INVALID_ARG;
+    if (!db || !socket_path) return NULL;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    size_t plen = strlen(socket_path);
+    if (plen == 0 || plen >= sizeof(addr.sun_path)) return NULL;
+    memcpy(addr.sun_path, socket_path, plen);
+
+    *err = LIB_ERR_MEMORY;
+    lib_server_t *s = lib_heap_calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->path = lib_heap_malloc(plen + 1);
+    if (!s->path) { lib_heap_free(s); return NULL; }
+    memcpy(s->path, socket_path, plen + 1);
+    s->db = db;
+    s->listen_fd = s->epoll_fd = s->wake_fd = -1;
+
+    *err = LIB_ERR_IO;
+    /* Socket lama dari daemon yang mati; file lain di path itu tidak disentuh */
+    struct stat st;
+    if (stat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(socket_path);
+
+    s->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->listen_fd < 0) goto fail;
+    if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) goto fail;
+    if (listen(s->listen_fd, 128) != 0) { unlink(socket_path); goto fail; }
+    s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    s->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s->epoll_fd < 0 || s->wake_fd < 0) { unlink(socket_path); goto fail; }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &s->listen_fd;
+    if (epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->listen_fd, &ev) != 0) { unlink(socket_path); goto fail; }
+    ev.data.ptr = &s->wake_fd;
+    if (epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->wake_fd, &ev) != 0) { unlink(socket_path); goto fail; }
+    *err = LIB_OK;
+    return s;
+
+fail:
+    if (s->listen_fd >= 0) close(s->listen_fd);
+    if (s->epoll_fd >= 0) close(s->epoll_fd);
+    if (s->wake_fd >= 0) close(s->wake_fd);
+    lib_heap_free(s->path);
+    lib_heap_free(s);
+    return NULL;
+}
+
+void lib_server_set_commit_batch(lib_server_t *s, size_t max_writes) {
+    if (s) s->commit_batch = max_writes;
+}
+
+lib_status_t lib_server_run(lib_server_t *s) {
+    if (!s) return LIB_ERR_INVALID_ARG;
+    struct epoll_event ev[SERVER_MAX_EVENTS];
+    bool stop = false;
+    while (!stop) {
+        /* durability group: tunggu paling lama sampai tenggat fsync berikutnya */
+        long next_ms;
+        lib_db_tick(s->db, false, &next_ms);
+        int timeout = next_ms < 0 ? -1 : next_ms > INT_MAX ? INT_MAX : (int)next_ms;
+        int n = epoll_wait(s->epoll_fd, ev, SERVER_MAX_EVENTS, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return LIB_ERR_IO;
+        }
+        for (int i = 0; i < n; ++i) {
+            void *tag = ev[i].data.ptr;
+            if (tag == &s->listen_fd) { accept_all(s); continue; }
+            if (tag == &s->wake_fd) {
+                uint64_t v;
+                ssize_t k = read(s->wake_fd, &v, sizeof(v));
+                (void)k;
+                stop = true;
+                continue;
+            }
+            conn_t *c = tag;
+            if (c->dead) continue;
+            if (ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read_conn(s, c);
+            if (ev[i].events & EPOLLOUT) {
+                process_input(s, c);
+                touch(s, c);
+            }
+        }
+        commit_pending(s);
+        for (size_t i = 0; i < s->touched_count; ++i) {
+            conn_t *c = s->touched[i];
+            c->touched = false;
+            flush_conn(s, c);
+        }
+        s->touched_count = 0;
+        reap_dead(s);
+    }
+    return LIB_OK;
+}
+
+void lib_server_stop(lib_server_t *s) {
+    if (!s) return;
+    uint64_t one = 1;
+    ssize_t k = write(s->wake_fd, &one, sizeof(one));
+    (void)k;
+}
+
+lib_status_t lib_server_get_stats(const lib_server_t *s, lib_server_stats_t *out) {
+    if (!s || !out) return LIB_ERR_INVALID_ARG;
+    *out = s->stats;
+    return LIB_OK;
+}
+
+void lib_server_close(lib_server_t *s) {
+    if (!s) return;
+    commit_pending(s);
+    for (size_t i = 0; i < s->conn_count; ++i) free_conn(s, s->conns[i]);
+    close(s->listen_fd);
+    close(s->epoll_fd);
+    close(s->wake_fd);
+    unlink(s->path);
+    lib_heap_free(s->conns);
+    lib_heap_free(s->touched);
+    lib_heap_free(s->pending);
+    lib_heap_free(s->path);
+    lib_heap_free(s);
+}
+
+#else /* !__linux__ */
+
+struct lib_server { int unused; };
+
+lib_server_t *lib_server_open(library_db_t *db, const char *socket_path, lib_status_t *err) {
+    (void)db; (void)socket_path;
+    if (err) *err = LIB_ERR_IO;
+    return NULL;
+}
+void lib_server_set_commit_batch(lib_server_t *s, size_t max_writes) { (void)s; (void)max_writes; }
+lib_status_t lib_server_run(lib_server_t *s) { (void)s; return LIB_ERR_IO; }
+void lib_server_stop(lib_server_t *s) { (void)s; }
+lib_status_t lib_server_get_stats(const lib_server_t *s, lib_server_stats_t *out) {
+    (void)s; (void)out;
+    return LIB_ERR_IO;
+}
+void lib_server_close(lib_server_t *s) { (void)s; }
+
+#endif
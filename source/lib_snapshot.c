@@ -0,0 +1,348 @@
+/* lib_snapshot.c
+ *
+ * Snapshot biner (lihat lib_snapshot.h).
+ * Layout file (byte order mesin penulis, dicek lewat penanda endian):
+ *   header | section buku | section peminjam | section pinjaman | string heap
+ * Setiap section berawal di offset kelipatan 8. Record menyimpan ISBN, ID
+ * (lib_isbn_t/lib_id_t) dan tanggal (lib_day_t) sebagai integer mentah, sama
+ * dengan nilai di memori, jadi loader tidak mem-parse apa pun. Heap hanya
+ * untuk teks bebas (judul, nama, dst.; offset 0 = string kosong).
+ *
+ * Standard: ISO C99
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include "../include/lib_snapshot.h"
+#include "../include/lib_arena.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <windows.h>
+  #include <io.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+#define SNAP_MAGIC "PDSNAP\0\0"
+#define SNAP_ENDIAN 0x01020304u
+
+enum { SEC_BOOKS = 0, SEC_BORROWERS, SEC_LOANS, SEC_HEAP, SEC_COUNT };
+
+typedef struct {
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t offset;
+} snap_section_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t file_size;
+    snap_section_t sections[SEC_COUNT];
+} snap_header_t;
+
+typedef struct {
+    uint64_t isbn;
+    double price;
+    uint32_t title, author, notes;
+    int32_t year, total_stock, available;
+} snap_book_t;
+
+typedef struct {
+    uint64_t id;
+    uint32_t nim, name, phone, email;
+} snap_borrower_t;
+
+#define SNAP_LOAN_RETURNED 0x1u
+#define SNAP_LOAN_LOST     0x2u
+
+typedef struct {
+    uint64_t loan_id, isbn, borrower_id;
+    int64_t fine_paid;
+    int32_t date_borrow, date_due, date_returned;   /* lib_day_t; date_returned 0 = belum kembali */
+    uint32_t flags;
+} snap_loan_t;
+
+/* ukuran record on-disk tidak boleh berubah tanpa menaikkan LIB_SNAPSHOT_VERSION */
+typedef char snap_book_size_check[sizeof(snap_book_t) == 40 ? 1 : -1];
+typedef char snap_borrower_size_check[sizeof(snap_borrower_t) == 24 ? 1 : -1];
+typedef char snap_loan_size_check[sizeof(snap_loan_t) == 48 ? 1 : -1];
+typedef char snap_key_size_check[sizeof(lib_id_t) == 8 && sizeof(lib_isbn_t) == 8 && sizeof(lib_day_t) == 4 ? 1 : -1];
+
+static uint64_t align8(uint64_t v) { return (v + 7u) & ~(uint64_t)7u; }
+
+/* ---------- reader ---------- */
+
+static bool section_ok(const snap_header_t *h, int sec, size_t record_size, size_t file_size) {
+    const snap_section_t *s = &h->sections[sec];
+    if (s->record_size != record_size || (s->offset & 7u) != 0 || s->offset > file_size) return false;
+    return s->count <= (file_size - s->offset) / record_size;
+}
+
+lib_snapshot_t *lib_snapshot_map(const char *path) {
+    if (!path) return NULL;
+    lib_snapshot_t *s = lib_heap_calloc(1, sizeof(*s));
+    if (!s) return NULL;
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE) { lib_heap_free(s); return NULL; }
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(fh, &sz) || sz.QuadPart < (LONGLONG)sizeof(snap_header_t)) { CloseHandle(fh); lib_heap_free(s); return NULL; }
+    HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(fh);
+    if (!mh) { lib_heap_free(s); return NULL; }
+    void *base = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    if (!base) { CloseHandle(mh); lib_heap_free(s); return NULL; }
+    s->handle = mh;
+    s->size = (size_t)sz.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { lib_heap_free(s); return NULL; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(snap_header_t)) { close(fd); lib_heap_free(s); return NULL; }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) { lib_heap_free(s); return NULL; }
+    s->size = (size_t)st.st_size;
+#endif
+    s->base = base;
+
+    const snap_header_t *h = (const snap_header_t *)base;
+    if (memcmp(h->magic, SNAP_MAGIC, 8) != 0 || h->version != LIB_SNAPSHOT_VERSION
+        || h->endian != SNAP_ENDIAN || h->file_size != s->size
+        || !section_ok(h, SEC_BOOKS, sizeof(snap_book_t), s->size)
+        || !section_ok(h, SEC_BORROWERS, sizeof(snap_borrower_t), s->size)
+        || !section_ok(h, SEC_LOANS, sizeof(snap_loan_t), s->size)
+        || !section_ok(h, SEC_HEAP, 1, s->size)
+        || h->sections[SEC_HEAP].count == 0) {
+        lib_snapshot_unmap(s);
+        return NULL;
+    }
+    s->books = s->base + h->sections[SEC_BOOKS].offset;
+    s->books_count = (size_t)h->sections[SEC_BOOKS].count;
+    s->borrowers = s->base + h->sections[SEC_BORROWERS].offset;
+    s->borrowers_count = (size_t)h->sections[SEC_BORROWERS].count;
+    s->loans = s->base + h->sections[SEC_LOANS].offset;
+    s->loans_count = (size_t)h->sections[SEC_LOANS].count;
+    s->heap = (const char *)s->base + h->sections[SEC_HEAP].offset;
+    s->heap_size = (size_t)h->sections[SEC_HEAP].count;
+    /* byte terakhir heap NUL: setiap offset yang valid menunjuk string yang berakhir */
+    if (s->heap[s->heap_size - 1] != '\0') { lib_snapshot_unmap(s); return NULL; }
+    return s;
+}
+
+void lib_snapshot_unmap(lib_snapshot_t *s) {
+    if (!s) return;
+#if defined(_WIN32) || defined(_WIN64)
+    if (s->base) UnmapViewOfFile(s->base);
+    if (s->handle) CloseHandle((HANDLE)s->handle);
+#else
+    if (s->base) munmap((void *)s->base, s->size);
+#endif
+    lib_heap_free(s);
+}
+
+static void copy_heap_str(const lib_snapshot_t *s, uint32_t off, char *dst, size_t cap) {
+    const char *src = off < s->heap_size ? s->heap + off : "";
+    size_t n = strnlen(src, cap - 1);
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+void lib_snapshot_book(const lib_snapshot_t *s, size_t i, book_t *out) {
+    const snap_book_t *r = (const snap_book_t *)(const void *)s->books + i;
+    memset(out, 0, sizeof(*out));
+    out->isbn = r->isbn;
+    copy_heap_str(s, r->title, out->title, sizeof(out->title));
+    copy_heap_str(s, r->author, out->author, sizeof(out->author));
+    copy_heap_str(s, r->notes, out->notes, sizeof(out->notes));
+    out->year = r->year;
+    out->total_stock = r->total_stock;
+    out->available = r->available;
+    out->price = r->price;
+}
+
+void lib_snapshot_borrower(const lib_snapshot_t *s, size_t i, borrower_t *out) {
+    const snap_borrower_t *r = (const snap_borrower_t *)(const void *)s->borrowers + i;
+    memset(out, 0, sizeof(*out));
+    out->id = r->id;
+    copy_heap_str(s, r->nim, out->nim, sizeof(out->nim));
+    copy_heap_str(s, r->name, out->name, sizeof(out->name));
+    copy_heap_str(s, r->phone, out->phone, sizeof(out->phone));
+    copy_heap_str(s, r->email, out->email, sizeof(out->email));
+}
+
+void lib_snapshot_loan(const lib_snapshot_t *s, size_t i, loan_t *out) {
+    const snap_loan_t *r = (const snap_loan_t *)(const void *)s->loans + i;
+    memset(out, 0, sizeof(*out));
+    out->loan_id = r->loan_id;
+    out->isbn = r->isbn;
+    out->borrower_id = r->borrower_id;
+    out->date_borrow = r->date_borrow;
+    out->date_due = r->date_due;
+    out->date_returned = r->date_returned;
+    out->is_returned = (r->flags & SNAP_LOAN_RETURNED) != 0;
+    out->is_lost = (r->flags & SNAP_LOAN_LOST) != 0;
+    out->fine_paid = (long)r->fine_paid;
+}
+
+/* ---------- writer ---------- */
+
+/* Heap ditulis berurutan; offset berikutnya = jumlah byte yang sudah ditulis */
+typedef struct {
+    FILE *f;
+    uint64_t used;
+    bool ok;
+} heap_writer_t;
+
+static uint32_t heap_put(heap_writer_t *hw, const char *str, size_t cap) {
+    size_t n = strnlen(str, cap);
+    if (n == 0) return 0;
+    uint32_t off = (uint32_t)hw->used;
+    if (hw->used + n + 1 > UINT32_MAX) { hw->ok = false; return 0; }
+    if (fwrite(str, 1, n, hw->f) != n || fputc('\0', hw->f) == EOF) hw->ok = false;
+    hw->used += n + 1;
+    return off;
+}
+
+/* Offset string dihitung ulang dengan urutan yang sama seperti heap_put */
+static uint32_t heap_next(uint64_t *used, const char *str, size_t cap) {
+    size_t n = strnlen(str, cap);
+    if (n == 0) return 0;
+    uint32_t off = (uint32_t)*used;
+    *used += n + 1;
+    return off;
+}
+
+static bool write_padding(FILE *f, uint64_t from, uint64_t to) {
+    static const char zeros[8] = { 0 };
+    return to == from || fwrite(zeros, 1, (size_t)(to - from), f) == (size_t)(to - from);
+}
+
+/* Section loan = riwayat lalu partisi aktif (loader memisahkannya lagi) */
+static const loan_t *loan_src(const library_db_t *db, size_t i) {
+    return i < db->loans_count ? lib_loan_at(db, i) : lib_active_loan_at(db, i - db->loans_count);
+}
+
+lib_status_t lib_snapshot_write(const library_db_t *db, const char *outfile) {
+    if (!db || !outfile) return LIB_ERR_INVALID_ARG;
+    FILE *f = fopen(outfile, "wb");
+    if (!f) {
+        fprintf(stderr, "[lib] lib_snapshot_write: fopen('%s') failed: %s\n", outfile, strerror(errno));
+        return LIB_ERR_IO;
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 16);
+
+    snap_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAP_MAGIC, 8);
+    h.version = LIB_SNAPSHOT_VERSION;
+    h.endian = SNAP_ENDIAN;
+    h.sections[SEC_BOOKS].record_size = sizeof(snap_book_t);
+    h.sections[SEC_BOOKS].count = db->books_count;
+    h.sections[SEC_BOOKS].offset = align8(sizeof(h));
+    h.sections[SEC_BORROWERS].record_size = sizeof(snap_borrower_t);
+    h.sections[SEC_BORROWERS].count = db->borrowers_count;
+    h.sections[SEC_BORROWERS].offset = align8(h.sections[SEC_BOOKS].offset + db->books_count * sizeof(snap_book_t));
+    h.sections[SEC_LOANS].record_size = sizeof(snap_loan_t);
+    size_t loans_count = db->loans_count + db->active_loans_count;
+    h.sections[SEC_LOANS].count = loans_count;
+    h.sections[SEC_LOANS].offset = align8(h.sections[SEC_BORROWERS].offset + db->borrowers_count * sizeof(snap_borrower_t));
+    h.sections[SEC_HEAP].record_size = 1;
+    h.sections[SEC_HEAP].offset = align8(h.sections[SEC_LOANS].offset + loans_count * sizeof(snap_loan_t));
+
+    /* section record: offset heap dihitung tanpa menulis heap dulu */
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    uint64_t pos = sizeof(h);
+    uint64_t heap_used = 1;   /* byte 0 = string kosong */
+    ok = ok && write_padding(f, pos, h.sections[SEC_BOOKS].offset);
+    pos = h.sections[SEC_BOOKS].offset;
+    for (size_t i = 0; ok && i < db->books_count; ++i) {
+        const book_t *b = lib_book_at(db, i);
+        snap_book_t r;
+        memset(&r, 0, sizeof(r));
+        r.isbn = b->isbn;
+        r.title = heap_next(&heap_used, b->title, sizeof(b->title));
+        r.author = heap_next(&heap_used, b->author, sizeof(b->author));
+        r.notes = heap_next(&heap_used, b->notes, sizeof(b->notes));
+        r.year = b->year;
+        r.total_stock = b->total_stock;
+        r.available = b->available;
+        r.price = b->price;
+        ok = fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    pos += db->books_count * sizeof(snap_book_t);
+    ok = ok && write_padding(f, pos, h.sections[SEC_BORROWERS].offset);
+    pos = h.sections[SEC_BORROWERS].offset;
+    for (size_t i = 0; ok && i < db->borrowers_count; ++i) {
+        const borrower_t *b = lib_borrower_at(db, i);
+        snap_borrower_t r;
+        memset(&r, 0, sizeof(r));
+        r.id = b->id;
+        r.nim = heap_next(&heap_used, b->nim, sizeof(b->nim));
+        r.name = heap_next(&heap_used, b->name, sizeof(b->name));
+        r.phone = heap_next(&heap_used, b->phone, sizeof(b->phone));
+        r.email = heap_next(&heap_used, b->email, sizeof(b->email));
+        ok = fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    pos += db->borrowers_count * sizeof(snap_borrower_t);
+    ok = ok && write_padding(f, pos, h.sections[SEC_LOANS].offset);
+    pos = h.sections[SEC_LOANS].offset;
+    for (size_t i = 0; ok && i < loans_count; ++i) {
+        const loan_t *l = loan_src(db, i);
+        snap_loan_t r;
+        memset(&r, 0, sizeof(r));
+        r.loan_id = l->loan_id;
+        r.isbn = l->isbn;
+        r.borrower_id = l->borrower_id;
+        r.date_borrow = l->date_borrow;
+        r.date_due = l->date_due;
+        r.date_returned = l->is_returned ? l->date_returned : 0;
+        r.flags = (l->is_returned ? SNAP_LOAN_RETURNED : 0u) | (l->is_lost ? SNAP_LOAN_LOST : 0u);
+        r.fine_paid = (int64_t)l->fine_paid;
+        ok = fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    pos += loans_count * sizeof(snap_loan_t);
+    ok = ok && heap_used <= UINT32_MAX && write_padding(f, pos, h.sections[SEC_HEAP].offset);
+
+    /* heap: urutan string sama dengan perhitungan offset di atas (pinjaman tanpa teks) */
+    heap_writer_t hw = { f, 1, ok };
+    if (hw.ok && fputc('\0', f) == EOF) hw.ok = false;
+    for (size_t i = 0; hw.ok && i < db->books_count; ++i) {
+        const book_t *b = lib_book_at(db, i);
+        heap_put(&hw, b->title, sizeof(b->title));
+        heap_put(&hw, b->author, sizeof(b->author));
+        heap_put(&hw, b->notes, sizeof(b->notes));
+    }
+    for (size_t i = 0; hw.ok && i < db->borrowers_count; ++i) {
+        const borrower_t *b = lib_borrower_at(db, i);
+        heap_put(&hw, b->nim, sizeof(b->nim));
+        heap_put(&hw, b->name, sizeof(b->name));
+        heap_put(&hw, b->phone, sizeof(b->phone));
+        heap_put(&hw, b->email, sizeof(b->email));
+    }
+    ok = hw.ok && hw.used == heap_used;
+
+    /* header final: ukuran heap dan file baru diketahui sekarang */
+    h.sections[SEC_HEAP].count = heap_used;
+    h.file_size = h.sections[SEC_HEAP].offset + heap_used;
+    ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, f) == 1 && fflush(f) == 0;
+#if defined(_WIN32) || defined(_WIN64)
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    if (fclose(f) != 0) ok = false;
+    return ok ? LIB_OK : LIB_ERR_IO;
+}
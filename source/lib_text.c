@@ -0,0 +1,183 @@
+/* lib_text.c
+ *
+ * Pencarian substring case-insensitive tanpa alokasi.
+ * - Case folding ASCII dilakukan on-the-fly (tidak menyalin haystack/needle)
+ * - Filter byte pertama & terakhir needle: hanya posisi yang cocok di kedua
+ *   ujungnya yang dibandingkan penuh
+ * - SSE2 (16 byte/iterasi) dan AVX2 (32 byte/iterasi, dipilih saat runtime
+ *   lewat cpuid di GCC/Clang) dengan fallback scalar
+ *
+ * Standard: ISO C99
+ */
+
+#define _POSIX_C_SOURCE 200809L   /* pthread_rwlock_t di lib_thread.h */
+
+#include <string.h>
+#include <stdint.h>
+#include "../include/lib_text.h"
+#include "../include/lib_thread.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define LIB_TEXT_HAVE_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+#if defined(LIB_TEXT_HAVE_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define LIB_TEXT_HAVE_AVX2 1
+  #include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+static unsigned char fold(unsigned char c) {
+    return ((unsigned)(c - 'A') < 26u) ? (unsigned char)(c | 0x20) : c;
+}
+
+/* Bandingkan n byte; `needle` belum di-fold. */
+static bool equal_ci(const unsigned char *hay, const unsigned char *needle, size_t n) {
+    for (size_t k = 0; k < n; ++k) {
+        if (fold(hay[k]) != fold(needle[k])) return false;
+    }
+    return true;
+}
+
+static unsigned lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (unsigned)idx;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/* Scalar: mulai dari posisi `from` (dipakai juga sebagai tail kernel SIMD). */
+static bool contains_scalar_from(const unsigned char *h, size_t hlen,
+                                 const unsigned char *n, size_t nlen, size_t from) {
+    unsigned char first = fold(n[0]), last = fold(n[nlen - 1]);
+    size_t mid = nlen > 2 ? nlen - 2 : 0;
+    for (size_t i = from; i + nlen <= hlen; ++i) {
+        if (fold(h[i]) != first || fold(h[i + nlen - 1]) != last) continue;
+        if (equal_ci(h + i + 1, n + 1, mid)) return true;
+    }
+    return false;
+}
+
+static bool contains_scalar(const unsigned char *h, size_t hlen, const unsigned char *n, size_t nlen) {
+    return contains_scalar_from(h, hlen, n, nlen, 0);
+}
+
+#if defined(LIB_TEXT_HAVE_SSE2)
+/* 'A'..'Z' -> 'a'..'z' per byte: (c - 'A') + 0x80 < 0x80 + 26 secara signed */
+static __m128i fold16(__m128i v) {
+    __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - 'A')));
+    __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + 26)));
+    return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/* Periksa 16 posisi awal mulai dari h + i. */
+static bool block_sse2(const unsigned char *h, size_t i, const unsigned char *n, size_t nlen,
+                       __m128i vfirst, __m128i vlast) {
+    size_t mid = nlen > 2 ? nlen - 2 : 0;
+    __m128i a = fold16(_mm_loadu_si128((const __m128i *)(const void *)(h + i)));
+    __m128i b = fold16(_mm_loadu_si128((const __m128i *)(const void *)(h + i + nlen - 1)));
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, vfirst), _mm_cmpeq_epi8(b, vlast)));
+    while (mask) {
+        unsigned bit = lowest_bit(mask);
+        if (equal_ci(h + i + bit + 1, n + 1, mid)) return true;
+        mask &= mask - 1;
+    }
+    return false;
+}
+
+static bool contains_sse2(const unsigned char *h, size_t hlen, const unsigned char *n, size_t nlen) {
+    if (hlen < nlen - 1 + 16) return contains_scalar_from(h, hlen, n, nlen, 0);
+    const __m128i vfirst = _mm_set1_epi8((char)fold(n[0]));
+    const __m128i vlast = _mm_set1_epi8((char)fold(n[nlen - 1]));
+    size_t last = hlen - (nlen - 1) - 16;   /* posisi blok terakhir yang masih utuh */
+    for (size_t i = 0; i < last; i += 16) {
+        if (block_sse2(h, i, n, nlen, vfirst, vlast)) return true;
+    }
+    /* blok terakhir boleh tumpang tindih dengan blok sebelumnya; tidak perlu tail scalar */
+    return block_sse2(h, last, n, nlen, vfirst, vlast);
+}
+#endif
+
+#if defined(LIB_TEXT_HAVE_AVX2)
+__attribute__((target("avx2")))
+static __m256i fold32(__m256i v) {
+    __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8((char)(0x80 - 'A')));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + 26)), shifted);
+    return _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+static bool contains_avx2(const unsigned char *h, size_t hlen, const unsigned char *n, size_t nlen) {
+    const __m256i vfirst = _mm256_set1_epi8((char)fold(n[0]));
+    const __m256i vlast = _mm256_set1_epi8((char)fold(n[nlen - 1]));
+    size_t mid = nlen > 2 ? nlen - 2 : 0;
+    size_t i = 0;
+    for (; i + nlen - 1 + 32 <= hlen; i += 32) {
+        __m256i a = fold32(_mm256_loadu_si256((const __m256i *)(const void *)(h + i)));
+        __m256i b = fold32(_mm256_loadu_si256((const __m256i *)(const void *)(h + i + nlen - 1)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, vfirst), _mm256_cmpeq_epi8(b, vlast)));
+        while (mask) {
+            unsigned bit = lowest_bit(mask);
+            if (equal_ci(h + i + bit + 1, n + 1, mid)) return true;
+            mask &= mask - 1;
+        }
+    }
+    /* sisa < 32 posisi: lanjutkan dengan SSE2. vzeroupper dulu agar kode SSE
+     * non-VEX tidak terkena penalti transisi state AVX. */
+    _mm256_zeroupper();
+    return i + nlen <= hlen && contains_sse2(h + i, hlen - i, n, nlen);
+}
+#endif
+
+typedef bool (*contains_fn)(const unsigned char *, size_t, const unsigned char *, size_t);
+
+static contains_fn kernel = NULL;
+/* kernel untuk haystack pendek (< 32 byte yang bisa dipindai AVX2): kebanyakan
+ * judul/nama cukup pendek, menyiapkan register 256-bit di sana hanya menambah biaya */
+static contains_fn kernel_short = NULL;
+static const char *kernel_name = "scalar";
+static lib_once_t kernel_once = LIB_ONCE_INIT;
+
+/* dipanggil sekali lewat lib_once: pencarian dari beberapa thread pembaca
+ * tidak pernah melihat pointer kernel yang setengah terisi */
+static void resolve_kernel(void) {
+    contains_fn fn = contains_scalar;
+    kernel_name = "scalar";
+#if defined(LIB_TEXT_HAVE_SSE2)
+    fn = contains_sse2;
+    kernel_name = "sse2";
+#endif
+    kernel_short = fn;
+#if defined(LIB_TEXT_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { fn = contains_avx2; kernel_name = "avx2"; }
+#endif
+    kernel = fn;
+}
+
+bool lib_contains_ci_n(const char *haystack, size_t hlen, const char *needle, size_t nlen) {
+    if (!haystack || !needle) return false;
+    if (nlen == 0) return true;
+    if (nlen > hlen) return false;
+    lib_once(&kernel_once, resolve_kernel);
+    contains_fn fn = kernel;
+    if (hlen < nlen - 1 + 32 && kernel_short) fn = kernel_short;
+    return fn((const unsigned char *)haystack, hlen, (const unsigned char *)needle, nlen);
+}
+
+bool lib_contains_ci(const char *haystack, const char *needle) {
+    if (!haystack || !needle) return false;
+    return lib_contains_ci_n(haystack, strlen(haystack), needle, strlen(needle));
+}
+
+const char *lib_text_kernel_name(void) {
+    lib_once(&kernel_once, resolve_kernel);
+    return kernel_name;
+}
@@ -0,0 +1,269 @@
+/* lib_thread.c
+ * Implementasi lib_thread.h (Win32 / pthread).
+ *
+ * Standard: ISO C99
+ */
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  #define _POSIX_C_SOURCE 200809L
+  #if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE      /* pthread_rwlockattr_setkind_np */
+  #endif
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/lib_thread.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <windows.h>
+  #include <process.h>
+#else
+  #include <time.h>
+  #include <unistd.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+static unsigned __stdcall thread_entry(void *p) {
+    lib_thread_t *t = p;
+    t->fn(t->arg);
+    return 0;
+}
+#else
+static void *thread_entry(void *p) {
+    lib_thread_t *t = p;
+    t->fn(t->arg);
+    return NULL;
+}
+#endif
+
+bool lib_thread_start(lib_thread_t *t, lib_thread_fn fn, void *arg) {
+    if (!t || !fn) return false;
+    t->fn = fn;
+    t->arg = arg;
+    t->started = false;
+#if defined(_WIN32) || defined(_WIN64)
+    uintptr_t h = _beginthreadex(NULL, 0, thread_entry, t, 0, NULL);
+    if (h == 0) return false;
+    t->handle = (void *)h;
+#else
+    if (pthread_create(&t->id, NULL, thread_entry, t) != 0) return false;
+#endif
+    t->started = true;
+    return true;
+}
+
+void lib_thread_join(lib_thread_t *t) {
+    if (!t || !t->started) return;
+#if defined(_WIN32) || defined(_WIN64)
+    WaitForSingleObject((HANDLE)t->handle, INFINITE);
+    CloseHandle((HANDLE)t->handle);
+#else
+    pthread_join(t->id, NULL);
+#endif
+    t->started = false;
+}
+
+bool lib_mutex_init(lib_mutex_t *m) {
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeSRWLock((PSRWLOCK)&m->srw);
+    return true;
+#else
+    return pthread_mutex_init(&m->m, NULL) == 0;
+#endif
+}
+
+void lib_mutex_destroy(lib_mutex_t *m) {
+#if defined(_WIN32) || defined(_WIN64)
+    (void)m;   /* SRWLOCK tidak perlu dilepas */
+#else
+    pthread_mutex_destroy(&m->m);
+#endif
+}
+
+void lib_mutex_lock(lib_mutex_t *m) {
+#if defined(_WIN32) || defined(_WIN64)
+    AcquireSRWLockExclusive((PSRWLOCK)&m->srw);
+#else
+    pthread_mutex_lock(&m->m);
+#endif
+}
+
+void lib_mutex_unlock(lib_mutex_t *m) {
+#if defined(_WIN32) || defined(_WIN64)
+    ReleaseSRWLockExclusive((PSRWLOCK)&m->srw);
+#else
+    pthread_mutex_unlock(&m->m);
+#endif
+}
+
+bool lib_rwlock_init(lib_rwlock_t *l) {
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeSRWLock((PSRWLOCK)&l->srw);
+    return true;
+#else
+    pthread_rwlockattr_t attr;
+    if (pthread_rwlockattr_init(&attr) != 0) return false;
+  #if defined(__GLIBC__)
+    /* default glibc mendahulukan pembaca: dengan banyak pencarian, checkout
+     * bisa menunggu tanpa batas. Aman karena kunci tidak pernah diambil
+     * rekursif. */
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+  #endif
+    bool ok = pthread_rwlock_init(&l->rw, &attr) == 0;
+    pthread_rwlockattr_destroy(&attr);
+    return ok;
+#endif
+}
+
+void lib_rwlock_destroy(lib_rwlock_t *l) {
+#if defined(_WIN32) || defined(_WIN64)
+    (void)l;
+#else
+    pthread_rwlock_destroy(&l->rw);
+#endif
+}
+
+void lib_rwlock_read_lock(lib_rwlock_t *l) {
+#if defined(_WIN32) || defined(_WIN64)
+    AcquireSRWLockShared((PSRWLOCK)&l->srw);
+#else
+    pthread_rwlock_rdlock(&l->rw);
+#endif
+}
+
+void lib_rwlock_read_unlock(lib_rwlock_t *l) {
+#if defined(_WIN32) || defined(_WIN64)
+    ReleaseSRWLockShared((PSRWLOCK)&l->srw);
+#else
+    pthread_rwlock_unlock(&l->rw);
+#endif
+}
+
+void lib_rwlock_write_lock(lib_rwlock_t *l) {
+#if defined(_WIN32) || defined(_WIN64)
+    AcquireSRWLockExclusive((PSRWLOCK)&l->srw);
+#else
+    pthread_rwlock_wrlock(&l->rw);
+#endif
+}
+
+void lib_rwlock_write_unlock(lib_rwlock_t *l) {
+#if defined(_WIN32) || defined(_WIN64)
+    ReleaseSRWLockExclusive((PSRWLOCK)&l->srw);
+#else
+    pthread_rwlock_unlock(&l->rw);
+#endif
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+static BOOL CALLBACK once_entry(PINIT_ONCE o, PVOID param, PVOID *ctx) {
+    (void)o; (void)ctx;
+    void (**fn)(void) = param;
+    (*fn)();
+    return TRUE;
+}
+#endif
+
+void lib_once(lib_once_t *o, void (*fn)(void)) {
+#if defined(_WIN32) || defined(_WIN64)
+    InitOnceExecuteOnce((PINIT_ONCE)&o->once, once_entry, (PVOID)&fn, NULL);
+#else
+    pthread_once(&o->once, fn);
+#endif
+}
+
+bool lib_cond_init(lib_cond_t *c) {
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeConditionVariable((PCONDITION_VARIABLE)&c->cv);
+    return true;
+#else
+    return pthread_cond_init(&c->c, NULL) == 0;
+#endif
+}
+
+void lib_cond_destroy(lib_cond_t *c) {
+#if defined(_WIN32) || defined(_WIN64)
+    (void)c;
+#else
+    pthread_cond_destroy(&c->c);
+#endif
+}
+
+void lib_cond_wait(lib_cond_t *c, lib_mutex_t *m) {
+#if defined(_WIN32) || defined(_WIN64)
+    SleepConditionVariableSRW((PCONDITION_VARIABLE)&c->cv, (PSRWLOCK)&m->srw, INFINITE, 0);
+#else
+    pthread_cond_wait(&c->c, &m->m);
+#endif
+}
+
+void lib_cond_signal(lib_cond_t *c) {
+#if defined(_WIN32) || defined(_WIN64)
+    WakeConditionVariable((PCONDITION_VARIABLE)&c->cv);
+#else
+    pthread_cond_signal(&c->c);
+#endif
+}
+
+void lib_cond_broadcast(lib_cond_t *c) {
+#if defined(_WIN32) || defined(_WIN64)
+    WakeAllConditionVariable((PCONDITION_VARIABLE)&c->cv);
+#else
+    pthread_cond_broadcast(&c->c);
+#endif
+}
+
+unsigned lib_cpu_count(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (unsigned)si.dwNumberOfProcessors : 1u;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1u;
+#endif
+}
+
+double lib_clock_ms(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+#endif
+}
+
+unsigned long long lib_wall_clock_ms(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    unsigned long long t = ((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return t / 10000ULL - 11644473600000ULL;   /* 100 ns sejak 1601 -> ms sejak 1970 */
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (unsigned long long)ts.tv_sec * 1000ULL + (unsigned long long)ts.tv_nsec / 1000000ULL;
+#endif
+}
+
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(__GNUC__)
+static pthread_mutex_t atomic_fallback = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+unsigned long long lib_atomic_add(volatile unsigned long long *p, unsigned long long v) {
+#if defined(_WIN32) || defined(_WIN64)
+    return (unsigned long long)InterlockedExchangeAdd64((volatile LONG64 *)p, (LONG64)v) + v;
+#elif defined(__GNUC__)
+    return __atomic_add_fetch(p, v, __ATOMIC_RELAXED);
+#else
+    pthread_mutex_lock(&atomic_fallback);
+    unsigned long long r = (*p += v);
+    pthread_mutex_unlock(&atomic_fallback);
+    return r;
+#endif
+}
@@ -13,25 +13,27 @@
 
 #include <string.h>
 #include "../include/library.h"
-
-/* Our own strdup implementation */
-static char *my_strdup(const char *str) {
-    if (!str) return NULL;
-    size_t len = strlen(str) + 1;
-    char *new_str = malloc(len);
-    if (new_str) {
-        memcpy(new_str, str, len);
-    }
-    return new_str;
-}
+#include "../include/lib_index.h"
+#include "../include/lib_text.h"
+#include "../include/lib_journal.h"
+#include "../include/lib_snapshot.h"
+#include "../include/lib_csv.h"
+#include "../include/lib_thread.h"
+#include "../include/lib_import.h"
+#include "../include/lib_archive.h"
+#include "../include/lib_arena.h"
+#include "../include/lib_rows.h"
 
 #include <errno.h>
 #include <ctype.h>
+#include <limits.h>
 #include <math.h>
 #include <sys/stat.h>
 #include <stdarg.h>
 #if defined(_WIN32) || defined(_WIN64)
 #include <direct.h>
+#else
+#include <unistd.h>     /* fsync */
 #endif
 
 /* strtok_r compatibility for Windows / non-POSIX */
@@ -136,7 +138,6 @@ static time_t timegm_portable(struct tm *tm) {
 /* ---------- internal helpers ---------- */
 
 #define INITIAL_CAPACITY LIB_DEFAULT_CAPACITY
-static unsigned long _id_counter = 0;
 
 /* Default replacement-cost multiplier (days) used when DB doesn't override it. */
 #define LIB_REPLACEMENT_COST_DAYS_DEFAULT 30UL
@@ -174,31 +175,165 @@ static int ensure_dir_for_path(const char *path) {
 #endif
 }
 
-static void str_to_lower_inplace(char *s) {
-    if (!s) return;
-    for (; *s; ++s) *s = (char) tolower((unsigned char)*s);
-}
-
-static int contains_case_insensitive(const char *haystack, const char *needle) {
-    if (!haystack || !needle) return 0;
-    size_t hlen = strlen(haystack), nlen = strlen(needle);
-    if (nlen == 0) return 1;
-    char *hl = malloc(hlen + 1);
-    char *nl = malloc(nlen + 1);
-    if (!hl || !nl) { free(hl); free(nl); return 0; }
-    strcpy(hl, haystack); strcpy(nl, needle);
-    str_to_lower_inplace(hl); str_to_lower_inplace(nl);
-    int res = (strstr(hl, nl) != NULL);
-    free(hl); free(nl);
-    return res;
+/* ---------- ID 64-bit ----------
+ * ID alokator: 41 bit milidetik sejak LIB_ID_EPOCH_MS lalu 22 bit urutan,
+ * selalu di bawah 2^63. ID dari teks lama yang tidak berbentuk angka (atau
+ * angka >= 2^63, mis. "L<time><rand>" versi lama) berada di atas 2^63 dan
+ * tidak menggeser high-water mark.
+ */
+#define LIB_ID_EPOCH_MS 1577836800000ULL          /* 2020-01-01T00:00:00Z */
+#define LIB_ID_SEQ_BITS 22
+#define LIB_ID_FOREIGN ((lib_id_t)1 << 63)
+
+void lib_id_format(lib_id_t id, char prefix, char *out, size_t out_sz) {
+    if (!out || out_sz == 0) return;
+    if (id == LIB_ID_NONE) { out[0] = '\0'; return; }
+    if (prefix) snprintf(out, out_sz, "%c%llu", prefix, (unsigned long long)id);
+    else snprintf(out, out_sz, "%llu", (unsigned long long)id);
+}
+
+bool lib_id_parse(const char *text, lib_id_t *out) {
+    if (!text || !out || text[0] == '\0') return false;
+    const char *p = text;
+    if (isalpha((unsigned char)*p)) p++;
+    lib_id_t v = 0;
+    bool numeric = *p != '\0';
+    for (; numeric && *p; ++p) {
+        unsigned d = (unsigned)(*p - '0');
+        if (d > 9 || v > (UINT64_MAX - d) / 10) numeric = false;
+        else v = v * 10 + d;
+    }
+    *out = numeric && v != LIB_ID_NONE ? v : (lib_hash_str(text) | LIB_ID_FOREIGN);
+    return true;
+}
+
+/* Naikkan high-water mark untuk ID yang dimuat/di-replay (ID asing diabaikan) */
+static void note_id(library_db_t *db, lib_id_t id) {
+    if (id < LIB_ID_FOREIGN && id > db->id_high_water) db->id_high_water = id;
+}
+
+static lib_id_t next_id(library_db_t *db) {
+    if (!db) return LIB_ID_NONE;
+    unsigned long long now = lib_wall_clock_ms();
+    lib_id_t t = now > LIB_ID_EPOCH_MS ? (lib_id_t)(now - LIB_ID_EPOCH_MS) << LIB_ID_SEQ_BITS : 0;
+    lib_id_t id = db->id_high_water + 1;
+    if (t > id && t < LIB_ID_FOREIGN) id = t;   /* jam mundur: lanjut dari high-water */
+    db->id_high_water = id;
+    db->dirty |= LIB_DIRTY_META;
+    return id;
+}
+
+lib_id_t lib_next_id(library_db_t *db) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ID_NONE;
+    lib_id_t r = next_id(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+/* ---------- ISBN 64-bit ----------
+ * Kanonik: angka ISBN-13 (< 10^13, bit 62/63 mati).
+ * Mentah (bit 63): bit 62 mati = angka <= 17 digit, panjangnya di bit 57..61
+ * agar nol di depan tidak hilang; bit 62 menyala = <= 8 karakter ASCII 7-bit
+ * di bit 0..55, karakter pertama paling tinggi (urutan tetap urutan teks).
+ */
+#define LIB_ISBN_RAW ((lib_isbn_t)1 << 63)
+#define LIB_ISBN_RAW_TEXT ((lib_isbn_t)1 << 62)
+#define LIB_ISBN_RAW_DIGITS 17
+#define LIB_ISBN_RAW_CHARS 8
+#define LIB_ISBN13_LIMIT 10000000000000ULL
+
+/* Buang '-' dan spasi; false jika hasilnya tidak muat di out */
+static bool isbn_compact(const char *text, char *out, size_t out_sz) {
+    size_t n = 0;
+    for (const char *p = text; *p; ++p) {
+        if (*p == '-' || *p == ' ') continue;
+        if (n + 1 >= out_sz) return false;
+        out[n++] = *p;
+    }
+    out[n] = '\0';
+    return true;
+}
+
+static bool all_digits(const char *s, size_t n) {
+    for (size_t i = 0; i < n; ++i) if (!isdigit((unsigned char)s[i])) return false;
+    return true;
+}
+
+static int isbn13_check_digit(const char *d) {
+    int sum = 0;
+    for (int i = 0; i < 12; ++i) sum += (d[i] - '0') * (i % 2 ? 3 : 1);
+    return (10 - sum % 10) % 10;
+}
+
+bool lib_isbn_parse(const char *text, lib_isbn_t *out) {
+    char d[16];
+    if (!text || !out || !isbn_compact(text, d, sizeof(d))) return false;
+    size_t n = strlen(d);
+    if (n == 10) {
+        if (!all_digits(d, 9)) return false;
+        int sum = 0;
+        for (int i = 0; i < 9; ++i) sum += (d[i] - '0') * (10 - i);
+        int c = d[9] == 'X' || d[9] == 'x' ? 10 : isdigit((unsigned char)d[9]) ? d[9] - '0' : -1;
+        if (c < 0 || (sum + c) % 11 != 0) return false;
+        /* ISBN-10 -> 978 + 9 digit + check digit ISBN-13 baru */
+        memmove(d + 3, d, 9);
+        memcpy(d, "978", 3);
+        d[12] = (char)('0' + isbn13_check_digit(d));
+        d[13] = '\0';
+    } else if (n == 13) {
+        if (!all_digits(d, 13) || d[12] - '0' != isbn13_check_digit(d)) return false;
+        if (strncmp(d, "978", 3) != 0 && strncmp(d, "979", 3) != 0) return false;
+    } else {
+        return false;
+    }
+    lib_isbn_t v = 0;
+    for (int i = 0; i < 13; ++i) v = v * 10 + (lib_isbn_t)(d[i] - '0');
+    *out = v;
+    return true;
+}
+
+lib_isbn_t lib_isbn_key(const char *text) {
+    lib_isbn_t v;
+    if (lib_isbn_parse(text, &v)) return v;
+    char d[LIB_ISBN_TEXT_MAX];
+    if (!text || !isbn_compact(text, d, sizeof(d)) || d[0] == '\0') return LIB_ISBN_NONE;
+    size_t n = strlen(d);
+    if (n <= LIB_ISBN_RAW_DIGITS && all_digits(d, n)) {
+        v = 0;
+        for (size_t i = 0; i < n; ++i) v = v * 10 + (lib_isbn_t)(d[i] - '0');
+        return LIB_ISBN_RAW | ((lib_isbn_t)n << 57) | v;
+    }
+    if (n > LIB_ISBN_RAW_CHARS) return LIB_ISBN_NONE;
+    v = 0;
+    for (size_t i = 0; i < LIB_ISBN_RAW_CHARS; ++i) {
+        unsigned char c = i < n ? (unsigned char)d[i] : 0;
+        if (c > 0x7f || (i < n && c < 0x20)) return LIB_ISBN_NONE;
+        v = (v << 7) | c;
+    }
+    return LIB_ISBN_RAW | LIB_ISBN_RAW_TEXT | v;
+}
+
+void lib_isbn_format(lib_isbn_t isbn, char *out, size_t out_sz) {
+    if (!out || out_sz == 0) return;
+    out[0] = '\0';
+    if (isbn == LIB_ISBN_NONE) return;
+    if (!(isbn & LIB_ISBN_RAW)) {
+        snprintf(out, out_sz, "%013llu", (unsigned long long)isbn);
+    } else if (!(isbn & LIB_ISBN_RAW_TEXT)) {
+        int len = (int)((isbn >> 57) & 0x1f);
+        snprintf(out, out_sz, "%0*llu", len, (unsigned long long)(isbn & (((lib_isbn_t)1 << 57) - 1)));
+    } else {
+        char t[LIB_ISBN_RAW_CHARS + 1];
+        for (int i = 0; i < LIB_ISBN_RAW_CHARS; ++i)
+            t[i] = (char)((isbn >> (7 * (LIB_ISBN_RAW_CHARS - 1 - i))) & 0x7f);
+        t[LIB_ISBN_RAW_CHARS] = '\0';
+        snprintf(out, out_sz, "%s", t);
+    }
 }
 
-static void generate_unique_id(const char *prefix, char *out, size_t out_sz) {
-    time_t t = time(NULL);
-    _id_counter++;
-    unsigned long r = (unsigned long)rand();
-    if (!prefix) prefix = "ID";
-    snprintf(out, out_sz, "%s%lu%lu", prefix, (unsigned long)t, (unsigned long)(r ^ _id_counter));
+bool lib_isbn_is_valid(lib_isbn_t isbn) {
+    return isbn != LIB_ISBN_NONE && isbn < LIB_ISBN13_LIMIT;
 }
 
 /* ---------- Date helpers (public API implemented) ---------- */
@@ -217,69 +352,469 @@ time_t lib_time_t_from_date(lib_date_t d) {
     tm.tm_hour = 0; tm.tm_min = 0; tm.tm_sec = 0;
     return timegm_portable(&tm);
 }
+/* Nomor hari untuk tanggal sipil (Gregorian proleptik): tahun dimulai Maret
+ * sehingga hari kabisat jatuh di akhir, lalu dihitung per era 400 tahun */
+lib_day_t lib_date_to_days(lib_date_t d) {
+    long y = d.year - (d.month <= 2);
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long mp = (d.month + 9) % 12;
+    long doy = (153 * mp + 2) / 5 + d.day - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (lib_day_t)(era * 146097 + doe - 719468);
+}
+
+lib_date_t lib_date_from_days(lib_day_t days) {
+    long z = (long)days + 719468;
+    long era = (z >= 0 ? z : z - 146096) / 146097;
+    long doe = z - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+    lib_date_t d;
+    d.day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    d.month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    d.year = (int)(yoe + era * 400 + (d.month <= 2));
+    return d;
+}
+
+lib_date_t lib_date_add_days(lib_date_t d, int n) {
+    return lib_date_from_days(lib_date_to_days(d) + n);
+}
+
+/* UTC lewat gmtime, konsisten dengan tanggal pinjam yang diisi UI */
+lib_day_t lib_day_today(void) {
+    return lib_date_to_days(lib_date_from_time_t(time(NULL)));
+}
+
+void lib_day_format(lib_day_t day, char *out, size_t out_sz) {
+    lib_date_t d = lib_date_from_days(day);
+    snprintf(out, out_sz, "%04d-%02d-%02d", d.year, d.month, d.day);
+}
+
 int lib_date_days_between(lib_date_t a, lib_date_t b) {
-    time_t ta = lib_time_t_from_date(a);
-    time_t tb = lib_time_t_from_date(b);
-    if (ta == (time_t)-1 || tb == (time_t)-1) return 0;
-    double diff = difftime(tb, ta);
-    return (int)(diff / 86400.0);
+    return (int)(lib_date_to_days(b) - lib_date_to_days(a));
 }
 
-/* ---------- Dynamic capacity helpers ---------- */
+/* ---------- Dynamic capacity helpers ----------
+ * Tabel disimpan per chunk dari db->arena (lib_rows.h): kapasitas bertambah
+ * dengan menambah chunk, baris yang ada tidak disalin dan alamatnya tetap. */
+
+static book_t *book_row(const library_db_t *db, size_t i) { return LIB_ROWS_AT(book_t, &db->books, i); }
+static lib_book_hot_t *hot_row(const library_db_t *db, size_t i) { return LIB_ROWS_AT(lib_book_hot_t, &db->books_hot, i); }
+static borrower_t *borrower_row(const library_db_t *db, size_t i) { return LIB_ROWS_AT(borrower_t, &db->borrowers, i); }
+static loan_t *history_row(const library_db_t *db, size_t i) { return LIB_ROWS_AT(loan_t, &db->loans, i); }
+static loan_t *active_row(const library_db_t *db, size_t i) { return LIB_ROWS_AT(loan_t, &db->active_loans, i); }
+
+/* Semua tabel kosong (tanpa alokasi); chunk lama ikut arena pemiliknya */
+static void tables_init(library_db_t *db) {
+    lib_rows_init(&db->books, sizeof(book_t));
+    lib_rows_init(&db->books_hot, sizeof(lib_book_hot_t));
+    lib_rows_init(&db->borrowers, sizeof(borrower_t));
+    lib_rows_init(&db->active_loans, sizeof(loan_t));
+    lib_rows_init(&db->loans, sizeof(loan_t));
+    db->books_count = db->borrowers_count = 0;
+    db->books_tombstones = 0;
+    db->active_loans_count = db->loans_count = 0;
+    db->loans_tombstones = 0;
+}
 
 static lib_status_t ensure_books_capacity(library_db_t *db) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    if (db->books_capacity == 0) {
-        db->books_capacity = INITIAL_CAPACITY;
-        db->books = calloc(db->books_capacity, sizeof(book_t));
-        if (!db->books) return LIB_ERR_MEMORY;
-    } else if (db->books_count >= db->books_capacity) {
-        size_t newcap = db->books_capacity * 2;
-        book_t *tmp = realloc(db->books, newcap * sizeof(book_t));
-        if (!tmp) return LIB_ERR_MEMORY;
-        db->books = tmp;
-        db->books_capacity = newcap;
-    }
+    /* books lebih dulu: jika hot gagal, kapasitas books yang lebih besar tidak dipakai */
+    if (!lib_rows_reserve(&db->books, db->arena, db->books_count + 1)) return LIB_ERR_MEMORY;
+    if (!lib_rows_reserve(&db->books_hot, db->arena, db->books_count + 1)) return LIB_ERR_MEMORY;
+    return LIB_OK;
+}
+
+/* Satu-satunya jalur tulis baris buku: book_t dan kolom panasnya selalu
+ * diubah bersama, jadi keduanya tidak bisa berbeda */
+static void book_store(library_db_t *db, size_t row, const book_t *b) {
+    lib_book_hot_t *h = hot_row(db, row);
+    *book_row(db, row) = *b;
+    h->isbn = b->isbn;
+    h->price = b->price;
+    h->year = b->year;
+    h->total_stock = b->total_stock;
+    h->available = b->available;
+}
+
+static void book_set_stock(library_db_t *db, size_t row, int total_stock, int available) {
+    book_t *b = book_row(db, row);
+    lib_book_hot_t *h = hot_row(db, row);
+    b->total_stock = h->total_stock = total_stock;
+    b->available = h->available = available;
+}
+
+/* Tambah baris buku di akhir tabel (baris + kolom panas) */
+static lib_status_t append_book_row(library_db_t *db, const book_t *b) {
+    lib_status_t st = ensure_books_capacity(db);
+    if (st != LIB_OK) return st;
+    book_store(db, db->books_count, b);
+    db->books_count++;
     return LIB_OK;
 }
 
 static lib_status_t ensure_borrowers_capacity(library_db_t *db) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    if (db->borrowers_capacity == 0) {
-        db->borrowers_capacity = INITIAL_CAPACITY;
-        db->borrowers = calloc(db->borrowers_capacity, sizeof(borrower_t));
-        if (!db->borrowers) return LIB_ERR_MEMORY;
-    } else if (db->borrowers_count >= db->borrowers_capacity) {
-        size_t newcap = db->borrowers_capacity * 2;
-        borrower_t *tmp = realloc(db->borrowers, newcap * sizeof(borrower_t));
-        if (!tmp) return LIB_ERR_MEMORY;
-        db->borrowers = tmp;
-        db->borrowers_capacity = newcap;
-    }
-    return LIB_OK;
+    return lib_rows_reserve(&db->borrowers, db->arena, db->borrowers_count + 1) ? LIB_OK : LIB_ERR_MEMORY;
 }
 
 static lib_status_t ensure_loans_capacity(library_db_t *db) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    if (db->loans_capacity == 0) {
-        db->loans_capacity = INITIAL_CAPACITY;
-        db->loans = calloc(db->loans_capacity, sizeof(loan_t));
-        if (!db->loans) return LIB_ERR_MEMORY;
-    } else if (db->loans_count >= db->loans_capacity) {
-        size_t newcap = db->loans_capacity * 2;
-        loan_t *tmp = realloc(db->loans, newcap * sizeof(loan_t));
-        if (!tmp) return LIB_ERR_MEMORY;
-        db->loans = tmp;
-        db->loans_capacity = newcap;
+    return lib_rows_reserve(&db->loans, db->arena, db->loans_count + 1) ? LIB_OK : LIB_ERR_MEMORY;
+}
+
+/* Pastikan kapasitas minimal untuk jumlah baris yang sudah diketahui (loader) */
+static lib_status_t reserve_rows(library_db_t *db, size_t books, size_t borrowers, size_t loans) {
+    if (!lib_rows_reserve(&db->books, db->arena, books) || !lib_rows_reserve(&db->books_hot, db->arena, books) ||
+        !lib_rows_reserve(&db->borrowers, db->arena, borrowers) || !lib_rows_reserve(&db->loans, db->arena, loans)) {
+        return LIB_ERR_MEMORY;
+    }
+    return LIB_OK;
+}
+
+static lib_status_t append_borrower_row(library_db_t *db, const borrower_t *br) {
+    lib_status_t st = ensure_borrowers_capacity(db);
+    if (st != LIB_OK) return st;
+    *borrower_row(db, db->borrowers_count++) = *br;
+    note_id(db, br->id);
+    return LIB_OK;
+}
+
+static lib_status_t ensure_active_loans_capacity(library_db_t *db) {
+    return lib_rows_reserve(&db->active_loans, db->arena, db->active_loans_count + 1) ? LIB_OK : LIB_ERR_MEMORY;
+}
+
+/* Partisi tujuan: pinjaman terbuka di active_loans, selesai/hilang di loans */
+static bool loan_is_open(const loan_t *ln) {
+    return !ln->is_returned && !ln->is_lost;
+}
+
+/* Tambah baris di akhir partisinya (tanpa indeks; dipakai loader) */
+static lib_status_t append_loan_row(library_db_t *db, const loan_t *ln) {
+    lib_status_t st;
+    note_id(db, ln->loan_id);
+    if (loan_is_open(ln)) {
+        st = ensure_active_loans_capacity(db);
+        if (st == LIB_OK) *active_row(db, db->active_loans_count++) = *ln;
+        return st;
     }
+    st = ensure_loans_capacity(db);
+    if (st != LIB_OK) return st;
+    *history_row(db, db->loans_count++) = *ln;
     return LIB_OK;
 }
 
+/* ---------- Primary-key hash index ----------
+ * Semua lookup kunci (ISBN, loan_id, borrower id, NIM) lewat indeks ini.
+ * Indeks menyimpan nomor baris; jika baris bergeser (compact/import) indeks
+ * dibangun ulang. Jika alokasi indeks gagal, indeks dilepas (db->index = NULL)
+ * dan semua lookup kembali ke linear scan sehingga hasil tetap benar.
+ */
+
+struct lib_db_index {
+    lib_hindex_t book_isbn;
+    lib_hindex_t borrower_id;
+    lib_hindex_t borrower_nim;
+    lib_hindex_t loan_id;
+
+    /* Multimap borrower_id -> loans: setiap borrower_id punya satu "grup"
+     * berisi linked list baris loan (urut sesuai urutan tabel). */
+    lib_hindex_t loan_group;   /* hash(borrower_id) -> nomor grup */
+    uint32_t *group_head;
+    uint32_t *group_tail;
+    size_t group_count;
+    size_t group_capacity;
+    uint32_t *loan_next;       /* per baris loan: baris berikutnya di grup yang sama */
+    size_t loan_next_capacity;
+
+    /* Partisi aktif: loan_id -> baris, dan borrower_id -> baris sebagai
+     * multimap (kunci duplikat, ditelusuri dengan lib_hindex_find_next) */
+    lib_hindex_t active_id;
+    lib_hindex_t active_borrower;
+    /* Partisi aktif per hari jatuh tempo */
+    lib_calendar_index_t active_due;
+
+    /* Trigram posting list untuk pencarian substring judul dan pengarang */
+    lib_trigram_index_t title_tri;
+    lib_trigram_index_t author_tri;
+};
+
+static bool eq_book_isbn(const void *ctx, uint32_t row, const void *key) {
+    const library_db_t *db = ctx;
+    return row < db->books_count && hot_row(db, row)->isbn == *(const lib_isbn_t *)key;
+}
+static bool eq_borrower_id(const void *ctx, uint32_t row, const void *key) {
+    const library_db_t *db = ctx;
+    return row < db->borrowers_count && borrower_row(db, row)->id == *(const lib_id_t *)key;
+}
+static bool eq_borrower_nim(const void *ctx, uint32_t row, const void *key) {
+    const library_db_t *db = ctx;
+    return row < db->borrowers_count && strcmp(borrower_row(db, row)->nim, (const char *)key) == 0;
+}
+static bool eq_loan_id(const void *ctx, uint32_t row, const void *key) {
+    const library_db_t *db = ctx;
+    return row < db->loans_count && history_row(db, row)->loan_id == *(const lib_id_t *)key;
+}
+
+static bool eq_active_id(const void *ctx, uint32_t row, const void *key) {
+    const library_db_t *db = ctx;
+    return row < db->active_loans_count && active_row(db, row)->loan_id == *(const lib_id_t *)key;
+}
+static bool eq_active_borrower(const void *ctx, uint32_t row, const void *key) {
+    const library_db_t *db = ctx;
+    return row < db->active_loans_count && active_row(db, row)->borrower_id == *(const lib_id_t *)key;
+}
+
+static bool eq_loan_group(const void *ctx, uint32_t group, const void *key) {
+    const library_db_t *db = ctx;
+    uint32_t row = db->index->group_head[group];
+    return row < db->loans_count && history_row(db, row)->borrower_id == *(const lib_id_t *)key;
+}
+
+static void index_drop(library_db_t *db) {
+    if (!db || !db->index) return;
+    lib_hindex_free(&db->index->book_isbn);
+    lib_hindex_free(&db->index->borrower_id);
+    lib_hindex_free(&db->index->borrower_nim);
+    lib_hindex_free(&db->index->loan_id);
+    lib_hindex_free(&db->index->loan_group);
+    lib_hindex_free(&db->index->active_id);
+    lib_hindex_free(&db->index->active_borrower);
+    lib_calendar_free(&db->index->active_due);
+    lib_mem_release(db->arena, db->index->group_head);
+    lib_mem_release(db->arena, db->index->group_tail);
+    lib_mem_release(db->arena, db->index->loan_next);
+    lib_trigram_free(&db->index->title_tri);
+    lib_trigram_free(&db->index->author_tri);
+    lib_mem_release(db->arena, db->index);
+    db->index = NULL;
+}
+
+static void index_create(library_db_t *db) {
+    if (!db || db->index) return;
+    db->index = lib_mem_calloc(db->arena, 1, sizeof(*db->index));
+    if (!db->index) return;
+    lib_arena_t *a = db->arena;
+    lib_hindex_init(&db->index->book_isbn, a);
+    lib_hindex_init(&db->index->borrower_id, a);
+    lib_hindex_init(&db->index->borrower_nim, a);
+    lib_hindex_init(&db->index->loan_id, a);
+    lib_hindex_init(&db->index->loan_group, a);
+    lib_hindex_init(&db->index->active_id, a);
+    lib_hindex_init(&db->index->active_borrower, a);
+    lib_calendar_init(&db->index->active_due, a);
+    lib_trigram_init(&db->index->title_tri, a);
+    lib_trigram_init(&db->index->author_tri, a);
+}
+
+/* Insert helper: kunci duplikat tidak ditambahkan (baris pertama menang, sama
+ * seperti linear scan lama). Gagal alokasi -> indeks dilepas. */
+static void index_add(library_db_t *db, lib_hindex_t *ix, lib_hindex_eq_fn eq, const char *key, size_t row) {
+    if (!db->index || !key || key[0] == '\0') return;
+    uint64_t h = lib_hash_str(key);
+    if (lib_hindex_find(ix, h, eq, db, key) != LIB_ROW_NONE) return;
+    if (row >= LIB_ROW_NONE || !lib_hindex_insert(ix, h, (uint32_t)row)) index_drop(db);
+}
+
+/* Sama untuk kunci integer (ID, ISBN): hash satu word, pembanding integer */
+static void index_add_id(library_db_t *db, lib_hindex_t *ix, lib_hindex_eq_fn eq, lib_id_t id, size_t row) {
+    if (!db->index || id == LIB_ID_NONE) return;
+    uint64_t h = lib_hash_u64(id);
+    if (lib_hindex_find(ix, h, eq, db, &id) != LIB_ROW_NONE) return;
+    if (row >= LIB_ROW_NONE || !lib_hindex_insert(ix, h, (uint32_t)row)) index_drop(db);
+}
+
+static void index_add_borrower(library_db_t *db, size_t row) {
+    if (!db->index) return;
+    index_add_id(db, &db->index->borrower_id, eq_borrower_id, borrower_row(db, row)->id, row);
+    if (db->index) index_add(db, &db->index->borrower_nim, eq_borrower_nim, borrower_row(db, row)->nim, row);
+}
+
+static void index_add_book_text(library_db_t *db, size_t row) {
+    if (!db->index) return;
+    const book_t *b = book_row(db, row);
+    if (b->isbn == LIB_ISBN_NONE) return;   /* tombstone */
+    if (!lib_trigram_add(&db->index->title_tri, (uint32_t)row, b->title) ||
+        !lib_trigram_add(&db->index->author_tri, (uint32_t)row, b->author)) index_drop(db);
+}
+
+static void index_rebuild_book_keys(library_db_t *db) {
+    if (!db->index) return;
+    lib_hindex_clear(&db->index->book_isbn);
+    if (!lib_hindex_reserve(&db->index->book_isbn, db->books_count)) { index_drop(db); return; }
+    for (size_t i = 0; i < db->books_count && db->index; ++i)
+        index_add_id(db, &db->index->book_isbn, eq_book_isbn, book_row(db, i)->isbn, i);
+}
+
+static void index_rebuild_books(library_db_t *db) {
+    index_rebuild_book_keys(db);
+    if (!db->index) return;
+    lib_trigram_clear(&db->index->title_tri);
+    lib_trigram_clear(&db->index->author_tri);
+    for (size_t i = 0; i < db->books_count && db->index; ++i) index_add_book_text(db, i);
+}
+
+static void index_rebuild_borrowers(library_db_t *db) {
+    if (!db->index) return;
+    lib_hindex_clear(&db->index->borrower_id);
+    lib_hindex_clear(&db->index->borrower_nim);
+    if (!lib_hindex_reserve(&db->index->borrower_id, db->borrowers_count) ||
+        !lib_hindex_reserve(&db->index->borrower_nim, db->borrowers_count)) { index_drop(db); return; }
+    for (size_t i = 0; i < db->borrowers_count && db->index; ++i) index_add_borrower(db, i);
+}
+
+/* Tambahkan baris loan `row` ke ekor grup borrower-nya (membuat grup baru bila perlu). */
+static void index_add_loan_to_group(library_db_t *db, size_t row) {
+    struct lib_db_index *ix = db->index;
+    if (!ix) return;
+    if (row >= ix->loan_next_capacity) {
+        size_t newcap = ix->loan_next_capacity ? ix->loan_next_capacity : INITIAL_CAPACITY;
+        while (newcap <= row) newcap *= 2;
+        uint32_t *t = lib_mem_grow(db->arena, ix->loan_next, ix->loan_next_capacity * sizeof(uint32_t),
+                                   newcap * sizeof(uint32_t));
+        if (!t) { index_drop(db); return; }
+        ix->loan_next = t;
+        ix->loan_next_capacity = newcap;
+    }
+    ix->loan_next[row] = LIB_ROW_NONE;
+    lib_id_t bid = history_row(db, row)->borrower_id;
+    if (bid == LIB_ID_NONE) return;
+    uint64_t h = lib_hash_u64(bid);
+    uint32_t g = lib_hindex_find(&ix->loan_group, h, eq_loan_group, db, &bid);
+    if (g != LIB_ROW_NONE) {
+        ix->loan_next[ix->group_tail[g]] = (uint32_t)row;
+        ix->group_tail[g] = (uint32_t)row;
+        return;
+    }
+    if (ix->group_count >= ix->group_capacity) {
+        size_t newcap = ix->group_capacity ? ix->group_capacity * 2 : INITIAL_CAPACITY;
+        uint32_t *nh = lib_mem_grow(db->arena, ix->group_head, ix->group_capacity * sizeof(uint32_t),
+                                    newcap * sizeof(uint32_t));
+        if (!nh) { index_drop(db); return; }
+        ix->group_head = nh;
+        uint32_t *nt = lib_mem_grow(db->arena, ix->group_tail, ix->group_capacity * sizeof(uint32_t),
+                                    newcap * sizeof(uint32_t));
+        if (!nt) { index_drop(db); return; }
+        ix->group_tail = nt;
+        ix->group_capacity = newcap;
+    }
+    g = (uint32_t)ix->group_count++;
+    ix->group_head[g] = ix->group_tail[g] = (uint32_t)row;
+    if (!lib_hindex_insert(&ix->loan_group, h, g)) index_drop(db);
+}
+
+static void index_add_active(library_db_t *db, size_t row) {
+    if (!db->index) return;
+    const loan_t *ln = active_row(db, row);
+    index_add_id(db, &db->index->active_id, eq_active_id, ln->loan_id, row);
+    if (!db->index) return;
+    if (!lib_calendar_add(&db->index->active_due, (uint32_t)row, ln->date_due)) { index_drop(db); return; }
+    if (ln->borrower_id == LIB_ID_NONE) return;
+    if (!lib_hindex_insert(&db->index->active_borrower, lib_hash_u64(ln->borrower_id), (uint32_t)row)) index_drop(db);
+}
+
+static void index_remove_active(library_db_t *db, size_t row) {
+    if (!db->index) return;
+    const loan_t *ln = active_row(db, row);
+    lib_hindex_remove(&db->index->active_id, lib_hash_u64(ln->loan_id), (uint32_t)row);
+    lib_hindex_remove(&db->index->active_borrower, lib_hash_u64(ln->borrower_id), (uint32_t)row);
+    lib_calendar_remove(&db->index->active_due, (uint32_t)row);
+}
+
+/* Riwayat (loan_id + multimap grup) dan partisi aktif */
+static void index_rebuild_loans(library_db_t *db) {
+    if (!db->index) return;
+    lib_hindex_clear(&db->index->loan_id);
+    lib_hindex_clear(&db->index->loan_group);
+    lib_hindex_clear(&db->index->active_id);
+    lib_hindex_clear(&db->index->active_borrower);
+    lib_calendar_clear(&db->index->active_due);
+    db->index->group_count = 0;
+    if (!lib_hindex_reserve(&db->index->loan_id, db->loans_count) ||
+        !lib_hindex_reserve(&db->index->active_id, db->active_loans_count) ||
+        !lib_hindex_reserve(&db->index->active_borrower, db->active_loans_count) ||
+        !lib_calendar_reserve(&db->index->active_due, db->active_loans_count)) { index_drop(db); return; }
+    for (size_t i = 0; i < db->loans_count && db->index; ++i) {
+        index_add_id(db, &db->index->loan_id, eq_loan_id, history_row(db, i)->loan_id, i);
+        index_add_loan_to_group(db, i);
+    }
+    for (size_t i = 0; i < db->active_loans_count && db->index; ++i) index_add_active(db, i);
+}
+
+static void index_rebuild_all(library_db_t *db) {
+    index_rebuild_books(db);
+    index_rebuild_borrowers(db);
+    index_rebuild_loans(db);
+}
+
+/* Row lookups: SIZE_MAX jika tidak ditemukan */
+static size_t find_book_row(const library_db_t *db, lib_isbn_t isbn) {
+    if (isbn == LIB_ISBN_NONE) return SIZE_MAX;
+    if (db->index) {
+        uint32_t r = lib_hindex_find(&db->index->book_isbn, lib_hash_u64(isbn), eq_book_isbn, db, &isbn);
+        return r == LIB_ROW_NONE ? SIZE_MAX : (size_t)r;
+    }
+    for (size_t i = 0; i < db->books_count; ++i) if (hot_row(db, i)->isbn == isbn) return i;
+    return SIZE_MAX;
+}
+
+static size_t find_borrower_row(const library_db_t *db, lib_id_t id) {
+    if (id == LIB_ID_NONE) return SIZE_MAX;
+    if (db->index) {
+        uint32_t r = lib_hindex_find(&db->index->borrower_id, lib_hash_u64(id), eq_borrower_id, db, &id);
+        return r == LIB_ROW_NONE ? SIZE_MAX : (size_t)r;
+    }
+    for (size_t i = 0; i < db->borrowers_count; ++i) if (borrower_row(db, i)->id == id) return i;
+    return SIZE_MAX;
+}
+
+static size_t find_borrower_row_by_nim(const library_db_t *db, const char *nim) {
+    if (db->index && nim[0] != '\0') {
+        uint32_t r = lib_hindex_find(&db->index->borrower_nim, lib_hash_str(nim), eq_borrower_nim, db, nim);
+        return r == LIB_ROW_NONE ? SIZE_MAX : (size_t)r;
+    }
+    for (size_t i = 0; i < db->borrowers_count; ++i) if (strcmp(borrower_row(db, i)->nim, nim) == 0) return i;
+    return SIZE_MAX;
+}
+
+/* Letak satu loan: partisi aktif atau riwayat */
+typedef struct {
+    bool active;
+    size_t row;
+} loan_pos_t;
+
+/* Partisi aktif dicek dulu (kecil, paling sering dicari) */
+static bool find_loan_pos(const library_db_t *db, lib_id_t loan_id, loan_pos_t *out) {
+    if (loan_id == LIB_ID_NONE) return false;   /* tombstone */
+    if (db->index) {
+        uint64_t h = lib_hash_u64(loan_id);
+        uint32_t r = lib_hindex_find(&db->index->active_id, h, eq_active_id, db, &loan_id);
+        if (r != LIB_ROW_NONE) { out->active = true; out->row = r; return true; }
+        r = lib_hindex_find(&db->index->loan_id, h, eq_loan_id, db, &loan_id);
+        if (r == LIB_ROW_NONE) return false;
+        out->active = false; out->row = r;
+        return true;
+    }
+    for (size_t i = 0; i < db->active_loans_count; ++i)
+        if (active_row(db, i)->loan_id == loan_id) { out->active = true; out->row = i; return true; }
+    for (size_t i = 0; i < db->loans_count; ++i)
+        if (history_row(db, i)->loan_id == loan_id) { out->active = false; out->row = i; return true; }
+    return false;
+}
+
+static loan_t *loan_at(const library_db_t *db, loan_pos_t p) {
+    return p.active ? active_row(db, p.row) : history_row(db, p.row);
+}
+
 /* ---------- Path helper ---------- */
 
-static char *alloc_path_with_suffix(const char *base, const char *suffix) {
+/* Path sementara dari scratch arena pemanggil (LIB_SCRATCH); hidup sampai
+ * arena itu dilepas */
+static char *scratch_path(lib_arena_t *s, const char *base, const char *suffix) {
     size_t len = strlen(base) + strlen(suffix) + 2;
-    char *buf = malloc(len);
+    char *buf = lib_arena_alloc(s, len);
     if (!buf) return NULL;
     snprintf(buf, len, "%s%s", base, suffix);
     return buf;
@@ -288,84 +823,310 @@ static char *alloc_path_with_suffix(const char *base, const char *suffix) {
 /* forward declaration for meta-file reader used during DB open */
 static void read_meta_file(library_db_t *db);
 
+/* ---------- CSV row format (dipakai file CSV dan journal) ---------- */
+
+/* Dihitung dari field maksimum: teks yang seluruhnya tanda kutip menjadi
+ * 2n + 2 byte, sisanya ISBN/ID, angka, harga "%.2f" terpanjang (~312 byte)
+ * dan koma. Baris yang tetap lebih panjang ditolak (journal -> checkpoint,
+ * writer CSV -> save gagal), tidak pernah dipotong diam-diam. */
+#define CSV_QUOTED_MAX(n) (2 * (n) + 2)
+#define LIB_ROW_BUF 2048
+typedef char book_row_fits[CSV_QUOTED_MAX(LIB_MAX_TITLE + LIB_MAX_AUTHOR + LIB_MAX_NOTES) + 512
+                           <= LIB_ROW_BUF ? 1 : -1];
+typedef char borrower_row_fits[CSV_QUOTED_MAX(sizeof(((borrower_t *)0)->nim) + LIB_MAX_NAME
+                                              + sizeof(((borrower_t *)0)->phone)
+                                              + sizeof(((borrower_t *)0)->email)) + 64
+                               <= LIB_ROW_BUF ? 1 : -1];
+
+/* Field-field satu baris; dipakai baris journal (format_*_row) dan penulis
+ * file CSV yang memformat langsung ke buffer lib_csv_writer_t */
+static void row_isbn(lib_csv_row_t *row, lib_isbn_t isbn) {
+    if (lib_isbn_is_valid(isbn)) { lib_csv_row_uint(row, 0, isbn, 13); return; }
+    char text[LIB_ISBN_TEXT_MAX];
+    lib_isbn_format(isbn, text, sizeof(text));
+    lib_csv_row_str(row, text);
+}
+
+static void row_id(lib_csv_row_t *row, lib_id_t id, char prefix) {
+    if (id == LIB_ID_NONE) lib_csv_row_raw(row, "");
+    else lib_csv_row_uint(row, prefix, id, 0);
+}
+
+static void row_day(lib_csv_row_t *row, lib_day_t day) {
+    lib_date_t d = lib_date_from_days(day);
+    lib_csv_row_date(row, d.year, d.month, d.day);
+}
+
+static void book_fields(lib_csv_row_t *row, const book_t *b) {
+    row_isbn(row, b->isbn);
+    lib_csv_row_str(row, b->title);
+    lib_csv_row_str(row, b->author);
+    lib_csv_row_long(row, b->year);
+    lib_csv_row_long(row, b->total_stock);
+    lib_csv_row_long(row, b->available);
+    lib_csv_row_fixed2(row, b->price);
+    lib_csv_row_str(row, b->notes);
+}
+
+static void borrower_fields(lib_csv_row_t *row, const borrower_t *br) {
+    row_id(row, br->id, 'B');
+    lib_csv_row_str(row, br->nim);
+    lib_csv_row_str(row, br->name);
+    lib_csv_row_str(row, br->phone);
+    lib_csv_row_str(row, br->email);
+}
+
+static void loan_fields(lib_csv_row_t *row, const loan_t *l) {
+    row_id(row, l->loan_id, 'L');
+    row_isbn(row, l->isbn);
+    row_id(row, l->borrower_id, 'B');
+    row_day(row, l->date_borrow);
+    row_day(row, l->date_due);
+    if (l->is_returned) row_day(row, l->date_returned);
+    else lib_csv_row_raw(row, "");
+    lib_csv_row_long(row, l->is_returned ? 1 : 0);
+    lib_csv_row_long(row, l->is_lost ? 1 : 0);
+    lib_csv_row_long(row, (long)l->fine_paid);
+}
+
+static int format_book_row(const book_t *b, char *out, size_t out_sz) {
+    lib_csv_row_t row;
+    lib_csv_row_init(&row, out, out_sz);
+    book_fields(&row, b);
+    return lib_csv_row_end(&row);
+}
+
+static int format_borrower_row(const borrower_t *br, char *out, size_t out_sz) {
+    lib_csv_row_t row;
+    lib_csv_row_init(&row, out, out_sz);
+    borrower_fields(&row, br);
+    return lib_csv_row_end(&row);
+}
+
+static int format_loan_row(const loan_t *l, char *out, size_t out_sz) {
+    lib_csv_row_t row;
+    lib_csv_row_init(&row, out, out_sz);
+    loan_fields(&row, l);
+    return lib_csv_row_end(&row);
+}
+
+/* Salin field ke buffer tetap (dipotong bila terlalu panjang) */
+static void copy_field(char *dst, size_t cap, const lib_csv_field_t *f) {
+    size_t n = f->len < cap - 1 ? f->len : cap - 1;
+    memcpy(dst, f->ptr, n);
+    dst[n] = '\0';
+}
+
+/* Field ID teks -> lib_id_t; kosong = LIB_ID_NONE */
+static lib_id_t parse_id_field(const lib_csv_field_t *f) {
+    char buf[64];
+    lib_id_t id = LIB_ID_NONE;
+    copy_field(buf, sizeof(buf), f);
+    (void)lib_id_parse(buf, &id);
+    return id;
+}
+
+/* Field ISBN -> kunci (kanonik atau mentah); kosong/tidak muat = LIB_ISBN_NONE */
+static lib_isbn_t parse_isbn_field(const lib_csv_field_t *f) {
+    char buf[64];
+    copy_field(buf, sizeof(buf), f);
+    return lib_isbn_key(buf);
+}
+
+static bool parse_date_field(const lib_csv_field_t *f, lib_day_t *out) {
+    int y, m, d;
+    if (f->len < 8 || !lib_csv_to_date(f, &y, &m, &d)) return false;
+    *out = lib_date_to_days((lib_date_t){ y, m, d });
+    return true;
+}
+
+/* Jumlah kolom per tabel; LOAN_FIELDS juga ukuran array field terbesar */
+#define BOOK_FIELDS 8
+#define BORROWER_FIELDS 5
+#define LOAN_FIELDS 9
+
+static bool parse_book_row(const lib_csv_field_t *f, size_t n, book_t *b) {
+    if (n < 3 || f[0].len == 0) return false;
+    memset(b, 0, sizeof(*b));
+    b->isbn = parse_isbn_field(&f[0]);
+    if (b->isbn == LIB_ISBN_NONE) return false;
+    copy_field(b->title, sizeof(b->title), &f[1]);
+    copy_field(b->author, sizeof(b->author), &f[2]);
+    if (n > 3) b->year = (int)lib_csv_to_long(&f[3]);
+    if (n > 4) b->total_stock = (int)lib_csv_to_long(&f[4]);
+    if (n > 5) b->available = (int)lib_csv_to_long(&f[5]);
+    if (n > 6) b->price = lib_csv_to_double(&f[6]);
+    if (n > 7) copy_field(b->notes, sizeof(b->notes), &f[7]);
+    return true;
+}
+
+static bool parse_borrower_row(const lib_csv_field_t *f, size_t n, borrower_t *br) {
+    if (n < 3 || f[0].len == 0) return false;
+    memset(br, 0, sizeof(*br));
+    br->id = parse_id_field(&f[0]);
+    if (n >= 5) {
+        copy_field(br->nim, sizeof(br->nim), &f[1]);
+        copy_field(br->name, sizeof(br->name), &f[2]);
+        copy_field(br->phone, sizeof(br->phone), &f[3]);
+        copy_field(br->email, sizeof(br->email), &f[4]);
+    } else {
+        /* format lama tanpa kolom nim: id,name,phone,email */
+        copy_field(br->name, sizeof(br->name), &f[1]);
+        copy_field(br->phone, sizeof(br->phone), &f[2]);
+        if (n > 3) copy_field(br->email, sizeof(br->email), &f[3]);
+    }
+    return true;
+}
+
+static bool parse_loan_row(const lib_csv_field_t *f, size_t n, loan_t *ln) {
+    if (n < 3 || f[0].len == 0) return false;
+    memset(ln, 0, sizeof(*ln));
+    ln->loan_id = parse_id_field(&f[0]);
+    ln->isbn = parse_isbn_field(&f[1]);
+    ln->borrower_id = parse_id_field(&f[2]);
+    if (n > 3) parse_date_field(&f[3], &ln->date_borrow);
+    if (n > 4) parse_date_field(&f[4], &ln->date_due);
+    if (n > 5 && parse_date_field(&f[5], &ln->date_returned)) ln->is_returned = true;
+    if (n > 6) ln->is_returned = lib_csv_to_long(&f[6]) ? true : ln->is_returned;
+    if (n > 7) ln->is_lost = lib_csv_to_long(&f[7]) ? true : false;
+    if (n > 8) ln->fine_paid = lib_csv_to_long(&f[8]);
+    return true;
+}
+
 /* ---------- CSV writers to explicit path (used by atomic save) ---------- */
 
-static lib_status_t write_books_csv_to(const library_db_t *db, const char *outfile) {
-    if (!db || !outfile) return LIB_ERR_INVALID_ARG;
-    /* ensure directory exists before attempting to open file */
+#define BOOK_CSV_HEADER "isbn,title,author,year,total_stock,available,price,notes\n"
+#define BORROWER_CSV_HEADER "id,nim,name,phone,email\n"
+
+/* Buka writer CSV untuk snapshot/ekspor (direktori dibuat bila perlu) */
+static bool csv_writer_begin(lib_csv_writer_t *w, const char *who, const char *outfile, const char *header) {
     if (ensure_dir_for_path(outfile) != 0) {
-        fprintf(stderr, "[lib] write_books_csv_to: cannot ensure directory for '%s'\n", outfile);
-        return LIB_ERR_IO;
+        fprintf(stderr, "[lib] %s: cannot ensure directory for '%s'\n", who, outfile);
+        return false;
     }
-    FILE *f = fopen(outfile, "w");
-    if (!f) {
-        fprintf(stderr, "[lib] write_books_csv_to: fopen('%s') failed: %s\n", outfile, strerror(errno));
-        return LIB_ERR_IO;
+    if (!lib_csv_writer_open(w, outfile)) {
+        fprintf(stderr, "[lib] %s: fopen('%s') failed: %s\n", who, outfile, strerror(errno));
+        return false;
     }
-    if (fprintf(f, "isbn,title,author,year,total_stock,available,price,notes\n") < 0) { fclose(f); return LIB_ERR_IO; }
+    lib_csv_writer_put(w, header, strlen(header));
+    return true;
+}
+
+static lib_status_t write_books_csv_to(const library_db_t *db, const char *outfile) {
+    if (!db || !outfile) return LIB_ERR_INVALID_ARG;
+    lib_csv_writer_t w;
+    if (!csv_writer_begin(&w, "write_books_csv_to", outfile, BOOK_CSV_HEADER)) return LIB_ERR_IO;
+    lib_csv_row_t row;
     for (size_t i = 0; i < db->books_count; ++i) {
-        const book_t *b = &db->books[i];
-        if (fprintf(f, "%s,%s,%s,%d,%d,%d,%.2f,%s\n",
-                b->isbn, b->title, b->author, b->year, b->total_stock, b->available, b->price, b->notes) < 0) {
-            fclose(f); return LIB_ERR_IO;
-        }
+        if (hot_row(db, i)->isbn == LIB_ISBN_NONE) continue;   /* tombstone */
+        lib_csv_writer_row(&w, &row, LIB_ROW_BUF);
+        book_fields(&row, book_row(db, i));
+        lib_csv_writer_end_row(&w, &row);
     }
-    fflush(f);
-#if !defined(_WIN32) && !defined(_WIN64)
-    fsync(fileno(f));
-#endif
-    fclose(f);
-    return LIB_OK;
+    return lib_csv_writer_close(&w, true) ? LIB_OK : LIB_ERR_IO;
 }
 
 static lib_status_t write_borrowers_csv_to(const library_db_t *db, const char *outfile) {
     if (!db || !outfile) return LIB_ERR_INVALID_ARG;
-    if (ensure_dir_for_path(outfile) != 0) {
-        fprintf(stderr, "[lib] write_borrowers_csv_to: cannot ensure directory for '%s'\n", outfile);
-        return LIB_ERR_IO;
+    lib_csv_writer_t w;
+    if (!csv_writer_begin(&w, "write_borrowers_csv_to", outfile, BORROWER_CSV_HEADER)) return LIB_ERR_IO;
+    lib_csv_row_t row;
+    for (size_t i = 0; i < db->borrowers_count; ++i) {
+        lib_csv_writer_row(&w, &row, LIB_ROW_BUF);
+        borrower_fields(&row, borrower_row(db, i));
+        lib_csv_writer_end_row(&w, &row);
     }
-    FILE *f = fopen(outfile, "w");
-    if (!f) {
-        fprintf(stderr, "[lib] write_borrowers_csv_to: fopen('%s') failed: %s\n", outfile, strerror(errno));
-        return LIB_ERR_IO;
+    return lib_csv_writer_close(&w, true) ? LIB_OK : LIB_ERR_IO;
+}
+
+#define LOAN_CSV_HEADER "loan_id,isbn,borrower_id,date_borrow,date_due,date_returned,is_returned,is_lost,fine_paid\n"
+
+/* Kunjungi setiap baris satu partisi arsip (format _loans.csv). Mengembalikan
+ * false jika visit meminta berhenti; file yang hilang dianggap kosong. */
+static bool scan_loan_segment(const library_db_t *db, const lib_archive_part_t *part,
+                              lib_loan_visit_fn visit, void *ctx, unsigned long long *rows_read) {
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, db->db_file_path, part->file);
+    if (!p) return false;
+    lib_csv_reader_t rd;
+    bool opened = lib_csv_open(&rd, p);
+    if (!opened) fprintf(stderr, "[lib] archive: cannot open '%s'\n", p);
+    lib_arena_free(&s);
+    if (!opened) return true;
+    lib_csv_field_t f[LOAN_FIELDS];
+    bool go = true;
+    int n = lib_csv_next(&rd, f, LOAN_FIELDS);
+    while (go && n > 0 && (n = lib_csv_next(&rd, f, LOAN_FIELDS)) > 0) {
+        loan_t ln;
+        if (!parse_loan_row(f, (size_t)n, &ln)) continue;
+        if (rows_read) (*rows_read)++;
+        go = visit(ctx, &ln);
     }
-    if (fprintf(f, "id,nim,name,phone,email\n") < 0) { fclose(f); return LIB_ERR_IO; }
-    for (size_t i = 0; i < db->borrowers_count; ++i) {
-        const borrower_t *br = &db->borrowers[i];
-        if (fprintf(f, "%s,%s,%s,%s,%s\n", br->id, br->nim, br->name, br->phone, br->email) < 0) {
-            fclose(f); return LIB_ERR_IO;
+    lib_csv_close(&rd);
+    return go;
+}
+
+/* Tujuan baris saat menulis CSV pinjaman (juga dipakai sebagai visitor arsip) */
+static bool sink_loan_row(void *ctx, const loan_t *ln) {
+    lib_csv_writer_t *w = ctx;
+    lib_csv_row_t row;
+    lib_csv_writer_row(w, &row, LIB_ROW_BUF);
+    loan_fields(&row, ln);
+    lib_csv_writer_end_row(w, &row);
+    return !w->failed;
+}
+
+/* Baris berurutan di memori (isi satu partisi arsip) */
+typedef struct {
+    const loan_t *rows;
+    size_t count;
+} loan_span_t;
+
+/* Tulis tabel pinjaman: with_archive juga menyalin semua partisi arsip
+ * (ekspor), checkpoint hanya menulis yang ada di memori. */
+static lib_status_t write_loans_csv(const library_db_t *db, const loan_span_t *span,
+                                    bool with_archive, const char *outfile) {
+    if (!db || !outfile) return LIB_ERR_INVALID_ARG;
+    lib_csv_writer_t w;
+    if (!csv_writer_begin(&w, "write_loans_csv", outfile, LOAN_CSV_HEADER)) return LIB_ERR_IO;
+    if (span) {
+        for (size_t i = 0; !w.failed && i < span->count; ++i) sink_loan_row(&w, &span->rows[i]);
+    } else {
+        const lib_archive_t *a = db->archive;
+        for (size_t k = 0; with_archive && a && !w.failed && k < a->count; ++k)
+            scan_loan_segment(db, &a->parts[k], sink_loan_row, &w, NULL);
+        /* satu file untuk kedua partisi: riwayat lalu aktif; loader memisahkannya lagi */
+        for (size_t i = 0; !w.failed && i < db->loans_count + db->active_loans_count; ++i) {
+            const loan_t *ln = i < db->loans_count ? history_row(db, i) : active_row(db, i - db->loans_count);
+            if (ln->loan_id == LIB_ID_NONE) continue;   /* tombstone */
+            sink_loan_row(&w, ln);
         }
     }
-    fflush(f);
-#if !defined(_WIN32) && !defined(_WIN64)
-    fsync(fileno(f));
-#endif
-    fclose(f);
-    return LIB_OK;
+    return lib_csv_writer_close(&w, true) ? LIB_OK : LIB_ERR_IO;
 }
 
 static lib_status_t write_loans_csv_to(const library_db_t *db, const char *outfile) {
+    return write_loans_csv(db, NULL, false, outfile);
+}
+
+static lib_status_t write_meta_to(const library_db_t *db, const char *outfile) {
     if (!db || !outfile) return LIB_ERR_INVALID_ARG;
-    if (ensure_dir_for_path(outfile) != 0) {
-        fprintf(stderr, "[lib] write_loans_csv_to: cannot ensure directory for '%s'\n", outfile);
-        return LIB_ERR_IO;
-    }
     FILE *f = fopen(outfile, "w");
     if (!f) {
-        fprintf(stderr, "[lib] write_loans_csv_to: fopen('%s') failed: %s\n", outfile, strerror(errno));
+        fprintf(stderr, "[lib] write_meta_to: fopen('%s') failed: %s\n", outfile, strerror(errno));
         return LIB_ERR_IO;
     }
-    if (fprintf(f, "loan_id,isbn,borrower_id,date_borrow,date_due,date_returned,is_returned,is_lost,fine_paid\n") < 0) { fclose(f); return LIB_ERR_IO; }
-    for (size_t i = 0; i < db->loans_count; ++i) {
-        const loan_t *l = &db->loans[i];
-        char db1[16] = "", db2[16] = "", db3[16] = "";
-        snprintf(db1, sizeof(db1), "%04d-%02d-%02d", l->date_borrow.year, l->date_borrow.month, l->date_borrow.day);
-        snprintf(db2, sizeof(db2), "%04d-%02d-%02d", l->date_due.year, l->date_due.month, l->date_due.day);
-        if (l->is_returned) snprintf(db3, sizeof(db3), "%04d-%02d-%02d", l->date_returned.year, l->date_returned.month, l->date_returned.day);
-        if (fprintf(f, "%s,%s,%s,%s,%s,%s,%d,%d,%ld\n",
-                l->loan_id, l->isbn, l->borrower_id, db1, db2, db3, l->is_returned ? 1 : 0, l->is_lost ? 1 : 0, (long)l->fine_paid) < 0) {
-            fclose(f); return LIB_ERR_IO;
-        }
+    /* policy: fine_per_day, replacement_cost_days, max_overdue_days_before_lost */
+    if (fprintf(f, "fine_per_day=%ld\n", db->fine_per_day) < 0
+        || fprintf(f, "replacement_cost_days=%lu\n", db->replacement_cost_days) < 0
+        || fprintf(f, "max_overdue_days_before_lost=%lu\n", db->max_overdue_days_before_lost) < 0
+        || fprintf(f, "journal_checkpoint_entries=%lu\n", (unsigned long)db->journal_checkpoint_entries) < 0
+        || fprintf(f, "durability=%s\n", lib_durability_name(db->durability)) < 0
+        || fprintf(f, "group_commit_ms=%lu\n", db->group_commit_ms) < 0
+        || fprintf(f, "group_commit_ops=%lu\n", db->group_commit_ops) < 0
+        || fprintf(f, "binary_snapshot=%d\n", db->binary_snapshot ? 1 : 0) < 0
+        || fprintf(f, "id_high_water=%llu\n", (unsigned long long)db->id_high_water) < 0) {
+        fclose(f); return LIB_ERR_IO;
     }
     fflush(f);
 #if !defined(_WIN32) && !defined(_WIN64)
@@ -377,106 +1138,408 @@ static lib_status_t write_loans_csv_to(const library_db_t *db, const char *outfi
 
 /* ---------- CSV readers (full) ---------- */
 
-static lib_status_t read_books_csv(library_db_t *db, const char *path) {
-    if (!db || !path) return LIB_ERR_INVALID_ARG;
-    char *p = alloc_path_with_suffix(path, "_books.csv");
-    if (!p) return LIB_ERR_MEMORY;
-    FILE *f = fopen(p, "r");
-    if (!f) { free(p); return LIB_OK; } /* missing file -> empty */
-    char *line = NULL; size_t len = 0; ssize_t r;
-    bool skip_header = false;
-    while ((r = getline(&line, &len, f)) != -1) {
-        trim_newline(line);
-        if (!skip_header) { skip_header = true; continue; }
-        if (strlen(line) == 0) continue;
-        char *s = my_strdup(line);
-        char *ctx = NULL;
-        char *tok = strtok_r(s, ",", &ctx);
-        if (!tok) { free(s); continue; }
-    book_t b; memset(&b,0,sizeof(b));
-    strncpy(b.isbn, tok, LIB_MAX_ISBN-1);
-    tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(b.title, tok, LIB_MAX_TITLE-1);
-    tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(b.author, tok, LIB_MAX_AUTHOR-1);
-    tok = strtok_r(NULL, ",", &ctx); if (tok) b.year = atoi(tok);
-    tok = strtok_r(NULL, ",", &ctx); if (tok) b.total_stock = atoi(tok);
-    tok = strtok_r(NULL, ",", &ctx); if (tok) b.available = atoi(tok);
-    tok = strtok_r(NULL, ",", &ctx); if (tok) b.price = atof(tok);
-    tok = strtok_r(NULL, "", &ctx); if (tok) strncpy(b.notes, tok, LIB_MAX_NOTES-1);
-        lib_status_t st = ensure_books_capacity(db); if (st != LIB_OK) { free(s); free(line); fclose(f); free(p); return st; }
-        db->books[db->books_count++] = b;
-        free(s);
-    }
-    free(line); fclose(f); free(p);
-    return LIB_OK;
+/* Parse satu record lalu tambahkan ke tabel; record yang tidak valid dilewati */
+typedef lib_status_t (*csv_row_fn)(library_db_t *db, const lib_csv_field_t *f, size_t n);
+
+static lib_status_t load_book_row(library_db_t *db, const lib_csv_field_t *f, size_t n) {
+    book_t b;
+    return parse_book_row(f, n, &b) ? append_book_row(db, &b) : LIB_OK;
 }
 
-static lib_status_t read_borrowers_csv(library_db_t *db, const char *path) {
+static lib_status_t load_borrower_row(library_db_t *db, const lib_csv_field_t *f, size_t n) {
+    borrower_t br;
+    return parse_borrower_row(f, n, &br) ? append_borrower_row(db, &br) : LIB_OK;
+}
+
+static lib_status_t load_loan_row(library_db_t *db, const lib_csv_field_t *f, size_t n) {
+    loan_t ln;
+    return parse_loan_row(f, n, &ln) ? append_loan_row(db, &ln) : LIB_OK;
+}
+
+/* Baca <path><suffix>; record pertama (header) dilewati. File tidak ada = tabel kosong. */
+static lib_status_t read_csv_table(library_db_t *db, const char *path, const char *suffix,
+                                   size_t max_fields, csv_row_fn load_row) {
     if (!db || !path) return LIB_ERR_INVALID_ARG;
-    char *p = alloc_path_with_suffix(path, "_borrowers.csv");
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, path, suffix);
     if (!p) return LIB_ERR_MEMORY;
-    FILE *f = fopen(p, "r");
-    if (!f) { free(p); return LIB_OK; }
-    char *line = NULL; size_t len = 0; ssize_t r;
-    bool skip_header = false;
-    while ((r = getline(&line, &len, f)) != -1) {
-        trim_newline(line);
-        if (!skip_header) { skip_header = true; continue; }
-        if (strlen(line) == 0) continue;
-        int commas = 0; for (char *c = line; *c; ++c) if (*c == ',') commas++;
-        char *s = my_strdup(line);
-        char *ctx = NULL;
-        borrower_t br; memset(&br,0,sizeof(br));
-        if (commas >= 4) {
-            char *tok = strtok_r(s, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.id, tok, sizeof(br.id)-1);
-            tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.nim, tok, sizeof(br.nim)-1);
-            tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.name, tok, LIB_MAX_NAME-1);
-            tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.phone, tok, sizeof(br.phone)-1);
-            tok = strtok_r(NULL, "", &ctx); if (tok) strncpy(br.email, tok, sizeof(br.email)-1);
-        } else {
-            char *tok = strtok_r(s, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.id, tok, sizeof(br.id)-1);
-            tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.name, tok, LIB_MAX_NAME-1);
-            tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(br.phone, tok, sizeof(br.phone)-1);
-            tok = strtok_r(NULL, "", &ctx); if (tok) strncpy(br.email, tok, sizeof(br.email)-1);
-            br.nim[0] = '\0';
-        }
-        lib_status_t st = ensure_borrowers_capacity(db); if (st != LIB_OK) { free(s); free(line); fclose(f); free(p); return st; }
-        db->borrowers[db->borrowers_count++] = br;
-        free(s);
+    lib_csv_reader_t rd;
+    bool opened = lib_csv_open(&rd, p);
+    lib_arena_free(&s);
+    if (!opened) return LIB_OK;
+    lib_csv_field_t f[LOAN_FIELDS];
+    lib_status_t st = LIB_OK;
+    int n = lib_csv_next(&rd, f, max_fields);
+    while (n > 0 && (n = lib_csv_next(&rd, f, max_fields)) > 0) {
+        st = load_row(db, f, (size_t)n);
+        if (st != LIB_OK) break;
     }
-    free(line); fclose(f); free(p);
-    return LIB_OK;
+    if (n < 0) st = LIB_ERR_MEMORY;
+    lib_csv_close(&rd);
+    return st;
+}
+
+static lib_status_t read_books_csv(library_db_t *db, const char *path) {
+    return read_csv_table(db, path, "_books.csv", BOOK_FIELDS, load_book_row);
+}
+
+static lib_status_t read_borrowers_csv(library_db_t *db, const char *path) {
+    return read_csv_table(db, path, "_borrowers.csv", BORROWER_FIELDS, load_borrower_row);
 }
 
 static lib_status_t read_loans_csv(library_db_t *db, const char *path) {
-    if (!db || !path) return LIB_ERR_INVALID_ARG;
-    char *p = alloc_path_with_suffix(path, "_loans.csv");
+    return read_csv_table(db, path, "_loans.csv", LOAN_FIELDS, load_loan_row);
+}
+
+/* ---------- Binary snapshot reader ---------- */
+
+/* mtime file; false jika tidak ada */
+static bool file_mtime(const char *base, const char *suffix, time_t *out) {
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, base, suffix);
+    if (!p) return false;
+    struct stat sb;
+    bool ok = stat(p, &sb) == 0;
+    if (ok) *out = sb.st_mtime;
+    lib_arena_free(&s);
+    return ok;
+}
+
+/* Snapshot dipakai hanya jika tidak ada CSV yang lebih baru (mis. diedit/diimpor
+ * di luar aplikasi). Resolusi mtime detik: waktu sama dianggap snapshot terbaru. */
+static bool snapshot_is_current(const char *base) {
+    static const char *csv[] = { "_books.csv", "_borrowers.csv", "_loans.csv" };
+    time_t snap, t;
+    if (!file_mtime(base, "_snapshot.bin", &snap)) return false;
+    for (size_t i = 0; i < sizeof(csv) / sizeof(csv[0]); ++i) {
+        if (file_mtime(base, csv[i], &t) && difftime(t, snap) > 0) return false;
+    }
+    return true;
+}
+
+/* Muat ketiga tabel dari snapshot biner. LIB_ERR_NOT_FOUND jika snapshot
+ * tidak ada, lebih lama dari CSV, atau tidak valid (pemanggil membaca CSV). */
+static lib_status_t read_snapshot(library_db_t *db, const char *path) {
+    if (!snapshot_is_current(path)) return LIB_ERR_NOT_FOUND;
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, path, "_snapshot.bin");
     if (!p) return LIB_ERR_MEMORY;
-    FILE *f = fopen(p, "r");
-    if (!f) { free(p); return LIB_OK; }
-    char *line = NULL; size_t len = 0; ssize_t r;
-    bool skip_header = false;
-    while ((r = getline(&line, &len, f)) != -1) {
-        trim_newline(line);
-        if (!skip_header) { skip_header = true; continue; }
-        if (strlen(line) == 0) continue;
-        char *s = my_strdup(line);
-        char *ctx = NULL;
-        loan_t ln; memset(&ln,0,sizeof(ln));
-        char *tok = strtok_r(s, ",", &ctx); if (!tok) { free(s); continue; } strncpy(ln.loan_id, tok, sizeof(ln.loan_id)-1);
-        tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(ln.isbn, tok, LIB_MAX_ISBN-1);
-        tok = strtok_r(NULL, ",", &ctx); if (!tok) { free(s); continue; } strncpy(ln.borrower_id, tok, sizeof(ln.borrower_id)-1);
-        tok = strtok_r(NULL, ",", &ctx); if (tok) { int y,m,d; if (sscanf(tok, "%d-%d-%d", &y,&m,&d)==3) { ln.date_borrow.year=y; ln.date_borrow.month=m; ln.date_borrow.day=d; } }
-        tok = strtok_r(NULL, ",", &ctx); if (tok) { int y,m,d; if (sscanf(tok, "%d-%d-%d", &y,&m,&d)==3) { ln.date_due.year=y; ln.date_due.month=m; ln.date_due.day=d; } }
-        tok = strtok_r(NULL, ",", &ctx); if (tok && strlen(tok) >= 8) { int y,m,d; if (sscanf(tok, "%d-%d-%d", &y,&m,&d)==3) { ln.date_returned.year=y; ln.date_returned.month=m; ln.date_returned.day=d; ln.is_returned = true; } }
-        tok = strtok_r(NULL, ",", &ctx); if (tok) ln.is_returned = atoi(tok) ? true : ln.is_returned;
-        tok = strtok_r(NULL, ",", &ctx); if (tok) ln.is_lost = atoi(tok) ? true : false;
-        tok = strtok_r(NULL, ",", &ctx); if (tok) ln.fine_paid = atol(tok);
-        lib_status_t st = ensure_loans_capacity(db); if (st != LIB_OK) { free(s); free(line); fclose(f); free(p); return st; }
-        db->loans[db->loans_count++] = ln;
-        free(s);
-    }
-    free(line); fclose(f); free(p);
-    return LIB_OK;
+    lib_snapshot_t *snap = lib_snapshot_map(p);
+    lib_arena_free(&s);
+    if (!snap) return LIB_ERR_NOT_FOUND;
+    /* jumlah baris sudah diketahui: chunk disiapkan sekaligus, record langsung ke slotnya */
+    lib_status_t st = reserve_rows(db, snap->books_count, snap->borrowers_count, snap->loans_count);
+    if (st == LIB_OK) {
+        for (size_t i = 0; i < snap->books_count; ++i) {
+            book_t b;
+            lib_snapshot_book(snap, i, &b);
+            book_store(db, i, &b);
+        }
+        db->books_count = snap->books_count;
+        for (size_t i = 0; i < snap->borrowers_count; ++i) lib_snapshot_borrower(snap, i, borrower_row(db, i));
+        db->borrowers_count = snap->borrowers_count;
+        /* sebagian besar pinjaman adalah riwayat; yang aktif masuk partisinya */
+        for (size_t i = 0; st == LIB_OK && i < snap->loans_count; ++i) {
+            loan_t ln;
+            lib_snapshot_loan(snap, i, &ln);
+            st = append_loan_row(db, &ln);
+        }
+    }
+    lib_snapshot_unmap(snap);
+    if (st != LIB_OK) db->books_count = db->borrowers_count = db->loans_count = db->active_loans_count = 0;
+    return st;
+}
+
+/* ---------- Row operations (tanpa journal; dipakai API publik dan replay) ---------- */
+
+/* Buang tombstone buku dalam satu sweep linear (urutan baris tetap). Posting
+ * list trigram dipetakan ulang lewat tabel baris lama -> baru tanpa membaca
+ * teks lagi; hash ISBN dibangun ulang sekali. */
+static void compact_books(library_db_t *db) {
+    if (db->books_tombstones == 0) return;
+    uint32_t *map = db->index ? lib_heap_malloc(db->books_count * sizeof(uint32_t)) : NULL;
+    size_t w = 0;
+    for (size_t r = 0; r < db->books_count; ++r) {
+        if (hot_row(db, r)->isbn == LIB_ISBN_NONE) {
+            if (map) map[r] = LIB_ROW_NONE;
+            continue;
+        }
+        if (w != r) {
+            *book_row(db, w) = *book_row(db, r);
+            *hot_row(db, w) = *hot_row(db, r);
+        }
+        if (map) map[r] = (uint32_t)w;
+        w++;
+    }
+    size_t old_count = db->books_count;
+    db->books_count = w;
+    db->books_tombstones = 0;
+    if (!db->index) return;
+    if (map) {
+        lib_trigram_remap(&db->index->title_tri, map, old_count);
+        lib_trigram_remap(&db->index->author_tri, map, old_count);
+        lib_heap_free(map);
+        index_rebuild_book_keys(db);
+    } else {
+        index_rebuild_books(db);   /* tabel pemetaan tidak teralokasi: indeks dari teks */
+    }
+}
+
+/* Hapus buku: O(1). ISBN dilepas dari hash index dan baris ditandai tombstone
+ * (isbn kosong); posting trigram lama dilewati pencarian sampai compact_books. */
+static void remove_book_row(library_db_t *db, size_t idx) {
+    lib_book_hot_t *h = hot_row(db, idx);
+    if (h->isbn == LIB_ISBN_NONE) return;
+    if (db->index) lib_hindex_remove(&db->index->book_isbn, lib_hash_u64(h->isbn), (uint32_t)idx);
+    h->isbn = book_row(db, idx)->isbn = LIB_ISBN_NONE;
+    db->books_tombstones++;
+    if (db->books_tombstones * LIB_TOMBSTONE_COMPACT_DIV > db->books_count) compact_books(db);
+}
+
+/* Tombstone: loan_id dikosongkan dan kuncinya dilepas dari hash index; baris
+ * tetap di tempat sampai compact_loans. borrower_id tidak diubah sehingga
+ * rantai multimap borrower tetap utuh (pembacanya melewati tombstone). */
+static void tombstone_loan_row(library_db_t *db, size_t idx) {
+    loan_t *ln = history_row(db, idx);
+    if (ln->loan_id == LIB_ID_NONE) return;
+    if (db->index) lib_hindex_remove(&db->index->loan_id, lib_hash_u64(ln->loan_id), (uint32_t)idx);
+    ln->loan_id = LIB_ID_NONE;
+    db->loans_tombstones++;
+}
+
+/* Buang semua tombstone dalam satu sweep linear (urutan baris tetap), lalu
+ * bangun ulang indeks loan sekali */
+static void compact_loans(library_db_t *db) {
+    if (db->loans_tombstones == 0) return;
+    size_t w = 0;
+    for (size_t r = 0; r < db->loans_count; ++r) {
+        if (history_row(db, r)->loan_id == LIB_ID_NONE) continue;
+        if (w != r) *history_row(db, w) = *history_row(db, r);
+        w++;
+    }
+    db->loans_count = w;
+    db->loans_tombstones = 0;
+    index_rebuild_loans(db);
+}
+
+/* Hapus baris riwayat: O(1), pemadatan ditunda sampai rasio tombstone terlewati */
+static void remove_loan_row(library_db_t *db, size_t idx) {
+    tombstone_loan_row(db, idx);
+    if (db->loans_tombstones * LIB_TOMBSTONE_COMPACT_DIV > db->loans_count) compact_loans(db);
+}
+
+/* Hapus baris aktif: baris terakhir dipindah ke lubangnya, O(1) */
+static void remove_active_row(library_db_t *db, size_t idx) {
+    size_t last = db->active_loans_count - 1;
+    index_remove_active(db, idx);
+    if (idx != last) {
+        index_remove_active(db, last);
+        *active_row(db, idx) = *active_row(db, last);
+    }
+    db->active_loans_count--;
+    if (idx != last) index_add_active(db, idx);
+}
+
+static void delete_loan(library_db_t *db, loan_pos_t p) {
+    if (p.active) remove_active_row(db, p.row);
+    else remove_loan_row(db, p.row);
+}
+
+/* Tambah loan baru ke partisinya beserta indeksnya; NULL jika memori habis */
+static loan_t *insert_loan_row(library_db_t *db, const loan_t *ln) {
+    if (append_loan_row(db, ln) != LIB_OK) return NULL;
+    if (loan_is_open(ln)) {
+        index_add_active(db, db->active_loans_count - 1);
+        return active_row(db, db->active_loans_count - 1);
+    }
+    size_t row = db->loans_count - 1;
+    if (db->index) index_add_id(db, &db->index->loan_id, eq_loan_id, ln->loan_id, row);
+    index_add_loan_to_group(db, row);
+    return history_row(db, row);
+}
+
+/* Ganti loan di posisi p dengan after-image `ln`. Jika status terbuka/selesai
+ * berubah, loan pindah partisi. Mengembalikan pointer barunya (NULL jika
+ * memori habis; isi lama tidak berubah). */
+static loan_t *store_loan_row(library_db_t *db, loan_pos_t p, const loan_t *ln) {
+    if (p.active != loan_is_open(ln)) {
+        /* tambah dulu baru hapus: gagal alokasi tidak menghilangkan loan */
+        loan_t *moved = insert_loan_row(db, ln);
+        if (moved) delete_loan(db, p);
+        return moved;
+    }
+    loan_t *cur = loan_at(db, p);
+    bool regroup = cur->borrower_id != ln->borrower_id;
+    if (p.active) {
+        /* borrower atau jatuh tempo berubah: pindahkan entri indeksnya */
+        bool reindex = regroup || cur->date_due != ln->date_due;
+        if (reindex) index_remove_active(db, p.row);
+        *cur = *ln;
+        if (reindex) index_add_active(db, p.row);
+    } else {
+        *cur = *ln;
+        if (regroup) index_rebuild_loans(db);
+    }
+    return cur;
+}
+
+static void upsert_book_row(library_db_t *db, const book_t *b) {
+    size_t i = find_book_row(db, b->isbn);
+    if (i == SIZE_MAX) {
+        if (append_book_row(db, b) != LIB_OK) return;
+        i = db->books_count - 1;
+        if (db->index) index_add_id(db, &db->index->book_isbn, eq_book_isbn, b->isbn, i);
+        index_add_book_text(db, i);
+        return;
+    }
+    if (db->index) {
+        lib_trigram_remove(&db->index->title_tri, (uint32_t)i, book_row(db, i)->title);
+        lib_trigram_remove(&db->index->author_tri, (uint32_t)i, book_row(db, i)->author);
+    }
+    book_store(db, i, b);
+    index_add_book_text(db, i);
+}
+
+static void upsert_borrower_row(library_db_t *db, const borrower_t *br) {
+    size_t i = find_borrower_row(db, br->id);
+    if (i == SIZE_MAX) {
+        if (append_borrower_row(db, br) == LIB_OK) index_add_borrower(db, db->borrowers_count - 1);
+        return;
+    }
+    bool nim_changed = strcmp(borrower_row(db, i)->nim, br->nim) != 0;
+    *borrower_row(db, i) = *br;
+    if (nim_changed) index_rebuild_borrowers(db);
+}
+
+static void upsert_loan_row(library_db_t *db, const loan_t *ln) {
+    loan_pos_t p;
+    if (!find_loan_pos(db, ln->loan_id, &p)) (void) insert_loan_row(db, ln);
+    else (void) store_loan_row(db, p, ln);
+}
+
+/* key=value dari _meta.cfg atau record journal 'M' */
+static void apply_meta_value(library_db_t *db, const char *key, const char *val) {
+    if (strcmp(key, "fine_per_day") == 0) db->fine_per_day = atol(val);
+    else if (strcmp(key, "replacement_cost_days") == 0) db->replacement_cost_days = strtoul(val, NULL, 10);
+    else if (strcmp(key, "max_overdue_days_before_lost") == 0) db->max_overdue_days_before_lost = strtoul(val, NULL, 10);
+    else if (strcmp(key, "journal_checkpoint_entries") == 0) db->journal_checkpoint_entries = (size_t)strtoul(val, NULL, 10);
+    else if (strcmp(key, "durability") == 0) (void)lib_durability_parse(val, &db->durability);
+    else if (strcmp(key, "group_commit_ms") == 0) db->group_commit_ms = strtoul(val, NULL, 10);
+    else if (strcmp(key, "group_commit_ops") == 0) db->group_commit_ops = strtoul(val, NULL, 10);
+    else if (strcmp(key, "id_high_water") == 0) {
+        /* hanya naik: baris yang sudah dimuat bisa lebih baru dari meta */
+        lib_id_t hw = (lib_id_t)strtoull(val, NULL, 10);
+        if (hw > db->id_high_water) db->id_high_water = hw;
+    }
+    else if (strcmp(key, "binary_snapshot") == 0) {
+        bool enabled = atoi(val) != 0;
+        /* ganti format (juga saat replay): tabel belum ada di format baru */
+        if (enabled != db->binary_snapshot) db->dirty |= LIB_DIRTY_TABLES;
+        db->binary_snapshot = enabled;
+    }
+}
+
+/* ---------- Journal hooks ----------
+ * Record: 'B' upsert buku, 'b' hapus buku (isbn), 'P' upsert peminjam,
+ * 'L' upsert loan, 'l' hapus loan (loan_id), 'M' meta (key=value).
+ * Payload upsert = baris CSV lengkap (after-image) sehingga replay idempoten.
+ */
+
+/* Tabel yang disentuh record; dipakai juga untuk menandai dirty saat replay */
+static unsigned op_tables(char op) {
+    switch (op) {
+        case 'B': case 'b': return LIB_DIRTY_BOOKS;
+        case 'P': return LIB_DIRTY_BORROWERS;
+        case 'L': case 'l': return LIB_DIRTY_LOANS;
+        case 'M': return LIB_DIRTY_META;
+        default: return 0;
+    }
+}
+
+/* Semua mutator lewat sini: tandai tabel dirty walau journal tidak aktif */
+static void journal_record(library_db_t *db, char op, const char *payload, int len) {
+    db->dirty |= op_tables(op);
+    if (!db->journal) return;
+    lib_journal_t *j = db->journal;
+    /* save berikutnya menulis snapshot penuh: record tambahan tidak berguna
+     * (mis. purge jutaan pinjaman tidak perlu masuk journal satu per satu) */
+    if (j->need_checkpoint) return;
+    if (len < 0 || len >= LIB_ROW_BUF ||
+        j->entries + j->pending_records >= lib_get_journal_checkpoint_entries(db)) {
+        lib_journal_discard(j);
+        j->need_checkpoint = true;
+        return;
+    }
+    lib_journal_append(j, op, payload);
+}
+
+static void journal_book(library_db_t *db, size_t row) {
+    char buf[LIB_ROW_BUF];
+    journal_record(db, 'B', buf, db->journal ? format_book_row(book_row(db, row), buf, sizeof(buf)) : 0);
+}
+
+static void journal_borrower(library_db_t *db, size_t row) {
+    char buf[LIB_ROW_BUF];
+    journal_record(db, 'P', buf, db->journal ? format_borrower_row(borrower_row(db, row), buf, sizeof(buf)) : 0);
+}
+
+static void journal_loan(library_db_t *db, const loan_t *ln) {
+    char buf[LIB_ROW_BUF];
+    journal_record(db, 'L', buf, db->journal ? format_loan_row(ln, buf, sizeof(buf)) : 0);
+}
+
+static void journal_key(library_db_t *db, char op, const char *key) {
+    journal_record(db, op, key, (int)strlen(key));
+}
+
+static void journal_id(library_db_t *db, char op, lib_id_t id) {
+    char buf[LIB_ID_TEXT_MAX];
+    lib_id_format(id, 'L', buf, sizeof(buf));
+    journal_key(db, op, buf);
+}
+
+static void journal_isbn(library_db_t *db, char op, lib_isbn_t isbn) {
+    char buf[LIB_ISBN_TEXT_MAX];
+    lib_isbn_format(isbn, buf, sizeof(buf));
+    journal_key(db, op, buf);
+}
+
+static void journal_meta(library_db_t *db, const char *key, unsigned long val) {
+    char buf[128];
+    journal_record(db, 'M', buf, db->journal ? snprintf(buf, sizeof(buf), "%s=%lu", key, val) : 0);
+}
+
+static void journal_meta_str(library_db_t *db, const char *key, const char *val) {
+    char buf[128];
+    journal_record(db, 'M', buf, db->journal ? snprintf(buf, sizeof(buf), "%s=%s", key, val) : 0);
+}
+
+static void journal_apply(void *ctx, char op, char *payload) {
+    library_db_t *db = ctx;
+    lib_csv_field_t f[LOAN_FIELDS];
+    /* isi journal belum ada di CSV */
+    db->dirty |= op_tables(op);
+    switch (op) {
+        case 'B': { book_t b; if (parse_book_row(f, lib_csv_split(payload, strlen(payload), f, BOOK_FIELDS), &b)) upsert_book_row(db, &b); break; }
+        case 'b': { size_t i = find_book_row(db, lib_isbn_key(payload)); if (i != SIZE_MAX) remove_book_row(db, i); break; }
+        case 'P': { borrower_t br; if (parse_borrower_row(f, lib_csv_split(payload, strlen(payload), f, BORROWER_FIELDS), &br)) upsert_borrower_row(db, &br); break; }
+        case 'L': { loan_t ln; if (parse_loan_row(f, lib_csv_split(payload, strlen(payload), f, LOAN_FIELDS), &ln)) upsert_loan_row(db, &ln); break; }
+        case 'l': { loan_pos_t p; lib_id_t id; if (lib_id_parse(payload, &id) && find_loan_pos(db, id, &p)) delete_loan(db, p); break; }
+        case 'M': {
+            char *eq = strchr(payload, '=');
+            if (eq) { *eq = '\0'; apply_meta_value(db, payload, eq + 1); }
+            break;
+        }
+        default: break; /* record tidak dikenal: abaikan */
+    }
+}
+
+static void journal_attach(library_db_t *db) {
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, db->db_file_path, "_journal.log");
+    if (!p) return;
+    db->journal = lib_journal_open(p);
+    lib_arena_free(&s);
 }
 
 /* ---------- atomic rename helper ---------- */
@@ -499,28 +1562,517 @@ static int replace_file_atomic(const char *tmp_path, const char *final_path) {
 #endif
 }
 
+/* ---------- File snapshot (ditulis atomik) ---------- */
+
+/* Tulis satu file snapshot ke <file>.tmp lalu rename; ukuran file masuk ke stats */
+typedef lib_status_t (*snapshot_writer_fn)(const library_db_t *db, const char *outfile);
+/* Varian dengan argumen tambahan (mis. isi satu partisi arsip) */
+typedef lib_status_t (*db_file_writer_fn)(const library_db_t *db, const void *arg, const char *outfile);
+
+static lib_status_t write_db_file(library_db_t *db, const char *suffix, db_file_writer_fn writer, const void *arg) {
+    LIB_SCRATCH(s);
+    char *final_path = scratch_path(&s, db->db_file_path, suffix);
+    char *tmp_path = final_path ? scratch_path(&s, final_path, ".tmp") : NULL;
+    if (!tmp_path) { lib_arena_free(&s); return LIB_ERR_MEMORY; }
+    lib_status_t st = writer(db, arg, tmp_path);
+    if (st == LIB_OK) {
+        struct stat sb;
+        unsigned long long size = stat(tmp_path, &sb) == 0 ? (unsigned long long)sb.st_size : 0;
+        if (replace_file_atomic(tmp_path, final_path) != 0) st = LIB_ERR_IO;
+        else {
+            db->save_stats.files_written++;
+            db->save_stats.bytes_written += size;
+            db->save_stats.total_bytes_written += size;
+        }
+    }
+    lib_arena_free(&s);
+    return st;
+}
+
+static lib_status_t call_snapshot_writer(const library_db_t *db, const void *arg, const char *outfile) {
+    return (*(const snapshot_writer_fn *)arg)(db, outfile);
+}
+
+static lib_status_t write_snapshot_file(library_db_t *db, const char *suffix, snapshot_writer_fn writer) {
+    return write_db_file(db, suffix, call_snapshot_writer, &writer);
+}
+
+/* ---------- Arsip riwayat pinjaman per bulan (lihat lib_archive.h) ----------
+ * Urutan tulis saat checkpoint: file partisi -> manifest -> _loans.csv ->
+ * reset journal. Crash di antaranya hanya menyisakan baris ganda di
+ * _loans.csv / journal; archive_drop_duplicates membuangnya saat open.
+ */
+
+static int month_key(lib_day_t day) {
+    lib_date_t d = lib_date_from_days(day);
+    return d.year * 12 + (d.month - 1);
+}
+
+/* Hanya pinjaman yang sudah kembali; pinjaman hilang tetap di memori sampai
+ * dilunasi (lib_settle_lost_loan / lib_set_loan_payment mencarinya) */
+static bool loan_archivable(const loan_t *ln) {
+    return ln->loan_id != LIB_ID_NONE && ln->is_returned && !ln->is_lost;
+}
+
+static void archive_attach(library_db_t *db) {
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, db->db_file_path, "_loans_manifest.csv");
+    if (!p) return;
+    db->archive = lib_archive_load(p);
+    lib_arena_free(&s);
+}
+
+static lib_status_t write_manifest_to(const library_db_t *db, const char *outfile) {
+    return lib_archive_write(db->archive, outfile) == 0 ? LIB_OK : LIB_ERR_IO;
+}
+
+static lib_status_t save_manifest(library_db_t *db) {
+    return write_snapshot_file(db, "_loans_manifest.csv", write_manifest_to);
+}
+
+static lib_status_t write_loan_span_to(const library_db_t *db, const void *arg, const char *outfile) {
+    return write_loans_csv(db, arg, false, outfile);
+}
+
+static void span_range(const loan_span_t *span, lib_date_t *first, lib_date_t *last) {
+    lib_day_t lo = span->rows[0].date_returned, hi = lo;
+    for (size_t i = 1; i < span->count; ++i) {
+        lib_day_t d = span->rows[i].date_returned;
+        if (d < lo) lo = d;
+        if (d > hi) hi = d;
+    }
+    *first = lib_date_from_days(lo);
+    *last = lib_date_from_days(hi);
+}
+
+typedef struct {
+    int month;
+    size_t row;
+} archive_key_t;
+
+static int cmp_archive_key(const void *x, const void *y) {
+    const archive_key_t *a = x, *b = y;
+    if (a->month != b->month) return a->month < b->month ? -1 : 1;
+    return a->row < b->row ? -1 : (a->row > b->row);
+}
+
+/* Pindahkan pinjaman yang kembali sebelum bulan ini ke partisi baru (satu per
+ * bulan) lalu tombstone barisnya; pemanggil memadatkan dan menulis _loans.csv.
+ * Tidak ada yang berubah di memori jika salah satu file gagal ditulis. */
+static lib_status_t archive_closed_loans(library_db_t *db) {
+    lib_archive_t *a = db->archive;
+    if (!a) return LIB_OK;
+    a->stats.last_archived = 0;
+    int current = month_key(lib_day_today());
+    size_t n = 0;
+    for (size_t i = 0; i < db->loans_count; ++i)
+        if (loan_archivable(history_row(db, i)) && month_key(history_row(db, i)->date_returned) < current) n++;
+    if (n == 0) return LIB_OK;
+    LIB_SCRATCH(s);
+    archive_key_t *keys = lib_arena_alloc(&s, n * sizeof(*keys));
+    loan_t *rows = lib_arena_alloc(&s, n * sizeof(*rows));
+    if (!keys || !rows) { lib_arena_free(&s); return LIB_ERR_MEMORY; }
+    n = 0;
+    for (size_t i = 0; i < db->loans_count; ++i) {
+        const loan_t *ln = history_row(db, i);
+        if (!loan_archivable(ln) || month_key(ln->date_returned) >= current) continue;
+        keys[n].month = month_key(ln->date_returned);
+        keys[n].row = i;
+        n++;
+    }
+    /* urut bulan, urutan baris dalam satu bulan tetap */
+    qsort(keys, n, sizeof(*keys), cmp_archive_key);
+    for (size_t k = 0; k < n; ++k) rows[k] = *history_row(db, keys[k].row);
+    size_t before = a->count;
+    lib_status_t st = LIB_OK;
+    for (size_t g = 0; st == LIB_OK && g < n; ) {
+        size_t e = g + 1;
+        while (e < n && keys[e].month == keys[g].month) e++;
+        lib_archive_part_t part;
+        loan_span_t span = { &rows[g], e - g };
+        lib_archive_name_part(a, keys[g].month / 12, keys[g].month % 12 + 1, &part);
+        part.rows = span.count;
+        span_range(&span, &part.first, &part.last);
+        st = write_db_file(db, part.file, write_loan_span_to, &span);
+        if (st == LIB_OK && !lib_archive_add(a, &part)) st = LIB_ERR_MEMORY;
+        g = e;
+    }
+    if (st == LIB_OK) st = save_manifest(db);
+    if (st != LIB_OK) {
+        /* file partisi yang sudah tertulis tidak ada di manifest; namanya
+         * dipakai (ditimpa) lagi pada percobaan berikutnya */
+        lib_archive_truncate(a, before);
+    } else {
+        for (size_t k = 0; k < n; ++k) tombstone_loan_row(db, keys[k].row);
+        db->dirty |= LIB_DIRTY_LOANS;
+        a->stats.last_archived = (unsigned long)n;
+    }
+    lib_arena_free(&s);
+    return st;
+}
+
+typedef struct {
+    library_db_t *db;
+    size_t dropped;
+} archive_dup_t;
+
+static bool drop_if_loaded(void *ctx, const loan_t *ln) {
+    archive_dup_t *d = ctx;
+    loan_pos_t p;
+    if (find_loan_pos(d->db, ln->loan_id, &p) && !p.active) {
+        tombstone_loan_row(d->db, p.row);
+        d->dropped++;
+    }
+    return true;
+}
+
+/* Riwayat di memori yang bulannya sudah punya partisi bisa jadi duplikat
+ * arsip (crash di tengah checkpoint, replay journal, impor). Hanya partisi
+ * bulan-bulan itu yang dibaca; pada open normal tidak ada file yang dibuka. */
+static void archive_drop_duplicates(library_db_t *db) {
+    lib_archive_t *a = db->archive;
+    if (!a || a->count == 0) return;
+    int lo = a->parts[0].year * 12 + (a->parts[0].month - 1), hi = lo;
+    for (size_t k = 1; k < a->count; ++k) {
+        int m = a->parts[k].year * 12 + (a->parts[k].month - 1);
+        if (m < lo) lo = m;
+        if (m > hi) hi = m;
+    }
+    /* bulan yang muncul di riwayat memori (rentang bulan manifest saja) */
+    LIB_SCRATCH(s);
+    bool *seen = lib_arena_calloc(&s, (size_t)(hi - lo + 1), sizeof(bool));
+    if (!seen) return;
+    bool any = false;
+    for (size_t i = 0; i < db->loans_count; ++i) {
+        const loan_t *ln = history_row(db, i);
+        if (!loan_archivable(ln)) continue;
+        int m = month_key(ln->date_returned);
+        if (m >= lo && m <= hi) seen[m - lo] = any = true;
+    }
+    archive_dup_t d = { db, 0 };
+    for (size_t k = 0; any && k < a->count; ++k) {
+        int m = a->parts[k].year * 12 + (a->parts[k].month - 1);
+        if (seen[m - lo]) scan_loan_segment(db, &a->parts[k], drop_if_loaded, &d, NULL);
+    }
+    lib_arena_free(&s);
+    if (d.dropped) {
+        compact_loans(db);
+        db->dirty |= LIB_DIRTY_LOANS;
+    }
+}
+
+/* Tulis ulang satu partisi tanpa baris yang ditolak keep. Hanya untuk
+ * penghapusan data (lib_remove_old_loans / lib_remove_loan); save biasa tidak
+ * pernah menyentuh partisi lama. Partisi yang menjadi kosong dikeluarkan dari
+ * manifest dan namanya disalin ke emptied (file dihapus pemanggil setelah
+ * manifest ditulis); selain itu emptied = "". */
+typedef bool (*loan_keep_fn)(const loan_t *ln, const void *arg);
+
+typedef struct {
+    loan_keep_fn keep;
+    const void *arg;
+    lib_arena_t *scratch;
+    loan_t *rows;
+    size_t count;
+    size_t capacity;
+    size_t dropped;
+    bool oom;
+} archive_filter_t;
+
+static bool filter_collect(void *ctx, const loan_t *ln) {
+    archive_filter_t *ft = ctx;
+    if (!ft->keep(ln, ft->arg)) { ft->dropped++; return true; }
+    if (ft->count == ft->capacity) {
+        size_t cap = ft->capacity ? ft->capacity * 2 : 256;
+        loan_t *r = lib_arena_grow(ft->scratch, ft->rows, ft->capacity * sizeof(*r), cap * sizeof(*r));
+        if (!r) { ft->oom = true; return false; }
+        ft->rows = r;
+        ft->capacity = cap;
+    }
+    ft->rows[ft->count++] = *ln;
+    return true;
+}
+
+static lib_status_t archive_filter_part(library_db_t *db, size_t idx, loan_keep_fn keep, const void *arg,
+                                        size_t *dropped, char emptied[LIB_ARCHIVE_FILE_MAX]) {
+    lib_archive_t *a = db->archive;
+    lib_archive_part_t *part = &a->parts[idx];
+    LIB_SCRATCH(s);
+    archive_filter_t ft = { keep, arg, &s, NULL, 0, 0, 0, false };
+    emptied[0] = '\0';
+    scan_loan_segment(db, part, filter_collect, &ft, NULL);
+    lib_status_t st = LIB_OK;
+    if (ft.oom) st = LIB_ERR_MEMORY;
+    else if (ft.dropped == 0) st = LIB_OK;
+    else if (ft.count == 0) {
+        memcpy(emptied, part->file, LIB_ARCHIVE_FILE_MAX);
+        lib_archive_remove(a, idx);
+    } else {
+        loan_span_t span = { ft.rows, ft.count };
+        st = write_db_file(db, part->file, write_loan_span_to, &span);
+        if (st == LIB_OK) {
+            a->stats.archived_rows -= part->rows - ft.count;
+            part->rows = ft.count;
+            span_range(&span, &part->first, &part->last);
+        }
+    }
+    if (st == LIB_OK) *dropped += ft.dropped;
+    lib_arena_free(&s);
+    return st;
+}
+
+static void remove_db_file(const library_db_t *db, const char *suffix) {
+    LIB_SCRATCH(s);
+    char *p = scratch_path(&s, db->db_file_path, suffix);
+    if (p) remove(p);
+    lib_arena_free(&s);
+}
+
+/* ---------- Parallel table load (lib_db_open) ----------
+ * Ketiga CSV tidak saling bergantung: masing-masing dibaca (dan diindeks)
+ * oleh worker ke library_db_t sementara miliknya sendiri, sementara thread
+ * pemanggil membaca meta. Setelah semua join, array tabel dan bagian indeksnya
+ * dipindahkan ke db. Urutan baris sama dengan urutan di file, jadi hasilnya
+ * identik dengan pembacaan berurutan.
+ */
+
+typedef lib_status_t (*table_reader_fn)(library_db_t *db, const char *path);
+
+typedef struct {
+    table_reader_fn read;
+    void (*rebuild_index)(library_db_t *db);
+    const char *path;
+    library_db_t part;
+    double ms;
+    lib_thread_t thread;
+} table_load_job_t;
+
+static void table_load_run(void *arg) {
+    table_load_job_t *job = arg;
+    double t = lib_clock_ms();
+    (void) job->read(&job->part, job->path);
+    index_create(&job->part);
+    job->rebuild_index(&job->part);
+    job->ms = lib_clock_ms() - t;
+}
+
+/* Arena yang dipakai indeks untuk tumbuh (setelah blok worker diadopsi db) */
+static void index_set_arena(struct lib_db_index *ix, lib_arena_t *a) {
+    ix->book_isbn.arena = ix->borrower_id.arena = ix->borrower_nim.arena = a;
+    ix->loan_id.arena = ix->loan_group.arena = ix->active_id.arena = ix->active_borrower.arena = a;
+    ix->active_due.arena = a;
+    ix->title_tri.arena = ix->title_tri.lookup.arena = a;
+    ix->author_tri.arena = ix->author_tri.lookup.arena = a;
+}
+
+/* Gabungkan indeks per tabel dari ketiga worker ke db->index. Jika salah
+ * satu gagal dibangun (memori habis), indeks dibangun ulang di sini. */
+static void adopt_table_indexes(library_db_t *db, table_load_job_t *jobs) {
+    struct lib_db_index *bi = jobs[0].part.index, *ri = jobs[1].part.index, *li = jobs[2].part.index;
+    if (bi && ri && li) {
+        /* pakai struct indeks worker pinjaman sebagai wadah, pindahkan sisanya */
+        struct lib_db_index *ix = li;
+        ix->book_isbn = bi->book_isbn;     lib_hindex_init(&bi->book_isbn, NULL);
+        ix->title_tri = bi->title_tri;     lib_trigram_init(&bi->title_tri, NULL);
+        ix->author_tri = bi->author_tri;   lib_trigram_init(&bi->author_tri, NULL);
+        ix->borrower_id = ri->borrower_id;   lib_hindex_init(&ri->borrower_id, NULL);
+        ix->borrower_nim = ri->borrower_nim; lib_hindex_init(&ri->borrower_nim, NULL);
+        jobs[2].part.index = NULL;
+        index_set_arena(ix, db->arena);
+        db->index = ix;
+    }
+    for (int i = 0; i < 3; ++i) index_drop(&jobs[i].part);
+    if (!db->index) {
+        index_create(db);
+        index_rebuild_all(db);
+    }
+}
+
+static void read_tables_parallel(library_db_t *db) {
+    table_reader_fn readers[3] = { read_books_csv, read_borrowers_csv, read_loans_csv };
+    void (*rebuilders[3])(library_db_t *) = { index_rebuild_books, index_rebuild_borrowers, index_rebuild_loans };
+    table_load_job_t jobs[3];
+    memset(jobs, 0, sizeof(jobs));
+    /* satu arena per worker (arena tidak thread-safe); bloknya diadopsi db */
+    bool arenas = true;
+    for (int i = 0; i < 3; ++i) {
+        tables_init(&jobs[i].part);
+        arenas = (jobs[i].part.arena = lib_arena_create()) != NULL && arenas;
+    }
+    if (!arenas) {
+        for (int i = 0; i < 3; ++i) lib_arena_free(jobs[i].part.arena);
+        double tm = lib_clock_ms();
+        read_meta_file(db);
+        db->open_stats.meta_ms = lib_clock_ms() - tm;
+        for (int i = 0; i < 3; ++i) (void) readers[i](db, db->db_file_path);
+        index_create(db);
+        index_rebuild_all(db);
+        return;
+    }
+    unsigned threads = 0;
+    for (int i = 0; i < 3; ++i) {
+        jobs[i].read = readers[i];
+        jobs[i].rebuild_index = rebuilders[i];
+        jobs[i].path = db->db_file_path;
+        if (lib_thread_start(&jobs[i].thread, table_load_run, &jobs[i])) threads++;
+    }
+    double tm = lib_clock_ms();
+    read_meta_file(db);
+    db->open_stats.meta_ms = lib_clock_ms() - tm;
+    for (int i = 0; i < 3; ++i) {
+        if (jobs[i].thread.started) lib_thread_join(&jobs[i].thread);
+        else table_load_run(&jobs[i]);   /* thread gagal dibuat: baca di sini */
+    }
+    /* pindahkan hasil (db masih kosong di titik ini) */
+    library_db_t *b = &jobs[0].part, *br = &jobs[1].part, *ln = &jobs[2].part;
+    db->books = b->books; db->books_hot = b->books_hot; db->books_count = b->books_count;
+    db->borrowers = br->borrowers; db->borrowers_count = br->borrowers_count;
+    db->loans = ln->loans; db->loans_count = ln->loans_count;
+    db->active_loans = ln->active_loans; db->active_loans_count = ln->active_loans_count;
+    note_id(db, br->id_high_water);
+    note_id(db, ln->id_high_water);
+    double ti = lib_clock_ms();
+    adopt_table_indexes(db, jobs);
+    for (int i = 0; i < 3; ++i) lib_arena_adopt(db->arena, jobs[i].part.arena);
+    db->open_stats.index_ms = lib_clock_ms() - ti;
+    db->open_stats.threads = threads;
+    db->open_stats.books_ms = jobs[0].ms;
+    db->open_stats.borrowers_ms = jobs[1].ms;
+    db->open_stats.loans_ms = jobs[2].ms;
+}
+
+/* ---------- Thread safety ----------
+ * held_locks: frame kunci yang sedang dipegang thread ini (yang terakhir di
+ * depan). API lib_* yang dipanggil dari dalam API lain, atau di dalam kunci
+ * yang diambil pemanggil, menemukan db-nya di sini dan tidak mengunci ulang;
+ * jadi rwlock tidak perlu rekursif dan fungsi internal bebas memanggil API
+ * publik.
+ */
+struct lib_db_sync {
+    lib_rwlock_t rw;
+};
+
+static LIB_THREAD_LOCAL lib_db_lock_t *held_locks;
+
+static const lib_db_lock_t *held_lock_of(const library_db_t *db) {
+    for (const lib_db_lock_t *h = held_locks; h; h = h->outer) if (h->db == db) return h;
+    return NULL;
+}
+
+static void lock_frame_init(lib_db_lock_t *lk, const library_db_t *db, bool write) {
+    lk->db = db;
+    lk->outer = NULL;
+    lk->write = write;
+    lk->held = false;
+}
+
+static void lock_frame_push(lib_db_lock_t *lk) {
+    lk->held = true;
+    lk->outer = held_locks;
+    held_locks = lk;
+}
+
+void lib_db_read_lock(const library_db_t *db, lib_db_lock_t *lk) {
+    lock_frame_init(lk, db, false);
+    if (!db || !db->sync || held_lock_of(db)) return;
+    lib_rwlock_read_lock(&db->sync->rw);
+    lock_frame_push(lk);
+}
+
+bool lib_db_write_lock(library_db_t *db, lib_db_lock_t *lk) {
+    lock_frame_init(lk, db, true);
+    if (!db) return false;
+    if (!db->sync) return true;
+    const lib_db_lock_t *h = held_lock_of(db);
+    if (h) return h->write;     /* baca -> tulis akan deadlock */
+    lib_rwlock_write_lock(&db->sync->rw);
+    lock_frame_push(lk);
+    return true;
+}
+
+void lib_db_unlock(lib_db_lock_t *lk) {
+    if (!lk || !lk->held) return;
+    /* biasanya frame teratas; urutan lepas lain tetap dilayani */
+    lib_db_lock_t **pp = &held_locks;
+    while (*pp && *pp != lk) pp = &(*pp)->outer;
+    if (*pp) *pp = lk->outer;
+    lk->held = false;
+    if (lk->write) lib_rwlock_write_unlock(&lk->db->sync->rw);
+    else lib_rwlock_read_unlock(&lk->db->sync->rw);
+}
+
+static void sync_free(library_db_t *db) {
+    if (!db->sync) return;
+    lib_rwlock_destroy(&db->sync->rw);
+    lib_heap_free(db->sync);
+    db->sync = NULL;
+}
+
+lib_status_t lib_set_thread_safe(library_db_t *db, bool enabled) {
+    if (!db || held_lock_of(db)) return LIB_ERR_INVALID_ARG;
+    if (!enabled) { sync_free(db); return LIB_OK; }
+    if (db->sync) return LIB_OK;
+    struct lib_db_sync *sync = lib_heap_calloc(1, sizeof(*sync));
+    if (!sync) return LIB_ERR_MEMORY;
+    if (!lib_rwlock_init(&sync->rw)) { lib_heap_free(sync); return LIB_ERR_MEMORY; }
+    db->sync = sync;
+    return LIB_OK;
+}
+
+bool lib_get_thread_safe(const library_db_t *db) {
+    return db && db->sync;
+}
+
 /* ---------- Public DB management API ---------- */
 
 library_db_t *lib_db_open(const char *path, lib_status_t *err) {
     if (err) *err = LIB_OK;
-    library_db_t *db = calloc(1, sizeof(library_db_t));
+    library_db_t *db = lib_heap_calloc(1, sizeof(library_db_t));
     if (!db) { if (err) *err = LIB_ERR_MEMORY; return NULL; }
-    db->books = NULL; db->books_count = db->books_capacity = 0;
-    db->borrowers = NULL; db->borrowers_count = db->borrowers_capacity = 0;
-    db->loans = NULL; db->loans_count = db->loans_capacity = 0;
+    db->arena = lib_arena_create();
+    if (!db->arena) { lib_heap_free(db); if (err) *err = LIB_ERR_MEMORY; return NULL; }
+    tables_init(db);
+    db->archive = NULL;
     db->fine_per_day = LIB_DEFAULT_FINE_PER_DAY;
     db->max_book_types = LIB_MAX_BOOK_TYPES;
     db->replacement_cost_days = LIB_REPLACEMENT_COST_DAYS_DEFAULT;
     db->max_overdue_days_before_lost = 30UL; /* Default 30 days */
-    if (path) db->db_file_path = my_strdup(path);
-    else db->db_file_path = my_strdup(LIB_DEFAULT_DB_FILE);
-    if (!db->db_file_path) { free(db); if (err) *err = LIB_ERR_MEMORY; return NULL; }
-    srand((unsigned)time(NULL));
-    (void) read_books_csv(db, db->db_file_path);
-    (void) read_borrowers_csv(db, db->db_file_path);
-    (void) read_loans_csv(db, db->db_file_path);
-    /* Read persisted policy meta if present (fine_per_day, replacement_cost_days) */
-    (void) read_meta_file(db);
+    db->journal_checkpoint_entries = LIB_DEFAULT_JOURNAL_CHECKPOINT;
+    db->durability = LIB_DURABILITY_SYNC;
+    db->group_commit_ms = LIB_DEFAULT_GROUP_COMMIT_MS;
+    db->group_commit_ops = LIB_DEFAULT_GROUP_COMMIT_OPS;
+    db->db_file_path = lib_arena_strdup(db->arena, path ? path : LIB_DEFAULT_DB_FILE);
+    if (!db->db_file_path) { lib_arena_free(db->arena); lib_heap_free(db); if (err) *err = LIB_ERR_MEMORY; return NULL; }
+    lib_open_stats_t *os = &db->open_stats;
+    double t0 = lib_clock_ms();
+    /* snapshot biner (tanpa parsing) jika ada dan lebih baru dari CSV */
+    bool from_snapshot = read_snapshot(db, db->db_file_path) == LIB_OK;
+    os->from_snapshot = from_snapshot;
+    if (!from_snapshot) {
+        read_tables_parallel(db);
+    } else {
+        double tm = lib_clock_ms();
+        read_meta_file(db);
+        os->meta_ms = lib_clock_ms() - tm;
+        double ti = lib_clock_ms();
+        index_create(db);
+        index_rebuild_all(db);
+        os->index_ms = lib_clock_ms() - ti;
+    }
+    /* manifest saja; partisi arsip dibaca sesuai kebutuhan query */
+    archive_attach(db);
+    os->load_ms = lib_clock_ms() - t0;
+    /* isi memori = snapshot di disk; replay di bawah menandai tabel yang berubah.
+     * Jika dimuat dari format lain dari yang dipakai checkpoint, tulis ulang
+     * semua tabel dalam format yang dipilih. */
+    db->dirty = from_snapshot != db->binary_snapshot ? LIB_DIRTY_TABLES : 0;
+    /* Terapkan mutasi yang sudah di-commit ke journal setelah snapshot CSV terakhir */
+    double tr = lib_clock_ms();
+    journal_attach(db);
+    if (db->journal) lib_journal_replay(db->journal, journal_apply, db);
+    archive_drop_duplicates(db);
+    os->replay_ms = lib_clock_ms() - tr;
+    os->total_ms = lib_clock_ms() - t0;
     if (err) *err = LIB_OK;
     return db;
 }
@@ -530,459 +2082,1895 @@ library_db_t *lib_db_open(const char *path, lib_status_t *err) {
    the older `lib_db_init` API used by legacy callers. */
 lib_status_t lib_db_init(library_db_t *db) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    db->books = NULL; db->books_count = db->books_capacity = 0;
-    db->borrowers = NULL; db->borrowers_count = db->borrowers_capacity = 0;
-    db->loans = NULL; db->loans_count = db->loans_capacity = 0;
+    tables_init(db);
+    db->archive = NULL;
     db->fine_per_day = LIB_DEFAULT_FINE_PER_DAY;
     db->max_book_types = LIB_MAX_BOOK_TYPES;
-    db->db_file_path = my_strdup(LIB_DEFAULT_DB_FILE);
+    db->arena = lib_arena_create();
+    db->db_file_path = db->arena ? lib_arena_strdup(db->arena, LIB_DEFAULT_DB_FILE) : NULL;
     db->replacement_cost_days = LIB_REPLACEMENT_COST_DAYS_DEFAULT;
     db->max_overdue_days_before_lost = 30UL; /* Default 30 days */
+    db->journal_checkpoint_entries = LIB_DEFAULT_JOURNAL_CHECKPOINT;
+    db->durability = LIB_DURABILITY_SYNC;
+    db->group_commit_ms = LIB_DEFAULT_GROUP_COMMIT_MS;
+    db->group_commit_ops = LIB_DEFAULT_GROUP_COMMIT_OPS;
+    db->id_high_water = LIB_ID_NONE;
+    db->sync = NULL;
     if (!db->db_file_path) return LIB_ERR_MEMORY;
+    db->index = NULL;
+    index_create(db);
+    /* DB kosong: save pertama harus menulis snapshot penuh, bukan menambah
+     * ke journal lama yang mungkin tertinggal di path default */
+    db->journal = NULL;
+    journal_attach(db);
+    if (db->journal) db->journal->need_checkpoint = true;
+    db->dirty = LIB_DIRTY_ALL;
+    memset(&db->save_stats, 0, sizeof(db->save_stats));
     /* Ensure data directory exists for the default DB path */
     ensure_dir_for_path(db->db_file_path);
     return LIB_OK;
 }
 
-/* ---------- lib_db_save (atomic write for each file) ---------- */
+/* ---------- lib_db_save (journal commit) / lib_db_checkpoint (atomic write for each file) ---------- */
+
+/* Checkpoint: hanya tabel dirty yang ditulis ulang; bit dibersihkan per file
+ * yang berhasil sehingga kegagalan di tengah jalan diulang pada save berikutnya. */
+static lib_status_t checkpoint_dirty(library_db_t *db) {
+    static const struct {
+        unsigned bit;
+        const char *suffix;
+        snapshot_writer_fn write;
+    } csv_files[] = {
+        { LIB_DIRTY_BOOKS,     "_books.csv",     write_books_csv_to },
+        { LIB_DIRTY_BORROWERS, "_borrowers.csv", write_borrowers_csv_to },
+        { LIB_DIRTY_LOANS,     "_loans.csv",     write_loans_csv_to },
+    };
+    db->save_stats.checkpoint = true;
+    db->save_stats.checkpoints++;
+    db->save_stats.files_written = db->save_stats.files_skipped = 0;
+    /* riwayat bulan lalu pindah ke arsip dulu agar _loans.csv tetap kecil;
+     * gagal mengarsip tidak menggagalkan checkpoint (dicoba lagi berikutnya) */
+    if (archive_closed_loans(db) != LIB_OK)
+        fprintf(stderr, "[lib] checkpoint: archiving closed loans failed, kept in _loans.csv\n");
+    /* tabel ditulis ulang seluruhnya: saat yang tepat membuang tombstone */
+    compact_books(db);
+    compact_loans(db);
+    lib_status_t st;
+    if (db->binary_snapshot) {
+        /* satu file untuk ketiga tabel: ditulis ulang jika salah satunya dirty */
+        if (!(db->dirty & LIB_DIRTY_TABLES)) db->save_stats.files_skipped++;
+        else {
+            st = write_snapshot_file(db, "_snapshot.bin", lib_snapshot_write);
+            if (st != LIB_OK) return st;
+            db->dirty &= ~LIB_DIRTY_TABLES;
+        }
+    } else {
+        for (size_t k = 0; k < sizeof(csv_files) / sizeof(csv_files[0]); ++k) {
+            if (!(db->dirty & csv_files[k].bit)) { db->save_stats.files_skipped++; continue; }
+            st = write_snapshot_file(db, csv_files[k].suffix, csv_files[k].write);
+            if (st != LIB_OK) return st;
+            db->dirty &= ~csv_files[k].bit;
+        }
+        /* semua CSV terbaru: snapshot biner lama (jika pernah dipakai) sudah usang */
+        remove_db_file(db, "_snapshot.bin");
+    }
+    if (!(db->dirty & LIB_DIRTY_META)) db->save_stats.files_skipped++;
+    else {
+        st = write_snapshot_file(db, "_meta.cfg", write_meta_to);
+        if (st != LIB_OK) return st;
+        db->dirty &= ~LIB_DIRTY_META;
+    }
+    /* snapshot sudah memuat semua mutasi: journal boleh dikosongkan */
+    if (db->journal) lib_journal_reset(db->journal);
+    return LIB_OK;
+}
+
+static void save_stats_begin(library_db_t *db) {
+    lib_save_stats_t *s = &db->save_stats;
+    s->checkpoint = false;
+    s->synced = false;
+    s->files_written = 0;
+    s->files_skipped = db->binary_snapshot ? 2 : 4;
+    s->journal_records = 0;
+    s->bytes_written = 0;
+    s->saves++;
+}
+
+/* fsync journal sekarang? barrier = lib_db_flush */
+static bool sync_due(const library_db_t *db, bool barrier) {
+    const lib_journal_t *j = db->journal;
+    if (j->unsynced_records == 0) return false;
+    if (barrier) return true;
+    switch (db->durability) {
+        case LIB_DURABILITY_GROUP: {
+            unsigned long ms = db->group_commit_ms ? db->group_commit_ms : LIB_DEFAULT_GROUP_COMMIT_MS;
+            unsigned long ops = db->group_commit_ops ? db->group_commit_ops : LIB_DEFAULT_GROUP_COMMIT_OPS;
+            return j->unsynced_records >= ops || lib_journal_unsynced_age_ms(j) >= (double)ms;
+        }
+        case LIB_DURABILITY_BUFFERED: return false;
+        case LIB_DURABILITY_SYNC:
+        default: return true;
+    }
+}
+
+static lib_status_t save_internal(library_db_t *db, bool barrier) {
+    save_stats_begin(db);
+    lib_journal_t *j = db->journal;
+    if (j && !j->need_checkpoint) {
+        /* O(perubahan): satu append untuk semua mutasi sejak save terakhir;
+         * fsync mengikuti kebijakan durability sehingga save beruntun berbagi satu fsync */
+        size_t len = j->pending_len, records = j->pending_records;
+        if (lib_journal_write(j) == 0) {
+            db->save_stats.journal_records = records;
+            db->save_stats.bytes_written += len;
+            db->save_stats.total_bytes_written += len;
+            if (j->entries < lib_get_journal_checkpoint_entries(db)) {
+                if (!sync_due(db, barrier)) return LIB_OK;
+                if (lib_journal_sync(j) == 0) {
+                    db->save_stats.synced = true;
+                    db->save_stats.syncs++;
+                    return LIB_OK;
+                }
+            }
+        }
+        /* write/fsync gagal atau journal sudah panjang: lipat ke snapshot CSV
+         * (file snapshot selalu di-fsync) */
+    }
+    return checkpoint_dirty(db);
+}
+
+static lib_status_t db_save(library_db_t *db) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    return save_internal(db, false);
+}
 
 lib_status_t lib_db_save(library_db_t *db) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = db_save(db);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t db_flush(library_db_t *db) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    lib_status_t st = LIB_OK;
+    return save_internal(db, true);
+}
+
+lib_status_t lib_db_flush(library_db_t *db) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = db_flush(db);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+/* fsync record group commit yang sudah lewat tenggat (atau semuanya jika
+ * idle) tanpa menunggu save berikutnya */
+static lib_status_t db_tick(library_db_t *db, bool idle, long *next_ms) {
+    if (next_ms) *next_ms = -1;
+    if (!db) return LIB_ERR_INVALID_ARG;
+    lib_journal_t *j = db->journal;
+    if (!j || j->unsynced_records == 0 || db->durability != LIB_DURABILITY_GROUP) return LIB_OK;
+    unsigned long ms = db->group_commit_ms ? db->group_commit_ms : LIB_DEFAULT_GROUP_COMMIT_MS;
+    double left = (double)ms - lib_journal_unsynced_age_ms(j);
+    if (!idle && left > 0.0) {
+        if (next_ms) *next_ms = left >= (double)LONG_MAX ? LONG_MAX : (long)left + 1;
+        return LIB_OK;
+    }
+    save_stats_begin(db);
+    if (lib_journal_sync(j) == 0) {
+        db->save_stats.synced = true;
+        db->save_stats.syncs++;
+        return LIB_OK;
+    }
+    return checkpoint_dirty(db);   /* fsync gagal: sama seperti save_internal */
+}
+
+lib_status_t lib_db_tick(library_db_t *db, bool idle, long *next_ms) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) {
+        if (next_ms) *next_ms = -1;
+        return LIB_ERR_INVALID_ARG;
+    }
+    lib_status_t st = db_tick(db, idle, next_ms);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t db_checkpoint(library_db_t *db) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    save_stats_begin(db);
+    return checkpoint_dirty(db);
+}
+
+lib_status_t lib_db_checkpoint(library_db_t *db) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = db_checkpoint(db);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t get_save_stats(const library_db_t *db, lib_save_stats_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    *out = db->save_stats;
+    return LIB_OK;
+}
+
+lib_status_t lib_get_save_stats(const library_db_t *db, lib_save_stats_t *out) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = get_save_stats(db, out);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t get_open_stats(const library_db_t *db, lib_open_stats_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    *out = db->open_stats;
+    return LIB_OK;
+}
+
+lib_status_t lib_get_open_stats(const library_db_t *db, lib_open_stats_t *out) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = get_open_stats(db, out);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t db_compact(library_db_t *db) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    compact_books(db);
+    compact_loans(db);
+    return LIB_OK;
+}
+
+lib_status_t lib_db_compact(library_db_t *db) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = db_compact(db);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t get_import_stats(const library_db_t *db, lib_import_stats_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    *out = db->import_stats;
+    return LIB_OK;
+}
+
+lib_status_t lib_get_import_stats(const library_db_t *db, lib_import_stats_t *out) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = get_import_stats(db, out);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t get_alloc_stats(const library_db_t *db, lib_alloc_stats_t *out) {
+    if (!out) return LIB_ERR_INVALID_ARG;
+    memset(out, 0, sizeof(*out));
+    out->heap_allocs = lib_heap_alloc_count();
+    out->heap_frees = lib_heap_free_count();
+    out->arena_allocs = lib_arena_alloc_count();
+    if (db && db->arena) {
+        out->arena_blocks = db->arena->blocks;
+        out->arena_reserved = db->arena->reserved;
+        out->arena_used = db->arena->used;
+    }
+    return LIB_OK;
+}
+
+lib_status_t lib_get_alloc_stats(const library_db_t *db, lib_alloc_stats_t *out) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = get_alloc_stats(db, out);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t db_mark_dirty(library_db_t *db, unsigned tables) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    db->dirty |= tables & LIB_DIRTY_ALL;
+    return LIB_OK;
+}
+
+lib_status_t lib_db_mark_dirty(library_db_t *db, unsigned tables) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = db_mark_dirty(db, tables);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+lib_status_t lib_db_close(library_db_t *db) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    lib_archive_free(db->archive);
+    /* record pending yang belum di-save dibuang, sama seperti perubahan in-memory;
+     * yang sudah di-save tapi belum di-fsync (group/buffered) di-fsync sekarang */
+    if (db->journal) lib_journal_sync(db->journal);
+    lib_journal_close(db->journal);
+    /* tabel, path dan indeks: beberapa blok arena, bukan satu free per array */
+    lib_arena_free(db->arena);
+    sync_free(db);
+    lib_heap_free(db);
+    return LIB_OK;
+}
+
+/* Read meta file if present: simple key=value lines */
+static void read_meta_file(library_db_t *db) {
+    if (!db || !db->db_file_path) return;
+    LIB_SCRATCH(s);
+    char *meta = scratch_path(&s, db->db_file_path, "_meta.cfg");
+    if (!meta) return;
+    FILE *f = fopen(meta, "r");
+    if (!f) { lib_arena_free(&s); return; }
+    char *line = NULL; size_t len = 0; ssize_t r;
+    while ((r = getline(&line, &len, f)) != -1) {
+        trim_newline(line);
+        if (line[0] == '\0') continue;
+        char *eq = strchr(line, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        apply_meta_value(db, line, eq + 1);
+    }
+    if (line) free(line);
+    fclose(f); lib_arena_free(&s);
+}
+
+/* ---------- max_book_types API ---------- */
+
+static lib_status_t set_max_book_types(library_db_t *db, size_t max) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    if (max == 0) db->max_book_types = LIB_MAX_BOOK_TYPES;
+    else {
+        if (max > LIB_MAX_BOOK_TYPES_HARD_LIMIT) return LIB_ERR_INVALID_ARG;
+        db->max_book_types = max;
+    }
+    return LIB_OK;
+}
+
+lib_status_t lib_set_max_book_types(library_db_t *db, size_t max) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_max_book_types(db, max);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static size_t get_max_book_types(const library_db_t *db) {
+    if (!db) return 0;
+    return db->max_book_types;
+}
+
+size_t lib_get_max_book_types(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = get_max_book_types(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+/* ---------- Book management ---------- */
+
+static lib_status_t add_book(library_db_t *db, const book_t *book) {
+    if (!db || !book) return LIB_ERR_INVALID_ARG;
+    /* buku baru wajib ISBN kanonik; kunci mentah hanya dari data lama */
+    if (!lib_isbn_is_valid(book->isbn)) return LIB_ERR_INVALID_ARG;
+    /* batas berlaku untuk buku yang masih ada: tombstone dibuang dulu bila penuh */
+    if (db->books_count >= db->max_book_types) compact_books(db);
+    if (db->books_count >= db->max_book_types) return LIB_ERR_MAX_TYPES;
+    if (find_book_row(db, book->isbn) != SIZE_MAX) return LIB_ERR_EXISTS;
+    lib_status_t st = append_book_row(db, book); if (st != LIB_OK) return st;
+    if (db->index) index_add_id(db, &db->index->book_isbn, eq_book_isbn, book->isbn, db->books_count - 1);
+    index_add_book_text(db, db->books_count - 1);
+    journal_book(db, db->books_count - 1);
+    return LIB_OK;
+}
+
+lib_status_t lib_add_book(library_db_t *db, const book_t *book) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = add_book(db, book);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t remove_book(library_db_t *db, lib_isbn_t isbn) {
+    if (!db || isbn == LIB_ISBN_NONE) return LIB_ERR_INVALID_ARG;
+    /* pinjaman yang belum kembali hanya ada di partisi aktif */
+    for (size_t i = 0, n; i < db->active_loans_count; i += n) {
+        const loan_t *run = lib_rows_span(&db->active_loans, i, db->active_loans_count, &n);
+        for (size_t k = 0; k < n; ++k) if (run[k].isbn == isbn) return LIB_ERR_INVALID_ARG;
+    }
+    size_t idx = find_book_row(db, isbn);
+    if (idx == SIZE_MAX) return LIB_ERR_NOT_FOUND;
+    journal_isbn(db, 'b', isbn);
+    remove_book_row(db, idx);
+    return LIB_OK;
+}
+
+lib_status_t lib_remove_book(library_db_t *db, lib_isbn_t isbn) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = remove_book(db, isbn);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static const book_t *find_book_by_isbn(const library_db_t *db, lib_isbn_t isbn) {
+    if (!db) return NULL;
+    size_t i = find_book_row(db, isbn);
+    return i == SIZE_MAX ? NULL : book_row(db, i);
+}
+
+const book_t *lib_find_book_by_isbn(const library_db_t *db, lib_isbn_t isbn) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const book_t *r = find_book_by_isbn(db, isbn);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+/* Konteks verifikasi kandidat trigram */
+typedef struct {
+    const library_db_t *db;
+    const char *needle;
+    size_t needle_len;
+    bool by_author;
+    const book_t **out;
+    size_t found;
+    size_t capacity;
+} book_search_ctx_t;
+
+static bool book_search_visit(void *ctx, uint32_t row) {
+    book_search_ctx_t *c = ctx;
+    const book_t *b = book_row(c->db, row);
+    if (b->isbn == LIB_ISBN_NONE) return true;   /* tombstone: posting lama belum dipadatkan */
+    const char *text = c->by_author ? b->author : b->title;
+    if (lib_contains_ci_n(text, strlen(text), c->needle, c->needle_len)) c->out[c->found++] = b;
+    return c->found < c->capacity;
+}
+
+static size_t search_books(const library_db_t *db, const char *substr, bool by_author, const book_t **out, size_t out_capacity) {
+    if (!db || !substr || !out || out_capacity == 0) return 0;
+    book_search_ctx_t c = { db, substr, strlen(substr), by_author, out, 0, out_capacity };
+    if (db->index) {
+        const lib_trigram_index_t *tx = by_author ? &db->index->author_tri : &db->index->title_tri;
+        /* kandidat dari irisan posting list, diverifikasi dengan pencocokan substring */
+        if (lib_trigram_query(tx, substr, book_search_visit, &c)) return c.found;
+    }
+    /* needle < 3 karakter (atau indeks tidak aktif): full scan */
+    for (size_t i = 0; i < db->books_count && c.found < out_capacity; ++i) book_search_visit(&c, (uint32_t)i);
+    return c.found;
+}
+
+size_t lib_search_books_by_title(const library_db_t *db, const char *title_substr, const book_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = search_books(db, title_substr, false, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+size_t lib_search_books_by_author(const library_db_t *db, const char *author_substr, const book_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = search_books(db, author_substr, true, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static size_t book_count(const library_db_t *db) {
+    return db ? db->books_count : 0;
+}
+
+size_t lib_book_count(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = book_count(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+bool lib_book_is_deleted(const book_t *b) {
+    return b && b->isbn == LIB_ISBN_NONE;
+}
+
+static const book_t *book_at(const library_db_t *db, size_t i) {
+    if (!db || i >= db->books_count) return NULL;
+    return book_row(db, i);
+}
+
+const book_t *lib_book_at(const library_db_t *db, size_t i) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const book_t *r = book_at(db, i);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+lib_status_t lib_get_book(const library_db_t *db, lib_isbn_t isbn, book_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const book_t *b = find_book_by_isbn(db, isbn);
+    if (b) *out = *b;
+    lib_db_unlock(&lk);
+    return b ? LIB_OK : LIB_ERR_NOT_FOUND;
+}
+
+static lib_book_ref_t book_ref(const library_db_t *db, const book_t *book) {
+    lib_book_ref_t ref = { LIB_ISBN_NONE, SIZE_MAX };
+    if (!db || !book) return ref;
+    ref.isbn = book->isbn;
+    ref.row = find_book_row(db, book->isbn);
+    return ref;
+}
+
+lib_book_ref_t lib_book_ref(const library_db_t *db, const book_t *book) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_book_ref_t r = book_ref(db, book);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static const book_t *book_get(const library_db_t *db, lib_book_ref_t *ref) {
+    if (!db || !ref || ref->isbn == LIB_ISBN_NONE) return NULL;
+    if (ref->row < db->books_count && book_row(db, ref->row)->isbn == ref->isbn) return book_row(db, ref->row);
+    ref->row = find_book_row(db, ref->isbn);   /* tabel dipadatkan atau diganti */
+    return ref->row == SIZE_MAX ? NULL : book_row(db, ref->row);
+}
+
+const book_t *lib_book_get(const library_db_t *db, lib_book_ref_t *ref) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const book_t *r = book_get(db, ref);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+/* Laporan stok & filter ketersediaan hanya membaca books_hot (32 byte/buku);
+ * baris book_t (teks) baru disentuh untuk hasil yang lolos filter. */
+static lib_status_t stock_report(const library_db_t *db, lib_stock_report_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    memset(out, 0, sizeof(*out));
+    long total = 0, avail = 0;
+    size_t empty = 0;
+    double value = 0.0;
+    /* per chunk: loop dalam tetap array kontigu */
+    for (size_t i = 0, n; i < db->books_count; i += n) {
+        const lib_book_hot_t *hot = lib_rows_span(&db->books_hot, i, db->books_count, &n);
+        for (size_t k = 0; k < n; ++k) {
+            if (hot[k].isbn == LIB_ISBN_NONE) continue;   /* tombstone */
+            total += hot[k].total_stock;
+            avail += hot[k].available;
+            empty += (hot[k].available <= 0);
+            value += hot[k].price * (double)hot[k].total_stock;
+        }
+    }
+    out->titles = db->books_count - db->books_tombstones;
+    out->total_stock = total;
+    out->available = avail;
+    out->borrowed = total - avail;
+    out->out_of_stock = empty;
+    out->stock_value = value;
+    return LIB_OK;
+}
+
+lib_status_t lib_stock_report(const library_db_t *db, lib_stock_report_t *out) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = stock_report(db, out);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static size_t find_available_books(const library_db_t *db, int min_available, const book_t **out, size_t out_capacity) {
+    if (!db || !out || out_capacity == 0) return 0;
+    size_t found = 0;
+    for (size_t i = 0, n; i < db->books_count && found < out_capacity; i += n) {
+        const lib_book_hot_t *hot = lib_rows_span(&db->books_hot, i, db->books_count, &n);
+        for (size_t k = 0; k < n && found < out_capacity; ++k) {
+            if (hot[k].available >= min_available && hot[k].isbn != LIB_ISBN_NONE) out[found++] = book_row(db, i + k);
+        }
+    }
+    return found;
+}
+
+size_t lib_find_available_books(const library_db_t *db, int min_available, const book_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = find_available_books(db, min_available, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_status_t update_book_stock(library_db_t *db, lib_isbn_t isbn, int delta) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    size_t i = find_book_row(db, isbn);
+    if (i == SIZE_MAX) return LIB_ERR_NOT_FOUND;
+    const lib_book_hot_t *h = hot_row(db, i);
+    long new_total = (long)h->total_stock + delta;
+    long new_avail = (long)h->available + delta;
+    if (new_total < 0 || new_avail < 0) return LIB_ERR_NO_STOCK;
+    book_set_stock(db, i, (int)new_total, (int)new_avail);
+    journal_book(db, i);
+    return LIB_OK;
+}
+
+lib_status_t lib_update_book_stock(library_db_t *db, lib_isbn_t isbn, int delta) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = update_book_stock(db, isbn, delta);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t update_book(library_db_t *db, lib_isbn_t isbn, const book_t *updated_book) {
+    if (!db || !updated_book) return LIB_ERR_INVALID_ARG;
+    size_t i = find_book_row(db, isbn);
+    if (i == SIZE_MAX) return LIB_ERR_NOT_FOUND;
+    book_t b = *book_row(db, i);
+    if (db->index) {
+        lib_trigram_remove(&db->index->title_tri, (uint32_t)i, b.title);
+        lib_trigram_remove(&db->index->author_tri, (uint32_t)i, b.author);
+    }
+    // Update all fields except ISBN (ISBN is key, cannot change)
+    strncpy(b.title, updated_book->title, LIB_MAX_TITLE - 1);
+    b.title[LIB_MAX_TITLE - 1] = '\0';
+    strncpy(b.author, updated_book->author, LIB_MAX_AUTHOR - 1);
+    b.author[LIB_MAX_AUTHOR - 1] = '\0';
+    b.year = updated_book->year;
+    b.price = updated_book->price;
+    strncpy(b.notes, updated_book->notes, LIB_MAX_NOTES - 1);
+    b.notes[LIB_MAX_NOTES - 1] = '\0';
+    book_store(db, i, &b);
+    index_add_book_text(db, i);
+    journal_book(db, i);
+    // Stock fields are not updated here; use lib_update_book_stock for that
+    return LIB_OK;
+}
+
+lib_status_t lib_update_book(library_db_t *db, lib_isbn_t isbn, const book_t *updated_book) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = update_book(db, isbn, updated_book);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static bool keep_returned_after(const loan_t *ln, const void *arg) {
+    return ln->date_returned > *(const lib_day_t *)arg;
+}
+
+/* Bagian arsip lib_remove_old_loans, dipilih dari manifest: partisi yang
+ * seluruhnya <= cutoff dihapus tanpa dibaca, partisi yang melewati cutoff
+ * ditulis ulang, sisanya tidak dibuka. Langsung diterapkan ke disk. */
+static lib_status_t remove_old_archived_loans(library_db_t *db, lib_day_t cutoff) {
+    lib_archive_t *a = db->archive;
+    if (!a || a->count == 0) return LIB_OK;
+    LIB_SCRATCH(s);
+    char (*gone)[LIB_ARCHIVE_FILE_MAX] = lib_arena_alloc(&s, a->count * sizeof(*gone));
+    if (!gone) return LIB_ERR_MEMORY;
+    size_t ngone = 0;
+    bool changed = false;
+    lib_status_t st = LIB_OK;
+    for (size_t k = 0; st == LIB_OK && k < a->count; ) {
+        const lib_archive_part_t *part = &a->parts[k];
+        if (lib_date_to_days(part->first) > cutoff) { k++; continue; }
+        if (lib_date_to_days(part->last) <= cutoff) {
+            memcpy(gone[ngone++], part->file, LIB_ARCHIVE_FILE_MAX);
+            lib_archive_remove(a, k);
+            changed = true;
+            continue;
+        }
+        size_t dropped = 0;
+        st = archive_filter_part(db, k, keep_returned_after, &cutoff, &dropped, gone[ngone]);
+        if (dropped) changed = true;
+        if (gone[ngone][0]) ngone++;
+        else k++;
+    }
+    /* manifest dulu: crash sebelum file dihapus hanya menyisakan file yatim */
+    if (changed) {
+        lib_status_t ms = save_manifest(db);
+        if (st == LIB_OK) st = ms;
+        if (ms == LIB_OK)
+            for (size_t k = 0; k < ngone; ++k) remove_db_file(db, gone[k]);
+    }
+    lib_arena_free(&s);
+    return st;
+}
+
+static lib_status_t remove_old_loans(library_db_t *db, unsigned long days_old) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    /* dikembalikan paling lambat `cutoff` = sudah >= days_old hari */
+    if (days_old > (unsigned long)INT32_MAX) days_old = INT32_MAX;
+    lib_day_t cutoff = (lib_day_t)((long)lib_day_today() - (long)days_old);
+    /* tandai semua lalu padatkan sekali: O(n), bukan geser per baris */
+    for (size_t i = 0; i < db->loans_count; ++i) {
+        loan_t *ln = history_row(db, i);
+        if (ln->loan_id == LIB_ID_NONE || !ln->is_returned || ln->is_lost) continue;
+        if (ln->date_returned <= cutoff) {
+            journal_id(db, 'l', ln->loan_id);
+            tombstone_loan_row(db, i);
+        }
+    }
+    compact_loans(db);
+    return remove_old_archived_loans(db, cutoff); /* LIB_OK walaupun tidak ada yang dihapus */
+}
+
+lib_status_t lib_remove_old_loans(library_db_t *db, unsigned long days_old) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = remove_old_loans(db, days_old);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+/* ---------- Borrower management (NIM) ---------- */
+
+static lib_status_t add_borrower(library_db_t *db, const borrower_t *b) {
+    if (!db || !b) return LIB_ERR_INVALID_ARG;
+    if (b->nim[0] != '\0' && find_borrower_row_by_nim(db, b->nim) != SIZE_MAX) return LIB_ERR_EXISTS;
+    if (find_borrower_row(db, b->id) != SIZE_MAX) return LIB_ERR_EXISTS;
+    borrower_t br = *b;
+    if (br.id == LIB_ID_NONE) br.id = lib_next_id(db);   /* id kosong: alokasikan */
+    lib_status_t st = append_borrower_row(db, &br); if (st != LIB_OK) return st;
+    index_add_borrower(db, db->borrowers_count - 1);
+    journal_borrower(db, db->borrowers_count - 1);
+    return LIB_OK;
+}
+
+lib_status_t lib_add_borrower(library_db_t *db, const borrower_t *b) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = add_borrower(db, b);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t update_borrower(library_db_t *db, lib_id_t id, const borrower_t *updated) {
+    if (!db || !updated) return LIB_ERR_INVALID_ARG;
+    size_t i = find_borrower_row(db, id);
+    if (i == SIZE_MAX) return LIB_ERR_NOT_FOUND;
+    borrower_t *br = borrower_row(db, i);
+    if (br != updated) {
+        strncpy(br->name, updated->name, LIB_MAX_NAME - 1);
+        br->name[LIB_MAX_NAME - 1] = '\0';
+        strncpy(br->phone, updated->phone, sizeof(br->phone) - 1);
+        br->phone[sizeof(br->phone) - 1] = '\0';
+        strncpy(br->email, updated->email, sizeof(br->email) - 1);
+        br->email[sizeof(br->email) - 1] = '\0';
+    }
+    journal_borrower(db, i);
+    return LIB_OK;
+}
+
+lib_status_t lib_update_borrower(library_db_t *db, lib_id_t id, const borrower_t *updated) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = update_borrower(db, id, updated);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static size_t borrower_count(const library_db_t *db) {
+    return db ? db->borrowers_count : 0;
+}
+
+size_t lib_borrower_count(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = borrower_count(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static const borrower_t *borrower_at(const library_db_t *db, size_t i) {
+    if (!db || i >= db->borrowers_count) return NULL;
+    return borrower_row(db, i);
+}
+
+const borrower_t *lib_borrower_at(const library_db_t *db, size_t i) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const borrower_t *r = borrower_at(db, i);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_borrower_ref_t borrower_ref(const library_db_t *db, const borrower_t *borrower) {
+    lib_borrower_ref_t ref = { LIB_ID_NONE, SIZE_MAX };
+    if (!db || !borrower) return ref;
+    ref.id = borrower->id;
+    ref.row = find_borrower_row(db, borrower->id);
+    return ref;
+}
+
+lib_borrower_ref_t lib_borrower_ref(const library_db_t *db, const borrower_t *borrower) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_borrower_ref_t r = borrower_ref(db, borrower);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static const borrower_t *borrower_get(const library_db_t *db, lib_borrower_ref_t *ref) {
+    if (!db || !ref || ref->id == LIB_ID_NONE) return NULL;
+    if (ref->row < db->borrowers_count && borrower_row(db, ref->row)->id == ref->id) return borrower_row(db, ref->row);
+    ref->row = find_borrower_row(db, ref->id);
+    return ref->row == SIZE_MAX ? NULL : borrower_row(db, ref->row);
+}
+
+const borrower_t *lib_borrower_get(const library_db_t *db, lib_borrower_ref_t *ref) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const borrower_t *r = borrower_get(db, ref);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static const borrower_t *find_borrower_by_id(const library_db_t *db, lib_id_t id) {
+    if (!db) return NULL;
+    size_t i = find_borrower_row(db, id);
+    return i == SIZE_MAX ? NULL : borrower_row(db, i);
+}
+
+const borrower_t *lib_find_borrower_by_id(const library_db_t *db, lib_id_t id) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const borrower_t *r = find_borrower_by_id(db, id);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static const borrower_t *find_borrower_by_nim(const library_db_t *db, const char *nim) {
+    if (!db || !nim) return NULL;
+    size_t i = find_borrower_row_by_nim(db, nim);
+    return i == SIZE_MAX ? NULL : borrower_row(db, i);
+}
+
+const borrower_t *lib_find_borrower_by_nim(const library_db_t *db, const char *nim) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const borrower_t *r = find_borrower_by_nim(db, nim);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+lib_status_t lib_get_borrower_by_nim(const library_db_t *db, const char *nim, borrower_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const borrower_t *b = find_borrower_by_nim(db, nim);
+    if (b) *out = *b;
+    lib_db_unlock(&lk);
+    return b ? LIB_OK : LIB_ERR_NOT_FOUND;
+}
+
+static borrower_t *get_or_create_borrower_by_nim(library_db_t *db, const char *nim, bool create_if_missing) {
+    if (!db || !nim) return NULL;
+    size_t row = find_borrower_row_by_nim(db, nim);
+    if (row != SIZE_MAX) return borrower_row(db, row);
+    if (!create_if_missing) return NULL;
+    lib_status_t st = ensure_borrowers_capacity(db); if (st != LIB_OK) return NULL;
+    borrower_t br; memset(&br,0,sizeof(br));
+    br.id = lib_next_id(db);
+    strncpy(br.nim, nim, sizeof(br.nim)-1);
+    br.name[0] = '\0';
+    br.phone[0] = '\0';
+    br.email[0] = '\0';
+    *borrower_row(db, db->borrowers_count++) = br;
+    index_add_borrower(db, db->borrowers_count - 1);
+    journal_borrower(db, db->borrowers_count - 1);
+    return borrower_row(db, db->borrowers_count - 1);
+}
+
+borrower_t *lib_get_or_create_borrower_by_nim(library_db_t *db, const char *nim, bool create_if_missing) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return NULL;
+    borrower_t *r = get_or_create_borrower_by_nim(db, nim, create_if_missing);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+bool lib_validate_nim_format(const char *nim) {
+    if (!nim) return false;
+    size_t len = strlen(nim);
+    if (len < 4 || len > 32) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (!isalnum((unsigned char)nim[i])) return false;
+    }
+    return true;
+}
+
+/* ---------- Loan management ---------- */
+
+static unsigned long calculate_fine(const library_db_t *db, lib_day_t due_date, lib_day_t return_date) {
+    if (!db || return_date <= due_date) return 0;
+    long days = (long)return_date - (long)due_date;
+    return (unsigned long) days * (unsigned long) db->fine_per_day;
+}
+
+unsigned long lib_calculate_fine(const library_db_t *db, lib_day_t due_date, lib_day_t return_date) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    unsigned long r = calculate_fine(db, due_date, return_date);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+/* Buat loan untuk buku di baris bi (stok sudah diperiksa pemanggil) */
+static lib_status_t checkout_row(library_db_t *db, size_t bi, lib_id_t borrower_id,
+                                 lib_day_t day_borrow, lib_day_t day_due, lib_id_t *out_loan_id) {
+    loan_t ln; memset(&ln,0,sizeof(ln));
+    ln.loan_id = lib_next_id(db);
+    ln.isbn = book_row(db, bi)->isbn;
+    ln.borrower_id = borrower_id;
+    ln.date_borrow = day_borrow;
+    ln.date_due = day_due;
+    ln.is_returned = false; ln.is_lost = false; ln.fine_paid = 0;
+    const loan_t *added = insert_loan_row(db, &ln);
+    if (!added) return LIB_ERR_MEMORY;
+    book_set_stock(db, bi, hot_row(db, bi)->total_stock, hot_row(db, bi)->available - 1);
+    journal_loan(db, added);
+    journal_book(db, bi);
+    if (out_loan_id) *out_loan_id = ln.loan_id;
+    return LIB_OK;
+}
+
+static lib_status_t checkout_book(library_db_t *db, lib_isbn_t isbn, const borrower_t *borrower, lib_date_t date_borrow, lib_date_t date_due, lib_id_t *out_loan_id) {
+    if (!db || !borrower) return LIB_ERR_INVALID_ARG;
+    size_t bi = find_book_row(db, isbn);
+    if (bi == SIZE_MAX) return LIB_ERR_NOT_FOUND;
+    if (hot_row(db, bi)->available <= 0) return LIB_ERR_NO_STOCK;
+    lib_id_t borrower_id = borrower->id;
+    const borrower_t *exists = lib_find_borrower_by_id(db, borrower_id);
+    if (!exists) {
+        lib_status_t st = lib_add_borrower(db, borrower);
+        if (st != LIB_OK) return st;
+        borrower_id = borrower_row(db, db->borrowers_count - 1)->id;
+    }
+    return checkout_row(db, bi, borrower_id, lib_date_to_days(date_borrow), lib_date_to_days(date_due), out_loan_id);
+}
+
+lib_status_t lib_checkout_book(library_db_t *db, lib_isbn_t isbn, const borrower_t *borrower, lib_date_t date_borrow, lib_date_t date_due, lib_id_t *out_loan_id) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = checkout_book(db, isbn, borrower, date_borrow, date_due, out_loan_id);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t return_book(library_db_t *db, lib_id_t loan_id, lib_date_t date_return, unsigned long *out_fine) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    loan_pos_t li;
+    if (!find_loan_pos(db, loan_id, &li)) return LIB_ERR_NOT_FOUND;
+    loan_t upd = *loan_at(db, li);
+    /* If the loan was already returned or marked as lost, do not accept a normal return */
+    if (upd.is_returned) return LIB_ERR_INVALID_ARG;
+    if (upd.is_lost) return LIB_ERR_INVALID_ARG;
+
+    upd.is_returned = true;
+    upd.date_returned = lib_date_to_days(date_return);
+    unsigned long fine = lib_calculate_fine(db, upd.date_due, upd.date_returned);
+    upd.fine_paid = fine;
+    /* selesai: pindah dari partisi aktif ke riwayat */
+    const loan_t *ln = store_loan_row(db, li, &upd);
+    if (!ln) return LIB_ERR_MEMORY;
+    if (out_fine) *out_fine = fine;
+    journal_loan(db, ln);
+
+    /* Restore available stock safely (don't overflow) */
+    size_t bi = find_book_row(db, ln->isbn);
+    if (bi != SIZE_MAX) {
+        /* ensure available does not exceed total_stock */
+        const lib_book_hot_t *h = hot_row(db, bi);
+        if (h->available < h->total_stock) book_set_stock(db, bi, h->total_stock, h->available + 1);
+        journal_book(db, bi);
+    }
+    return LIB_OK;
+}
+
+lib_status_t lib_return_book(library_db_t *db, lib_id_t loan_id, lib_date_t date_return, unsigned long *out_fine) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = return_book(db, loan_id, date_return, out_fine);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+/* ---------- Sirkulasi batch ----------
+ * Tiga fase di bawah satu kunci tulis: validasi semua item (termasuk stok
+ * untuk ISBN yang sama dipinjam beberapa kali dan loan_id ganda), reservasi
+ * baris tabel tujuan dan kapasitas indeksnya, lalu terapkan. Item yang ditolak
+ * validasi atau reservasi yang gagal membatalkan seluruh batch. Fase terapkan
+ * masih bisa gagal (LIB_ERR_MEMORY); batch berhenti di item itu dan item
+ * sebelumnya tetap berlaku, jadi pemanggil membaca status/loan_id per item.
+ * Satu save di akhir untuk seluruh batch. */
+
+/* (kunci, posisi item): diurutkan untuk mengelompokkan item yang sama */
+typedef struct {
+    uint64_t key;
+    size_t item;
+} batch_key_t;
+
+static int cmp_batch_key(const void *a, const void *b) {
+    const batch_key_t *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->item > y->item) - (x->item < y->item);
+}
+
+
+/* Kapasitas untuk n pinjaman aktif baru: baris partisi plus indeks aktif,
+ * agar sisipan berikutnya tidak perlu mengalokasi (batch) */
+static bool reserve_active_loans(library_db_t *db, size_t n) {
+    size_t total = db->active_loans_count + n;
+    if (!lib_rows_reserve(&db->active_loans, db->arena, total)) return false;
+    if (!db->index) return true;
+    return lib_hindex_reserve(&db->index->active_id, db->index->active_id.count + n) &&
+           lib_hindex_reserve(&db->index->active_borrower, db->index->active_borrower.count + n) &&
+           lib_calendar_reserve(&db->index->active_due, total);
+}
+
+static lib_status_t checkout_batch(library_db_t *db, lib_checkout_item_t *items, size_t count,
+                                   lib_date_t date_borrow, lib_date_t date_due) {
+    if (!db || (!items && count)) return LIB_ERR_INVALID_ARG;
+    if (count == 0) return LIB_OK;
+    LIB_SCRATCH(s);
+    batch_key_t *keys = lib_arena_alloc(&s, count * sizeof(*keys));
+    size_t *rows = lib_arena_alloc(&s, count * sizeof(*rows));
+    if (!keys || !rows) { lib_arena_free(&s); return LIB_ERR_MEMORY; }
+
+    lib_status_t first = LIB_OK;
+    size_t valid = 0;
+    for (size_t i = 0; i < count; ++i) {
+        lib_checkout_item_t *it = &items[i];
+        it->loan_id = LIB_ID_NONE;
+        it->status = LIB_OK;
+        size_t bi = rows[i] = find_book_row(db, it->isbn);
+        if (!it->borrower) it->status = LIB_ERR_INVALID_ARG;
+        else if (find_borrower_row(db, it->borrower->id) == SIZE_MAX) it->status = LIB_ERR_NOT_FOUND;
+        else if (bi == SIZE_MAX) it->status = LIB_ERR_NOT_FOUND;
+        else keys[valid++] = (batch_key_t){ bi, i };
+    }
+    /* item ke-k untuk buku yang sama butuh available > k */
+    qsort(keys, valid, sizeof(*keys), cmp_batch_key);
+    for (size_t i = 0; i < valid; ) {
+        size_t j = i;
+        int available = hot_row(db, (size_t)keys[i].key)->available;
+        for (; j < valid && keys[j].key == keys[i].key; ++j)
+            if ((long)(j - i) >= (long)available) items[keys[j].item].status = LIB_ERR_NO_STOCK;
+        i = j;
+    }
+    for (size_t i = 0; i < count && first == LIB_OK; ++i) first = items[i].status;
+    if (first == LIB_OK && !reserve_active_loans(db, count)) first = LIB_ERR_MEMORY;
+    if (first != LIB_OK) { lib_arena_free(&s); return first; }
+
+    lib_day_t day_borrow = lib_date_to_days(date_borrow), day_due = lib_date_to_days(date_due);
+    for (size_t i = 0; i < count; ++i) {
+        lib_checkout_item_t *it = &items[i];
+        it->status = checkout_row(db, rows[i], it->borrower->id, day_borrow, day_due, &it->loan_id);
+        if (it->status != LIB_OK) { first = it->status; break; }
+    }
+    lib_arena_free(&s);
+    /* yang sudah diterapkan tetap disimpan; status gagal pertama menang */
+    lib_status_t st = db_save(db);
+    return first != LIB_OK ? first : st;
+}
+
+lib_status_t lib_checkout_batch(library_db_t *db, lib_checkout_item_t *items, size_t count,
+                                lib_date_t date_borrow, lib_date_t date_due) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = checkout_batch(db, items, count, date_borrow, date_due);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t return_batch(library_db_t *db, lib_return_item_t *items, size_t count, lib_date_t date_return) {
+    if (!db || (!items && count)) return LIB_ERR_INVALID_ARG;
+    if (count == 0) return LIB_OK;
+    LIB_SCRATCH(s);
+    batch_key_t *keys = lib_arena_alloc(&s, count * sizeof(*keys));
+    if (!keys) { lib_arena_free(&s); return LIB_ERR_MEMORY; }
+
+    lib_status_t first = LIB_OK;
+    for (size_t i = 0; i < count; ++i) {
+        lib_return_item_t *it = &items[i];
+        it->fine = 0;
+        it->status = LIB_OK;
+        keys[i] = (batch_key_t){ it->loan_id, i };
+        loan_pos_t p;
+        if (!find_loan_pos(db, it->loan_id, &p)) it->status = LIB_ERR_NOT_FOUND;
+        else if (loan_at(db, p)->is_returned || loan_at(db, p)->is_lost) it->status = LIB_ERR_INVALID_ARG;
+    }
+    /* loan yang sama dua kali: kemunculan kedua ditolak seperti pengembalian ulang */
+    qsort(keys, count, sizeof(*keys), cmp_batch_key);
+    for (size_t i = 1; i < count; ++i)
+        if (keys[i].key == keys[i - 1].key && items[keys[i].item].status == LIB_OK)
+            items[keys[i].item].status = LIB_ERR_INVALID_ARG;
+    for (size_t i = 0; i < count && first == LIB_OK; ++i) first = items[i].status;
+    /* pengembalian memindahkan loan ke partisi riwayat */
+    if (first == LIB_OK && (!lib_rows_reserve(&db->loans, db->arena, db->loans_count + count) ||
+                            (db->index && !lib_hindex_reserve(&db->index->loan_id, db->index->loan_id.count + count))))
+        first = LIB_ERR_MEMORY;
+    lib_arena_free(&s);
+    if (first != LIB_OK) return first;
+
+    for (size_t i = 0; i < count; ++i) {
+        items[i].status = return_book(db, items[i].loan_id, date_return, &items[i].fine);
+        if (items[i].status != LIB_OK) { first = items[i].status; break; }
+    }
+    lib_status_t st = db_save(db);
+    return first != LIB_OK ? first : st;
+}
+
+lib_status_t lib_return_batch(library_db_t *db, lib_return_item_t *items, size_t count, lib_date_t date_return) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = return_batch(db, items, count, date_return);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+/* Replacement cost policy: default multiplier in days of fine_per_day to estimate replacement cost */
+/* Replacement default days used when DB doesn't override it */
+
+static lib_status_t set_replacement_cost_days(library_db_t *db, unsigned long days) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    db->replacement_cost_days = days;
+    journal_meta(db, "replacement_cost_days", days);
+    return LIB_OK;
+}
+
+lib_status_t lib_set_replacement_cost_days(library_db_t *db, unsigned long days) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_replacement_cost_days(db, days);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static unsigned long get_replacement_cost_days(const library_db_t *db) {
+    if (!db) return LIB_REPLACEMENT_COST_DAYS_DEFAULT;
+    return db->replacement_cost_days ? db->replacement_cost_days : LIB_REPLACEMENT_COST_DAYS_DEFAULT;
+}
+
+unsigned long lib_get_replacement_cost_days(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    unsigned long r = get_replacement_cost_days(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_status_t set_max_overdue_days_before_lost(library_db_t *db, unsigned long days) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    db->max_overdue_days_before_lost = days;
+    journal_meta(db, "max_overdue_days_before_lost", days);
+    return LIB_OK;
+}
+
+lib_status_t lib_set_max_overdue_days_before_lost(library_db_t *db, unsigned long days) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_max_overdue_days_before_lost(db, days);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static unsigned long get_max_overdue_days_before_lost(const library_db_t *db) {
+    if (!db) return 30UL; /* Default 30 days */
+    return db->max_overdue_days_before_lost ? db->max_overdue_days_before_lost : 30UL;
+}
+
+unsigned long lib_get_max_overdue_days_before_lost(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    unsigned long r = get_max_overdue_days_before_lost(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+/* Fine policy accessors */
+static lib_status_t set_fine_per_day(library_db_t *db, long fine) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    db->fine_per_day = fine;
+    char buf[64];
+    journal_record(db, 'M', buf, snprintf(buf, sizeof(buf), "fine_per_day=%ld", fine));
+    return LIB_OK;
+}
+
+lib_status_t lib_set_fine_per_day(library_db_t *db, long fine) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_fine_per_day(db, fine);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static long get_fine_per_day(const library_db_t *db) {
+    if (!db) return LIB_DEFAULT_FINE_PER_DAY;
+    return db->fine_per_day;
+}
+
+long lib_get_fine_per_day(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    long r = get_fine_per_day(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_status_t set_journal_checkpoint_entries(library_db_t *db, size_t entries) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    db->journal_checkpoint_entries = entries;
+    journal_meta(db, "journal_checkpoint_entries", (unsigned long)entries);
+    return LIB_OK;
+}
+
+lib_status_t lib_set_journal_checkpoint_entries(library_db_t *db, size_t entries) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_journal_checkpoint_entries(db, entries);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static size_t get_journal_checkpoint_entries(const library_db_t *db) {
+    if (!db || db->journal_checkpoint_entries == 0) return LIB_DEFAULT_JOURNAL_CHECKPOINT;
+    return db->journal_checkpoint_entries;
+}
+
+size_t lib_get_journal_checkpoint_entries(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = get_journal_checkpoint_entries(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static const char *const durability_names[] = { "sync", "group", "buffered" };
+
+const char *lib_durability_name(lib_durability_t mode) {
+    if ((unsigned)mode >= sizeof(durability_names) / sizeof(durability_names[0])) return "sync";
+    return durability_names[mode];
+}
+
+bool lib_durability_parse(const char *name, lib_durability_t *out) {
+    if (!name || !out) return false;
+    for (size_t i = 0; i < sizeof(durability_names) / sizeof(durability_names[0]); ++i) {
+        if (strcmp(name, durability_names[i]) == 0) { *out = (lib_durability_t)i; return true; }
+    }
+    return false;
+}
+
+static lib_status_t set_durability(library_db_t *db, lib_durability_t mode,
+                                   unsigned long interval_ms, unsigned long max_ops) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    if (mode != LIB_DURABILITY_SYNC && mode != LIB_DURABILITY_GROUP && mode != LIB_DURABILITY_BUFFERED)
+        return LIB_ERR_INVALID_ARG;
+    db->durability = mode;
+    db->group_commit_ms = interval_ms ? interval_ms : LIB_DEFAULT_GROUP_COMMIT_MS;
+    db->group_commit_ops = max_ops ? max_ops : LIB_DEFAULT_GROUP_COMMIT_OPS;
+    journal_meta_str(db, "durability", lib_durability_name(mode));
+    journal_meta(db, "group_commit_ms", db->group_commit_ms);
+    journal_meta(db, "group_commit_ops", db->group_commit_ops);
+    return LIB_OK;
+}
+
+lib_status_t lib_set_durability(library_db_t *db, lib_durability_t mode,
+                                unsigned long interval_ms, unsigned long max_ops) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_durability(db, mode, interval_ms, max_ops);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_durability_t get_durability(const library_db_t *db) {
+    return db ? db->durability : LIB_DURABILITY_SYNC;
+}
+
+lib_durability_t lib_get_durability(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_durability_t r = get_durability(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_status_t set_binary_snapshot(library_db_t *db, bool enabled) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    if (db->binary_snapshot == enabled) return LIB_OK;
+    db->binary_snapshot = enabled;
+    /* format baru belum berisi apa pun: checkpoint berikutnya menulis semua tabel */
+    db->dirty |= LIB_DIRTY_TABLES;
+    journal_meta(db, "binary_snapshot", enabled ? 1UL : 0UL);
+    return LIB_OK;
+}
+
+lib_status_t lib_set_binary_snapshot(library_db_t *db, bool enabled) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_binary_snapshot(db, enabled);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static bool get_binary_snapshot(const library_db_t *db) {
+    return db ? db->binary_snapshot : false;
+}
+
+bool lib_get_binary_snapshot(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    bool r = get_binary_snapshot(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_status_t mark_book_lost(library_db_t *db, lib_id_t loan_id, unsigned long *out_cost) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    loan_pos_t li;
+    if (!find_loan_pos(db, loan_id, &li)) return LIB_ERR_NOT_FOUND;
+    loan_t upd = *loan_at(db, li);
+    loan_t *ln = &upd;
+    if (ln->is_lost) return LIB_ERR_INVALID_ARG;
+    /* tempat di riwayat disiapkan dulu agar perubahan stok di bawah tidak
+     * tercatat tanpa loan-nya */
+    if (li.active && ensure_loans_capacity(db) != LIB_OK) return LIB_ERR_MEMORY;
+
+    /* Mark lost. If the book hasn't been returned yet, mark it returned at today
+     * and compute a replacement cost as `fine_per_day * replacement_cost_days`.
+     */
+    ln->is_lost = true;
+    if (!ln->is_returned) {
+        ln->is_returned = true;
+        ln->date_returned = lib_day_today();
+    }
 
-    /* Books */
-    char *final_books = alloc_path_with_suffix(db->db_file_path, "_books.csv");
-    if (!final_books) return LIB_ERR_MEMORY;
-    size_t tmp_len = strlen(final_books) + 5;
-    char *tmp_books = malloc(tmp_len);
-    if (!tmp_books) { free(final_books); return LIB_ERR_MEMORY; }
-    snprintf(tmp_books, tmp_len, "%s.tmp", final_books);
-    st = write_books_csv_to(db, tmp_books);
-    if (st != LIB_OK) { free(final_books); free(tmp_books); return st; }
-    if (replace_file_atomic(tmp_books, final_books) != 0) {
-        free(final_books); free(tmp_books); return LIB_ERR_IO;
-    }
-    free(tmp_books); free(final_books);
-
-    /* Borrowers */
-    char *final_b = alloc_path_with_suffix(db->db_file_path, "_borrowers.csv");
-    if (!final_b) return LIB_ERR_MEMORY;
-    tmp_len = strlen(final_b) + 5;
-    char *tmp_b = malloc(tmp_len);
-    if (!tmp_b) { free(final_b); return LIB_ERR_MEMORY; }
-    snprintf(tmp_b, tmp_len, "%s.tmp", final_b);
-    st = write_borrowers_csv_to(db, tmp_b);
-    if (st != LIB_OK) { free(final_b); free(tmp_b); return st; }
-    if (replace_file_atomic(tmp_b, final_b) != 0) { free(final_b); free(tmp_b); return LIB_ERR_IO; }
-    free(tmp_b); free(final_b);
-
-    /* Loans */
-    char *final_l = alloc_path_with_suffix(db->db_file_path, "_loans.csv");
-    if (!final_l) return LIB_ERR_MEMORY;
-    tmp_len = strlen(final_l) + 5;
-    char *tmp_l = malloc(tmp_len);
-    if (!tmp_l) { free(final_l); return LIB_ERR_MEMORY; }
-    snprintf(tmp_l, tmp_len, "%s.tmp", final_l);
-    st = write_loans_csv_to(db, tmp_l);
-    if (st != LIB_OK) { free(final_l); free(tmp_l); return st; }
-    if (replace_file_atomic(tmp_l, final_l) != 0) { free(final_l); free(tmp_l); return LIB_ERR_IO; }
-    free(tmp_l); free(final_l);
-
-    /* Meta: write policy file (fine_per_day, replacement_cost_days, max_overdue_days_before_lost) */
-    char *final_meta = alloc_path_with_suffix(db->db_file_path, "_meta.cfg");
-    if (final_meta) {
-        size_t tmpm_len = strlen(final_meta) + 5;
-        char *tmp_meta = malloc(tmpm_len);
-        if (tmp_meta) {
-            snprintf(tmp_meta, tmpm_len, "%s.tmp", final_meta);
-            FILE *mf = fopen(tmp_meta, "w");
-            if (mf) {
-                if (fprintf(mf, "fine_per_day=%ld\n", db->fine_per_day) < 0) { /* ignore */ }
-                if (fprintf(mf, "replacement_cost_days=%lu\n", db->replacement_cost_days) < 0) { /* ignore */ }
-                if (fprintf(mf, "max_overdue_days_before_lost=%lu\n", db->max_overdue_days_before_lost) < 0) { /* ignore */ }
-                fflush(mf);
-#if !defined(_WIN32) && !defined(_WIN64)
-                fsync(fileno(mf));
-#endif
-                fclose(mf);
-                replace_file_atomic(tmp_meta, final_meta);
-            }
-            free(tmp_meta);
+    /* Prefer computing replacement cost from known book price (persisted). If price is 0 (unknown),
+     * fallback to configured `replacement_cost_days * fine_per_day`.
+     */
+    unsigned long cost = 0;
+    size_t i = find_book_row(db, ln->isbn);
+    if (i != SIZE_MAX) {
+        const lib_book_hot_t *h = hot_row(db, i);
+        double p = h->price;
+        if (p > 0.0) {
+            /* round to nearest currency unit */
+            cost = (unsigned long) llround(p);
+        } else {
+            unsigned long days = lib_get_replacement_cost_days(db);
+            cost = (unsigned long) db->fine_per_day * days;
         }
-        free(final_meta);
+        /* Adjust library stock: reduce total and available safely (prevent negative values). */
+        int total = h->total_stock > 0 ? h->total_stock - 1 : 0;
+        int avail = h->available > 0 ? h->available - 1 : 0;
+        /* Ensure available never exceeds total_stock */
+        if (avail > total) avail = total;
+        book_set_stock(db, i, total, avail);
+        journal_book(db, i);
     }
+    ln->fine_paid = (long) cost;
+    const loan_t *stored = store_loan_row(db, li, &upd);
+    if (stored) journal_loan(db, stored);
 
+    if (out_cost) *out_cost = cost;
     return LIB_OK;
 }
 
-lib_status_t lib_db_close(library_db_t *db) {
+lib_status_t lib_mark_book_lost(library_db_t *db, lib_id_t loan_id, unsigned long *out_cost) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = mark_book_lost(db, loan_id, out_cost);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+static lib_status_t set_loan_payment(library_db_t *db, lib_id_t loan_id, long amount) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    if (db->books) free(db->books);
-    if (db->borrowers) free(db->borrowers);
-    if (db->loans) free(db->loans);
-    if (db->db_file_path) free(db->db_file_path);
-    free(db);
+    loan_pos_t p;
+    if (!find_loan_pos(db, loan_id, &p)) return LIB_ERR_NOT_FOUND;
+    loan_t *ln = loan_at(db, p);
+    ln->fine_paid = amount;
+    journal_loan(db, ln);
     return LIB_OK;
 }
 
-/* Read meta file if present: simple key=value lines */
-static void read_meta_file(library_db_t *db) {
-    if (!db || !db->db_file_path) return;
-    char *meta = alloc_path_with_suffix(db->db_file_path, "_meta.cfg");
-    if (!meta) return;
-    FILE *f = fopen(meta, "r");
-    if (!f) { free(meta); return; }
-    char *line = NULL; size_t len = 0; ssize_t r;
-    while ((r = getline(&line, &len, f)) != -1) {
-        trim_newline(line);
-        if (line[0] == '\0') continue;
-        char *eq = strchr(line, '=');
-        if (!eq) continue;
-        *eq = '\0'; char *key = line; char *val = eq + 1;
-        if (strcmp(key, "fine_per_day") == 0) db->fine_per_day = atol(val);
-        else if (strcmp(key, "replacement_cost_days") == 0) db->replacement_cost_days = strtoul(val, NULL, 10);
-        else if (strcmp(key, "max_overdue_days_before_lost") == 0) db->max_overdue_days_before_lost = strtoul(val, NULL, 10);
-    }
-    if (line) free(line);
-    fclose(f); free(meta);
+lib_status_t lib_set_loan_payment(library_db_t *db, lib_id_t loan_id, long amount) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = set_loan_payment(db, loan_id, amount);
+    lib_db_unlock(&lk);
+    return st;
 }
 
-/* ---------- max_book_types API ---------- */
-
-lib_status_t lib_set_max_book_types(library_db_t *db, size_t max) {
+static lib_status_t settle_lost_loan(library_db_t *db, lib_id_t loan_id) {
     if (!db) return LIB_ERR_INVALID_ARG;
-    if (max == 0) db->max_book_types = LIB_MAX_BOOK_TYPES;
-    else {
-        if (max > LIB_MAX_BOOK_TYPES_HARD_LIMIT) return LIB_ERR_INVALID_ARG;
-        db->max_book_types = max;
-    }
+    loan_pos_t p;
+    if (!find_loan_pos(db, loan_id, &p)) return LIB_ERR_NOT_FOUND;
+    loan_t *ln = loan_at(db, p);
+    if (!ln->is_lost) return LIB_ERR_INVALID_ARG;
+    /* hilang -> kembali: tetap di riwayat */
+    ln->is_lost = false;
+    ln->is_returned = true;
+    journal_loan(db, ln);
     return LIB_OK;
 }
-size_t lib_get_max_book_types(const library_db_t *db) {
-    if (!db) return 0;
-    return db->max_book_types;
-}
 
-/* ---------- Book management ---------- */
+lib_status_t lib_settle_lost_loan(library_db_t *db, lib_id_t loan_id) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = settle_lost_loan(db, loan_id);
+    lib_db_unlock(&lk);
+    return st;
+}
 
-lib_status_t lib_add_book(library_db_t *db, const book_t *book) {
-    if (!db || !book) return LIB_ERR_INVALID_ARG;
-    if (db->books_count >= db->max_book_types) return LIB_ERR_MAX_TYPES;
-    for (size_t i = 0; i < db->books_count; ++i) {
-        if (strcmp(db->books[i].isbn, book->isbn) == 0) return LIB_ERR_EXISTS;
-    }
-    lib_status_t st = ensure_books_capacity(db); if (st != LIB_OK) return st;
-    db->books[db->books_count++] = *book;
-    return LIB_OK;
+static const loan_t *find_loan_by_id(const library_db_t *db, lib_id_t loan_id) {
+    if (!db) return NULL;
+    loan_pos_t p;
+    return find_loan_pos(db, loan_id, &p) ? loan_at(db, p) : NULL;
 }
 
-lib_status_t lib_remove_book(library_db_t *db, const char *isbn) {
-    if (!db || !isbn) return LIB_ERR_INVALID_ARG;
-    for (size_t i = 0; i < db->loans_count; ++i) {
-        if (strcmp(db->loans[i].isbn, isbn) == 0 && !db->loans[i].is_returned) return LIB_ERR_INVALID_ARG;
-    }
-    size_t idx = SIZE_MAX;
-    for (size_t i = 0; i < db->books_count; ++i) if (strcmp(db->books[i].isbn, isbn) == 0) { idx = i; break; }
-    if (idx == SIZE_MAX) return LIB_ERR_NOT_FOUND;
-    for (size_t i = idx; i + 1 < db->books_count; ++i) db->books[i] = db->books[i+1];
-    db->books_count--;
-    return LIB_OK;
+const loan_t *lib_find_loan_by_id(const library_db_t *db, lib_id_t loan_id) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const loan_t *r = find_loan_by_id(db, loan_id);
+    lib_db_unlock(&lk);
+    return r;
 }
 
-const book_t *lib_find_book_by_isbn(const library_db_t *db, const char *isbn) {
-    if (!db || !isbn) return NULL;
-    for (size_t i = 0; i < db->books_count; ++i) if (strcmp(db->books[i].isbn, isbn) == 0) return &db->books[i];
-    return NULL;
+lib_status_t lib_get_loan(const library_db_t *db, lib_id_t loan_id, loan_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const loan_t *l = find_loan_by_id(db, loan_id);
+    if (l) *out = *l;
+    lib_db_unlock(&lk);
+    return l ? LIB_OK : LIB_ERR_NOT_FOUND;
 }
 
-size_t lib_search_books_by_title(const library_db_t *db, const char *title_substr, const book_t **out, size_t out_capacity) {
-    if (!db || !title_substr || !out) return 0;
-    size_t found = 0;
-    for (size_t i = 0; i < db->books_count && found < out_capacity; ++i) {
-        if (contains_case_insensitive(db->books[i].title, title_substr)) out[found++] = &db->books[i];
-    }
-    return found;
+static loan_t *find_loan_by_id_mutable(library_db_t *db, lib_id_t loan_id) {
+    if (!db) return NULL;
+    loan_pos_t p;
+    return find_loan_pos(db, loan_id, &p) ? loan_at(db, p) : NULL;
 }
 
-lib_status_t lib_update_book_stock(library_db_t *db, const char *isbn, int delta) {
-    if (!db || !isbn) return LIB_ERR_INVALID_ARG;
-    for (size_t i = 0; i < db->books_count; ++i) {
-        if (strcmp(db->books[i].isbn, isbn) == 0) {
-            long new_total = (long)db->books[i].total_stock + delta;
-            long new_avail = (long)db->books[i].available + delta;
-            if (new_total < 0 || new_avail < 0) return LIB_ERR_NO_STOCK;
-            db->books[i].total_stock = (int)new_total;
-            db->books[i].available = (int)new_avail;
-            return LIB_OK;
-        }
-    }
-    return LIB_ERR_NOT_FOUND;
+loan_t *lib_find_loan_by_id_mutable(library_db_t *db, lib_id_t loan_id) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return NULL;
+    loan_t *r = find_loan_by_id_mutable(db, loan_id);
+    lib_db_unlock(&lk);
+    return r;
 }
 
-lib_status_t lib_update_book(library_db_t *db, const char *isbn, const book_t *updated_book) {
-    if (!db || !isbn || !updated_book) return LIB_ERR_INVALID_ARG;
-    for (size_t i = 0; i < db->books_count; ++i) {
-        if (strcmp(db->books[i].isbn, isbn) == 0) {
-            // Update all fields except ISBN (ISBN is key, cannot change)
-            strncpy(db->books[i].title, updated_book->title, LIB_MAX_TITLE - 1);
-            db->books[i].title[LIB_MAX_TITLE - 1] = '\0';
-            strncpy(db->books[i].author, updated_book->author, LIB_MAX_AUTHOR - 1);
-            db->books[i].author[LIB_MAX_AUTHOR - 1] = '\0';
-            db->books[i].year = updated_book->year;
-            db->books[i].price = updated_book->price;
-            strncpy(db->books[i].notes, updated_book->notes, LIB_MAX_NOTES - 1);
-            db->books[i].notes[LIB_MAX_NOTES - 1] = '\0';
-            // Stock fields are not updated here; use lib_update_book_stock for that
-            return LIB_OK;
-        }
-    }
-    return LIB_ERR_NOT_FOUND;
+typedef struct {
+    lib_loan_visit_fn visit;
+    void *ctx;
+    lib_day_t from;
+    lib_day_t to;
+    size_t visited;
+} history_query_t;
+
+static bool history_visit(void *ctx, const loan_t *ln) {
+    history_query_t *q = ctx;
+    if (!ln->is_returned) return true;
+    if (ln->date_returned < q->from || ln->date_returned > q->to) return true;
+    q->visited++;
+    return q->visit(q->ctx, ln);
 }
 
-lib_status_t lib_remove_old_loans(library_db_t *db, unsigned long days_old) {
-    if (!db) return LIB_ERR_INVALID_ARG;
-    lib_date_t today = lib_date_from_time_t(time(NULL));
-    size_t removed = 0;
-    for (size_t i = 0; i < db->loans_count; ) {
-        loan_t *ln = &db->loans[i];
-        if (ln->is_returned && !ln->is_lost) {
-            int days_since_return = lib_date_days_between(ln->date_returned, today);
-            if (days_since_return >= (int)days_old) {
-                // Remove this loan by shifting the rest
-                for (size_t j = i; j + 1 < db->loans_count; ++j) {
-                    db->loans[j] = db->loans[j + 1];
-                }
-                db->loans_count--;
-                removed++;
-                continue; // Do not increment i
-            }
-        }
-        i++;
+/* Hanya membaca db: statistik query masuk ke *stats milik pemanggil */
+static size_t loan_history_between(const library_db_t *db, lib_date_t from, lib_date_t to,
+                                   lib_loan_visit_fn visit, void *ctx, lib_history_stats_t *stats) {
+    lib_history_stats_t hs;
+    memset(&hs, 0, sizeof(hs));
+    if (stats) *stats = hs;
+    if (!db || !visit) return 0;
+    double t0 = lib_clock_ms();
+    history_query_t q = { visit, ctx, lib_date_to_days(from), lib_date_to_days(to), 0 };
+    bool go = true;
+    const lib_archive_t *a = db->archive;
+    for (size_t k = 0; a && go && k < a->count; ++k) {
+        if (!lib_archive_overlaps(&a->parts[k], from, to)) { hs.parts_pruned++; continue; }
+        hs.parts_scanned++;
+        go = scan_loan_segment(db, &a->parts[k], history_visit, &q, &hs.rows_read);
+    }
+    for (size_t i = 0; go && i < db->loans_count; ++i) {
+        if (history_row(db, i)->loan_id == LIB_ID_NONE) continue;
+        go = history_visit(&q, history_row(db, i));
     }
-    return LIB_OK; // Always return OK, even if none removed
+    hs.query_ms = lib_clock_ms() - t0;
+    if (stats) *stats = hs;
+    return q.visited;
 }
 
-/* ---------- Borrower management (NIM) ---------- */
+size_t lib_loan_history_between(const library_db_t *db, lib_date_t from, lib_date_t to,
+                                lib_loan_visit_fn visit, void *ctx, lib_history_stats_t *stats) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = loan_history_between(db, from, to, visit, ctx, stats);
+    lib_db_unlock(&lk);
+    return r;
+}
 
-lib_status_t lib_add_borrower(library_db_t *db, const borrower_t *b) {
-    if (!db || !b) return LIB_ERR_INVALID_ARG;
-    if (b->nim[0] != '\0') {
-        for (size_t i = 0; i < db->borrowers_count; ++i) {
-            if (strcmp(db->borrowers[i].nim, b->nim) == 0) return LIB_ERR_EXISTS;
-        }
-    }
-    for (size_t i = 0; i < db->borrowers_count; ++i) {
-        if (strcmp(db->borrowers[i].id, b->id) == 0) return LIB_ERR_EXISTS;
-    }
-    lib_status_t st = ensure_borrowers_capacity(db); if (st != LIB_OK) return st;
-    db->borrowers[db->borrowers_count++] = *b;
+static lib_status_t get_archive_stats(const library_db_t *db, lib_archive_stats_t *out) {
+    if (!db || !out) return LIB_ERR_INVALID_ARG;
+    if (db->archive) *out = db->archive->stats;
+    else memset(out, 0, sizeof(*out));
     return LIB_OK;
 }
 
-const borrower_t *lib_find_borrower_by_id(const library_db_t *db, const char *id) {
-    if (!db || !id) return NULL;
-    for (size_t i = 0; i < db->borrowers_count; ++i) if (strcmp(db->borrowers[i].id, id) == 0) return &db->borrowers[i];
-    return NULL;
+lib_status_t lib_get_archive_stats(const library_db_t *db, lib_archive_stats_t *out) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = get_archive_stats(db, out);
+    lib_db_unlock(&lk);
+    return st;
 }
 
-const borrower_t *lib_find_borrower_by_nim(const library_db_t *db, const char *nim) {
-    if (!db || !nim) return NULL;
-    for (size_t i = 0; i < db->borrowers_count; ++i) if (strcmp(db->borrowers[i].nim, nim) == 0) return &db->borrowers[i];
-    return NULL;
+bool lib_loan_is_deleted(const loan_t *l) {
+    return !l || l->loan_id == LIB_ID_NONE;
 }
 
-borrower_t *lib_get_or_create_borrower_by_nim(library_db_t *db, const char *nim, bool create_if_missing) {
-    if (!db || !nim) return NULL;
-    for (size_t i = 0; i < db->borrowers_count; ++i) {
-        if (strcmp(db->borrowers[i].nim, nim) == 0) return &db->borrowers[i];
-    }
-    if (!create_if_missing) return NULL;
-    lib_status_t st = ensure_borrowers_capacity(db); if (st != LIB_OK) return NULL;
-    borrower_t br; memset(&br,0,sizeof(br));
-    generate_unique_id("B", br.id, sizeof(br.id));
-    strncpy(br.nim, nim, sizeof(br.nim)-1);
-    br.name[0] = '\0';
-    br.phone[0] = '\0';
-    br.email[0] = '\0';
-    db->borrowers[db->borrowers_count++] = br;
-    return &db->borrowers[db->borrowers_count - 1];
+static const loan_t *loan_row_at(const library_db_t *db, size_t i) {
+    if (!db || i >= db->loans_count) return NULL;
+    return history_row(db, i);
 }
 
-bool lib_validate_nim_format(const char *nim) {
-    if (!nim) return false;
-    size_t len = strlen(nim);
-    if (len < 4 || len > 32) return false;
-    for (size_t i = 0; i < len; ++i) {
-        if (!isalnum((unsigned char)nim[i])) return false;
-    }
-    return true;
+const loan_t *lib_loan_at(const library_db_t *db, size_t i) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const loan_t *r = loan_row_at(db, i);
+    lib_db_unlock(&lk);
+    return r;
 }
 
-/* ---------- Loan management ---------- */
+static const loan_t *active_loan_at(const library_db_t *db, size_t i) {
+    if (!db || i >= db->active_loans_count) return NULL;
+    return active_row(db, i);
+}
 
-unsigned long lib_calculate_fine(const library_db_t *db, lib_date_t due_date, lib_date_t return_date) {
+const loan_t *lib_active_loan_at(const library_db_t *db, size_t i) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    const loan_t *r = active_loan_at(db, i);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static size_t loan_count(const library_db_t *db) {
     if (!db) return 0;
-    int days = lib_date_days_between(due_date, return_date);
-    if (days <= 0) return 0;
-    return (unsigned long) days * (unsigned long) db->fine_per_day;
+    size_t archived = db->archive ? (size_t)db->archive->stats.archived_rows : 0;
+    return db->active_loans_count + db->loans_count - db->loans_tombstones + archived;
 }
 
-lib_status_t lib_checkout_book(library_db_t *db, const char *isbn, const borrower_t *borrower, lib_date_t date_borrow, lib_date_t date_due, char out_loan_id[32]) {
-    if (!db || !isbn || !borrower) return LIB_ERR_INVALID_ARG;
-    size_t bi = SIZE_MAX;
-    for (size_t i = 0; i < db->books_count; ++i) if (strcmp(db->books[i].isbn, isbn) == 0) { bi = i; break; }
-    if (bi == SIZE_MAX) return LIB_ERR_NOT_FOUND;
-    if (db->books[bi].available <= 0) return LIB_ERR_NO_STOCK;
-    const borrower_t *exists = lib_find_borrower_by_id(db, borrower->id);
-    if (!exists) {
-        lib_status_t st = lib_add_borrower(db, borrower);
+size_t lib_loan_count(const library_db_t *db) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = loan_count(db);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static bool keep_other_id(const loan_t *ln, const void *arg) {
+    return ln->loan_id != *(const lib_id_t *)arg;
+}
+
+/* Hapus loan yang sudah diarsip: tanggalnya tidak diketahui, jadi partisi
+ * dibaca satu per satu sampai ketemu (operasi admin yang jarang) */
+static lib_status_t remove_archived_loan(library_db_t *db, lib_id_t loan_id) {
+    lib_archive_t *a = db->archive;
+    for (size_t k = 0; a && k < a->count; ++k) {
+        size_t dropped = 0;
+        char emptied[LIB_ARCHIVE_FILE_MAX];
+        lib_status_t st = archive_filter_part(db, k, keep_other_id, &loan_id, &dropped, emptied);
         if (st != LIB_OK) return st;
+        if (dropped == 0) continue;
+        st = save_manifest(db);
+        if (st == LIB_OK && emptied[0]) remove_db_file(db, emptied);
+        return st;
     }
-    lib_status_t st = ensure_loans_capacity(db); if (st != LIB_OK) return st;
-    loan_t ln; memset(&ln,0,sizeof(ln));
-    generate_unique_id("L", ln.loan_id, sizeof(ln.loan_id));
-    strncpy(ln.isbn, isbn, LIB_MAX_ISBN-1);
-    strncpy(ln.borrower_id, borrower->id, sizeof(ln.borrower_id)-1);
-    ln.date_borrow = date_borrow;
-    ln.date_due = date_due;
-    ln.is_returned = false; ln.is_lost = false; ln.fine_paid = 0;
-    db->loans[db->loans_count++] = ln;
-    db->books[bi].available -= 1;
-    if (out_loan_id) strncpy(out_loan_id, ln.loan_id, 32);
+    return LIB_ERR_NOT_FOUND;
+}
+
+static lib_status_t remove_loan(library_db_t *db, lib_id_t loan_id) {
+    if (!db) return LIB_ERR_INVALID_ARG;
+    loan_pos_t p;
+    if (!find_loan_pos(db, loan_id, &p)) return remove_archived_loan(db, loan_id);
+    journal_id(db, 'l', loan_at(db, p)->loan_id);
+    delete_loan(db, p);
     return LIB_OK;
 }
 
-lib_status_t lib_return_book(library_db_t *db, const char *loan_id, lib_date_t date_return, unsigned long *out_fine) {
-    if (!db || !loan_id) return LIB_ERR_INVALID_ARG;
-    size_t li = SIZE_MAX;
-    for (size_t i = 0; i < db->loans_count; ++i) if (strcmp(db->loans[i].loan_id, loan_id) == 0) { li = i; break; }
-    if (li == SIZE_MAX) return LIB_ERR_NOT_FOUND;
-    loan_t *ln = &db->loans[li];
-    /* If the loan was already returned or marked as lost, do not accept a normal return */
-    if (ln->is_returned) return LIB_ERR_INVALID_ARG;
-    if (ln->is_lost) return LIB_ERR_INVALID_ARG;
+lib_status_t lib_remove_loan(library_db_t *db, lib_id_t loan_id) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = remove_loan(db, loan_id);
+    lib_db_unlock(&lk);
+    return st;
+}
 
-    ln->is_returned = true;
-    ln->date_returned = date_return;
-    unsigned long fine = lib_calculate_fine(db, ln->date_due, date_return);
-    ln->fine_paid = fine;
-    if (out_fine) *out_fine = fine;
+/* Pinjaman aktif milik borrower_id lewat multimap partisi aktif */
+static size_t collect_active_loans_of_borrower(const library_db_t *db, lib_id_t borrower_id,
+                                               loan_t **out, size_t found, size_t out_capacity) {
+    uint64_t h = lib_hash_u64(borrower_id);
+    size_t pos = 0;
+    uint32_t r;
+    while (found < out_capacity &&
+           (r = lib_hindex_find_next(&db->index->active_borrower, h, eq_active_borrower, db, &borrower_id, &pos)) != LIB_ROW_NONE)
+        out[found++] = active_row(db, r);
+    return found;
+}
 
-    /* Restore available stock safely (don't overflow) */
-    for (size_t i = 0; i < db->books_count; ++i) {
-        if (strcmp(db->books[i].isbn, ln->isbn) == 0) {
-            /* ensure available does not exceed total_stock */
-            if (db->books[i].available < db->books[i].total_stock) db->books[i].available += 1;
-            break;
+/* Kumpulkan semua loan milik borrower_id: riwayat lewat multimap grup
+ * (urut tabel), lalu yang aktif; O(jumlah loan borrower). */
+static size_t collect_loans_of_borrower(const library_db_t *db, lib_id_t borrower_id,
+                                        loan_t **out, size_t found, size_t out_capacity) {
+    const struct lib_db_index *ix = db->index;
+    uint32_t g = lib_hindex_find(&ix->loan_group, lib_hash_u64(borrower_id), eq_loan_group, db, &borrower_id);
+    if (g != LIB_ROW_NONE) {
+        for (uint32_t r = ix->group_head[g]; r != LIB_ROW_NONE && found < out_capacity; r = ix->loan_next[r])
+            if (history_row(db, r)->loan_id != LIB_ID_NONE) out[found++] = history_row(db, r);
+    }
+    return collect_active_loans_of_borrower(db, borrower_id, out, found, out_capacity);
+}
+
+static size_t find_loans_by_borrower(const library_db_t *db, const char *borrower_id_or_name, loan_t **out, size_t out_capacity) {
+    if (!db || !borrower_id_or_name || !out) return 0;
+    size_t found = 0;
+    lib_id_t id = LIB_ID_NONE;
+    (void)lib_id_parse(borrower_id_or_name, &id);
+    if (db->index && id != LIB_ID_NONE) {
+        /* Exact id: langsung dari multimap, tanpa pencocokan nama/NIM. */
+        const struct lib_db_index *ix = db->index;
+        uint64_t h = lib_hash_u64(id);
+        if (lib_hindex_find(&ix->loan_group, h, eq_loan_group, db, &id) != LIB_ROW_NONE ||
+            lib_hindex_find(&ix->active_borrower, h, eq_active_borrower, db, &id) != LIB_ROW_NONE ||
+            find_borrower_row(db, id) != SIZE_MAX) {
+            return collect_loans_of_borrower(db, id, out, 0, out_capacity);
         }
+        /* Fallback: cocokkan substring nama/NIM pada tabel borrower, lalu ambil
+         * loan tiap borrower yang cocok lewat multimap. */
+        for (size_t i = 0; i < db->borrowers_count && found < out_capacity; ++i) {
+            const borrower_t *br = borrower_row(db, i);
+            if (lib_contains_ci(br->name, borrower_id_or_name) ||
+                lib_contains_ci(br->nim, borrower_id_or_name)) {
+                /* lewati duplikat id (hanya baris pertama yang terindeks) */
+                if (find_borrower_row(db, br->id) != i) continue;
+                found = collect_loans_of_borrower(db, br->id, out, found, out_capacity);
+            }
+        }
+        return found;
     }
-    return LIB_OK;
+    for (size_t i = 0; i < db->loans_count + db->active_loans_count && found < out_capacity; ++i) {
+        const loan_t *ln = i < db->loans_count ? history_row(db, i) : active_row(db, i - db->loans_count);
+        if (ln->loan_id == LIB_ID_NONE) continue;
+        if (id != LIB_ID_NONE && ln->borrower_id == id) { out[found++] = (loan_t *)ln; continue; }
+        const borrower_t *br = lib_find_borrower_by_id(db, ln->borrower_id);
+        if (br && lib_contains_ci(br->name, borrower_id_or_name)) { out[found++] = (loan_t *)ln; }
+        else if (br && lib_contains_ci(br->nim, borrower_id_or_name)) { out[found++] = (loan_t *)ln; }
+    }
+    return found;
 }
 
-/* Replacement cost policy: default multiplier in days of fine_per_day to estimate replacement cost */
-/* Replacement default days used when DB doesn't override it */
+size_t lib_find_loans_by_borrower(const library_db_t *db, const char *borrower_id_or_name, loan_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = find_loans_by_borrower(db, borrower_id_or_name, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
+}
 
-lib_status_t lib_set_replacement_cost_days(library_db_t *db, unsigned long days) {
-    if (!db) return LIB_ERR_INVALID_ARG;
-    db->replacement_cost_days = days;
-    return LIB_OK;
+static size_t find_active_loans_by_borrower(const library_db_t *db, lib_id_t borrower_id, loan_t **out, size_t out_capacity) {
+    if (!db || !out || borrower_id == LIB_ID_NONE) return 0;
+    if (db->index) return collect_active_loans_of_borrower(db, borrower_id, out, 0, out_capacity);
+    size_t found = 0;
+    for (size_t i = 0; i < db->active_loans_count && found < out_capacity; ++i)
+        if (active_row(db, i)->borrower_id == borrower_id) out[found++] = active_row(db, i);
+    return found;
 }
 
-unsigned long lib_get_replacement_cost_days(const library_db_t *db) {
-    if (!db) return LIB_REPLACEMENT_COST_DAYS_DEFAULT;
-    return db->replacement_cost_days ? db->replacement_cost_days : LIB_REPLACEMENT_COST_DAYS_DEFAULT;
+size_t lib_find_active_loans_by_borrower(const library_db_t *db, lib_id_t borrower_id, loan_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = find_active_loans_by_borrower(db, borrower_id, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
 }
 
-lib_status_t lib_set_max_overdue_days_before_lost(library_db_t *db, unsigned long days) {
-    if (!db) return LIB_ERR_INVALID_ARG;
-    db->max_overdue_days_before_lost = days;
-    return LIB_OK;
+static size_t find_lost_loans_by_borrower(const library_db_t *db, lib_id_t borrower_id, loan_t **out, size_t out_capacity) {
+    if (!db || !out || borrower_id == LIB_ID_NONE) return 0;
+    size_t found = 0;
+    if (db->index) {
+        const struct lib_db_index *ix = db->index;
+        uint32_t g = lib_hindex_find(&ix->loan_group, lib_hash_u64(borrower_id), eq_loan_group, db, &borrower_id);
+        if (g == LIB_ROW_NONE) return 0;
+        for (uint32_t r = ix->group_head[g]; r != LIB_ROW_NONE && found < out_capacity; r = ix->loan_next[r]) {
+            loan_t *ln = history_row(db, r);
+            if (ln->loan_id != LIB_ID_NONE && ln->is_lost) out[found++] = ln;
+        }
+        return found;
+    }
+    for (size_t i = 0; i < db->loans_count && found < out_capacity; ++i) {
+        loan_t *ln = history_row(db, i);
+        if (ln->loan_id != LIB_ID_NONE && ln->is_lost && ln->borrower_id == borrower_id) out[found++] = ln;
+    }
+    return found;
 }
 
-unsigned long lib_get_max_overdue_days_before_lost(const library_db_t *db) {
-    if (!db) return 30UL; /* Default 30 days */
-    return db->max_overdue_days_before_lost ? db->max_overdue_days_before_lost : 30UL;
+size_t lib_find_lost_loans_by_borrower(const library_db_t *db, lib_id_t borrower_id, loan_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = find_lost_loans_by_borrower(db, borrower_id, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
 }
 
-/* Fine policy accessors */
-lib_status_t lib_set_fine_per_day(library_db_t *db, long fine) {
-    if (!db) return LIB_ERR_INVALID_ARG;
-    db->fine_per_day = fine;
-    return LIB_OK;
+/* ---------- Due-date queries ----------
+ * Pinjaman aktif per hari jatuh tempo lewat indeks kalender: biaya sebanding
+ * jumlah hari dalam rentang + hasil, bukan jumlah pinjaman aktif. */
+
+typedef struct {
+    const library_db_t *db;
+    loan_t **out;
+    size_t found;
+    size_t cap;
+} due_collect_t;
+
+static bool collect_due_row(void *ctx, uint32_t row, int32_t day) {
+    (void)day;
+    due_collect_t *c = ctx;
+    if (c->found >= c->cap) return false;
+    c->out[c->found++] = active_row(c->db, row);
+    return true;
 }
 
-long lib_get_fine_per_day(const library_db_t *db) {
-    if (!db) return LIB_DEFAULT_FINE_PER_DAY;
-    return db->fine_per_day;
+static int cmp_loan_due(const void *a, const void *b) {
+    lib_day_t da = (*(loan_t *const *)a)->date_due;
+    lib_day_t db_ = (*(loan_t *const *)b)->date_due;
+    return (da > db_) - (da < db_);
 }
 
-lib_status_t lib_mark_book_lost(library_db_t *db, const char *loan_id, unsigned long *out_cost) {
-    if (!db || !loan_id) return LIB_ERR_INVALID_ARG;
-    size_t li = SIZE_MAX;
-    for (size_t i = 0; i < db->loans_count; ++i) if (strcmp(db->loans[i].loan_id, loan_id) == 0) { li = i; break; }
-    if (li == SIZE_MAX) return LIB_ERR_NOT_FOUND;
-    loan_t *ln = &db->loans[li];
-    if (ln->is_lost) return LIB_ERR_INVALID_ARG;
+static int32_t clamp_day(long d) {
+    if (d < INT32_MIN) return INT32_MIN;
+    if (d > INT32_MAX) return INT32_MAX;
+    return (int32_t)d;
+}
 
-    /* Mark lost. If the book hasn't been returned yet, mark it returned at today
-     * and compute a replacement cost as `fine_per_day * replacement_cost_days`.
-     */
-    ln->is_lost = true;
-    if (!ln->is_returned) {
-        ln->is_returned = true;
-        ln->date_returned = lib_date_from_time_t(time(NULL));
+/* Pinjaman aktif dengan hari jatuh tempo di [lo, hi], urut jatuh tempo */
+static size_t collect_due_between(const library_db_t *db, long lo, long hi, loan_t **out, size_t out_capacity) {
+    if (lo > hi || out_capacity == 0) return 0;
+    if (db->index) {
+        due_collect_t c = { db, out, 0, out_capacity };
+        lib_calendar_query(&db->index->active_due, clamp_day(lo), clamp_day(hi), collect_due_row, &c);
+        return c.found;
     }
-
-    /* Prefer computing replacement cost from known book price (persisted). If price is 0 (unknown),
-     * fallback to configured `replacement_cost_days * fine_per_day`.
-     */
-    unsigned long cost = 0;
-    for (size_t i = 0; i < db->books_count; ++i) {
-        if (strcmp(db->books[i].isbn, ln->isbn) == 0) {
-            double p = db->books[i].price;
-            if (p > 0.0) {
-                /* round to nearest currency unit */
-                cost = (unsigned long) llround(p);
-            } else {
-                unsigned long days = lib_get_replacement_cost_days(db);
-                cost = (unsigned long) db->fine_per_day * days;
-            }
-            /* Adjust library stock: reduce total and available safely (prevent negative values). */
-            if (db->books[i].total_stock > 0) db->books[i].total_stock -= 1;
-            if (db->books[i].available > 0) db->books[i].available -= 1;
-            /* Ensure available never exceeds total_stock */
-            if (db->books[i].available > db->books[i].total_stock) db->books[i].available = db->books[i].total_stock;
-            break;
-        }
+    /* tanpa indeks: scan penuh, urutkan, ambil yang paling awal */
+    size_t n = 0;
+    for (size_t i = 0; i < db->active_loans_count; ++i) {
+        long d = active_row(db, i)->date_due;
+        if (d >= lo && d <= hi) n++;
     }
-    ln->fine_paid = (long) cost;
+    loan_t **all = out;
+    size_t cap = out_capacity;
+    LIB_SCRATCH(s);
+    if (n > out_capacity) {
+        loan_t **tmp = lib_arena_alloc(&s, n * sizeof(*tmp));
+        if (tmp) { all = tmp; cap = n; }   /* memori habis: hasil terpotong, tetap terurut */
+    }
+    size_t found = 0;
+    for (size_t i = 0; i < db->active_loans_count && found < cap; ++i) {
+        long d = active_row(db, i)->date_due;
+        if (d >= lo && d <= hi) all[found++] = active_row(db, i);
+    }
+    qsort(all, found, sizeof(*all), cmp_loan_due);
+    if (all != out) {
+        found = out_capacity;
+        memcpy(out, all, found * sizeof(*out));
+    }
+    lib_arena_free(&s);
+    return found;
+}
 
-    if (out_cost) *out_cost = cost;
-    return LIB_OK;
+static size_t find_loans_due_between(const library_db_t *db, lib_date_t from, lib_date_t to,
+                                     loan_t **out, size_t out_capacity) {
+    if (!db || !out) return 0;
+    return collect_due_between(db, lib_date_to_days(from), lib_date_to_days(to), out, out_capacity);
 }
 
-lib_status_t lib_set_loan_payment(library_db_t *db, const char *loan_id, long amount) {
-    if (!db || !loan_id) return LIB_ERR_INVALID_ARG;
-    for (size_t i = 0; i < db->loans_count; ++i) {
-        if (strcmp(db->loans[i].loan_id, loan_id) == 0) {
-            db->loans[i].fine_paid = amount;
-            return LIB_OK;
-        }
-    }
-    return LIB_ERR_NOT_FOUND;
+size_t lib_find_loans_due_between(const library_db_t *db, lib_date_t from, lib_date_t to,
+                                  loan_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = find_loans_due_between(db, from, to, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
 }
 
-size_t lib_find_loans_by_borrower(const library_db_t *db, const char *borrower_id_or_name, loan_t **out, size_t out_capacity) {
-    if (!db || !borrower_id_or_name || !out) return 0;
-    size_t found = 0;
-    for (size_t i = 0; i < db->loans_count && found < out_capacity; ++i) {
-        const loan_t *ln = &db->loans[i];
-        if (strcmp(ln->borrower_id, borrower_id_or_name) == 0) { out[found++] = (loan_t *)ln; continue; }
-        const borrower_t *br = lib_find_borrower_by_id(db, ln->borrower_id);
-        if (br && contains_case_insensitive(br->name, borrower_id_or_name)) { out[found++] = (loan_t *)ln; }
-        else if (br && contains_case_insensitive(br->nim, borrower_id_or_name)) { out[found++] = (loan_t *)ln; }
+static size_t find_overdue_loans(const library_db_t *db, lib_date_t today, unsigned long min_days_late,
+                                 loan_t **out, size_t out_capacity) {
+    if (!db || !out) return 0;
+    /* terlambat > min_days_late hari  <=>  due <= today - min_days_late - 1 */
+    long t = lib_date_to_days(today);
+    if (min_days_late > (unsigned long)INT32_MAX) return 0;
+    return collect_due_between(db, INT32_MIN, t - (long)min_days_late - 1, out, out_capacity);
+}
+
+size_t lib_find_overdue_loans(const library_db_t *db, lib_date_t today, unsigned long min_days_late,
+                              loan_t **out, size_t out_capacity) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    size_t r = find_overdue_loans(db, today, min_days_late, out, out_capacity);
+    lib_db_unlock(&lk);
+    return r;
+}
+
+static lib_status_t export_due_reminders(const library_db_t *db, const char *path, lib_date_t today,
+                                         unsigned days_ahead, size_t *out_count) {
+    if (out_count) *out_count = 0;
+    if (!db || !path) return LIB_ERR_INVALID_ARG;
+    long t = lib_date_to_days(today);
+    size_t cap = db->active_loans_count ? db->active_loans_count : 1;
+    LIB_SCRATCH(s);
+    loan_t **due = lib_arena_alloc(&s, cap * sizeof(*due));
+    if (!due) return LIB_ERR_MEMORY;
+    size_t n = collect_due_between(db, t, t + (long)days_ahead, due, cap);
+    if (ensure_dir_for_path(path) != 0) { lib_arena_free(&s); return LIB_ERR_IO; }
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "[lib] lib_export_due_reminders: fopen('%s') failed: %s\n", path, strerror(errno));
+        lib_arena_free(&s);
+        return LIB_ERR_IO;
     }
-    return found;
+    lib_status_t st = LIB_OK;
+    if (fprintf(f, "loan_id,isbn,title,borrower_id,nim,name,phone,email,date_due,days_left\n") < 0) st = LIB_ERR_IO;
+    char row[LIB_ROW_BUF];
+    for (size_t i = 0; st == LIB_OK && i < n; ++i) {
+        const loan_t *l = due[i];
+        const book_t *b = lib_find_book_by_isbn(db, l->isbn);
+        const borrower_t *br = lib_find_borrower_by_id(db, l->borrower_id);
+        char date[16], left[16], id[LIB_ID_TEXT_MAX], bid[LIB_ID_TEXT_MAX], isbn[LIB_ISBN_TEXT_MAX];
+        lib_id_format(l->loan_id, 'L', id, sizeof(id));
+        lib_isbn_format(l->isbn, isbn, sizeof(isbn));
+        lib_id_format(l->borrower_id, 'B', bid, sizeof(bid));
+        lib_day_format(l->date_due, date, sizeof(date));
+        snprintf(left, sizeof(left), "%ld", (long)l->date_due - t);
+        lib_csv_row_t r;
+        lib_csv_row_init(&r, row, sizeof(row));
+        lib_csv_row_raw(&r, id);
+        lib_csv_row_str(&r, isbn);
+        lib_csv_row_str(&r, b ? b->title : "");
+        lib_csv_row_raw(&r, bid);
+        lib_csv_row_str(&r, br ? br->nim : "");
+        lib_csv_row_str(&r, br ? br->name : "");
+        lib_csv_row_str(&r, br ? br->phone : "");
+        lib_csv_row_str(&r, br ? br->email : "");
+        lib_csv_row_raw(&r, date);
+        lib_csv_row_raw(&r, left);
+        lib_csv_row_end(&r);
+        if (fprintf(f, "%s\n", row) < 0) st = LIB_ERR_IO;
+    }
+    if (fclose(f) != 0) st = LIB_ERR_IO;
+    lib_arena_free(&s);
+    if (st == LIB_OK && out_count) *out_count = n;
+    return st;
+}
+
+lib_status_t lib_export_due_reminders(const library_db_t *db, const char *path, lib_date_t today,
+                                      unsigned days_ahead, size_t *out_count) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = export_due_reminders(db, path, today, days_ahead, out_count);
+    lib_db_unlock(&lk);
+    return st;
 }
 
 /* ---------- Admin auth minimal (file-based) ---------- */
@@ -999,56 +3987,56 @@ static void simple_hash_password(const char *plain, char *out_hash, size_t out_s
 
 lib_status_t lib_add_admin(const char *username, const char *password_plain) {
     if (!username || !password_plain) return LIB_ERR_INVALID_ARG;
-    char *admin_path = alloc_path_with_suffix(LIB_DEFAULT_DB_FILE, ADMIN_FILE_SUFFIX);
+    LIB_SCRATCH(s);
+    char *admin_path = scratch_path(&s, LIB_DEFAULT_DB_FILE, ADMIN_FILE_SUFFIX);
     if (!admin_path) return LIB_ERR_MEMORY;
     FILE *f = fopen(admin_path, "a+");
-    if (!f) { free(admin_path); return LIB_ERR_IO; }
+    lib_arena_free(&s);
+    if (!f) return LIB_ERR_IO;
     rewind(f);
     char *line = NULL; size_t len = 0;
+    /* buffer getline diisi ulang tiap baris: tokenisasi langsung di tempat */
     while (getline(&line, &len, f) != -1) {
         trim_newline(line);
         if (strlen(line) == 0) continue;
-        char *tmp = my_strdup(line);
         char *ctx = NULL;
-        char *tok = strtok_r(tmp, ",", &ctx);
-        if (tok && strcmp(tok, username) == 0) { free(tmp); free(line); fclose(f); free(admin_path); return LIB_ERR_EXISTS; }
-        free(tmp);
+        char *tok = strtok_r(line, ",", &ctx);
+        if (tok && strcmp(tok, username) == 0) { free(line); fclose(f); return LIB_ERR_EXISTS; }
     }
     if (line) free(line);
     char hash[64]; simple_hash_password(password_plain, hash, sizeof(hash));
     fprintf(f, "%s,%s\n", username, hash);
-    fclose(f); free(admin_path);
+    fclose(f);
     return LIB_OK;
 }
 
 lib_status_t lib_verify_admin(const char *username, const char *password_plain, admin_user_t *out) {
     if (!username || !password_plain) return LIB_ERR_INVALID_ARG;
-    char *admin_path = alloc_path_with_suffix(LIB_DEFAULT_DB_FILE, ADMIN_FILE_SUFFIX);
+    LIB_SCRATCH(s);
+    char *admin_path = scratch_path(&s, LIB_DEFAULT_DB_FILE, ADMIN_FILE_SUFFIX);
     if (!admin_path) return LIB_ERR_MEMORY;
     FILE *f = fopen(admin_path, "r");
-    if (!f) { free(admin_path); return LIB_ERR_IO; }
+    lib_arena_free(&s);
+    if (!f) return LIB_ERR_IO;
     char *line = NULL; size_t len = 0;
     char hash[64]; simple_hash_password(password_plain, hash, sizeof(hash));
     lib_status_t res = LIB_ERR_AUTH;
     while (getline(&line, &len, f) != -1) {
         trim_newline(line);
         if (strlen(line) == 0) continue;
-        char *tmp = my_strdup(line);
         char *ctx = NULL;
-        char *tok = strtok_r(tmp, ",", &ctx);
+        char *tok = strtok_r(line, ",", &ctx);
         if (tok && strcmp(tok, username) == 0) {
             char *tok2 = strtok_r(NULL, ",", &ctx);
             if (tok2 && strcmp(tok2, hash) == 0) {
                 if (out) { strncpy(out->username, username, sizeof(out->username)-1); strncpy(out->password_hash, tok2, sizeof(out->password_hash)-1); out->is_super = false; }
                 res = LIB_OK;
             } else res = LIB_ERR_AUTH;
-            free(tmp);
             break;
         }
-        free(tmp);
     }
     if (line) free(line);
-    fclose(f); free(admin_path);
+    fclose(f);
     return res;
 }
 
@@ -1056,74 +4044,139 @@ lib_status_t lib_verify_admin(const char *username, const char *password_plain,
 
 void lib_print_book(const book_t *b, FILE *fp) {
     if (!b || !fp) return;
+    char isbn[LIB_ISBN_TEXT_MAX];
+    lib_isbn_format(b->isbn, isbn, sizeof(isbn));
     fprintf(fp, "ISBN: %s\nTitle: %s\nAuthor: %s\nYear: %d\nStock: %d (available %d)\nNotes: %s\n",
-            b->isbn, b->title, b->author, b->year, b->total_stock, b->available, b->notes);
+            isbn, b->title, b->author, b->year, b->total_stock, b->available, b->notes);
 }
 void lib_print_borrower(const borrower_t *br, FILE *fp) {
     if (!br || !fp) return;
-    fprintf(fp, "ID: %s\nNIM: %s\nName: %s\nPhone: %s\nEmail: %s\n", br->id, br->nim, br->name, br->phone, br->email);
+    char id[LIB_ID_TEXT_MAX];
+    lib_id_format(br->id, 'B', id, sizeof(id));
+    fprintf(fp, "ID: %s\nNIM: %s\nName: %s\nPhone: %s\nEmail: %s\n", id, br->nim, br->name, br->phone, br->email);
 }
 void lib_print_loan(const loan_t *l, FILE *fp) {
     if (!l || !fp) return;
-    fprintf(fp, "Loan ID: %s\nISBN: %s\nBorrower ID: %s\nBorrowed: %04d-%02d-%02d\nDue: %04d-%02d-%02d\nReturned: %s\nLost: %d\nFinePaid: %ld\n",
-            l->loan_id, l->isbn, l->borrower_id,
-            l->date_borrow.year, l->date_borrow.month, l->date_borrow.day,
-            l->date_due.year, l->date_due.month, l->date_due.day,
+    char borrowed[16], due[16], id[LIB_ID_TEXT_MAX], bid[LIB_ID_TEXT_MAX], isbn[LIB_ISBN_TEXT_MAX];
+    lib_isbn_format(l->isbn, isbn, sizeof(isbn));
+    lib_day_format(l->date_borrow, borrowed, sizeof(borrowed));
+    lib_day_format(l->date_due, due, sizeof(due));
+    lib_id_format(l->loan_id, 'L', id, sizeof(id));
+    lib_id_format(l->borrower_id, 'B', bid, sizeof(bid));
+    fprintf(fp, "Loan ID: %s\nISBN: %s\nBorrower ID: %s\nBorrowed: %s\nDue: %s\nReturned: %s\nLost: %d\nFinePaid: %ld\n",
+            id, isbn, bid, borrowed, due,
             l->is_returned ? "YES" : "NO",
             l->is_lost, (long)l->fine_paid);
 }
 
 /* ---------- convenience alloc/free ---------- */
 
-book_t *lib_book_create_empty(void) { return calloc(1, sizeof(book_t)); }
-void lib_book_free(book_t *b) { if (b) free(b); }
-borrower_t *lib_borrower_create_empty(void) { return calloc(1, sizeof(borrower_t)); }
-void lib_borrower_free(borrower_t *b) { if (b) free(b); }
-loan_t *lib_loan_create_empty(void) { return calloc(1, sizeof(loan_t)); }
-void lib_loan_free(loan_t *l) { if (l) free(l); }
+book_t *lib_book_create_empty(void) { return lib_heap_calloc(1, sizeof(book_t)); }
+void lib_book_free(book_t *b) { lib_heap_free(b); }
+borrower_t *lib_borrower_create_empty(void) { return lib_heap_calloc(1, sizeof(borrower_t)); }
+void lib_borrower_free(borrower_t *b) { lib_heap_free(b); }
+loan_t *lib_loan_create_empty(void) { return lib_heap_calloc(1, sizeof(loan_t)); }
+void lib_loan_free(loan_t *l) { lib_heap_free(l); }
 
 /* ---------- Import/Export wrappers ---------- */
 
-lib_status_t lib_db_export_csv(const library_db_t *db, const char *path) {
+static lib_status_t db_export_csv(const library_db_t *db, const char *path) {
     if (!db || !path) return LIB_ERR_INVALID_ARG;
     /* treat `path` as a base path (like LIB_DEFAULT_DB_FILE) and write the three suffixed files */
-    char *p_books = alloc_path_with_suffix(path, "_books.csv");
-    if (!p_books) return LIB_ERR_MEMORY;
-    lib_status_t st = write_books_csv_to(db, p_books);
-    free(p_books);
-    if (st != LIB_OK) return st;
+    LIB_SCRATCH(s);
+    char *p_books = scratch_path(&s, path, "_books.csv");
+    char *p_borrowers = scratch_path(&s, path, "_borrowers.csv");
+    char *p_loans = scratch_path(&s, path, "_loans.csv");
+    lib_status_t st = p_books && p_borrowers && p_loans ? LIB_OK : LIB_ERR_MEMORY;
+    if (st == LIB_OK) st = write_books_csv_to(db, p_books);
+    if (st == LIB_OK) st = write_borrowers_csv_to(db, p_borrowers);
+    /* _loans.csv ekspor memuat partisi arsip juga, jadi bisa diimpor utuh */
+    if (st == LIB_OK) st = write_loans_csv(db, NULL, true, p_loans);
+    lib_arena_free(&s);
+    return st;
+}
 
-    char *p_borrowers = alloc_path_with_suffix(path, "_borrowers.csv");
-    if (!p_borrowers) return LIB_ERR_MEMORY;
-    st = write_borrowers_csv_to(db, p_borrowers);
-    free(p_borrowers);
-    if (st != LIB_OK) return st;
+lib_status_t lib_db_export_csv(const library_db_t *db, const char *path) {
+    lib_db_lock_t lk;
+    lib_db_read_lock(db, &lk);
+    lib_status_t st = db_export_csv(db, path);
+    lib_db_unlock(&lk);
+    return st;
+}
+
+/* Adapter pipeline impor: parser berjalan di thread pekerja, insert di thread pemanggil */
+static bool import_parse_book(const lib_csv_field_t *f, size_t n, void *out) { return parse_book_row(f, n, out); }
+static bool import_parse_borrower(const lib_csv_field_t *f, size_t n, void *out) { return parse_borrower_row(f, n, out); }
+static bool import_parse_loan(const lib_csv_field_t *f, size_t n, void *out) { return parse_loan_row(f, n, out); }
+static lib_status_t import_insert_book(void *ctx, const void *rec) { return append_book_row(ctx, rec); }
+static lib_status_t import_insert_borrower(void *ctx, const void *rec) { return append_borrower_row(ctx, rec); }
+static lib_status_t import_insert_loan(void *ctx, const void *rec) { return append_loan_row(ctx, rec); }
+
+/* Impor satu tabel; jatuh ke pembaca berurutan jika thread tidak bisa dibuat */
+static lib_status_t import_table(library_db_t *db, const char *path, const char *suffix,
+                                 const lib_import_table_t *t,
+                                 lib_status_t (*read_serial)(library_db_t *, const char *)) {
+    LIB_SCRATCH(s);
+    char *file = scratch_path(&s, path, suffix);
+    if (!file) return LIB_ERR_MEMORY;
+    bool pipelined = true;
+    lib_status_t st = lib_import_csv(file, t, 0, &db->import_stats, &pipelined);
+    lib_arena_free(&s);
+    return pipelined ? st : read_serial(db, path);
+}
 
-    char *p_loans = alloc_path_with_suffix(path, "_loans.csv");
-    if (!p_loans) return LIB_ERR_MEMORY;
-    st = write_loans_csv_to(db, p_loans);
-    free(p_loans);
+static lib_status_t db_import_csv(library_db_t *db, const char *path) {
+    if (!db || !path) return LIB_ERR_INVALID_ARG;
+    double t0 = lib_clock_ms();
+    /* tabel dan indeks lama dibuang utuh: arena baru (path ikut disalin,
+     * `path` bisa menunjuk ke memori arena lama), lalu arena lama dilepas */
+    lib_arena_t *fresh = lib_arena_create();
+    char *db_path = fresh ? lib_arena_strdup(fresh, db->db_file_path) : NULL;
+    path = db_path ? lib_arena_strdup(fresh, path) : NULL;
+    if (!path) { lib_arena_free(fresh); return LIB_ERR_MEMORY; }
+    lib_arena_free(db->arena);
+    db->arena = fresh;
+    db->db_file_path = db_path;
+    db->index = NULL;
+    tables_init(db);
+    memset(&db->import_stats, 0, sizeof(db->import_stats));
+    const lib_import_table_t books = { sizeof(book_t), BOOK_FIELDS, import_parse_book, import_insert_book, db };
+    const lib_import_table_t borrowers = { sizeof(borrower_t), BORROWER_FIELDS, import_parse_borrower, import_insert_borrower, db };
+    const lib_import_table_t loans = { sizeof(loan_t), LOAN_FIELDS, import_parse_loan, import_insert_loan, db };
+    lib_status_t st = import_table(db, path, "_books.csv", &books, read_books_csv);
+    if (st == LIB_OK) st = import_table(db, path, "_borrowers.csv", &borrowers, read_borrowers_csv);
+    if (st == LIB_OK) st = import_table(db, path, "_loans.csv", &loans, read_loans_csv);
+    /* rebuild indexes even on partial import so lookups match the table contents */
+    if (!db->index) index_create(db);
+    index_rebuild_all(db);
+    /* arsip tidak diganti: baris impor yang sudah ada di arsip dibuang */
+    archive_drop_duplicates(db);
+    /* isi tabel diganti seluruhnya: record journal lama tidak berlaku lagi */
+    if (db->journal) { lib_journal_discard(db->journal); db->journal->need_checkpoint = true; }
+    db->dirty |= LIB_DIRTY_TABLES;
+    lib_import_stats_t *is = &db->import_stats;
+    is->total_ms = lib_clock_ms() - t0;
+    is->rows_per_sec = is->total_ms > 0 ? (double)is->rows * 1000.0 / is->total_ms : 0.0;
     return st;
 }
 
 lib_status_t lib_db_import_csv(library_db_t *db, const char *path) {
-    if (!db || !path) return LIB_ERR_INVALID_ARG;
-    if (db->books) { free(db->books); db->books = NULL; db->books_capacity = db->books_count = 0; }
-    if (db->borrowers) { free(db->borrowers); db->borrowers = NULL; db->borrowers_capacity = db->borrowers_count = 0; }
-    if (db->loans) { free(db->loans); db->loans = NULL; db->loans_capacity = db->loans_count = 0; }
-    lib_status_t st = read_books_csv(db, path); if (st != LIB_OK) return st;
-    st = read_borrowers_csv(db, path); if (st != LIB_OK) return st;
-    st = read_loans_csv(db, path); return st;
-}
-
-/* Compatibility wrappers for older caller expectations */
-/* Provide a mutable find and a delete alias used by admin.c */
-book_t *lib_find_book_by_isbn_mutable(library_db_t *db, const char *isbn) {
-    if (!db || !isbn) return NULL;
-    for (size_t i = 0; i < db->books_count; ++i) if (strcmp(db->books[i].isbn, isbn) == 0) return &db->books[i];
-    return NULL;
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = db_import_csv(db, path);
+    lib_db_unlock(&lk);
+    return st;
 }
 
-lib_status_t lib_delete_book(library_db_t *db, const char *isbn) {
+/* Compatibility wrapper: delete alias used by admin.c */
+static lib_status_t delete_book(library_db_t *db, lib_isbn_t isbn) {
     return lib_remove_book(db, isbn);
 }
+
+lib_status_t lib_delete_book(library_db_t *db, lib_isbn_t isbn) {
+    lib_db_lock_t lk;
+    if (!lib_db_write_lock(db, &lk)) return LIB_ERR_INVALID_ARG;
+    lib_status_t st = delete_book(db, isbn);
+    lib_db_unlock(&lk);
+    return st;
+}
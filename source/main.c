@@ -85,6 +85,8 @@ int main(void) {
         return 1;
     }
 
+    ui_set_db(db);
+
     /* Set fine policy (optional) */
     db->fine_per_day = LIB_DEFAULT_FINE_PER_DAY;
 
@@ -140,7 +142,7 @@ int main(void) {
                        "9781234567897", "Demo Book", "Demo Author", 50000.00, 5, 3);
                 printf("\n--- Contoh Tampilan Detail Buku ---\n");
                 book_t sample_book = {
-                    .isbn = "9781234567897",
+                    .isbn = 9781234567897ULL,
                     .title = "Demo Book",
                     .author = "Demo Author",
                     .year = 2023,
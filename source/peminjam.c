@@ -6,7 +6,8 @@
  * Fitur:
  *  - Login/registrasi sederhana berdasarkan NIM
  *  - Cari buku (by ISBN exact atau title substring)
- *  - Checkout (peminjaman) otomatis menyimpan DB (auto-save)
+ *  - Checkout (peminjaman) otomatis menyimpan DB (auto-save); beberapa ISBN
+ *    dipisah koma dipinjam sekaligus lewat lib_checkout_batch
  *  - Return (pengembalian) otomatis menyimpan DB + menampilkan denda
  *  - Lihat daftar pinjaman milik peminjam (estimasi denda)
  *  - Lapor buku hilang (mark lost) otomatis menyimpan DB + biaya
@@ -52,6 +53,7 @@ static int portable_strcasecmp(const char *a, const char *b) {
 
 static char *read_line_local(char *buf, size_t size) {
     if (!buf || size == 0) return NULL;
+    ui_idle_sync();
     if (fgets(buf, (int)size, stdin) == NULL) return NULL;
     size_t len = strlen(buf);
     while (len > 0 && (buf[len-1] == '\n' || buf[len-1] == '\r')) buf[--len] = '\0';
@@ -90,10 +92,13 @@ static void tampilkan_daftar_buku(library_db_t *db) {
            "======",
            "=========");
 
-    for (size_t i = 0; i < db->books_count; i++) {
-        const book_t *b = &db->books[i];
+    for (size_t i = 0; i < lib_book_count(db); i++) {
+        const book_t *b = lib_book_at(db, i);
+        if (lib_book_is_deleted(b)) continue;
+        char isbn[LIB_ISBN_TEXT_MAX];
+        lib_isbn_format(b->isbn, isbn, sizeof(isbn));
         printf("%-15s | %-28s | %-18s | Rp%8.2f | %-6d | %d\n",
-               b->isbn, 
+               isbn, 
                (strlen(b->title) > 28) ? "..." : b->title, 
                (strlen(b->author) > 18) ? "..." : b->author,
                b->price, b->total_stock, b->available);
@@ -102,30 +107,38 @@ static void tampilkan_daftar_buku(library_db_t *db) {
 }
 
 /* Auto-mark overdue loans as lost for a borrower */
-static void auto_mark_overdue_loans_lost(library_db_t *db, const char *borrower_id) {
+static void auto_mark_overdue_loans_lost(library_db_t *db, lib_id_t borrower_id) {
     loan_t *loans[64];
-    size_t found = lib_find_loans_by_borrower(db, borrower_id, loans, 64);
+    size_t found = lib_find_active_loans_by_borrower(db, borrower_id, loans, 64);
     if (found == 0) return;
 
-    lib_date_t today = lib_date_from_time_t(time(NULL));
+    lib_day_t today = lib_day_today();
     unsigned long max_overdue = lib_get_max_overdue_days_before_lost(db);
     int marked = 0;
 
+    /* Menandai hilang memindahkan loan ke riwayat (pointer lain bisa bergeser),
+     * jadi kumpulkan ID yang terlambat dulu */
+    lib_id_t overdue[64];
+    size_t n_overdue = 0;
     for (size_t i = 0; i < found; i++) {
-        loan_t *l = loans[i];
-        if (!l->is_returned && !l->is_lost) {
-            int late = lib_date_days_between(l->date_due, today);
-            if ((unsigned long)late > max_overdue) {
-                unsigned long cost = 0;
-                lib_status_t st = lib_mark_book_lost(db, l->loan_id, &cost);
-                if (st == LIB_OK) {
-                    marked++;
-                    printf("[!] Pinjaman %s otomatis ditandai HILANG (terlambat > %lu hari). Biaya penggantian: Rp%lu\n",
-                           l->loan_id, max_overdue, cost);
-                } else {
-                    printf("[!] Gagal menandai hilang otomatis untuk %s (kode: %d)\n", l->loan_id, (int)st);
-                }
-            }
+        const loan_t *l = loans[i];
+        int late = (int)(today - l->date_due);
+        /* late < 0 (belum jatuh tempo) jangan ikut lolos lewat cast unsigned */
+        if (late > 0 && (unsigned long)late > max_overdue)
+            overdue[n_overdue++] = l->loan_id;
+    }
+
+    for (size_t i = 0; i < n_overdue; i++) {
+        unsigned long cost = 0;
+        char id[LIB_ID_TEXT_MAX];
+        lib_id_format(overdue[i], 'L', id, sizeof(id));
+        lib_status_t st = lib_mark_book_lost(db, overdue[i], &cost);
+        if (st == LIB_OK) {
+            marked++;
+            printf("[!] Pinjaman %s otomatis ditandai HILANG (terlambat > %lu hari). Biaya penggantian: Rp%lu\n",
+                   id, max_overdue, cost);
+        } else {
+            printf("[!] Gagal menandai hilang otomatis untuk %s (kode: %d)\n", id, (int)st);
         }
     }
 
@@ -135,10 +148,13 @@ static void auto_mark_overdue_loans_lost(library_db_t *db, const char *borrower_
     }
 }
 
-/* Tampilkan pinjaman yang sedang aktif untuk peminjam */
-static void tampilkan_pinjaman_aktif(library_db_t *db, const char *borrower_id) {
-    loan_t *loans[64];
-    size_t found = lib_find_loans_by_borrower(db, borrower_id, loans, 64);
+/* Tampilkan pinjaman yang sedang aktif untuk peminjam, lalu pinjaman hilang
+ * yang belum dilunasi. Dua query terpisah: jumlah riwayat tidak menggeser
+ * pinjaman aktif keluar dari daftar. */
+static void tampilkan_pinjaman_aktif(library_db_t *db, lib_id_t borrower_id) {
+    loan_t *loans[128];
+    size_t found = lib_find_active_loans_by_borrower(db, borrower_id, loans, 64);
+    found += lib_find_lost_loans_by_borrower(db, borrower_id, loans + found, 64);
     if (found == 0) {
         printf("Tidak ada pinjaman aktif.\n");
         return;
@@ -150,20 +166,20 @@ static void tampilkan_pinjaman_aktif(library_db_t *db, const char *borrower_id)
     printf("%-10s-+-%-13s-+-%-28s-+-%-12s-+-%-12s-+-%s\n",
            "==========", "=============", "============================", "============", "============", "==========");
 
-    lib_date_t today = lib_date_from_time_t(time(NULL));
+    lib_day_t today = lib_day_today();
     for (size_t i = 0; i < found; i++) {
         const loan_t *l = loans[i];
         const book_t *b = lib_find_book_by_isbn(db, l->isbn);
 
-        char date_borrow[16], date_due[16];
-        snprintf(date_borrow, sizeof(date_borrow), "%04d-%02d-%02d",
-                l->date_borrow.year, l->date_borrow.month, l->date_borrow.day);
-        snprintf(date_due, sizeof(date_due), "%04d-%02d-%02d",
-                l->date_due.year, l->date_due.month, l->date_due.day);
+        char date_borrow[16], date_due[16], id[LIB_ID_TEXT_MAX], isbn[LIB_ISBN_TEXT_MAX];
+        lib_day_format(l->date_borrow, date_borrow, sizeof(date_borrow));
+        lib_day_format(l->date_due, date_due, sizeof(date_due));
+        lib_id_format(l->loan_id, 'L', id, sizeof(id));
+        lib_isbn_format(l->isbn, isbn, sizeof(isbn));
 
         printf("%-10s %-15s %-30s %-12s %-12s ",
-               l->loan_id,
-               l->isbn,
+               id,
+               isbn,
                b ? b->title : "???",
                date_borrow,
                date_due);
@@ -180,9 +196,8 @@ static void tampilkan_pinjaman_aktif(library_db_t *db, const char *borrower_id)
                 cost = (unsigned long)db->fine_per_day * days;
             }
             if ((unsigned long)l->fine_paid == cost && cost > 0) {
-                // Update status di memori agar konsisten
-                ((loan_t*)l)->is_lost = false;
-                ((loan_t*)l)->is_returned = true;
+                // Update status agar konsisten (tersimpan pada save berikutnya)
+                lib_settle_lost_loan(db, l->loan_id);
                 printf("Kembali\n");
             } else {
                 printf("HILANG\n");
@@ -190,7 +205,7 @@ static void tampilkan_pinjaman_aktif(library_db_t *db, const char *borrower_id)
         } else if (l->is_returned) {
             printf("Kembali\n");
         } else {
-            int late = lib_date_days_between(l->date_due, today);
+            int late = (int)(today - l->date_due);
             if (late > 0) {
                 printf("TERLAMBAT %d hari\n", late);
             } else {
@@ -200,6 +215,75 @@ static void tampilkan_pinjaman_aktif(library_db_t *db, const char *borrower_id)
     }
 }
 
+/* Pinjam beberapa buku sekaligus (ISBN dipisah koma): satu batch, satu save.
+ * Jika satu buku ditolak, tidak ada yang dipinjam; status tiap ISBN dicetak. */
+#define PINJAM_BATCH_MAX 20
+static void pinjam_banyak_buku(library_db_t *db, const borrower_t *current, char *input) {
+    lib_checkout_item_t items[PINJAM_BATCH_MAX];
+    size_t n = 0;
+    for (char *tok = strtok(input, ","); tok && n < PINJAM_BATCH_MAX; tok = strtok(NULL, ",")) {
+        trim_spaces(tok);
+        if (tok[0] == '\0') continue;
+        memset(&items[n], 0, sizeof(items[n]));
+        items[n].isbn = lib_isbn_key(tok);
+        items[n].borrower = current;
+        n++;
+    }
+    if (n == 0) return;
+
+    printf("\nBuku yang akan dipinjam (%lu):\n", (unsigned long)n);
+    for (size_t i = 0; i < n; ++i) {
+        char isbn[LIB_ISBN_TEXT_MAX];
+        lib_isbn_format(items[i].isbn, isbn, sizeof(isbn));
+        const book_t *b = lib_find_book_by_isbn(db, items[i].isbn);
+        printf("  %2lu. %-20s %s\n", (unsigned long)(i + 1), isbn, b ? b->title : "(tidak ditemukan)");
+    }
+    printf("\nKonfirmasi peminjaman? [Y/N]: ");
+    char buf[32];
+    if (!read_line_local(buf, sizeof(buf)) || (buf[0] != 'y' && buf[0] != 'Y' && buf[0] != '\0')) return;
+
+    printf("\nMasukkan tanggal peminjaman (YYYY-MM-DD): ");
+    char date_str[11];
+    if (!read_line_local(date_str, sizeof(date_str))) return;
+    lib_date_t borrow_date = {0};
+    if (sscanf(date_str, "%d-%d-%d", &borrow_date.year, &borrow_date.month, &borrow_date.day) != 3) {
+        printf("[!] Format tanggal tidak valid. Gunakan format YYYY-MM-DD\n");
+        return;
+    }
+    lib_date_t due_date = lib_date_add_days(borrow_date, 7); // 7 hari peminjaman
+
+    lib_status_t st = lib_checkout_batch(db, items, n, borrow_date, due_date);
+    if (st != LIB_OK) {
+        /* Status per ISBN: penyebab penolakan, atau ID pinjam jika item sudah
+         * diterapkan sebelum batch gagal (memori / save) */
+        printf("[!] Peminjaman gagal (kode: %d). Status per buku:\n", (int)st);
+        for (size_t i = 0; i < n; ++i) {
+            char isbn[LIB_ISBN_TEXT_MAX];
+            lib_isbn_format(items[i].isbn, isbn, sizeof(isbn));
+            if (items[i].loan_id != LIB_ID_NONE) {
+                char id[LIB_ID_TEXT_MAX];
+                lib_id_format(items[i].loan_id, 'L', id, sizeof(id));
+                printf("  - %-20s tercatat (ID Pinjam: %s), belum tersimpan ke disk\n", isbn, id);
+                continue;
+            }
+            const char *why = items[i].status == LIB_OK ? "dibatalkan (buku lain gagal)"
+                            : items[i].status == LIB_ERR_NO_STOCK ? "stok tidak cukup"
+                            : items[i].status == LIB_ERR_NOT_FOUND ? "tidak ditemukan"
+                            : items[i].status == LIB_ERR_MEMORY ? "memori tidak cukup" : "tidak valid";
+            printf("  - %-20s %s (kode: %d)\n", isbn, why, (int)items[i].status);
+        }
+        return;
+    }
+    printf("Peminjaman berhasil!\n");
+    for (size_t i = 0; i < n; ++i) {
+        char id[LIB_ID_TEXT_MAX];
+        lib_id_format(items[i].loan_id, 'L', id, sizeof(id));
+        printf("  ID Pinjam: %s\n", id);
+    }
+    printf("Tanggal kembali: %04d-%02d-%02d\n", due_date.year, due_date.month, due_date.day);
+    animation_loading_bar(400);
+}
+
 void menu_peminjam(library_db_t *db) {
     if (!db) {
         printf("[!] Database belum diinisialisasi.\n");
@@ -230,13 +314,15 @@ void menu_peminjam(library_db_t *db) {
     animation_delay(450);
 
     if (current->name[0] == '\0') {
+        borrower_t profile = *current;
         printf("\n--- Lengkapi Data Anda ---\n\n");
         printf("Nama Lengkap\t: ");
-        read_line_local(current->name, LIB_MAX_NAME);
+        read_line_local(profile.name, LIB_MAX_NAME);
         printf("No. Telepon\t: ");
-        read_line_local(current->phone, sizeof(current->phone));
+        read_line_local(profile.phone, sizeof(profile.phone));
         printf("Email\t\t: ");
-        read_line_local(current->email, sizeof(current->email));
+        read_line_local(profile.email, sizeof(profile.email));
+        lib_update_borrower(db, current->id, &profile);
         lib_db_save(db);
         printf("Data berhasil disimpan.\n");
     }
@@ -264,7 +350,7 @@ void menu_peminjam(library_db_t *db) {
                 ui_clear_screen();
                 animation_typewriter("[Peminjam] Memuat daftar buku...", 25);
                 animation_delay(300);
-                animation_bookshelf_scan((int)(db->books_count > 12 ? 12 : db->books_count));
+                animation_bookshelf_scan((int)(lib_book_count(db) > 12 ? 12 : lib_book_count(db)));
                 tampilkan_daftar_buku(db);
                 break;
 
@@ -293,10 +379,14 @@ void menu_peminjam(library_db_t *db) {
                 ui_clear_screen();
                 animation_typewriter("[Peminjam] Pinjam buku...", 25);
                 animation_delay(300);
-                printf("\nMasukkan ISBN buku yang akan dipinjam: ");
+                printf("\nMasukkan ISBN buku yang akan dipinjam (beberapa buku: pisahkan dengan koma): ");
                 if (!read_line_local(input, sizeof(input))) break;
+                if (strchr(input, ',')) {
+                    pinjam_banyak_buku(db, current, input);
+                    break;
+                }
                 
-                const book_t *b = lib_find_book_by_isbn(db, input);
+                const book_t *b = lib_find_book_by_isbn(db, lib_isbn_key(input));
                 if (!b) {
                     printf("[!] Buku tidak ditemukan.\n");
                     break;
@@ -325,14 +415,15 @@ void menu_peminjam(library_db_t *db) {
                 }
                 
                 lib_date_t today = lib_date_from_time_t(time(NULL));
-                lib_date_t due_date = borrow_date;
-                due_date.day += 7; // 7 hari peminjaman
+                lib_date_t due_date = lib_date_add_days(borrow_date, 7); // 7 hari peminjaman
                 
-                char loan_id[32];
-                lib_status_t st = lib_checkout_book(db, b->isbn, current, borrow_date, due_date, loan_id);
+                lib_id_t loan_id = LIB_ID_NONE;
+                lib_status_t st = lib_checkout_book(db, b->isbn, current, borrow_date, due_date, &loan_id);
                 if (st == LIB_OK) {
+                    char id[LIB_ID_TEXT_MAX];
+                    lib_id_format(loan_id, 'L', id, sizeof(id));
                     printf("Peminjaman berhasil!\n");
-                    printf("ID Pinjam: %s\n", loan_id);
+                    printf("ID Pinjam: %s\n", id);
                     printf("Tanggal kembali: %04d-%02d-%02d\n", 
                            due_date.year, due_date.month, due_date.day);
                     lib_db_save(db);
@@ -360,11 +451,10 @@ void menu_peminjam(library_db_t *db) {
                 printf("\nMasukkan ID Pinjaman yang akan dikembalikan\t: ");
                 if (!read_line_local(input, sizeof(input))) break;
 
+                lib_id_t loan_id = LIB_ID_NONE;
+                (void)lib_id_parse(input, &loan_id);
                 /* Find the loan first to check if it should be marked lost */
-                loan_t *found_ln = NULL;
-                for (size_t ii = 0; ii < db->loans_count; ++ii) {
-                    if (strcmp(db->loans[ii].loan_id, input) == 0) { found_ln = &db->loans[ii]; break; }
-                }
+                loan_t *found_ln = lib_find_loan_by_id_mutable(db, loan_id);
                 if (!found_ln) {
                     printf("[!] Loan ID '%s' tidak ditemukan.\n", input);
                     break;
@@ -382,7 +472,7 @@ void menu_peminjam(library_db_t *db) {
                             unsigned long days = lib_get_replacement_cost_days(db);
                             cost = (unsigned long) db->fine_per_day * days;
                         }
-                        found_ln->fine_paid = (long) cost;
+                        lib_set_loan_payment(db, loan_id, (long) cost);
                         lib_db_save(db);
                     }
                     unsigned long cost = (unsigned long)found_ln->fine_paid;
@@ -400,11 +490,10 @@ void menu_peminjam(library_db_t *db) {
                             }
                             unsigned long paid = strtoul(paybuf, NULL, 10);
                             if (paid == cost) {
-                                lib_set_loan_payment(db, input, (long)paid);
+                                lib_set_loan_payment(db, loan_id, (long)paid);
                                 printf("Pembayaran penggantian Rp%lu dicatat. Terima kasih.\n", paid);
                                 /* Perbaikan: update status jika sudah bayar penggantian */
-                                found_ln->is_lost = false;
-                                found_ln->is_returned = true;
+                                lib_settle_lost_loan(db, loan_id);
                                 lib_db_save(db);
                                 animation_loading_bar(400);
                                 printf("Status pinjaman telah diupdate menjadi Kembali.\n");
@@ -424,13 +513,13 @@ void menu_peminjam(library_db_t *db) {
                 }
 
                 lib_date_t today = lib_date_from_time_t(time(NULL));
-                int late = lib_date_days_between(found_ln->date_due, today);
+                int late = (int)(lib_date_to_days(today) - found_ln->date_due);
                 unsigned long max_overdue = lib_get_max_overdue_days_before_lost(db);
 
-                if ((unsigned long)late > max_overdue) {
+                if (late > 0 && (unsigned long)late > max_overdue) {
                     /* Mark as lost instead of returning */
                     unsigned long cost = 0;
-                    lib_status_t st2 = lib_mark_book_lost(db, input, &cost);
+                    lib_status_t st2 = lib_mark_book_lost(db, loan_id, &cost);
                     if (st2 == LIB_OK) {
                         printf("Pinjaman %s terlambat lebih dari %lu hari dan otomatis ditandai HILANG. Biaya penggantian: Rp%lu\n", input, max_overdue, cost);
                         /* Require exact payment for replacement cost */
@@ -445,7 +534,7 @@ void menu_peminjam(library_db_t *db) {
                             }
                             unsigned long paid2 = strtoul(paybuf2, NULL, 10);
                             if (paid2 == cost) {
-                                lib_set_loan_payment(db, input, (long)paid2);
+                                lib_set_loan_payment(db, loan_id, (long)paid2);
                                 printf("Pembayaran penggantian Rp%lu dicatat. Terima kasih.\n", paid2);
                                 break;
                             } else {
@@ -460,7 +549,7 @@ void menu_peminjam(library_db_t *db) {
                 } else {
                     /* Normal return */
                     unsigned long fine = 0;
-                    lib_status_t st = lib_return_book(db, input, today, &fine);
+                    lib_status_t st = lib_return_book(db, loan_id, today, &fine);
                     if (st == LIB_OK) {
                         printf("Buku berhasil dikembalikan!\n");
                         if (fine > 0) {
@@ -477,7 +566,7 @@ void menu_peminjam(library_db_t *db) {
                                 }
                                 unsigned long paid = strtoul(paybuf, NULL, 10);
                                 if (paid == fine) {
-                                    lib_set_loan_payment(db, input, (long)paid);
+                                    lib_set_loan_payment(db, loan_id, (long)paid);
                                     printf("Pembayaran Rp%lu dicatat. Terima kasih.\n", paid);
                                     break;
                                 } else {
@@ -502,11 +591,10 @@ void menu_peminjam(library_db_t *db) {
                 printf("\nMasukkan ID Pinjaman yang akan dilaporkan HILANG (atau kosong untuk batal)\t: ");
                 if (!read_line_local(input, sizeof(input))) break;
                 if (input[0] == '\0') break;
+                lib_id_t loan_id = LIB_ID_NONE;
+                (void)lib_id_parse(input, &loan_id);
                 /* Find the loan in DB first and validate status before marking lost */
-                loan_t *found_ln = NULL;
-                for (size_t ii = 0; ii < db->loans_count; ++ii) {
-                    if (strcmp(db->loans[ii].loan_id, input) == 0) { found_ln = &db->loans[ii]; break; }
-                }
+                loan_t *found_ln = lib_find_loan_by_id_mutable(db, loan_id);
                 if (!found_ln) {
                     printf("[!] Loan ID '%s' tidak ditemukan.\n", input);
                     break;
@@ -521,7 +609,7 @@ void menu_peminjam(library_db_t *db) {
                 }
 
                 unsigned long cost = 0;
-                lib_status_t st2 = lib_mark_book_lost(db, input, &cost);
+                lib_status_t st2 = lib_mark_book_lost(db, loan_id, &cost);
                 if (st2 == LIB_OK) {
                     printf("Pinjaman %s berhasil ditandai HILANG. Biaya penggantian: Rp%lu\n", input, cost);
                     /* Require exact payment for replacement cost */
@@ -536,7 +624,7 @@ void menu_peminjam(library_db_t *db) {
                         }
                         unsigned long paid2 = strtoul(paybuf2, NULL, 10);
                         if (paid2 == cost) {
-                            lib_set_loan_payment(db, input, (long)paid2);
+                            lib_set_loan_payment(db, loan_id, (long)paid2);
                             printf("Pembayaran penggantian Rp%lu dicatat. Terima kasih.\n", paid2);
                             break;
                         } else {
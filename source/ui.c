@@ -54,7 +54,7 @@ void ensure_sample_data() {
         // Sample books
         book_t sample_books[] = {
             {
-                .isbn = "9780141988511",
+                .isbn = 9780141988511ULL,
                 .title = "21 Lessons for the 21st Century",
                 .author = "Yuval Noah Harari",
                 .total_stock = 3,
@@ -63,7 +63,7 @@ void ensure_sample_data() {
                 , .price = 30000.00
             },
             {
-                .isbn = "9780545010221",
+                .isbn = 9780545010221ULL,
                 .title = "Harry Potter and the Deathly Hallows",
                 .author = "J.K. Rowling",
                 .total_stock = 5,
@@ -72,7 +72,7 @@ void ensure_sample_data() {
                 , .price = 45000.00
             },
             {
-                .isbn = "9780262033848",
+                .isbn = 9780262033848ULL,
                 .title = "Introduction to Algorithms",
                 .author = "Thomas H. Cormen",
                 .total_stock = 4,
@@ -81,7 +81,7 @@ void ensure_sample_data() {
                 , .price = 75000.00
             },
             {
-                .isbn = "9780134685991",
+                .isbn = 9780134685991ULL,
                 .title = "Clean Architecture",
                 .author = "Robert C. Martin",
                 .total_stock = 2,
@@ -114,8 +114,19 @@ void header_tampilan(const char *title) {
     printf("\n================ %s ================\n", title);
 }
 
+static library_db_t *ui_db;
+
+void ui_set_db(library_db_t *db) {
+    ui_db = db;
+}
+
+void ui_idle_sync(void) {
+    if (ui_db) lib_db_tick(ui_db, true, NULL);
+}
+
 // Wait for user to press enter
 void press_enter() {
+    ui_idle_sync();
     printf("Press Enter to continue...");
     while (getchar() != '\n');
 }
@@ -216,6 +227,7 @@ int ui_save_theme(int color_code) {
 // Helper untuk membaca input dengan aman
 char *ui_read_line(char *buf, size_t size) {
     if (!buf || size == 0) return NULL;
+    ui_idle_sync();
     if (fgets(buf, (int)size, stdin) == NULL) return NULL;
     size_t len = strlen(buf);
     while (len > 0 && (buf[len-1] == '\n' || buf[len-1] == '\r')) {
@@ -154,8 +154,10 @@ void ui_show_book_detail(const book_t *b) {
     printf("%s", T_title);
     printf("%s", T_sep);
     if (b) {
+        char isbn[LIB_ISBN_TEXT_MAX];
+        lib_isbn_format(b->isbn, isbn, sizeof(isbn));
         if (view_use_ascii) {
-            printf("| ISBN         : %-60s |\n", b->isbn);
+            printf("| ISBN         : %-60s |\n", isbn);
             printf("| Judul        : %-60s |\n", b->title);
             printf("| Penulis      : %-60s |\n", b->author);
             printf("| Tahun Terbit : %-60d |\n", b->year);
@@ -171,7 +173,7 @@ void ui_show_book_detail(const book_t *b) {
                 printf("| Catatan      : %-60s |\n", b->notes);
             }
         } else {
-            printf("║ ISBN         : %-60s ║\n", b->isbn);
+            printf("║ ISBN         : %-60s ║\n", isbn);
             printf("║ Judul        : %-60s ║\n", b->title);
             printf("║ Penulis      : %-60s ║\n", b->author);
             printf("║ Tahun Terbit : %-60d ║\n", b->year);